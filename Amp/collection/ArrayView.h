@@ -2,6 +2,8 @@
 
 #include <dev/Dev.h>
 
+#include <type_traits>
+
 namespace Collection
 {
 /**
@@ -23,9 +25,10 @@ public:
 	ArrayView(const ArrayView<T>&) = default;
 	ArrayView<T>& operator=(const ArrayView<T>&) = default;
 
-	// ArrayView<T> can be implicitly converted to ArrayView<const T>.
-	template <typename NonConstT = std::enable_if_t<std::is_const_v<T>, std::remove_const_t<T>>>
-	ArrayView(const ArrayView<NonConstT>& rhs)
+	// ArrayView<T> can be implicitly converted to ArrayView<const T>, including through pointer element types, such as
+	// from ArrayView<T* const> to ArrayView<const T* const>. Array pointers only convert by adding qualifiers.
+	template <typename U, typename = std::enable_if_t<!std::is_same_v<U, T> && std::is_convertible_v<U(*)[], T(*)[]>>>
+	ArrayView(const ArrayView<U>& rhs)
 		: m_data(rhs.begin())
 		, m_count(rhs.Size())
 	{}
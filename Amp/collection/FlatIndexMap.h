@@ -0,0 +1,48 @@
+#pragma once
+
+#include <collection/Vector.h>
+
+#include <cstdint>
+
+namespace Collection
+{
+/**
+ * Maps 64-bit keys to 32-bit indices in a single open-addressed table with linear probing. Keys and indices are
+ * stored side by side, so a lookup is typically a hash and one or two loads from the same cache line.
+ * The table doubles in size whenever it becomes half full. Removal shifts the following entries back rather than
+ * leaving tombstones, so lookups never slow down as keys are added and removed.
+ */
+class FlatIndexMap
+{
+public:
+	static constexpr uint32_t k_invalidIndex = UINT32_MAX;
+
+	FlatIndexMap() = default;
+
+	// Returns k_invalidIndex if the key has no index.
+	uint32_t Find(const uint64_t key) const;
+
+	void Set(const uint64_t key, const uint32_t index);
+	void Remove(const uint64_t key);
+
+	uint32_t Size() const { return m_numEntries; }
+	void Clear();
+
+private:
+	static constexpr uint32_t k_initialCapacity = 16;
+
+	struct Entry
+	{
+		uint64_t m_key{ 0 };
+		uint32_t m_index{ k_invalidIndex };
+	};
+
+	uint32_t FindEntryIndex(const uint64_t key) const;
+	uint32_t GetIdealEntryIndex(const uint64_t key) const;
+	void Grow();
+
+	// An entry is empty if its index is k_invalidIndex. The number of entries is always a power of two.
+	Collection::Vector<Entry> m_entries;
+	uint32_t m_numEntries{ 0 };
+};
+}
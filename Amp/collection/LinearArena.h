@@ -0,0 +1,68 @@
+#pragma once
+
+#include <collection/Vector.h>
+
+#include <cstdint>
+
+namespace Collection
+{
+/**
+ * An allocator that allocates by bumping an offset through blocks of memory. Allocations can't be freed individually;
+ * Reset() makes all of the arena's memory available again at once. Reset() merges the blocks used since the previous
+ * reset into one block, so an arena which is reset periodically stops allocating once it has grown to its peak usage.
+ * Not thread-safe.
+ */
+class LinearArena final
+{
+public:
+	static constexpr size_t k_defaultBlockSizeInBytes = 64 * 1024;
+
+	LinearArena() = default;
+	explicit LinearArena(const size_t blockSizeInBytes);
+
+	LinearArena(const LinearArena&) = delete;
+	LinearArena& operator=(const LinearArena&) = delete;
+
+	LinearArena(LinearArena&& other);
+	LinearArena& operator=(LinearArena&& rhs);
+
+	~LinearArena();
+
+	void* Alloc(const size_t sizeInBytes, const size_t alignmentInBytes);
+
+	// Allocate uninitialized memory for an array of the given type.
+	template <typename T>
+	T* AllocArray(const size_t numElements);
+
+	// Make all of the arena's memory available for reuse. Invalidates everything allocated from the arena.
+	void Reset();
+
+	size_t GetNumBytesAllocated() const { return m_numBytesAllocated; }
+
+private:
+	struct Block
+	{
+		uint8_t* m_memory{ nullptr };
+		size_t m_sizeInBytes{ 0 };
+	};
+
+	void FreeBlocks();
+
+	Collection::Vector<Block> m_blocks;
+	size_t m_blockSizeInBytes{ k_defaultBlockSizeInBytes };
+
+	// Allocations are made from the last block.
+	size_t m_offsetInLastBlock{ 0 };
+	size_t m_numBytesAllocated{ 0 };
+};
+}
+
+// Inline implementations.
+namespace Collection
+{
+template <typename T>
+inline T* LinearArena::AllocArray(const size_t numElements)
+{
+	return static_cast<T*>(Alloc(sizeof(T) * numElements, alignof(T)));
+}
+}
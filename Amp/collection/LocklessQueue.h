@@ -1,64 +1,187 @@
 #pragma once
 
-#include <collection/Vector.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
 
 namespace Collection
 {
 /**
- * A lockless, thread safe, single producer/single consumer queue with a fixed capacity.
+ * A lockless, thread safe, multiple producer/multiple consumer queue with a fixed capacity.
+ * The queue is a ring of cells which each have a sequence number. A thread claims a cell by advancing the head or tail
+ * of the queue with a compare-and-swap, and then publishes the cell by updating its sequence number, so producers and
+ * consumers only contend with each other when the queue is nearly empty or nearly full.
+ * The capacity is rounded up to a power of two.
  */
 template <typename T>
 class LocklessQueue
 {
 public:
-	explicit LocklessQueue(size_t capacity)
-		: m_queue(static_cast<T*>(malloc(sizeof(T) * capacity)))
-		, m_inputIndex(0)
-		, m_outputIndex(0)
-		, m_capacity(capacity)
-	{}
-
-	~LocklessQueue()
+	explicit LocklessQueue(size_t capacity);
+
+	LocklessQueue(const LocklessQueue&) = delete;
+	LocklessQueue& operator=(const LocklessQueue&) = delete;
+
+	~LocklessQueue();
+
+	size_t GetCapacity() const { return m_mask + 1; }
+
+	bool TryPush(T&& item);
+	bool TryPop(T& outItem);
+
+	// Push up to numItems items from the given array, preserving their order. Returns the number of items pushed,
+	// which are moved from; items that don't fit are left untouched.
+	size_t TryPushBatch(T* items, const size_t numItems);
+
+	// Pop up to maxNumItems items into the given array. Returns the number of items popped.
+	size_t TryPopBatch(T* outItems, const size_t maxNumItems);
+
+private:
+	static constexpr size_t k_cacheLineSize = 64;
+
+	struct Cell
 	{
-		free(m_queue);
-		m_queue = nullptr;
-	}
+		// The position in the queue at which the cell can next be pushed to is equal to the cell's sequence.
+		// The position at which it can next be popped from is one less than its sequence.
+		std::atomic<size_t> m_sequence;
+		alignas(T) uint8_t m_storage[sizeof(T)];
+
+		T& GetItem() { return *reinterpret_cast<T*>(m_storage); }
+	};
+
+	// Claim up to maxNumCells consecutive cells whose sequence is their position plus sequenceOffset by advancing
+	// the given position. Returns the number of claimed cells and the position of the first in outPosition.
+	size_t ClaimCells(std::atomic<size_t>& position, const size_t sequenceOffset, const size_t maxNumCells,
+		size_t& outPosition);
+
+	Cell* m_cells;
+	size_t m_mask;
 
-	bool TryPush(T&& item)
+	// The head and tail are on separate cache lines so that producers and consumers don't falsely share them.
+	alignas(k_cacheLineSize) std::atomic<size_t> m_pushPosition{ 0 };
+	alignas(k_cacheLineSize) std::atomic<size_t> m_popPosition{ 0 };
+};
+}
+
+// Inline implementations.
+namespace Collection
+{
+template <typename T>
+inline LocklessQueue<T>::LocklessQueue(size_t capacity)
+{
+	size_t roundedCapacity = 2;
+	while (roundedCapacity < capacity)
 	{
-		const size_t nextInputIndex = NextIndex(m_inputIndex);
-		if (nextInputIndex == m_outputIndex)
-		{
-			return false;
-		}
+		roundedCapacity *= 2;
+	}
 
-		new (&m_queue[m_inputIndex]) T(std::move(item));
-		m_inputIndex = nextInputIndex;
-		return true;
+	m_cells = new Cell[roundedCapacity];
+	m_mask = roundedCapacity - 1;
+	for (size_t i = 0; i < roundedCapacity; ++i)
+	{
+		m_cells[i].m_sequence.store(i, std::memory_order_relaxed);
 	}
+}
 
-	bool TryPop(T& outItem)
+template <typename T>
+inline LocklessQueue<T>::~LocklessQueue()
+{
+	// Destroy any items left in the queue.
+	const size_t pushPosition = m_pushPosition.load(std::memory_order_acquire);
+	for (size_t i = m_popPosition.load(std::memory_order_acquire); i != pushPosition; ++i)
 	{
-		if (m_outputIndex == m_inputIndex)
-		{
-			return false;
-		}
+		m_cells[i & m_mask].GetItem().~T();
+	}
+
+	delete[] m_cells;
+	m_cells = nullptr;
+}
 
-		outItem = std::move(m_queue[m_outputIndex]);
-		m_queue[m_outputIndex].~T();
-		m_outputIndex = NextIndex(m_outputIndex);
-		return true;
+template <typename T>
+inline bool LocklessQueue<T>::TryPush(T&& item)
+{
+	return TryPushBatch(&item, 1) == 1;
+}
+
+template <typename T>
+inline bool LocklessQueue<T>::TryPop(T& outItem)
+{
+	return TryPopBatch(&outItem, 1) == 1;
+}
+
+template <typename T>
+inline size_t LocklessQueue<T>::TryPushBatch(T* items, const size_t numItems)
+{
+	size_t position;
+	const size_t numClaimedCells = ClaimCells(m_pushPosition, 0, numItems, position);
+
+	for (size_t i = 0; i < numClaimedCells; ++i)
+	{
+		Cell& cell = m_cells[(position + i) & m_mask];
+		new (cell.m_storage) T(std::move(items[i]));
+		cell.m_sequence.store(position + i + 1, std::memory_order_release);
 	}
+	return numClaimedCells;
+}
 
-private:
-	size_t NextIndex(size_t index)
+template <typename T>
+inline size_t LocklessQueue<T>::TryPopBatch(T* outItems, const size_t maxNumItems)
+{
+	size_t position;
+	const size_t numClaimedCells = ClaimCells(m_popPosition, 1, maxNumItems, position);
+
+	for (size_t i = 0; i < numClaimedCells; ++i)
 	{
-		return (index + 1) % m_capacity;
+		Cell& cell = m_cells[(position + i) & m_mask];
+		outItems[i] = std::move(cell.GetItem());
+		cell.GetItem().~T();
+
+		// The cell can be pushed to again once the push position has wrapped around the queue.
+		cell.m_sequence.store(position + i + m_mask + 1, std::memory_order_release);
 	}
+	return numClaimedCells;
+}
 
-	T* m_queue;
-	size_t m_inputIndex;
-	size_t m_outputIndex;
-	size_t m_capacity;
-};
+template <typename T>
+inline size_t LocklessQueue<T>::ClaimCells(std::atomic<size_t>& position, const size_t sequenceOffset,
+	const size_t maxNumCells, size_t& outPosition)
+{
+	size_t firstPosition = position.load(std::memory_order_relaxed);
+	while (true)
+	{
+		// Count the consecutive cells that are ready. Cells are published in order within a batch but batches may be
+		// published out of order, so counting stops at the first cell that isn't ready.
+		size_t numReadyCells = 0;
+		while (numReadyCells < maxNumCells)
+		{
+			const size_t cellPosition = firstPosition + numReadyCells;
+			const size_t sequence = m_cells[cellPosition & m_mask].m_sequence.load(std::memory_order_acquire);
+			if (sequence != cellPosition + sequenceOffset)
+			{
+				break;
+			}
+			++numReadyCells;
+		}
+
+		if (numReadyCells == 0)
+		{
+			// If another thread has moved the position, try again from the new position.
+			const size_t currentPosition = position.load(std::memory_order_relaxed);
+			if (currentPosition == firstPosition)
+			{
+				return 0;
+			}
+			firstPosition = currentPosition;
+			continue;
+		}
+
+		if (position.compare_exchange_weak(firstPosition, firstPosition + numReadyCells, std::memory_order_relaxed))
+		{
+			outPosition = firstPosition;
+			return numReadyCells;
+		}
+	}
+}
 }
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <collection/Vector.h>
+#include <collection/VectorMap.h>
+
+#include <cstdint>
+
+namespace Collection
+{
+/**
+ * Maps sparse 32-bit keys to dense 32-bit indices, as in the sparse half of a sparse set.
+ * Keys are grouped into fixed-size pages which are allocated when a key in them is first set and freed when their
+ * last key is removed. Because IDs tend to be allocated sequentially, a handful of pages covers most key ranges and
+ * every operation is a page lookup followed by an indexed load or store.
+ */
+class SparseIndexMap
+{
+public:
+	static constexpr uint32_t k_invalidIndex = UINT32_MAX;
+
+	SparseIndexMap() = default;
+
+	// Returns k_invalidIndex if the key has no index.
+	uint32_t Find(const uint32_t key) const;
+
+	void Set(const uint32_t key, const uint32_t index);
+	void Remove(const uint32_t key);
+
+	void Clear() { m_pages.Clear(); }
+
+private:
+	static constexpr uint32_t k_lgKeysPerPage = 10;
+	static constexpr uint32_t k_keysPerPage = 1 << k_lgKeysPerPage;
+
+	struct Page
+	{
+		uint32_t m_numSetKeys{ 0 };
+		Collection::Vector<uint32_t> m_indices;
+	};
+
+	Collection::VectorMap<uint32_t, Page> m_pages;
+};
+}
@@ -188,6 +188,18 @@ inline Vector<T>::Vector(Vector<T>&& o) noexcept
 template <typename T>
 inline void Vector<T>::operator=(Vector<T>&& rhs) noexcept
 {
+	if (this == &rhs)
+	{
+		return;
+	}
+
+	// Release this vector's elements and memory before taking ownership of rhs's.
+	for (T& element : *this)
+	{
+		(&element)->~T();
+	}
+	_aligned_free(m_data);
+
 	m_data = rhs.m_data;
 	m_capacity = rhs.m_capacity;
 	m_count = rhs.m_count;
@@ -311,14 +323,13 @@ inline void Vector<T>::Remove(const size_t start, const size_t end)
 		return;
 	}
 
-	size_t i = 0;
+	// Move every element after the removed range back to fill it, then destroy the moved-from elements at the end.
 	const size_t removeCount = (end - start);
-	for (const size_t iEnd = std::min(removeCount, m_count - end); i < iEnd; ++i)
+	for (size_t i = end, iEnd = m_count; i < iEnd; ++i)
 	{
-		m_data[start + i] = std::move(m_data[end + i]);
+		m_data[i - removeCount] = std::move(m_data[i]);
 	}
-	i += start;
-	for (const size_t iEnd = m_count; i < iEnd; ++i)
+	for (size_t i = m_count - removeCount, iEnd = m_count; i < iEnd; ++i)
 	{
 		(&m_data[i])->~T();
 	}
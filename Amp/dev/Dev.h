@@ -3,7 +3,15 @@
 #include <cstdio>
 #include <stdexcept>
 
+#if defined(_MSC_VER)
 #pragma intrinsic(__debugbreak)
+#define AMP_DEBUG_BREAK() __debugbreak()
+#define AMP_SNPRINTF(BUFFER, BUFFER_SIZE, ...) _snprintf_s(BUFFER, BUFFER_SIZE, __VA_ARGS__)
+#else
+#include <csignal>
+#define AMP_DEBUG_BREAK() raise(SIGTRAP)
+#define AMP_SNPRINTF(BUFFER, BUFFER_SIZE, ...) snprintf(BUFFER, BUFFER_SIZE, __VA_ARGS__)
+#endif
 
 #ifdef _DEBUG
 #define AMP_ASSERTS_ENABLED 1
@@ -13,50 +21,50 @@
 
 #define AMP_LOG_BUFFER_SIZE 512
 
-#define AMP_LOG(FORMAT, ...) \
+#define AMP_LOG(...) \
 	do {\
 		char buffer[AMP_LOG_BUFFER_SIZE]; \
-		_snprintf_s(buffer, AMP_LOG_BUFFER_SIZE, FORMAT, __VA_ARGS__); \
+		AMP_SNPRINTF(buffer, AMP_LOG_BUFFER_SIZE, __VA_ARGS__); \
 		Dev::PrintMessage(Dev::MessageType::Info, buffer); \
 	} while(false)
 
-#define AMP_LOG_WARNING(FORMAT, ...) \
+#define AMP_LOG_WARNING(...) \
 	do {\
 		char buffer[AMP_LOG_BUFFER_SIZE]; \
-		_snprintf_s(buffer, AMP_LOG_BUFFER_SIZE, FORMAT, __VA_ARGS__); \
+		AMP_SNPRINTF(buffer, AMP_LOG_BUFFER_SIZE, __VA_ARGS__); \
 		Dev::PrintMessage(Dev::MessageType::Warning, buffer); \
 	} while(false)
 
-#define AMP_LOG_ERROR(FORMAT, ...) \
+#define AMP_LOG_ERROR(...) \
 	do {\
 		char buffer[AMP_LOG_BUFFER_SIZE]; \
-		_snprintf_s(buffer, AMP_LOG_BUFFER_SIZE, FORMAT, __VA_ARGS__); \
+		AMP_SNPRINTF(buffer, AMP_LOG_BUFFER_SIZE, __VA_ARGS__); \
 		Dev::PrintMessage(Dev::MessageType::Error, buffer); \
 	} while(false)
 
-#define AMP_FATAL_ERROR(FORMAT, ...) \
+#define AMP_FATAL_ERROR(...) \
 	do {\
 		char buffer[AMP_LOG_BUFFER_SIZE]; \
-		_snprintf_s(buffer, AMP_LOG_BUFFER_SIZE, FORMAT, __VA_ARGS__); \
+		AMP_SNPRINTF(buffer, AMP_LOG_BUFFER_SIZE, __VA_ARGS__); \
 		Dev::PrintMessage(Dev::MessageType::FatalError, buffer); \
-		__debugbreak(); \
+		AMP_DEBUG_BREAK(); \
 		std::terminate(); \
 	} while(false)
 
 #if AMP_ASSERTS_ENABLED == 1
 
-#define AMP_ASSERT(CHECK, FORMAT, ...) \
+#define AMP_ASSERT(CHECK, ...) \
 	do { \
 		if (!(CHECK)) {\
-			AMP_LOG_ERROR(FORMAT, __VA_ARGS__); \
-			__debugbreak(); \
+			AMP_LOG_ERROR(__VA_ARGS__); \
+			AMP_DEBUG_BREAK(); \
 		} \
 	} while(false)
 
-#define AMP_FATAL_ASSERT(CHECK, FORMAT, ...) \
+#define AMP_FATAL_ASSERT(CHECK, ...) \
 	do { \
 		if (!(CHECK)) { \
-			AMP_FATAL_ERROR(FORMAT, __VA_ARGS__); \
+			AMP_FATAL_ERROR(__VA_ARGS__); \
 		} \
 	} while(false)
 
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <file/Path.h>
+
+namespace File
+{
+// Block until the writes to the file at the given path which have been flushed from the program's buffers reach the
+// storage device, so that they survive the program or the system stopping unexpectedly.
+// Returns false if the file can't be opened or synchronized.
+bool TrySyncFile(const Path& path);
+}
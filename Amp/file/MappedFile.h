@@ -0,0 +1,68 @@
+#pragma once
+
+#include <collection/ArrayView.h>
+#include <file/Path.h>
+
+#include <cstdint>
+
+namespace File
+{
+/**
+ * A read-only memory mapping of a whole file. Reading from a mapping reads the file's bytes directly from the page
+ * cache, without copying them into a buffer first. The mapping is released when the MappedFile is closed or destroyed.
+ */
+class MappedFile final
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	MappedFile(MappedFile&& other);
+	MappedFile& operator=(MappedFile&& rhs);
+
+	// Map the file at the given path, closing any file that is already mapped. Returns false if the file can't be
+	// opened or is empty.
+	bool TryOpen(const Path& path);
+	void Close();
+
+	bool IsOpen() const { return m_bytes != nullptr; }
+	Collection::ArrayView<const uint8_t> GetBytes() const { return { m_bytes, m_size }; }
+
+private:
+	const uint8_t* m_bytes{ nullptr };
+	size_t m_size{ 0 };
+};
+}
+
+// Inline implementations.
+namespace File
+{
+inline MappedFile::~MappedFile()
+{
+	Close();
+}
+
+inline MappedFile::MappedFile(MappedFile&& other)
+	: m_bytes(other.m_bytes)
+	, m_size(other.m_size)
+{
+	other.m_bytes = nullptr;
+	other.m_size = 0;
+}
+
+inline MappedFile& MappedFile::operator=(MappedFile&& rhs)
+{
+	if (this != &rhs)
+	{
+		Close();
+		m_bytes = rhs.m_bytes;
+		m_size = rhs.m_size;
+		rhs.m_bytes = nullptr;
+		rhs.m_size = 0;
+	}
+	return *this;
+}
+}
@@ -7,7 +7,11 @@
 
 namespace File
 {
+#if defined(_MSC_VER)
 namespace FileSystem = std::experimental::filesystem::v1;
+#else
+namespace FileSystem = std::filesystem;
+#endif
 
 using Path = FileSystem::path;
 
@@ -3,6 +3,8 @@
 #include <math/Vector3.h>
 #include <math/Vector4.h>
 
+#include <xmmintrin.h>
+
 namespace Math
 {
 /**
@@ -19,6 +21,9 @@ public:
 	static Matrix4x4 MakeRotateXYZ(const float xRadians, const float yRadians, const float zRadians);
 	static Matrix4x4 MakeOrientZAlong(const Math::Vector3& up, const Math::Vector3& orientAlong);
 
+	// Multiply two matrices with SIMD instructions, writing the result to outResult. outResult may not alias lhs or rhs.
+	static void Multiply(const Matrix4x4& lhs, const Matrix4x4& rhs, Matrix4x4& outResult);
+
 	// Identity matrix constructor.
 	Matrix4x4();
 
@@ -134,6 +139,27 @@ inline Matrix4x4 Matrix4x4::MakeOrientZAlong(const Math::Vector3& up, const Math
 	return result;
 }
 
+inline void Matrix4x4::Multiply(const Matrix4x4& lhs, const Matrix4x4& rhs, Matrix4x4& outResult)
+{
+	const __m128 lhs0 = _mm_loadu_ps(&lhs.m_matrix[0]);
+	const __m128 lhs1 = _mm_loadu_ps(&lhs.m_matrix[4]);
+	const __m128 lhs2 = _mm_loadu_ps(&lhs.m_matrix[8]);
+	const __m128 lhs3 = _mm_loadu_ps(&lhs.m_matrix[12]);
+
+	// Each column of the result is the sum of the columns of lhs weighted by the elements of the same column of rhs.
+	for (size_t i = 0; i < 16; i += 4)
+	{
+		const float* const rhsColumn = &rhs.m_matrix[i];
+
+		__m128 resultColumn = _mm_mul_ps(lhs0, _mm_set1_ps(rhsColumn[0]));
+		resultColumn = _mm_add_ps(resultColumn, _mm_mul_ps(lhs1, _mm_set1_ps(rhsColumn[1])));
+		resultColumn = _mm_add_ps(resultColumn, _mm_mul_ps(lhs2, _mm_set1_ps(rhsColumn[2])));
+		resultColumn = _mm_add_ps(resultColumn, _mm_mul_ps(lhs3, _mm_set1_ps(rhsColumn[3])));
+
+		_mm_storeu_ps(&outResult.m_matrix[i], resultColumn);
+	}
+}
+
 inline Matrix4x4::Matrix4x4()
 {
 	for (auto& v : m_matrix)
@@ -307,46 +333,7 @@ inline Vector3 Matrix4x4::operator*(const Vector3& rhs) const
 inline Matrix4x4 Matrix4x4::operator*(const Matrix4x4& rhs) const
 {
 	Matrix4x4 result;
-	
-	Vector4& result0 = result.GetColumn(0);
-	Vector4& result1 = result.GetColumn(1);
-	Vector4& result2 = result.GetColumn(2);
-	Vector4& result3 = result.GetColumn(3);
-
-	const Vector4 lhs0 = GetRow(0);
-	const Vector4 lhs1 = GetRow(1);
-	const Vector4 lhs2 = GetRow(2);
-	const Vector4 lhs3 = GetRow(3);
-
-	const Vector4& rhs0 = rhs.GetColumn(0);
-	const Vector4& rhs1 = rhs.GetColumn(1);
-	const Vector4& rhs2 = rhs.GetColumn(2);
-	const Vector4& rhs3 = rhs.GetColumn(3);
-	
-	// First column.
-	result0.x = lhs0.Dot(rhs0);
-	result0.y = lhs1.Dot(rhs0);
-	result0.z = lhs2.Dot(rhs0);
-	result0.w = lhs3.Dot(rhs0);
-
-	// Second column.
-	result1.x = lhs0.Dot(rhs1);
-	result1.y = lhs1.Dot(rhs1);
-	result1.z = lhs2.Dot(rhs1);
-	result1.w = lhs3.Dot(rhs1);
-
-	// Third column.
-	result2.x = lhs0.Dot(rhs2);
-	result2.y = lhs1.Dot(rhs2);
-	result2.z = lhs2.Dot(rhs2);
-	result2.w = lhs3.Dot(rhs2);
-
-	// Fourth column.
-	result3.x = lhs0.Dot(rhs3);
-	result3.y = lhs1.Dot(rhs3);
-	result3.z = lhs2.Dot(rhs3);
-	result3.w = lhs3.Dot(rhs3);
-
+	Multiply(*this, rhs, result);
 	return result;
 }
 
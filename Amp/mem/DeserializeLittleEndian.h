@@ -112,6 +112,29 @@ inline Collection::Pair<double, bool> DeserializeF64(const uint8_t*& bytes, cons
 	return { out, true };
 }
 
+// Deserialize an unsigned integer serialized with SerializeVarUint(). Fails if the integer doesn't fit in 64 bits.
+inline Collection::Pair<uint64_t, bool> DeserializeVarUint(const uint8_t*& bytes, const uint8_t* bytesEnd)
+{
+	constexpr uint32_t k_maxNumBytes = 10;
+
+	uint64_t out = 0;
+	for (uint32_t i = 0; i < k_maxNumBytes && bytes < bytesEnd; ++i)
+	{
+		const uint8_t byte = *(bytes++);
+		if (i == (k_maxNumBytes - 1) && byte > 1)
+		{
+			return { 0, false };
+		}
+
+		out |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+		if ((byte & 0x80) == 0)
+		{
+			return { out, true };
+		}
+	}
+	return { 0, false };
+}
+
 template <size_t Capacity>
 inline bool DeserializeString(const uint8_t*& bytes, const uint8_t* bytesEnd, char(&outStr)[Capacity])
 {
@@ -65,6 +65,18 @@ inline void Serialize(double v, Collection::Vector<uint8_t>& out)
 	memcpy(out.begin() + i, &v, sizeof(v));
 }
 
+// Serialize an unsigned integer in as few bytes as possible. Each byte stores 7 bits of the integer, least
+// significant first, and has its high bit set if more bytes follow it.
+inline void SerializeVarUint(uint64_t v, Collection::Vector<uint8_t>& out)
+{
+	while (v >= 0x80)
+	{
+		out.Add(static_cast<uint8_t>(v | 0x80));
+		v >>= 7;
+	}
+	out.Add(static_cast<uint8_t>(v));
+}
+
 inline void Serialize(const char* str, Collection::Vector<uint8_t>& out)
 {
 	uint16_t length = 0;
@@ -0,0 +1,122 @@
+#include <collection/FlatIndexMap.h>
+
+#include <dev/Dev.h>
+
+namespace Collection
+{
+uint32_t FlatIndexMap::Find(const uint64_t key) const
+{
+	const uint32_t entryIndex = FindEntryIndex(key);
+	return (entryIndex != k_invalidIndex) ? m_entries[entryIndex].m_index : k_invalidIndex;
+}
+
+void FlatIndexMap::Set(const uint64_t key, const uint32_t index)
+{
+	AMP_FATAL_ASSERT(index != k_invalidIndex, "Cannot map a key to the invalid index.");
+
+	if ((m_numEntries + 1) * 2 > m_entries.Size())
+	{
+		Grow();
+	}
+
+	const uint32_t mask = m_entries.Size() - 1;
+	for (uint32_t i = GetIdealEntryIndex(key);; i = (i + 1) & mask)
+	{
+		Entry& entry = m_entries[i];
+		if (entry.m_index == k_invalidIndex)
+		{
+			entry.m_key = key;
+			entry.m_index = index;
+			++m_numEntries;
+			return;
+		}
+		if (entry.m_key == key)
+		{
+			entry.m_index = index;
+			return;
+		}
+	}
+}
+
+void FlatIndexMap::Remove(const uint64_t key)
+{
+	uint32_t emptyIndex = FindEntryIndex(key);
+	if (emptyIndex == k_invalidIndex)
+	{
+		return;
+	}
+	m_entries[emptyIndex].m_index = k_invalidIndex;
+	--m_numEntries;
+
+	// Shift back any following entries whose probe sequences pass through the emptied entry.
+	const uint32_t mask = m_entries.Size() - 1;
+	for (uint32_t i = (emptyIndex + 1) & mask; m_entries[i].m_index != k_invalidIndex; i = (i + 1) & mask)
+	{
+		const uint32_t idealIndex = GetIdealEntryIndex(m_entries[i].m_key);
+		const uint32_t distanceFromIdeal = (i - idealIndex) & mask;
+		const uint32_t distanceFromEmpty = (i - emptyIndex) & mask;
+		if (distanceFromIdeal >= distanceFromEmpty)
+		{
+			m_entries[emptyIndex] = m_entries[i];
+			m_entries[i].m_index = k_invalidIndex;
+			emptyIndex = i;
+		}
+	}
+}
+
+void FlatIndexMap::Clear()
+{
+	for (auto& entry : m_entries)
+	{
+		entry.m_index = k_invalidIndex;
+	}
+	m_numEntries = 0;
+}
+
+uint32_t FlatIndexMap::FindEntryIndex(const uint64_t key) const
+{
+	if (m_numEntries == 0)
+	{
+		return k_invalidIndex;
+	}
+
+	const uint32_t mask = m_entries.Size() - 1;
+	for (uint32_t i = GetIdealEntryIndex(key);; i = (i + 1) & mask)
+	{
+		const Entry& entry = m_entries[i];
+		if (entry.m_index == k_invalidIndex)
+		{
+			return k_invalidIndex;
+		}
+		if (entry.m_key == key)
+		{
+			return i;
+		}
+	}
+}
+
+uint32_t FlatIndexMap::GetIdealEntryIndex(const uint64_t key) const
+{
+	// Fibonacci hashing spreads sequential keys, which are common for IDs, across the whole table.
+	const uint64_t hash = key * 11400714819323198485ull;
+	return static_cast<uint32_t>(hash >> 32) & (m_entries.Size() - 1);
+}
+
+void FlatIndexMap::Grow()
+{
+	Collection::Vector<Entry> oldEntries = std::move(m_entries);
+
+	const uint32_t newCapacity = oldEntries.IsEmpty() ? k_initialCapacity : (oldEntries.Size() * 2);
+	m_entries = Collection::Vector<Entry>(newCapacity);
+	m_entries.Resize(newCapacity);
+	m_numEntries = 0;
+
+	for (const auto& entry : oldEntries)
+	{
+		if (entry.m_index != k_invalidIndex)
+		{
+			Set(entry.m_key, entry.m_index);
+		}
+	}
+}
+}
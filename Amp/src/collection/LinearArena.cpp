@@ -0,0 +1,120 @@
+#include <collection/LinearArena.h>
+
+#include <dev/Dev.h>
+
+#include <algorithm>
+#include <cstddef>
+
+namespace Collection
+{
+namespace Internal_LinearArena
+{
+constexpr size_t k_blockAlignmentInBytes = alignof(std::max_align_t);
+}
+
+LinearArena::LinearArena(const size_t blockSizeInBytes)
+	: m_blocks()
+	, m_blockSizeInBytes(blockSizeInBytes)
+{}
+
+LinearArena::LinearArena(LinearArena&& other)
+	: m_blocks(std::move(other.m_blocks))
+	, m_blockSizeInBytes(other.m_blockSizeInBytes)
+	, m_offsetInLastBlock(other.m_offsetInLastBlock)
+	, m_numBytesAllocated(other.m_numBytesAllocated)
+{
+	other.m_offsetInLastBlock = 0;
+	other.m_numBytesAllocated = 0;
+}
+
+LinearArena& LinearArena::operator=(LinearArena&& rhs)
+{
+	FreeBlocks();
+
+	m_blocks = std::move(rhs.m_blocks);
+	m_blockSizeInBytes = rhs.m_blockSizeInBytes;
+	m_offsetInLastBlock = rhs.m_offsetInLastBlock;
+	m_numBytesAllocated = rhs.m_numBytesAllocated;
+
+	rhs.m_offsetInLastBlock = 0;
+	rhs.m_numBytesAllocated = 0;
+
+	return *this;
+}
+
+LinearArena::~LinearArena()
+{
+	FreeBlocks();
+}
+
+void* LinearArena::Alloc(const size_t sizeInBytes, const size_t alignmentInBytes)
+{
+	using namespace Internal_LinearArena;
+
+	AMP_FATAL_ASSERT(alignmentInBytes != 0 && (alignmentInBytes & (alignmentInBytes - 1)) == 0,
+		"LinearArena alignments must be powers of two.");
+
+	if (!m_blocks.IsEmpty())
+	{
+		Block& block = m_blocks.Back();
+		const uintptr_t blockBegin = reinterpret_cast<uintptr_t>(block.m_memory);
+		const uintptr_t alignedAddress =
+			(blockBegin + m_offsetInLastBlock + alignmentInBytes - 1) & ~(alignmentInBytes - 1);
+		const size_t alignedOffset = static_cast<size_t>(alignedAddress - blockBegin);
+
+		if (alignedOffset + sizeInBytes <= block.m_sizeInBytes)
+		{
+			m_numBytesAllocated += (alignedOffset - m_offsetInLastBlock) + sizeInBytes;
+			m_offsetInLastBlock = alignedOffset + sizeInBytes;
+			return block.m_memory + alignedOffset;
+		}
+	}
+
+	// The last block is full, so start a new one that is large enough for the allocation.
+	const size_t alignmentPadding = std::max(alignmentInBytes, k_blockAlignmentInBytes) - k_blockAlignmentInBytes;
+	Block& block = m_blocks.Emplace();
+	block.m_sizeInBytes = std::max(m_blockSizeInBytes, sizeInBytes + alignmentPadding);
+	block.m_memory = static_cast<uint8_t*>(_aligned_malloc(block.m_sizeInBytes, k_blockAlignmentInBytes));
+
+	const uintptr_t blockBegin = reinterpret_cast<uintptr_t>(block.m_memory);
+	const uintptr_t alignedAddress = (blockBegin + alignmentInBytes - 1) & ~(alignmentInBytes - 1);
+	const size_t alignedOffset = static_cast<size_t>(alignedAddress - blockBegin);
+
+	m_numBytesAllocated += alignedOffset + sizeInBytes;
+	m_offsetInLastBlock = alignedOffset + sizeInBytes;
+	return block.m_memory + alignedOffset;
+}
+
+void LinearArena::Reset()
+{
+	using namespace Internal_LinearArena;
+
+	// Replace multiple blocks with a single block large enough for all of them so that the next cycle of allocations
+	// fits in one block.
+	if (m_blocks.Size() > 1)
+	{
+		size_t totalSizeInBytes = 0;
+		for (const auto& block : m_blocks)
+		{
+			totalSizeInBytes += block.m_sizeInBytes;
+		}
+		FreeBlocks();
+
+		Block& block = m_blocks.Emplace();
+		block.m_sizeInBytes = totalSizeInBytes;
+		block.m_memory = static_cast<uint8_t*>(_aligned_malloc(block.m_sizeInBytes, k_blockAlignmentInBytes));
+	}
+
+	m_offsetInLastBlock = 0;
+	m_numBytesAllocated = 0;
+}
+
+void LinearArena::FreeBlocks()
+{
+	for (auto& block : m_blocks)
+	{
+		_aligned_free(block.m_memory);
+	}
+	m_blocks.Clear();
+}
+}
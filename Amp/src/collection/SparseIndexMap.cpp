@@ -0,0 +1,58 @@
+#include <collection/SparseIndexMap.h>
+
+#include <dev/Dev.h>
+
+namespace Collection
+{
+uint32_t SparseIndexMap::Find(const uint32_t key) const
+{
+	const auto pageIter = m_pages.Find(key >> k_lgKeysPerPage);
+	if (pageIter == m_pages.end())
+	{
+		return k_invalidIndex;
+	}
+	return pageIter->second.m_indices[key & (k_keysPerPage - 1)];
+}
+
+void SparseIndexMap::Set(const uint32_t key, const uint32_t index)
+{
+	AMP_FATAL_ASSERT(index != k_invalidIndex, "Cannot map a key to the invalid index.");
+
+	Page& page = m_pages[key >> k_lgKeysPerPage];
+	if (page.m_indices.IsEmpty())
+	{
+		page.m_indices.Resize(k_keysPerPage, k_invalidIndex);
+	}
+
+	uint32_t& entry = page.m_indices[key & (k_keysPerPage - 1)];
+	if (entry == k_invalidIndex)
+	{
+		++page.m_numSetKeys;
+	}
+	entry = index;
+}
+
+void SparseIndexMap::Remove(const uint32_t key)
+{
+	const uint32_t pageIndex = key >> k_lgKeysPerPage;
+	const auto pageIter = m_pages.Find(pageIndex);
+	if (pageIter == m_pages.end())
+	{
+		return;
+	}
+
+	Page& page = pageIter->second;
+	uint32_t& entry = page.m_indices[key & (k_keysPerPage - 1)];
+	if (entry == k_invalidIndex)
+	{
+		return;
+	}
+
+	entry = k_invalidIndex;
+	--page.m_numSetKeys;
+	if (page.m_numSetKeys == 0)
+	{
+		m_pages.TryRemove(pageIndex);
+	}
+}
+}
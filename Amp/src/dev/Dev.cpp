@@ -20,7 +20,7 @@ void Dev::PrintMessage(const MessageType messageType, const char* const message)
 	if (i >= static_cast<size_t>(MessageType::Count))
 	{
 		std::cerr << "INVALID MESSAGE TYPE " << i << " ENCOUNTERED" << std::endl;
-		__debugbreak();
+		AMP_DEBUG_BREAK();
 		return;
 	}
 
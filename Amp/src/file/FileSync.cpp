@@ -0,0 +1,23 @@
+#if defined(_WIN32)
+
+#include <file/FileSync.h>
+
+// Windows includes.
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+bool File::TrySyncFile(const Path& path)
+{
+	const HANDLE fileHandle = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	const bool isSynchronized = (FlushFileBuffers(fileHandle) != 0);
+	CloseHandle(fileHandle);
+	return isSynchronized;
+}
+
+#endif
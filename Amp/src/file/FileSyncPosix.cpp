@@ -0,0 +1,22 @@
+#if !defined(_WIN32)
+
+#include <file/FileSync.h>
+
+// POSIX includes.
+#include <fcntl.h>
+#include <unistd.h>
+
+bool File::TrySyncFile(const Path& path)
+{
+	const int fileDescriptor = open(path.c_str(), O_RDWR);
+	if (fileDescriptor == -1)
+	{
+		return false;
+	}
+
+	const bool isSynchronized = (fsync(fileDescriptor) == 0);
+	close(fileDescriptor);
+	return isSynchronized;
+}
+
+#endif
@@ -0,0 +1,64 @@
+#if defined(_WIN32)
+
+#include <file/MappedFile.h>
+
+#include <dev/Dev.h>
+
+// Windows includes.
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+namespace File
+{
+bool MappedFile::TryOpen(const Path& path)
+{
+	Close();
+
+	const HANDLE fileHandle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart <= 0)
+	{
+		CloseHandle(fileHandle);
+		return false;
+	}
+
+	// The view keeps the mapping and the file open, so the handles can be closed as soon as the view exists.
+	const HANDLE mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(fileHandle);
+	if (mappingHandle == nullptr)
+	{
+		AMP_LOG_WARNING("Failed to map \"%s\": error %lu", path.u8string().c_str(), GetLastError());
+		return false;
+	}
+
+	const void* const view = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mappingHandle);
+	if (view == nullptr)
+	{
+		AMP_LOG_WARNING("Failed to map a view of \"%s\": error %lu", path.u8string().c_str(), GetLastError());
+		return false;
+	}
+
+	m_bytes = static_cast<const uint8_t*>(view);
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_bytes != nullptr)
+	{
+		UnmapViewOfFile(m_bytes);
+		m_bytes = nullptr;
+		m_size = 0;
+	}
+}
+}
+
+#endif
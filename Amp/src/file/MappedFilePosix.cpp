@@ -0,0 +1,62 @@
+#if !defined(_WIN32)
+
+#include <file/MappedFile.h>
+
+#include <dev/Dev.h>
+
+#include <cerrno>
+#include <cstring>
+
+// POSIX includes.
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace File
+{
+bool MappedFile::TryOpen(const Path& path)
+{
+	Close();
+
+	const int fileDescriptor = open(path.c_str(), O_RDONLY);
+	if (fileDescriptor == -1)
+	{
+		return false;
+	}
+
+	struct stat fileStatus;
+	if (fstat(fileDescriptor, &fileStatus) != 0 || fileStatus.st_size <= 0)
+	{
+		close(fileDescriptor);
+		return false;
+	}
+
+	// The mapping keeps the file open, so the descriptor can be closed as soon as the mapping exists.
+	const size_t size = static_cast<size_t>(fileStatus.st_size);
+	void* const mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+	const int mapError = errno;
+	close(fileDescriptor);
+	if (mapping == MAP_FAILED)
+	{
+		AMP_LOG_WARNING("Failed to map \"%s\": %s", path.u8string().c_str(), strerror(mapError));
+		return false;
+	}
+
+	m_bytes = static_cast<const uint8_t*>(mapping);
+	m_size = size;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_bytes != nullptr)
+	{
+		munmap(const_cast<uint8_t*>(m_bytes), m_size);
+		m_bytes = nullptr;
+		m_size = 0;
+	}
+}
+}
+
+#endif
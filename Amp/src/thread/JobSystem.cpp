@@ -0,0 +1,208 @@
+#include <thread/JobSystem.h>
+
+#include <dev/Dev.h>
+
+#include <algorithm>
+
+namespace Thread
+{
+namespace Internal_JobSystem
+{
+// The job system the calling thread is a worker of, and the index of its queue.
+thread_local const JobSystem* t_workerJobSystem = nullptr;
+thread_local uint32_t t_workerIndex = 0;
+}
+
+JobSystem& JobSystem::GetEngineJobSystem()
+{
+	static JobSystem s_engineJobSystem{ std::max(std::thread::hardware_concurrency(), 2u) - 1 };
+	return s_engineJobSystem;
+}
+
+JobSystem::JobSystem(const uint32_t numWorkers)
+	: m_queues(numWorkers)
+	, m_workers(numWorkers)
+{
+	AMP_FATAL_ASSERT(numWorkers > 0, "A job system must have at least one worker.");
+
+	for (uint32_t i = 0; i < numWorkers; ++i)
+	{
+		m_queues.Add(Mem::MakeUnique<WorkQueue>());
+	}
+	for (uint32_t i = 0; i < numWorkers; ++i)
+	{
+		m_workers.Add(std::thread(&JobSystem::WorkerThreadFunction, this, i));
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard lock{ m_sleepMutex };
+		m_isShuttingDown = true;
+	}
+	m_wakeCondition.notify_all();
+
+	for (auto& worker : m_workers)
+	{
+		worker.join();
+	}
+}
+
+void JobSystem::Submit(const Job::Function function, void* const context, const uint32_t numJobs, JobCounter& counter)
+{
+	using namespace Internal_JobSystem;
+
+	if (numJobs == 0)
+	{
+		return;
+	}
+
+	counter.m_numPendingJobs.fetch_add(numJobs, std::memory_order_relaxed);
+
+	// Workers push to their own queue; other threads spread their jobs across the queues.
+	const bool isWorker = (t_workerJobSystem == this);
+	const uint32_t numQueues = m_queues.Size();
+	for (uint32_t i = 0; i < numJobs; ++i)
+	{
+		const uint32_t queueIndex = isWorker
+			? t_workerIndex
+			: (m_nextExternalQueueIndex.fetch_add(1, std::memory_order_relaxed) % numQueues);
+
+		WorkQueue& queue = *m_queues[queueIndex];
+		std::lock_guard lock{ queue.m_mutex };
+		queue.m_jobs.push_back({ function, context, i, &counter });
+	}
+	m_numQueuedJobs.fetch_add(numJobs, std::memory_order_release);
+
+	// Acquire the sleep mutex so that a worker can't miss the notification between checking for jobs and sleeping.
+	{
+		std::lock_guard lock{ m_sleepMutex };
+	}
+	if (numJobs == 1)
+	{
+		m_wakeCondition.notify_one();
+	}
+	else
+	{
+		m_wakeCondition.notify_all();
+	}
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	const uint32_t firstQueueIndex = GetPreferredQueueIndex();
+	while (!counter.IsDone())
+	{
+		Job job;
+		if (TryTakeJob(firstQueueIndex, job))
+		{
+			Execute(job);
+		}
+		else
+		{
+			// The remaining jobs are running on other threads.
+			std::this_thread::yield();
+		}
+	}
+}
+
+uint32_t JobSystem::GetCurrentThreadIndex() const
+{
+	using namespace Internal_JobSystem;
+
+	return (t_workerJobSystem == this) ? t_workerIndex : m_workers.Size();
+}
+
+bool JobSystem::TryExecuteJob()
+{
+	Job job;
+	if (TryTakeJob(GetPreferredQueueIndex(), job))
+	{
+		Execute(job);
+		return true;
+	}
+	return false;
+}
+
+void JobSystem::WorkerThreadFunction(const uint32_t workerIndex)
+{
+	using namespace Internal_JobSystem;
+
+	t_workerJobSystem = this;
+	t_workerIndex = workerIndex;
+
+	while (true)
+	{
+		Job job;
+		if (TryTakeJob(workerIndex, job))
+		{
+			Execute(job);
+			continue;
+		}
+
+		std::unique_lock lock{ m_sleepMutex };
+		m_wakeCondition.wait(lock, [this]()
+		{
+			return m_isShuttingDown || m_numQueuedJobs.load(std::memory_order_acquire) > 0;
+		});
+		if (m_isShuttingDown)
+		{
+			return;
+		}
+	}
+}
+
+uint32_t JobSystem::GetPreferredQueueIndex()
+{
+	using namespace Internal_JobSystem;
+
+	return (t_workerJobSystem == this)
+		? t_workerIndex
+		: (m_nextExternalQueueIndex.load(std::memory_order_relaxed) % m_queues.Size());
+}
+
+bool JobSystem::TryTakeJob(const uint32_t queueIndex, Job& outJob)
+{
+	if (m_numQueuedJobs.load(std::memory_order_acquire) == 0)
+	{
+		return false;
+	}
+
+	// Take the most recently queued job from the given queue, as its data is most likely to be in cache.
+	{
+		WorkQueue& queue = *m_queues[queueIndex];
+		std::lock_guard lock{ queue.m_mutex };
+		if (!queue.m_jobs.empty())
+		{
+			outJob = queue.m_jobs.back();
+			queue.m_jobs.pop_back();
+			m_numQueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	// Steal the oldest job from another queue.
+	const uint32_t numQueues = m_queues.Size();
+	for (uint32_t i = 1; i < numQueues; ++i)
+	{
+		WorkQueue& queue = *m_queues[(queueIndex + i) % numQueues];
+		std::lock_guard lock{ queue.m_mutex };
+		if (!queue.m_jobs.empty())
+		{
+			outJob = queue.m_jobs.front();
+			queue.m_jobs.pop_front();
+			m_numQueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::Execute(const Job& job)
+{
+	job.m_function(job.m_context, job.m_index);
+	job.m_counter->m_numPendingJobs.fetch_sub(1, std::memory_order_release);
+}
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <collection/Vector.h>
+#include <mem/UniquePtr.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace Thread
+{
+/**
+ * Counts the jobs of a submission which haven't finished yet. A JobSystem waits on a counter until it reaches zero.
+ */
+class JobCounter
+{
+public:
+	JobCounter() = default;
+
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	bool IsDone() const { return m_numPendingJobs.load(std::memory_order_acquire) == 0; }
+
+private:
+	friend class JobSystem;
+
+	std::atomic<uint32_t> m_numPendingJobs{ 0 };
+};
+
+/**
+ * A job is a function pointer with a context pointer and an index. Submitting many jobs that share a function and
+ * context but have different indices is how work is split into batches.
+ */
+struct Job
+{
+	using Function = void(*)(void* context, uint32_t index);
+
+	Function m_function{ nullptr };
+	void* m_context{ nullptr };
+	uint32_t m_index{ 0 };
+	JobCounter* m_counter{ nullptr };
+};
+
+/**
+ * A work-stealing thread pool. Each worker thread owns a queue of jobs which it takes jobs from the back of; idle
+ * workers steal jobs from the front of the other workers' queues. Threads that wait on a JobCounter execute jobs while
+ * they wait, so jobs may submit more jobs and wait on them without deadlocking.
+ * Jobs are run in no particular order on no particular thread.
+ */
+class JobSystem final
+{
+public:
+	// The job system shared by the whole engine, with one worker for each hardware thread but the calling thread.
+	static JobSystem& GetEngineJobSystem();
+
+	explicit JobSystem(const uint32_t numWorkers);
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	~JobSystem();
+
+	// The number of threads jobs can run on, which includes a thread waiting on the jobs.
+	uint32_t GetNumThreads() const { return m_workers.Size() + 1; }
+
+	// The index of the calling thread in [0, GetNumThreads()). Workers have the indices below the number of workers;
+	// all threads which aren't workers of this job system share the last index.
+	uint32_t GetCurrentThreadIndex() const;
+
+	// Submit jobs with indices [0, numJobs) which call the given function with the given context.
+	void Submit(const Job::Function function, void* const context, const uint32_t numJobs, JobCounter& counter);
+
+	// Execute jobs on the calling thread until all the jobs counted by the given counter are done.
+	void Wait(JobCounter& counter);
+
+	// Execute one queued job on the calling thread. Returns false if no job was queued.
+	bool TryExecuteJob();
+
+private:
+	struct alignas(64) WorkQueue
+	{
+		std::mutex m_mutex;
+		std::deque<Job> m_jobs;
+	};
+
+	void WorkerThreadFunction(const uint32_t workerIndex);
+
+	uint32_t GetPreferredQueueIndex();
+
+	bool TryTakeJob(const uint32_t queueIndex, Job& outJob);
+	void Execute(const Job& job);
+
+	Collection::Vector<Mem::UniquePtr<WorkQueue>> m_queues;
+	Collection::Vector<std::thread> m_workers;
+
+	// Threads which aren't workers push their jobs to the queues in turn.
+	std::atomic<uint32_t> m_nextExternalQueueIndex{ 0 };
+
+	// Idle workers sleep until jobs are queued.
+	std::atomic<uint32_t> m_numQueuedJobs{ 0 };
+	std::mutex m_sleepMutex;
+	std::condition_variable m_wakeCondition;
+	bool m_isShuttingDown{ false };
+};
+}
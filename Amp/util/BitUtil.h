@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Util
+{
+// Count the bits which are set in the given value.
+inline uint32_t CountSetBits(const uint64_t value)
+{
+#if defined(_MSC_VER)
+	return static_cast<uint32_t>(__popcnt64(value));
+#else
+	return static_cast<uint32_t>(__builtin_popcountll(value));
+#endif
+}
+
+// Count the zero bits below the lowest set bit of the given value. The value must not be zero.
+inline uint32_t CountTrailingZeros(const uint32_t value)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, value);
+	return static_cast<uint32_t>(index);
+#else
+	return static_cast<uint32_t>(__builtin_ctz(value));
+#endif
+}
+
+inline uint32_t CountTrailingZeros(const uint64_t value)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return static_cast<uint32_t>(index);
+#else
+	return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+}
+}
@@ -1,12 +1,11 @@
 #pragma once
 
-#include <functional>
-
 namespace Asset { template <typename TAsset> class AssetHandle; }
 namespace Collection { template <typename T> class Vector; }
 
 namespace ECS
 {
+class DeferredFunctionList;
 class Entity;
 class EntityManager;
 }
@@ -36,7 +35,7 @@ public:
 		const Collection::Vector<Asset::AssetHandle<BehaviourForest>>& forests,
 		ECS::Entity& entity,
 		BehaviourTreeEvaluator& treeEvaluator,
-		Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions) = 0;
+		ECS::DeferredFunctionList& deferredFunctions) = 0;
 
 	virtual void NotifyChildFinished(const BehaviourNode* child, const EvaluateResult result) {}
 
@@ -12,6 +12,7 @@ class AssetHandle;
 
 namespace ECS
 {
+class DeferredFunctionList;
 class Entity;
 class EntityManager;
 }
@@ -64,7 +65,7 @@ public:
 	void Update(const BehaveContext& context,
 		const Collection::Vector<Asset::AssetHandle<BehaviourForest>>& forests,
 		ECS::Entity& entity,
-		Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions);
+		ECS::DeferredFunctionList& deferredFunctions);
 
 private:
 	Collection::PolyStack<BehaviourNodeState> m_callStack;
@@ -4,8 +4,15 @@
 
 #include <collection/LocklessQueue.h>
 #include <host/MessageToClient.h>
+#include <mem/UniquePtr.h>
+#include <network/DatagramConnection.h>
+#include <network/DatagramSocket.h>
+#include <network/MessageFraming.h>
 #include <network/Socket.h>
+#include <network/TransportOptions.h>
+#include <unit/Time.h>
 
+#include <chrono>
 #include <thread>
 
 namespace Client
@@ -13,6 +20,8 @@ namespace Client
 /**
  * ClientNetworkWorld abstracts the network layer away from ClientWorld,
  * transmitting and receiving messages across the network to and from a host.
+ * The host is connected to over TCP or over UDP depending on the transport options. Over UDP, frame acknowledgements
+ * and input states are sent on sequenced streams and all other messages are sent reliably.
  */
 class ClientNetworkWorld
 {
@@ -20,7 +29,7 @@ public:
 	static constexpr size_t k_inboundMessageCapacity = 512;
 	static constexpr size_t k_outboundMessageCapacity = 128;
 
-	ClientNetworkWorld(const char* hostName, const char* hostPort);
+	ClientNetworkWorld(const char* hostName, const char* hostPort, const Network::TransportOptions& transportOptions = {});
 	
 	bool IsRunning() const;
 	void WaitForShutdown();
@@ -30,14 +39,44 @@ public:
 	Collection::LocklessQueue<Host::MessageToClient>& GetHostToClientMessageQueue() { return m_hostToClientMessages; }
 
 private:
+	// The number of messages popped from the outbound queue at once.
+	static constexpr size_t k_messageBatchSize = 16;
+	// How long to wait for a host to respond to a connection request over UDP.
+	static constexpr Unit::Time::Millisecond k_datagramConnectTimeout{ 5000 };
+
+	void ConnectToStreamHost(const char* hostName, const char* hostPort);
+	void ConnectToDatagramHost(const char* hostName, const char* hostPort);
+	// Handle a message received before the client ID. Returns true if the client is still waiting for its client ID.
+	bool ReceiveMessageWhileWaitingForClientID(Host::MessageToClient&& messageFromHost);
+
 	void NetworkThreadFunction();
 
+	Unit::Time::Millisecond GetNetworkTime() const;
+	bool IsConnected(const Unit::Time::Millisecond now) const;
+
+	void ReceiveFromStreamHost();
+	// Give any datagrams received from the host to m_datagramConnection.
+	void ReceiveDatagramsFromHost(const Unit::Time::Millisecond now);
+	void FlushDatagramConnection(const Unit::Time::Millisecond now);
+
 	bool TryReceiveMessageFromHost(
 		const Collection::ArrayView<const uint8_t>& bytes, Host::MessageToClient& outMessage) const;
-	void TransmitMessageToHost(const Client::MessageToHost& message);
+	void TransmitMessagesToHost(const Collection::ArrayView<const Client::MessageToHost>& messages);
+	void TransmitMessagesToDatagramHost(
+		const Unit::Time::Millisecond now, const Collection::ArrayView<const Client::MessageToHost>& messages);
 
 private:
-	Network::Socket m_socket;
+	Network::TransportOptions m_transportOptions;
+	std::chrono::steady_clock::time_point m_startTime;
+
+	Network::Socket m_socket{};
+	Network::FrameReassembler m_frameReassembler{};
+	Collection::Vector<uint8_t> m_transmissionBytes{};
+
+	// Only used by the datagram transport.
+	Network::DatagramSocket m_datagramSocket{};
+	Network::DatagramAddress m_hostAddress{};
+	Mem::UniquePtr<Network::DatagramConnection> m_datagramConnection{};
 
 	ClientID m_clientID{};
 	Collection::LocklessQueue<Client::MessageToHost> m_clientToHostMessages{ k_outboundMessageCapacity };
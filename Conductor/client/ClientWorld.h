@@ -1,7 +1,9 @@
 #pragma once
 
 #include <host/MessageToClient.h>
+#include <host/TickOptions.h>
 #include <mem/UniquePtr.h>
+#include <network/ECSInterpolationBuffer.h>
 
 #include <chrono>
 #include <functional>
@@ -20,6 +22,8 @@ class IRenderInstance;
 
 /**
  * ClientWorld connects to a host game simulation and allows a user to view it and interact with it.
+ * Player input is transmitted to the host once per host tick, and the host's simulation is presented a render delay
+ * behind the host so that it can be interpolated. The tick options must match the host's.
  */
 class ClientWorld final
 {
@@ -32,7 +36,9 @@ public:
 		IRenderInstance& renderInstance,
 		Collection::LocklessQueue<Input::InputMessage>& inputMessages,
 		Collection::LocklessQueue<Host::MessageToClient>& networkInputQueue,
-		ClientFactory&& clientFactory);
+		ClientFactory&& clientFactory,
+		const Host::TickOptions& tickOptions = {},
+		const Unit::Time::Millisecond renderDelay = Network::ECSInterpolationBuffer::k_defaultRenderDelay);
 
 	ClientWorld() = delete;
 	ClientWorld(const ClientWorld&) = delete;
@@ -46,6 +52,9 @@ public:
 	void NotifyOfHostDisconnected();
 
 private:
+	// The number of messages popped from the input queues at once.
+	static constexpr size_t k_messageBatchSize = 16;
+
 	enum class ClientThreadStatus
 	{
 		Stopped,
@@ -54,7 +63,8 @@ private:
 	};
 
 	void ClientThreadFunction();
-	void ProcessMessageFromHost(Host::MessageToClient& message);
+	Unit::Time::Millisecond GetClientTime() const;
+	void ProcessMessageFromHost(Host::MessageToClient& message, const Unit::Time::Millisecond now);
 	void ProcessInputMessage(Input::InputMessage& message);
 
 	const Conductor::IGameData& m_gameData;
@@ -62,10 +72,13 @@ private:
 	Collection::LocklessQueue<Input::InputMessage>& m_inputMessages;
 	Collection::LocklessQueue<Host::MessageToClient>& m_networkInputQueue;
 	ClientFactory m_clientFactory;
+	Host::TickOptions m_tickOptions;
+	Unit::Time::Millisecond m_renderDelay;
 
 	Mem::UniquePtr<ConnectedHost> m_connectedHost{};
 	Mem::UniquePtr<IClient> m_client{};
 
+	std::chrono::steady_clock::time_point m_startPoint;
 	std::chrono::steady_clock::time_point m_lastUpdatePoint;
 
 	std::thread m_clientThread{};
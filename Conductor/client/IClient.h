@@ -4,6 +4,7 @@
 #include <ecs/EntityManager.h>
 #include <input/CallbackRegistry.h>
 #include <input/InputStateManager.h>
+#include <network/ECSInterpolationBuffer.h>
 #include <network/ECSReceiver.h>
 
 #include <functional>
@@ -15,6 +16,9 @@ namespace Client
 class ConnectedHost;
 
 // IClient is the interface a game's client must implement.
+// Networked entities are presented a render delay behind the host with their transforms interpolated between frames.
+// The entity the client controls, which is the entity whose InputComponent receives the client's input, is instead
+// predicted ahead of the host by replaying the input states the host hasn't applied yet; see PredictControlledEntity.
 class IClient
 {
 protected:
@@ -34,13 +38,66 @@ public:
 	ECS::EntityManager& GetEntityManager() { return m_entityManager; }
 	const ECS::EntityManager& GetEntityManager() const { return m_entityManager; }
 
-	void NotifyOfECSUpdateTransmission(const Collection::Vector<uint8_t>& transmissionBytes);
+	// The tick delta must match the host's.
+	void SetNetworkTiming(const Unit::Time::Millisecond tickDelta, const Unit::Time::Millisecond renderDelay);
+
+	void NotifyOfECSUpdateTransmission(
+		const Collection::Vector<uint8_t>& transmissionBytes, const Unit::Time::Millisecond now);
 	void NotifyOfInputMessage(const Input::InputMessage& message);
 
-	Collection::Vector<uint8_t> SerializeInputStateTransmission() const;
+	// Transmit the input states recorded since the last transmission to the host and start recording new ones.
+	// This is done once per host tick so that each transmission is one tick of input for prediction to replay.
+	void TransmitInputStates(const Unit::Time::Millisecond now, const Unit::Time::Millisecond tickDelta);
+
+	// Set the networked entities to their state at the given time: interpolated for most entities, and predicted
+	// for the entity the client controls. This should be done before each update.
+	void PresentNetworkedEntities(const Unit::Time::Millisecond now);
 
 	virtual void Update(const Unit::Time::Millisecond delta) = 0;
 
+	// Reset the input states read during the update. The input states to transmit are kept until they are transmitted.
 	void PostUpdate();
+
+protected:
+	// Advance the controlled entity by the given input states for delta. When a frame is received from the host, the
+	// entity is set to its state in that frame and then advanced by each input state the host hadn't applied in it, in
+	// transmission order, and by the current input states for the time elapsed since the last transmission.
+	// Until the next frame, it is only advanced by the current input states for the time elapsed since it was last
+	// advanced. The prediction should match the host's simulation of the input.
+	// Clients which don't predict their controlled entity don't need to implement this.
+	virtual void PredictControlledEntity(ECS::Entity& entity,
+		const Input::InputStateManager& inputStates,
+		const Unit::Time::Millisecond delta) {}
+
+private:
+	struct UnappliedInputStates
+	{
+		uint32_t m_sequenceNumber{ 0 };
+		Unit::Time::Millisecond m_delta{ 0 };
+		Collection::Vector<uint8_t> m_bytes{};
+	};
+
+	// The most input state transmissions kept for prediction to replay. Older ones are forgotten.
+	static constexpr size_t k_maxUnappliedInputStates = 64;
+
+	// The controlled entity is predicted again from the newest frame when a new frame is received or when presenting
+	// the interpolated entities overwrote the prediction.
+	void PresentControlledEntity(const Unit::Time::Millisecond now, const bool isPredictionOverwritten);
+	ECS::EntityID FindControlledEntityID(const ECS::SerializedEntitiesAndComponents& frame) const;
+
+	Network::ECSInterpolationBuffer m_ecsInterpolationBuffer{};
+	uint64_t m_presentedFrameIndex{ Network::k_invalidFrameIndex };
+
+	uint32_t m_nextInputSequenceNumber{ 1 };
+	Unit::Time::Millisecond m_lastInputTransmissionTime{ 0 };
+	Collection::Vector<UnappliedInputStates> m_unappliedInputStates{};
+	Input::InputStateManager m_predictionInputStateManager{};
+
+	uint64_t m_controlledEntityFrameIndex{ Network::k_invalidFrameIndex };
+	ECS::EntityID m_controlledEntityID{};
+	ECS::SerializedEntitiesAndComponents m_controlledEntitySerialization{};
+	// The transform of the controlled entity is predicted, so it isn't interpolated.
+	ECS::ComponentID m_controlledTransformComponentID{};
+	Unit::Time::Millisecond m_lastPredictionTime{ 0 };
 };
 }
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <ecs/ComponentID.h>
+#include <ecs/ComponentType.h>
+
+#include <collection/ArrayView.h>
+#include <collection/Vector.h>
+#include <util/UniqueID.h>
+
+#include <cstdint>
+
+namespace ECS
+{
+/**
+ * Determines how an EntityManager lays out the memory of its components.
+ */
+enum class ComponentStorageMode : uint8_t
+{
+	// Each component type is stored in a single allocator regardless of which entity it belongs to.
+	PerType = 0,
+	// Each component type is split into one column per archetype so that entities with the same set of component
+	// types have their components allocated side by side, in the same order, across all of their component types.
+	Archetype,
+};
+
+/**
+ * Archetypes are identified by ID. The invalid ArchetypeID identifies the shared column used by PerType storage.
+ */
+class ArchetypeID : public Util::UniqueID<ArchetypeID, uint16_t>
+{
+public:
+	ArchetypeID()
+		: UniqueID()
+	{}
+
+	explicit ArchetypeID(const BackingType uniqueID)
+		: UniqueID(uniqueID)
+	{}
+};
+
+/**
+ * An archetype is the signature of an entity: the sorted set of the types of its components.
+ * The ArchetypeRegistry assigns an ArchetypeID to each distinct signature it encounters.
+ */
+class ArchetypeRegistry final
+{
+public:
+	ArchetypeRegistry() = default;
+
+	ArchetypeID FindOrAddArchetype(const Collection::ArrayView<const ComponentType>& componentTypes);
+	ArchetypeID FindOrAddArchetype(const Collection::ArrayView<const ComponentID>& componentIDs);
+
+	Collection::ArrayView<const ComponentType> GetSignature(const ArchetypeID archetypeID) const;
+
+	uint32_t Size() const { return m_archetypes.Size(); }
+
+private:
+	ArchetypeID FindOrAddSortedSignature();
+
+	struct Archetype
+	{
+		uint64_t m_signatureHash{ 0 };
+		Collection::Vector<ComponentType> m_signature;
+	};
+
+	// The number of archetypes in a world is small, so they are searched linearly by hash.
+	Collection::Vector<Archetype> m_archetypes;
+
+	// Reused when building signatures to avoid allocating on every lookup.
+	Collection::Vector<ComponentType> m_scratchSignature;
+};
+}
+
+namespace Traits
+{
+template <typename T>
+struct IsMemCopyAFullCopy;
+
+template <> struct IsMemCopyAFullCopy<ECS::ArchetypeID> : std::true_type {};
+}
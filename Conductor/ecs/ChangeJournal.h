@@ -0,0 +1,98 @@
+#pragma once
+
+#include <ecs/ComponentID.h>
+#include <ecs/EntityID.h>
+
+#include <collection/Vector.h>
+
+#include <algorithm>
+
+namespace ECS
+{
+/**
+ * A ChangeJournal records which entities and components of an EntityManager may have changed since it was last
+ * cleared, which lets the EntityManager serialize them incrementally.
+ * Components are recorded when something may have written to them: a system marked them as changed, or they were found
+ * through a non-const function of the EntityManager. Entities are recorded when they are created or
+ * deleted, when their components are added or removed, and when their parents change.
+ * Besides its own journal, an EntityManager records its changes in the journals of its change observers, which use
+ * them to keep their own state up to date.
+ * Nothing is recorded while the journal is disabled. The journal is only recorded to by the thread which updates the
+ * EntityManager, so it isn't thread safe.
+ */
+class ChangeJournal final
+{
+public:
+	ChangeJournal() = default;
+
+	bool IsEnabled() const { return m_isEnabled; }
+	void SetEnabled(const bool isEnabled);
+
+	bool IsEmpty() const { return m_changedComponentIDs.IsEmpty() && m_changedEntityIDs.IsEmpty(); }
+
+	void RecordComponentChange(const ComponentID id);
+	void RecordEntityChange(const EntityID id);
+
+	// Sort the recorded IDs and remove duplicates. Components are sorted by type and then by unique ID.
+	void Consolidate();
+
+	// The recorded IDs, which are only sorted and unique after a call to Consolidate().
+	const Collection::Vector<ComponentID>& GetChangedComponentIDs() const { return m_changedComponentIDs; }
+	const Collection::Vector<EntityID>& GetChangedEntityIDs() const { return m_changedEntityIDs; }
+
+	void Clear();
+
+private:
+	bool m_isEnabled{ false };
+	Collection::Vector<ComponentID> m_changedComponentIDs{};
+	Collection::Vector<EntityID> m_changedEntityIDs{};
+};
+}
+
+// Inline implementations.
+namespace ECS
+{
+inline void ChangeJournal::SetEnabled(const bool isEnabled)
+{
+	m_isEnabled = isEnabled;
+	if (!m_isEnabled)
+	{
+		Clear();
+	}
+}
+
+inline void ChangeJournal::RecordComponentChange(const ComponentID id)
+{
+	if (m_isEnabled)
+	{
+		m_changedComponentIDs.Add(id);
+	}
+}
+
+inline void ChangeJournal::RecordEntityChange(const EntityID id)
+{
+	if (m_isEnabled)
+	{
+		m_changedEntityIDs.Add(id);
+	}
+}
+
+inline void ChangeJournal::Consolidate()
+{
+	std::sort(m_changedComponentIDs.begin(), m_changedComponentIDs.end());
+	m_changedComponentIDs.Remove(
+		std::unique(m_changedComponentIDs.begin(), m_changedComponentIDs.end()) - m_changedComponentIDs.begin(),
+		m_changedComponentIDs.Size());
+
+	std::sort(m_changedEntityIDs.begin(), m_changedEntityIDs.end());
+	m_changedEntityIDs.Remove(
+		std::unique(m_changedEntityIDs.begin(), m_changedEntityIDs.end()) - m_changedEntityIDs.begin(),
+		m_changedEntityIDs.Size());
+}
+
+inline void ChangeJournal::Clear()
+{
+	m_changedComponentIDs.Clear();
+	m_changedEntityIDs.Clear();
+}
+}
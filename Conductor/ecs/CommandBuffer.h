@@ -0,0 +1,134 @@
+#pragma once
+
+#include <ecs/ComponentType.h>
+#include <ecs/EntityFlags.h>
+#include <ecs/EntityID.h>
+#include <ecs/EntityLayer.h>
+
+#include <collection/ArrayView.h>
+#include <collection/Vector.h>
+
+#include <cstdint>
+
+namespace ECS
+{
+/**
+ * A CommandBuffer records structural changes to the entities of an EntityManager so that they can be applied
+ * together by EntityManager::ApplyCommandBuffer(). Commands are applied grouped by kind rather than in the order they
+ * were recorded, which lets the EntityManager update the ECS groups of its systems once for each kind of command:
+ *   1. Entities are created.
+ *   2. Components are added to and removed from entities.
+ *   3. The parents of entities are set.
+ *   4. Entities are deleted, along with their children.
+ * Commands which refer to entities that don't exist when the command is applied are ignored.
+ */
+class CommandBuffer final
+{
+public:
+	CommandBuffer() = default;
+
+	// Create an entity with the given components. The invalid EntityID for the requested ID or the parent ID means
+	// the entity is given the next available ID or has no parent, respectively.
+	void CreateEntity(const Collection::ArrayView<const ComponentType>& componentTypes,
+		const EntityFlags flags,
+		const EntityLayer layer,
+		const EntityID requestedID = EntityID(),
+		const EntityID parentID = EntityID());
+
+	void DeleteEntity(const EntityID entityID);
+
+	void AddComponent(const EntityID entityID, const ComponentType componentType);
+	void RemoveComponent(const EntityID entityID, const ComponentType componentType);
+
+	// Set the parent of an entity. The invalid EntityID for the parent ID detaches the entity from its parent.
+	void SetParent(const EntityID entityID, const EntityID parentID);
+
+	bool IsEmpty() const;
+	void Clear();
+
+private:
+	friend class EntityManager;
+
+	struct EntityCreation
+	{
+		uint32_t m_componentTypesBeginIndex;
+		uint32_t m_componentTypesEndIndex;
+		EntityFlags m_flags;
+		EntityLayer m_layer;
+		EntityID m_requestedID;
+		EntityID m_parentID;
+	};
+
+	struct ComponentChange
+	{
+		EntityID m_entityID;
+		ComponentType m_componentType;
+		bool m_isAddition;
+	};
+
+	struct ParentChange
+	{
+		EntityID m_entityID;
+		EntityID m_parentID;
+	};
+
+	Collection::Vector<EntityCreation> m_entityCreations;
+	// The component types of all entity creations, stored contiguously.
+	Collection::Vector<ComponentType> m_creationComponentTypes;
+
+	Collection::Vector<ComponentChange> m_componentChanges;
+	Collection::Vector<ParentChange> m_parentChanges;
+	Collection::Vector<EntityID> m_entityDeletions;
+};
+}
+
+// Inline implementations.
+namespace ECS
+{
+inline void CommandBuffer::CreateEntity(const Collection::ArrayView<const ComponentType>& componentTypes,
+	const EntityFlags flags,
+	const EntityLayer layer,
+	const EntityID requestedID,
+	const EntityID parentID)
+{
+	const uint32_t componentTypesBeginIndex = m_creationComponentTypes.Size();
+	m_creationComponentTypes.AddAll(componentTypes);
+	m_entityCreations.Add({ componentTypesBeginIndex, m_creationComponentTypes.Size(), flags, layer,
+		requestedID, parentID });
+}
+
+inline void CommandBuffer::DeleteEntity(const EntityID entityID)
+{
+	m_entityDeletions.Add(entityID);
+}
+
+inline void CommandBuffer::AddComponent(const EntityID entityID, const ComponentType componentType)
+{
+	m_componentChanges.Add({ entityID, componentType, true });
+}
+
+inline void CommandBuffer::RemoveComponent(const EntityID entityID, const ComponentType componentType)
+{
+	m_componentChanges.Add({ entityID, componentType, false });
+}
+
+inline void CommandBuffer::SetParent(const EntityID entityID, const EntityID parentID)
+{
+	m_parentChanges.Add({ entityID, parentID });
+}
+
+inline bool CommandBuffer::IsEmpty() const
+{
+	return m_entityCreations.IsEmpty() && m_componentChanges.IsEmpty()
+		&& m_parentChanges.IsEmpty() && m_entityDeletions.IsEmpty();
+}
+
+inline void CommandBuffer::Clear()
+{
+	m_entityCreations.Clear();
+	m_creationComponentTypes.Clear();
+	m_componentChanges.Clear();
+	m_parentChanges.Clear();
+	m_entityDeletions.Clear();
+}
+}
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <ecs/Archetype.h>
 #include <ecs/ComponentType.h>
 #include <ecs/ComponentVector.h>
 
+#include <collection/FlatIndexMap.h>
 #include <collection/VectorMap.h>
 #include <mem/InspectorInfo.h>
 #include <unit/CountUnits.h>
@@ -20,11 +22,13 @@ class ComponentID;
  * more type safety and more flexible interfaces for components than is straightforwardly possible with virtual
  * function interfaces. Additionally, it removes the need for components to have a vtable pointer.
  * Component types can be registered using RegisterComponentType().
+ * Each registered component type is given a dense type index in registration order so that per-type data can be
+ * stored in arrays rather than maps.
  */
 class ComponentReflector final
 {
 public:
-	using BasicConstructFunction = Component&(*)(const ComponentID, ComponentVector&);
+	using BasicConstructFunction = Component&(*)(const ComponentID, const ArchetypeID, ComponentVector&);
 	using FullSerializationFunction = void(*)(const Component&, Collection::Vector<uint8_t>&);
 	using ApplyFullSerializationFunction = void(*)(Asset::AssetManager&, Component&, const uint8_t*&, const uint8_t*);
 	using DestructorFunction = void(*)(Component&);
@@ -39,6 +43,8 @@ public:
 		SwapFunction m_swapFunction;
 	};
 
+	static constexpr uint32_t k_invalidTypeIndex = Collection::FlatIndexMap::k_invalidIndex;
+
 	ComponentReflector();
 
 	template <typename ComponentType>
@@ -46,15 +52,27 @@ public:
 
 	bool IsRegistered(const ComponentType componentType) const;
 
+	// Returns k_invalidTypeIndex if the component type isn't registered.
+	uint32_t FindTypeIndex(const ComponentType componentType) const;
+	uint32_t GetNumComponentTypes() const { return m_typeIndices.Size(); }
+
+	// Call the given function with each registered component type. The types are ordered by the hashes of their names
+	// rather than by their type indices, so the order doesn't depend on the order the types were registered in.
+	template <typename Fn>
+	void ForEachComponentType(Fn&& fn) const;
+
 	Unit::ByteCount64 GetSizeOfComponentInBytes(const ComponentType componentType) const;
 	Unit::ByteCount64 GetAlignOfComponentInBytes(const ComponentType componentType) const;
 	Mem::InspectorInfoTypeHash GetTypeHashOfComponent(const ComponentType componentType) const;
 
-	Component* TryBasicConstructComponent(const ComponentID reservedID, ComponentVector& destination) const;
+	Component* TryBasicConstructComponent(const ComponentID reservedID,
+		const ArchetypeID archetypeID,
+		ComponentVector& destination) const;
 	Component* TryMakeComponent(Asset::AssetManager& assetManager,
 		const uint8_t*& bytes,
 		const uint8_t* bytesEnd,
 		const ComponentID reservedID,
+		const ArchetypeID archetypeID,
 		ComponentVector& destination) const;
 	void DestroyComponent(Component& component) const;
 	void SwapComponents(Component& a, Component& b) const;
@@ -91,12 +109,29 @@ private:
 	Collection::VectorMap<ComponentType, Unit::ByteCount64> m_componentAlignmentsInBytes;
 	Collection::VectorMap<ComponentType, MandatoryComponentFunctions> m_mandatoryComponentFunctions;
 	Collection::VectorMap<ComponentType, Mem::InspectorInfoTypeHash> m_componentInspectorInfoTypeHashes;
+
+	// The dense type indices of the component types, keyed by type hash.
+	Collection::FlatIndexMap m_typeIndices;
 };
 }
 
 // Inline implementations.
 namespace ECS
 {
+inline uint32_t ComponentReflector::FindTypeIndex(const ComponentType componentType) const
+{
+	return m_typeIndices.Find(componentType.GetTypeHash().Get());
+}
+
+template <typename Fn>
+inline void ComponentReflector::ForEachComponentType(Fn&& fn) const
+{
+	for (const auto& entry : m_componentSizesInBytes)
+	{
+		fn(entry.first);
+	}
+}
+
 template <typename ComponentType>
 inline void ComponentReflector::RegisterComponentType()
 {
@@ -120,9 +155,10 @@ inline void ComponentReflector::RegisterNormalComponentType()
 	// Utilize the type to handle as much boilerplate casting and definition as possible.
 	struct ComponentTypeFunctions
 	{
-		static Component& BasicConstruct(const ComponentID reservedID, ComponentVector& destination)
+		static Component& BasicConstruct(
+			const ComponentID reservedID, const ArchetypeID archetypeID, ComponentVector& destination)
 		{
-			ComponentType& component = destination.Emplace<ComponentType>(reservedID);
+			ComponentType& component = destination.Emplace<ComponentType>(archetypeID, reservedID);
 			return component;
 		}
 
@@ -189,9 +225,10 @@ inline void ComponentReflector::RegisterMemoryImagedComponentType()
 	// Utilize the type to handle as much boilerplate casting and definition as possible.
 	struct ComponentTypeFunctions
 	{
-		static Component& BasicConstruct(const ComponentID reservedID, ComponentVector& destination)
+		static Component& BasicConstruct(
+			const ComponentID reservedID, const ArchetypeID archetypeID, ComponentVector& destination)
 		{
-			ComponentType& component = destination.Emplace<ComponentType>(reservedID);
+			ComponentType& component = destination.Emplace<ComponentType>(archetypeID, reservedID);
 			return component;
 		}
 
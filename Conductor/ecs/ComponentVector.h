@@ -1,10 +1,12 @@
 #pragma once
 
+#include <ecs/Archetype.h>
 #include <ecs/ComponentID.h>
 
 #include <collection/ArrayView.h>
-#include <collection/HashMap.h>
+#include <collection/FlatIndexMap.h>
 #include <collection/LinearBlockAllocator.h>
+#include <collection/Vector.h>
 #include <traits/IsMemCopyAFullCopy.h>
 #include <unit/CountUnits.h>
 
@@ -16,13 +18,15 @@ class EntityManager;
 
 /**
  * A collection of components of a certain type stored in mostly contiguous memory.
+ * Components are allocated in columns: one column per archetype when the owning EntityManager uses archetype storage,
+ * or a single column for every component otherwise. Entities of the same archetype are allocated in lockstep across
+ * the columns of each of their component types, so systems iterating over them walk memory in order.
+ * Components are found by ID through a flat table of unique IDs to slots, so a lookup is a couple of indexed loads.
  */
 class ComponentVector
 {
 public:
 	using value_type = Component;
-	using iterator = Collection::LinearBlockAllocator::iterator;
-	using const_iterator = Collection::LinearBlockAllocator::const_iterator;
 
 	ComponentVector();
 	~ComponentVector();
@@ -43,42 +47,62 @@ public:
 	Component* Find(const ComponentID& key);
 	const Component* Find(const ComponentID& key) const;
 
+	// Construct a component in the column of the given archetype.
 	template <typename T, typename... Args>
-	T& Emplace(Args&&... args);
+	T& Emplace(const ArchetypeID archetypeID, Args&&... args);
+
+	// Move a component into the column of the given archetype. Pointers to the component are invalidated.
+	Component* Relocate(const ComponentID id, const ArchetypeID archetypeID);
 
 	void Remove(const ComponentID id);
 	void RemoveSorted(const Collection::ArrayView<const uint64_t> ids);
 
-	// These allocate over the internal allocator and as such the values iterated over
-	// must be reinterpret_cast to Component&.
-	iterator begin() { return m_allocator.begin(); }
-	const_iterator begin() const { return m_allocator.begin(); }
-	const_iterator cbegin() const { return m_allocator.cbegin(); }
-
-	iterator end() { return m_allocator.end(); }
-	const_iterator end() const { return m_allocator.end(); }
-	const_iterator cend() const { return m_allocator.cend(); }
-
 private:
-	class ComponentIDHashFunctor final : public Collection::I64HashFunctor
+	struct Column
 	{
-	public:
-		uint64_t Hash(const ComponentID& key) const { return I64HashFunctor::Hash(key.GetUniqueID()); }
+		Column() = default;
+		Column(const ArchetypeID archetypeID, Collection::LinearBlockAllocator&& allocator)
+			: m_archetypeID(archetypeID)
+			, m_allocator(std::move(allocator))
+		{}
+
+		ArchetypeID m_archetypeID{};
+		Collection::LinearBlockAllocator m_allocator{};
 	};
 
+	struct Slot
+	{
+		Component* m_component{ nullptr };
+		uint32_t m_columnIndex{ 0 };
+	};
+
+	uint32_t FindOrAddColumn(const ArchetypeID archetypeID);
+	void AddSlot(const ComponentID id, const Slot& slot);
+	// Remove the slot of the given component from the slot table and return it.
+	bool TryRemoveSlot(const ComponentID id, Slot& outSlot);
+	void DestroyAndFree(const Slot& slot);
+
 	const ComponentReflector* m_componentReflector{ nullptr };
 
 	ComponentType m_componentType{};
-	Collection::LinearBlockAllocator m_allocator{};
-	Collection::HashMap<ComponentID, Component*, ComponentIDHashFunctor> m_keyLookup;
+	uint32_t m_componentAlignment{ 0 };
+	uint32_t m_componentSize{ 0 };
+	Collection::Vector<Column> m_columns{};
+
+	// The slots of the components, indexed by the unique IDs of the components. Empty slots have a null component
+	// and are reused before the slot table grows.
+	Collection::Vector<Slot> m_slots{};
+	Collection::Vector<uint32_t> m_freeSlotIndices{};
+	Collection::FlatIndexMap m_slotIndices{};
 };
 
 template <typename T, typename... Args>
-inline T& ComponentVector::Emplace(Args&&... args)
+inline T& ComponentVector::Emplace(const ArchetypeID archetypeID, Args&&... args)
 {
-	T* const destination = reinterpret_cast<T*>(m_allocator.Alloc());
+	const uint32_t columnIndex = FindOrAddColumn(archetypeID);
+	T* const destination = reinterpret_cast<T*>(m_columns[columnIndex].m_allocator.Alloc());
 	new (destination) T(std::forward<Args>(args)...);
-	m_keyLookup[destination->m_id] = destination;
+	AddSlot(destination->m_id, Slot{ destination, columnIndex });
 	return *destination;
 }
 }
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <ecs/FrameAllocator.h>
+
+#include <collection/Vector.h>
+#include <dev/Dev.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ECS
+{
+class EntityManager;
+
+/**
+ * A function with the signature void(EntityManager&) which a system defers until it can access the EntityManager.
+ * Functions small enough to fit in a DeferredFunction are stored inside it. Larger functions are stored in a
+ * FrameAllocator when one is given and on the heap otherwise, so deferring a function doesn't need to allocate.
+ */
+class DeferredFunction final
+{
+public:
+	static constexpr size_t k_inlineSizeInBytes = 48;
+
+	DeferredFunction() = default;
+
+	template <typename Fn>
+	DeferredFunction(Fn&& fn, FrameAllocator* const frameAllocator);
+
+	DeferredFunction(const DeferredFunction&) = delete;
+	DeferredFunction& operator=(const DeferredFunction&) = delete;
+
+	DeferredFunction(DeferredFunction&& other) noexcept;
+	DeferredFunction& operator=(DeferredFunction&& rhs) noexcept;
+
+	~DeferredFunction();
+
+	void operator()(EntityManager& entityManager);
+
+private:
+	enum class Storage : uint8_t
+	{
+		None = 0,
+		Inline,
+		FrameAllocator,
+		Heap,
+	};
+
+	struct Operations
+	{
+		void (*m_invoke)(void* function, EntityManager& entityManager);
+		// Move construct the function at the destination from the function at the source, then destroy the source.
+		void (*m_relocate)(void* destination, void* source);
+		void (*m_destroy)(void* function);
+		void (*m_delete)(void* function);
+	};
+
+	template <typename StoredFn>
+	struct OperationsFor
+	{
+		static void Invoke(void* function, EntityManager& entityManager)
+		{
+			(*static_cast<StoredFn*>(function))(entityManager);
+		}
+
+		static void Relocate(void* destination, void* source)
+		{
+			StoredFn& sourceFunction = *static_cast<StoredFn*>(source);
+			new (destination) StoredFn(std::move(sourceFunction));
+			sourceFunction.~StoredFn();
+		}
+
+		static void Destroy(void* function)
+		{
+			static_cast<StoredFn*>(function)->~StoredFn();
+		}
+
+		static void Delete(void* function)
+		{
+			delete static_cast<StoredFn*>(function);
+		}
+
+		static constexpr Operations k_operations{ &Invoke, &Relocate, &Destroy, &Delete };
+	};
+
+	void* GetFunction() { return (m_storage == Storage::Inline) ? m_inlineStorage : m_externalFunction; }
+	void Reset();
+
+	alignas(std::max_align_t) uint8_t m_inlineStorage[k_inlineSizeInBytes];
+	void* m_externalFunction{ nullptr };
+	const Operations* m_operations{ nullptr };
+	Storage m_storage{ Storage::None };
+};
+
+/**
+ * The deferred functions of a system. Large deferred functions are stored in the list's FrameAllocator.
+ * Systems can also use the FrameAllocator for transient data that their deferred functions need.
+ */
+class DeferredFunctionList final
+{
+public:
+	DeferredFunctionList() = default;
+	explicit DeferredFunctionList(FrameAllocator& frameAllocator)
+		: m_frameAllocator(&frameAllocator)
+		, m_functions()
+	{}
+
+	// Defer a function with the signature void(EntityManager&).
+	template <typename Fn>
+	void Add(Fn&& fn);
+
+	// Move the functions of another list to the end of this list, preserving their order.
+	void AddAll(DeferredFunctionList&& other);
+
+	// Returns null if this list doesn't have a frame allocator.
+	FrameAllocator* GetFrameAllocator() const { return m_frameAllocator; }
+
+	bool IsEmpty() const { return m_functions.IsEmpty(); }
+	uint32_t Size() const { return m_functions.Size(); }
+	void Clear() { m_functions.Clear(); }
+
+	DeferredFunction* begin() { return m_functions.begin(); }
+	DeferredFunction* end() { return m_functions.end(); }
+
+private:
+	FrameAllocator* m_frameAllocator{ nullptr };
+	Collection::Vector<DeferredFunction> m_functions;
+};
+}
+
+// Inline implementations.
+namespace ECS
+{
+template <typename Fn>
+inline DeferredFunction::DeferredFunction(Fn&& fn, FrameAllocator* const frameAllocator)
+{
+	using StoredFn = std::decay_t<Fn>;
+	static_assert(std::is_invocable_v<StoredFn&, EntityManager&>,
+		"Deferred functions must have the signature void(EntityManager&).");
+
+	m_operations = &OperationsFor<StoredFn>::k_operations;
+
+	constexpr bool fitsInline = (sizeof(StoredFn) <= k_inlineSizeInBytes)
+		&& (alignof(StoredFn) <= alignof(std::max_align_t))
+		&& std::is_nothrow_move_constructible_v<StoredFn>;
+	if constexpr (fitsInline)
+	{
+		new (m_inlineStorage) StoredFn(std::forward<Fn>(fn));
+		m_storage = Storage::Inline;
+	}
+	else if (frameAllocator != nullptr)
+	{
+		m_externalFunction = frameAllocator->Alloc(sizeof(StoredFn), alignof(StoredFn));
+		new (m_externalFunction) StoredFn(std::forward<Fn>(fn));
+		m_storage = Storage::FrameAllocator;
+	}
+	else
+	{
+		m_externalFunction = new StoredFn(std::forward<Fn>(fn));
+		m_storage = Storage::Heap;
+	}
+}
+
+inline DeferredFunction::DeferredFunction(DeferredFunction&& other) noexcept
+	: m_externalFunction(other.m_externalFunction)
+	, m_operations(other.m_operations)
+	, m_storage(other.m_storage)
+{
+	if (m_storage == Storage::Inline)
+	{
+		m_operations->m_relocate(m_inlineStorage, other.m_inlineStorage);
+	}
+	other.m_externalFunction = nullptr;
+	other.m_operations = nullptr;
+	other.m_storage = Storage::None;
+}
+
+inline DeferredFunction& DeferredFunction::operator=(DeferredFunction&& rhs) noexcept
+{
+	if (this != &rhs)
+	{
+		Reset();
+
+		m_externalFunction = rhs.m_externalFunction;
+		m_operations = rhs.m_operations;
+		m_storage = rhs.m_storage;
+		if (m_storage == Storage::Inline)
+		{
+			m_operations->m_relocate(m_inlineStorage, rhs.m_inlineStorage);
+		}
+		rhs.m_externalFunction = nullptr;
+		rhs.m_operations = nullptr;
+		rhs.m_storage = Storage::None;
+	}
+	return *this;
+}
+
+inline DeferredFunction::~DeferredFunction()
+{
+	Reset();
+}
+
+inline void DeferredFunction::operator()(EntityManager& entityManager)
+{
+	AMP_FATAL_ASSERT(m_storage != Storage::None, "Cannot call an empty DeferredFunction.");
+	m_operations->m_invoke(GetFunction(), entityManager);
+}
+
+inline void DeferredFunction::Reset()
+{
+	switch (m_storage)
+	{
+	case Storage::None:
+	{
+		return;
+	}
+	case Storage::Inline:
+	case Storage::FrameAllocator:
+	{
+		// Memory in a frame allocator is freed when the allocator is reset.
+		m_operations->m_destroy(GetFunction());
+		break;
+	}
+	case Storage::Heap:
+	{
+		m_operations->m_delete(m_externalFunction);
+		break;
+	}
+	}
+
+	m_externalFunction = nullptr;
+	m_operations = nullptr;
+	m_storage = Storage::None;
+}
+
+template <typename Fn>
+inline void DeferredFunctionList::Add(Fn&& fn)
+{
+	m_functions.Emplace(std::forward<Fn>(fn), m_frameAllocator);
+}
+
+inline void DeferredFunctionList::AddAll(DeferredFunctionList&& other)
+{
+	for (auto& function : other.m_functions)
+	{
+		m_functions.Add(std::move(function));
+	}
+	other.m_functions.Clear();
+}
+}
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <ecs/EntityID.h>
+
 #include <collection/ArrayView.h>
+#include <collection/SparseIndexMap.h>
 #include <collection/Vector.h>
 #include <unit/CountUnits.h>
 #include <util/VariadicUtil.h>
@@ -9,6 +12,9 @@ namespace ECS
 {
 /**
  * Holds groups of entity pointers and component pointers in contiguous storage.
+ * Each group belongs to one entity and is indexed by the entity's ID, so groups can be added and removed in constant
+ * time. Removed groups are left in place as tombstones and added groups are appended unsorted; Compact() must be
+ * called before the groups are viewed to remove the tombstones and merge the new groups into sorted order.
  */
 class ECSGroupVector
 {
@@ -18,24 +24,30 @@ public:
 	explicit ECSGroupVector(const uint32_t groupSize, const uint32_t initialCapacity = 8)
 		: m_groupSize(groupSize)
 		, m_data(groupSize * initialCapacity)
+		, m_entityIDs(initialCapacity)
 	{}
 
-	uint32_t Size() const { return m_data.Size() / m_groupSize; }
-	uint32_t Capacity() const { return m_data.Capacity() / m_groupSize; }
-	bool IsEmpty() const { return m_data.IsEmpty(); }
+	uint32_t Size() const { return m_entityIDs.Size(); }
+	uint32_t Capacity() const { return m_entityIDs.Capacity(); }
+	bool IsEmpty() const { return m_entityIDs.IsEmpty(); }
 
-	// Add an ECS group to this ECS vector.
-	void Add(const Collection::Vector<void*>& pointers);
+	// Add the ECS group of the given entity to this ECS vector.
+	void Add(const EntityID entityID, const Collection::Vector<void*>& pointers);
 	
-	// Remove an ECS group from this ECS vector.
-	void Remove(const Collection::Vector<void*>& pointers);
+	// Remove the ECS group of the given entity from this ECS vector, copying its pointers into outPointers.
+	// Returns false if the entity has no group in this vector.
+	bool TryRemove(const EntityID entityID, Collection::Vector<void*>& outPointers);
+
+	bool Contains(const EntityID entityID) const;
 
-	// Sort the ECS groups of this vector by the first index in each ECS group.
-	void Sort();
+	// Remove the tombstones of removed groups and merge added groups into the groups sorted by their first pointer,
+	// which makes the memory accesses of iterating over the groups as fast as possible. Does nothing if no groups
+	// were added or removed since the last call.
+	void Compact();
 
-	void Clear() { m_data.Clear(); }
+	void Clear();
 
-	// Return an iterable view into this which iterates with the given group type.
+	// Return an iterable view into this which iterates with the given group type. The vector must be compact.
 	template <typename ECSGroupType>
 	Collection::ArrayView<ECSGroupType> GetView()
 	{
@@ -43,13 +55,33 @@ public:
 			"Component group type has mismatch between its size constant and its actual size.");
 		AMP_FATAL_ASSERT(m_groupSize == ECSGroupType::k_size,
 			"Component group type has the wrong number of components.");
+		AMP_FATAL_ASSERT(m_numRemovedGroups == 0 && m_numSortedGroups == Size(),
+			"ECS group vectors must be compacted before they are viewed.");
 		
-		ECSGroupType* const data = reinterpret_cast<ECSGroupType*>(&m_data[0]);
+		ECSGroupType* const data = reinterpret_cast<ECSGroupType*>(m_data.begin());
 		return Collection::ArrayView<ECSGroupType>(data, Size());
 	}
 
 private:
 	uint32_t m_groupSize{ 0 };
+
+	// The pointers of each group, stored contiguously.
 	Collection::Vector<void*> m_data;
+
+	// The entity each group belongs to. Removed groups have an invalid entity ID until they are compacted.
+	Collection::Vector<EntityID> m_entityIDs;
+
+	// The index of each entity's group.
+	Collection::SparseIndexMap m_groupIndices;
+
+	// Groups before this index are sorted by their first pointer. Groups at or after it were added since the last
+	// time this vector was compacted.
+	uint32_t m_numSortedGroups{ 0 };
+	uint32_t m_numRemovedGroups{ 0 };
+
+	// Scratch buffers reused by Compact() to avoid allocating.
+	Collection::Vector<uint32_t> m_scratchOrder;
+	Collection::Vector<void*> m_scratchData;
+	Collection::Vector<EntityID> m_scratchEntityIDs;
 };
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <ecs/Archetype.h>
 #include <ecs/ComponentID.h>
 #include <ecs/EntityFlags.h>
 #include <ecs/EntityID.h>
@@ -43,6 +44,7 @@ public:
 	const EntityID& GetID() const { return m_id; }
 	const EntityFlags& GetFlags() const { return m_flags; }
 	const EntityLayer& GetLayer() const { return m_layer; }
+	const ArchetypeID& GetArchetypeID() const { return m_archetypeID; }
 	const Entity* GetParent() const { return m_parent; }
 	Collection::ArrayView<const Entity* const> GetChildren() const { return m_children.GetView(); }
 	const Collection::Vector<ComponentID>& GetComponentIDs() const { return m_componentIDs; }
@@ -60,14 +62,22 @@ private:
 
 	EntityFlags m_flags;
 	EntityLayer m_layer;
-	uint8_t m_padding[13];
+
+	// The archetype this entity's components are stored in. Invalid if the EntityManager uses PerType storage.
+	ArchetypeID m_archetypeID;
+	uint8_t m_padding[4];
+
+	// Bit i is set when the entity has a component whose type has dense type index i in the ComponentReflector.
+	// m_componentIDs is sorted by type index, so such a component's ID is at the number of set bits below bit i.
+	uint64_t m_componentTypeMask{ 0 };
 
 	Entity* m_parent{ nullptr };
 	Collection::Vector<Entity*> m_children;
 
-	// The components this entity is composed of.
+	// The components this entity is composed of, sorted by the dense type indices of their types.
 	Collection::Vector<ComponentID> m_componentIDs;
 };
+static_assert(sizeof(Entity) == 64, "Entities are expected to fit in a single cache line.");
 
 template <typename TComponent>
 inline ComponentID Entity::FindComponentID() const
@@ -77,8 +87,8 @@ inline ComponentID Entity::FindComponentID() const
 
 inline ComponentID Entity::FindComponentID(const ComponentType& componentType) const
 {
-	// TODO(ecs) This is currently a linear search, which callers will typically follow up with a binary search
-	//      to actually get the component. It's worth remembering that this may be a performance concern.
+	// Entities have few components, so a linear search is cheap. EntityManager::FindComponent() avoids it by using
+	// the entity's component type mask to index directly into its sorted component IDs.
 	for (const auto& id : m_componentIDs)
 	{
 		if (id.GetType() == componentType)
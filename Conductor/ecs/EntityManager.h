@@ -7,17 +7,25 @@
 #include <collection/VectorMap.h>
 
 #include <ecs/ApplyDeltaTransmissionResult.h>
+#include <ecs/Archetype.h>
+#include <ecs/ChangeJournal.h>
+#include <ecs/CommandBuffer.h>
 #include <ecs/ComponentID.h>
+#include <ecs/ComponentVector.h>
+#include <ecs/DeferredFunction.h>
 #include <ecs/ECSGroupVector.h>
 #include <ecs/Entity.h>
 #include <ecs/EntityID.h>
-#include <ecs/SystemUtil.h>
+#include <ecs/FrameAllocator.h>
+#include <ecs/System.h>
 
 #include <mem/UniquePtr.h>
+#include <thread/JobSystem.h>
 
 #include <unit/Time.h>
 
 #include <functional>
+#include <mutex>
 #include <type_traits>
 
 namespace Asset { class AssetManager; }
@@ -26,14 +34,20 @@ namespace ECS
 {
 class Component;
 class ComponentReflector;
-class ComponentVector;
 class ECSGroupVector;
+struct SerializedBytesWithViews;
+struct SerializedChanges;
 struct SerializedEntitiesAndComponents;
 class System;
 
 /**
  * An entity manager owns and updates Entities composed of Components using Systems.
- * Systems run in the order they are registered.
+ * Systems are scheduled as a dependency graph built in registration order: each system runs once every previously
+ * registered system that it conflicts with has finished and had its deferred functions run, so systems with
+ * unrelated component types run concurrently. Deferred functions run on the updating thread while no system runs.
+ * Components are stored according to the EntityManager's ComponentStorageMode. With archetype storage, entities that
+ * have the same set of component types have their components allocated together so that systems iterate over them
+ * in memory order.
  */
 class EntityManager final
 {
@@ -41,7 +55,8 @@ public:
 	EntityManager(Asset::AssetManager& assetManager,
 		const ComponentReflector& componentReflector,
 		const EntityID firstEntityID,
-		const uint64_t firstComponentID);
+		const uint64_t firstComponentID,
+		const ComponentStorageMode storageMode = ComponentStorageMode::PerType);
 	~EntityManager();
 
 	Entity& CreateEntityWithComponents(
@@ -53,6 +68,9 @@ public:
 	Collection::Vector<Entity*> CreateEntitiesFromFullSerialization(
 		const SerializedEntitiesAndComponents& serialization);
 	void SetNetworkedEntitiesToFullSerialization(const SerializedEntitiesAndComponents& serialization);
+	// Apply the serialized state of the components in the serialization which exist in the EntityManager. Unlike
+	// SetNetworkedEntitiesToFullSerialization, no entities or components are created or deleted.
+	void ApplyFullSerializationToExistingComponents(const SerializedEntitiesAndComponents& serialization);
 
 	void FullySerializeEntitiesAndComponents(
 		const Collection::ArrayView<const Entity*>& entities,
@@ -61,31 +79,65 @@ public:
 		const std::function<bool(const Entity&)>& filter,
 		SerializedEntitiesAndComponents& serialization) const;
 
+	// Enable or disable recording which entities and components change in the change journal. Disabling change
+	// tracking clears the journal.
+	void SetChangeTrackingEnabled(const bool isEnabled) { m_changeJournal.SetEnabled(isEnabled); }
+	void ClearChangeJournal() { m_changeJournal.Clear(); }
+
+	// Record every change recorded in the change journal in the given journal as well, whether or not change tracking
+	// is enabled, so that the observer can find what changed without visiting every entity. The observer clears its
+	// journal as it consumes it and must stop observing before the journal is destroyed.
+	void AddChangeObserver(ChangeJournal& journal);
+	void RemoveChangeObserver(ChangeJournal& journal);
+
+	// Serialize the entities matching the filter and their components by applying the changes in the change journal
+	// to a previous serialization of them, and then clear the journal. Runs of unchanged entities and components are
+	// copied from the previous serialization, so the cost is proportional to the number of changes rather than to the
+	// number of entities. The previous serialization must have been made with the same filter, and the journal must
+	// have been cleared when it was made. The filter may only depend on state whose changes the journal records.
+	// The IDs of the entities and components which differ from the previous serialization are added to outChanges.
+	// Both serialization and outChanges must be empty.
+	void SerializeChangesOfEntitiesMatchingFilter(
+		const std::function<bool(const Entity&)>& filter,
+		const SerializedEntitiesAndComponents& previousSerialization,
+		SerializedEntitiesAndComponents& serialization,
+		SerializedChanges& outChanges);
+
 	void SetParentEntity(Entity& entity, Entity* parentEntity);
 	void DeleteEntities(const Collection::ArrayView<const EntityID>& entitiesToDelete);
 
+	// Apply the commands of a command buffer and clear it. Each kind of command updates the ECS groups of the
+	// systems in one pass, so this is much faster than making the same changes one entity at a time.
+	void ApplyCommandBuffer(CommandBuffer& commandBuffer);
+
 	Entity* FindEntity(const EntityID id);
 	const Entity* FindEntity(const EntityID id) const;
 
 	Component* FindComponent(const ComponentID id);
 	const Component* FindComponent(const ComponentID id) const;
 
+	// Find an entity's component of the given type. Returns null if the entity doesn't have one or it is a tag.
+	Component* FindComponent(const Entity& entity, const ComponentType componentType);
+	const Component* FindComponent(const Entity& entity, const ComponentType componentType) const;
+
 	template <typename TComponent>
 	TComponent* FindComponent(const Entity& entity);
 	template <typename TComponent>
 	const TComponent* FindComponent(const Entity& entity) const;
 
-	// Register a system to run by itself. Systems run in the order they are registered.
+	// Register a system. By default it runs by itself in registration order; systems which are known to be safe to run
+	// alongside others opt in with SystemScheduling::Automatic, after which they run after the previously registered
+	// systems they conflict with.
 	template <typename SystemType>
-	SystemType& RegisterSystem(Mem::UniquePtr<SystemType>&& system);
-
-	// Register multiple systems to run concurrently.
-	template <typename... SystemTypes>
-	void RegisterConcurrentSystems(Mem::UniquePtr<SystemTypes>&&... concurrentSystems);
+	SystemType& RegisterSystem(Mem::UniquePtr<SystemType>&& system,
+		const SystemScheduling scheduling = SystemScheduling::Exclusive);
 
 	// Run the EntityManager one step.
 	void Update(const Unit::Time::Millisecond delta);
 
+	// Memory allocated from the frame allocator is freed at the end of the current or next call to Update().
+	FrameAllocator& GetFrameAllocator() { return m_frameAllocator; }
+
 private:
 	struct RegisteredSystem;
 	using SystemUpdateFn = void(*)(RegisteredSystem&, Unit::Time::Millisecond);
@@ -95,26 +147,157 @@ private:
 	{
 		RegisteredSystem();
 		RegisteredSystem(Mem::UniquePtr<System>&& system, SystemUpdateFn updateFunction,
-			NotifyOfEntityFn notifyEntityAddedFunction, NotifyOfEntityFn notifyEntityRemovedFunction);
+			NotifyOfEntityFn notifyEntityAddedFunction, NotifyOfEntityFn notifyEntityRemovedFunction,
+			SystemScheduling scheduling, FrameAllocator& frameAllocator);
 
 		Mem::UniquePtr<System> m_system;
 		SystemUpdateFn m_updateFunction;
 		NotifyOfEntityFn m_notifyEntityAddedFunction;
 		NotifyOfEntityFn m_notifyEntityRemovedFunction;
 		ECSGroupVector m_ecsGroups;
-		Collection::Vector<std::function<void(EntityManager&)>> m_deferredFunctions;
+		DeferredFunctionList m_deferredFunctions;
+
+		// The system's place in the dependency graph: the number of systems it waits on and the indices of the
+		// systems that wait on it.
+		SystemScheduling m_scheduling;
+		uint32_t m_numDependencies{ 0 };
+		Collection::Vector<uint32_t> m_dependentIndices;
+	};
+
+	struct SystemUpdateContext
+	{
+		RegisteredSystem* m_registeredSystem;
+		Unit::Time::Millisecond m_delta;
+	};
+
+	// The state of the dependency graph during an update. It is kept between updates so that updating doesn't allocate.
+	struct SystemSchedule
+	{
+		Collection::Vector<SystemUpdateContext> m_updateContexts;
+		Collection::Vector<uint32_t> m_numUnfinishedDependencies;
+		Collection::Vector<Mem::UniquePtr<Thread::JobCounter>> m_updateCounters;
+		Collection::Vector<uint32_t> m_readySystems;
+		Collection::Vector<uint32_t> m_runningSystems;
+		Collection::Vector<uint32_t> m_systemsAwaitingDeferredFunctions;
+		uint32_t m_numFinishedSystems{ 0 };
 	};
 
-	struct RegisteredConcurrentSystemGroup
+	// Memory reused by full serializations so that serializing every frame doesn't allocate.
+	struct FullSerializationScratch
 	{
-		Collection::Vector<RegisteredSystem> m_systems;
+		struct ComponentToSerialize
+		{
+			uint64_t m_uniqueID;
+			const Component* m_component;
+		};
+
+		std::mutex m_mutex;
+		Collection::Vector<const Entity*> m_entities;
+		// The components to serialize, grouped by the dense type indices of their types.
+		Collection::Vector<Collection::Vector<ComponentToSerialize>> m_componentsByTypeIndex;
+		// The types which have components to serialize, with their dense type indices.
+		Collection::Vector<Collection::Pair<ComponentType, uint32_t>> m_typesToSerialize;
+		// The index of each type in SerializedEntitiesAndComponents::m_components, indexed by dense type index.
+		Collection::Vector<uint16_t> m_serializedTypeIndices;
+		// The number of bytes the components of each type serialized to last time, indexed by dense type index.
+		Collection::Vector<uint32_t> m_lastNumBytesByTypeIndex;
+	};
+
+	// Memory reused by incremental serializations.
+	struct IncrementalSerializationScratch
+	{
+		// A change to an element of a previous serialization. When an element has more than one change, the change
+		// with the lowest kind applies.
+		struct ElementChange
+		{
+			enum class Kind : uint8_t
+			{
+				Rewrite,
+				Remove,
+				RewriteIfPresent,
+			};
+
+			uint64_t m_id;
+			Kind m_kind;
+		};
+
+		// The changes to components, grouped by the dense type indices of their types.
+		Collection::Vector<Collection::Vector<ElementChange>> m_componentChangesByTypeIndex;
+		// The types which have component changes, with their dense type indices.
+		Collection::Vector<Collection::Pair<ComponentType, uint32_t>> m_changedTypes;
+		Collection::Vector<ElementChange> m_entityChanges;
+		// The types which aren't in the previous serialization, with their dense type indices.
+		Collection::Vector<Collection::Pair<ComponentType, uint32_t>> m_newTypes;
+		// The index of each type in SerializedEntitiesAndComponents::m_components, indexed by dense type index.
+		Collection::Vector<uint16_t> m_serializedTypeIndices;
+		Collection::Vector<ComponentID> m_componentIDs;
 	};
 
 	template <typename SystemType> struct SystemTypeFunctions;
 
+	// Serialize the entities in the full serialization scratch. The components of each type are serialized in
+	// parallel with each other and with the entities. The scratch's mutex must be locked.
+	void FullySerializeScratchEntities(SerializedEntitiesAndComponents& serialization) const;
+	void FullySerializeScratchComponentsOfType(
+		const uint32_t typeIndex,
+		SerializedEntitiesAndComponents& serialization) const;
+	void FullySerializeScratchEntityHeaders(
+		const uint32_t numEntityBytes,
+		SerializedEntitiesAndComponents& serialization) const;
+
+	// Serialize an entity's header and component IDs using the given serialized type indices.
+	void SerializeEntity(const Entity& entity,
+		const Collection::Vector<uint16_t>& serializedTypeIndices,
+		Collection::Vector<uint8_t>& outBytes) const;
+
+	// Build a list of serialized elements by applying sorted changes to a list of previous elements, which may be
+	// null. Runs of unchanged elements are copied, removed elements are skipped, and rewritten elements are serialized
+	// with writeElementFn(id, outBytes). The IDs of the elements which differ from the previous elements are added to
+	// outChangedElementIDs.
+	template <typename HeaderType, typename IDType, typename WriteElementFn>
+	static void ApplyChangesToSerializedElements(
+		const SerializedBytesWithViews* const previousElements,
+		const Collection::ArrayView<const IncrementalSerializationScratch::ElementChange>& changes,
+		WriteElementFn&& writeElementFn,
+		SerializedBytesWithViews& outElements,
+		Collection::Vector<IDType>& outChangedElementIDs);
+
+	// Record a change in the change journal and in the journals of the change observers.
+	void RecordComponentChange(const ComponentID id);
+	void RecordEntityChange(const EntityID id);
+
+	// Record the components a system marked as changed in the change journal. This is called once the system's
+	// deferred functions have run, on the thread which updates the EntityManager.
+	void RecordChangesOfSystem(RegisteredSystem& registeredSystem);
+
 	// Access a ComponentVector, initializing it if necessary. Returns null for tag components.
 	ComponentVector* GetComponentVector(const ComponentType componentType);
+
+	// Find the ID of an entity's component with the given type. Returns null if the entity doesn't have one.
+	const ComponentID* FindComponentIDOfEntity(const Entity& entity, const ComponentType componentType) const;
+
+	// Sort component IDs by the dense type indices of their types.
+	void SortComponentIDsByTypeIndex(Collection::Vector<ComponentID>& componentIDs) const;
+
+	// Sort an entity's component IDs and rebuild its component type mask. Must be called whenever the entity's
+	// component IDs change.
+	void IndexComponentIDsOfEntity(Entity& entity) const;
+
+	// Determine the archetype components with the given types should be stored in.
+	// Returns the invalid ArchetypeID when this manager uses PerType storage.
+	ArchetypeID ResolveArchetype(const Collection::ArrayView<const ComponentType>& componentTypes);
+	ArchetypeID ResolveArchetype(const Collection::ArrayView<const ComponentID>& componentIDs);
+
+	// Move an entity's components into the columns of its current archetype.
+	void RelocateComponentsToArchetype(const Entity& entity);
 	
+	// Create an entity with the given components without adding it to the ECS groups of the systems.
+	Entity& EmplaceEntityWithComponents(
+		const Collection::ArrayView<const ComponentType>& componentTypes,
+		const EntityFlags flags,
+		const EntityLayer layer,
+		const EntityID requestedID);
+
 	// Add a component to an entity.
 	void AddComponentToEntity(const ComponentType componentType, Entity& entity);
 	void AddComponentToEntity(
@@ -123,11 +306,18 @@ private:
 	void RemoveComponent(const ComponentID id);
 
 	template <typename SystemType>
-	SystemType& RegisterSystemInGroup(Mem::UniquePtr<SystemType>&& system, RegisteredConcurrentSystemGroup& outGroup);
+	SystemType& RegisterSystemInGraph(Mem::UniquePtr<SystemType>&& system, const SystemScheduling scheduling);
+
+	// Add the most recently registered system to the dependency graph.
+	void AddLastSystemToGraph();
+
+	// Mark a system as finished and make the systems waiting on it ready if it was the last system they waited on.
+	void ReleaseSystemDependents(const uint32_t systemIndex);
 
 	void AddECSPointersToSystems(Entity& entityToAdd);
 	void AddECSPointersToSystems(Collection::ArrayView<Entity* const> entitiesToAdd);
 	void RemoveECSPointersFromSystems(Entity& entity);
+	void RemoveECSPointersFromSystems(Collection::ArrayView<Entity* const> entitiesToRemove);
 	
 private:
 	// Components that load resources from disk use the AssetManager to do so efficiently.
@@ -144,8 +334,15 @@ private:
 	};
 	Collection::LinearBlockHashMap<EntityID, Entity, EntityIDHashFunctor> m_entities;
 
-	// The components this manager owns on behalf of its entities, grouped by type.
-	Collection::VectorMap<ComponentType, ComponentVector> m_components{};
+	// The components this manager owns on behalf of its entities, indexed by the dense type index of their type.
+	// Component vectors are initialized when a component of their type is first created.
+	Collection::Vector<ComponentVector> m_components{};
+
+	// How components are laid out in their component vectors.
+	ComponentStorageMode m_storageMode;
+
+	// The archetypes of this manager's entities. Only used with ComponentStorageMode::Archetype.
+	ArchetypeRegistry m_archetypeRegistry{};
 
 	// The next entity ID that will be assigned.
 	EntityID m_nextEntityID{ 0 };
@@ -153,55 +350,48 @@ private:
 	// The next component ID that will be assigned.
 	uint64_t m_nextComponentID{ 0 };
 
-	// The systems that this entity manager is running, sorted into groups which can run concurrently.
-	Collection::Vector<RegisteredConcurrentSystemGroup> m_concurrentSystemGroups{};
+	// Transient memory for systems and their deferred functions, which is freed at the end of each update.
+	// Declared before the systems so that it outlives their deferred functions.
+	FrameAllocator m_frameAllocator{};
+
+	// The systems that this entity manager is running, in registration order.
+	Collection::Vector<RegisteredSystem> m_systems{};
+
+	// Reused by Update() to track the progress of the systems through the dependency graph.
+	SystemSchedule m_systemSchedule{};
+
+	// Reused by full serializations, which are logically const.
+	mutable FullSerializationScratch m_fullSerializationScratch{};
+
+	// The entities and components which changed since the journal was last cleared. Only recorded to while change
+	// tracking is enabled.
+	ChangeJournal m_changeJournal{};
+	// The journals which are recorded to along with the change journal.
+	Collection::Vector<ChangeJournal*> m_changeObservers{};
+
+	IncrementalSerializationScratch m_incrementalSerializationScratch{};
 };
 
 template <typename TComponent>
 inline TComponent* EntityManager::FindComponent(const Entity& entity)
 {
-	const ComponentID componentID = entity.FindComponentID<TComponent>();
-	Component* const component = FindComponent(componentID);
-	if (component != nullptr)
-	{
-		return static_cast<TComponent*>(component);
-	}
-	return nullptr;
+	return static_cast<TComponent*>(FindComponent(entity, TComponent::k_type));
 }
 
 template <typename TComponent>
 inline const TComponent* EntityManager::FindComponent(const Entity& entity) const
 {
-	const ComponentID componentID = entity.FindComponentID<TComponent>();
-	const Component* const component = FindComponent(componentID);
-	if (component != nullptr)
-	{
-		return static_cast<const TComponent*>(component);
-	}
-	return nullptr;
+	return static_cast<const TComponent*>(FindComponent(entity, TComponent::k_type));
 }
 
 template <typename SystemType>
-inline SystemType& EntityManager::RegisterSystem(Mem::UniquePtr<SystemType>&& system)
+inline SystemType& EntityManager::RegisterSystem(Mem::UniquePtr<SystemType>&& system,
+	const SystemScheduling scheduling)
 {
 	AMP_FATAL_ASSERT(m_entities.IsEmpty(), "Systems must be registered before entities are added to the "
 		"EntityManager because there is not currently support for initializing the system's component groups.");
 
-	RegisteredConcurrentSystemGroup& newGroup = m_concurrentSystemGroups.Emplace();
-	return RegisterSystemInGroup<SystemType>(std::move(system), newGroup);
-}
-
-template <typename... SystemTypes>
-inline void EntityManager::RegisterConcurrentSystems(Mem::UniquePtr<SystemTypes>&&... concurrentSystems)
-{
-	static_assert(SystemUtil::AreSystemsWriteCompatible<SystemTypes...>(),
-		"The given systems can't run concurrently due to write conflicts.");
-
-	AMP_FATAL_ASSERT(m_entities.IsEmpty(), "Systems must be registered before entities are added to the "
-		"EntityManager because there is not currently support for initializing the system's component groups.");
-
-	RegisteredConcurrentSystemGroup& newGroup = m_concurrentSystemGroups.Emplace();
-	(... , RegisterSystemInGroup<SystemTypes>(std::move(concurrentSystems), newGroup));
+	return RegisterSystemInGraph<SystemType>(std::move(system), scheduling);
 }
 
 template <typename SystemType>
@@ -210,6 +400,9 @@ struct EntityManager::SystemTypeFunctions
 	static void Update(EntityManager::RegisteredSystem& registeredSystem, const Unit::Time::Millisecond delta)
 	{
 		SystemType& system = static_cast<SystemType&>(*registeredSystem.m_system);
+
+		// Clean up the groups of entities added or removed since the system last updated before viewing them.
+		registeredSystem.m_ecsGroups.Compact();
 		const auto ecsGroupsView =
 			registeredSystem.m_ecsGroups.GetView<SystemType::ECSGroupType>();
 
@@ -240,13 +433,19 @@ struct EntityManager::SystemTypeFunctions
 };
 
 template <typename SystemType>
-inline SystemType& EntityManager::RegisterSystemInGroup(Mem::UniquePtr<SystemType>&& system,
-	RegisteredConcurrentSystemGroup& outGroup)
+inline SystemType& EntityManager::RegisterSystemInGraph(Mem::UniquePtr<SystemType>&& system,
+	const SystemScheduling scheduling)
 {
-	RegisteredSystem& registeredSystem = outGroup.m_systems.Emplace(std::move(system),
+	RegisteredSystem& registeredSystem = m_systems.Emplace(std::move(system),
 		&SystemTypeFunctions<SystemType>::Update,
 		&SystemTypeFunctions<SystemType>::NotifyEntityAdded,
-		&SystemTypeFunctions<SystemType>::NotifyEntityRemoved);
-	return *static_cast<SystemType*>(registeredSystem.m_system.Get());
+		&SystemTypeFunctions<SystemType>::NotifyEntityRemoved,
+		scheduling,
+		m_frameAllocator);
+	SystemType& result = *static_cast<SystemType*>(registeredSystem.m_system.Get());
+
+	AddLastSystemToGraph();
+	result.NotifyOfRegistration(*this);
+	return result;
 }
 }
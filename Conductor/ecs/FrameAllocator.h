@@ -0,0 +1,46 @@
+#pragma once
+
+#include <collection/LinearArena.h>
+#include <collection/Vector.h>
+
+#include <cstdint>
+
+namespace ECS
+{
+/**
+ * Allocates memory which stays valid until the end of the EntityManager update it was allocated during.
+ * Each thread of the engine's job system allocates from its own arena, so systems updating concurrently can allocate
+ * without locking. Threads which aren't job system workers share an arena, so the only one of them which may allocate
+ * is the thread updating the EntityManager.
+ */
+class FrameAllocator final
+{
+public:
+	FrameAllocator();
+
+	FrameAllocator(const FrameAllocator&) = delete;
+	FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+	void* Alloc(const size_t sizeInBytes, const size_t alignmentInBytes);
+
+	// Allocate uninitialized memory for an array of the given type.
+	template <typename T>
+	T* AllocArray(const size_t numElements);
+
+	// Free everything allocated since the last reset. Must not be called while systems are updating.
+	void Reset();
+
+private:
+	Collection::Vector<Collection::LinearArena> m_threadArenas;
+};
+}
+
+// Inline implementations.
+namespace ECS
+{
+template <typename T>
+inline T* FrameAllocator::AllocArray(const size_t numElements)
+{
+	return static_cast<T*>(Alloc(sizeof(T) * numElements, alignof(T)));
+}
+}
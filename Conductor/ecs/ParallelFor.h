@@ -0,0 +1,100 @@
+#pragma once
+
+#include <ecs/DeferredFunction.h>
+
+#include <collection/ArrayView.h>
+#include <collection/Vector.h>
+#include <thread/JobSystem.h>
+
+#include <algorithm>
+
+namespace ECS
+{
+/**
+ * Splits a system's ECS groups into batches and updates the batches in parallel on the engine's job system.
+ * The given function is called once for each group with the signature:
+ *   void(const ECSGroupType& ecsGroup, DeferredFunctionList& deferredFunctions);
+ * Each batch has its own deferred functions, which are appended to the system's deferred functions in batch order
+ * once every batch is done, so the order of deferred functions is the same as if the groups were updated serially.
+ * Systems may only use this when updating a group doesn't access the components of other groups.
+ */
+template <typename ECSGroupType, typename Fn>
+void ParallelFor(const Collection::ArrayView<ECSGroupType>& ecsGroups,
+	DeferredFunctionList& deferredFunctions,
+	Fn&& fn,
+	const uint32_t minBatchSize = 16);
+}
+
+// Inline implementations.
+namespace ECS
+{
+template <typename ECSGroupType, typename Fn>
+inline void ParallelFor(const Collection::ArrayView<ECSGroupType>& ecsGroups,
+	DeferredFunctionList& deferredFunctions,
+	Fn&& fn,
+	const uint32_t minBatchSize)
+{
+	Thread::JobSystem& jobSystem = Thread::JobSystem::GetEngineJobSystem();
+
+	// Create a few batches per thread so that threads which finish early can steal work from the others.
+	constexpr uint32_t k_batchesPerThread = 4;
+	const uint32_t numGroups = static_cast<uint32_t>(ecsGroups.Size());
+	const uint32_t targetNumBatches = jobSystem.GetNumThreads() * k_batchesPerThread;
+	const uint32_t batchSize = std::max(minBatchSize, (numGroups + targetNumBatches - 1) / targetNumBatches);
+	const uint32_t numBatches = (numGroups + batchSize - 1) / batchSize;
+
+	// Small inputs aren't worth the overhead of the job system.
+	if (numBatches <= 1)
+	{
+		for (const auto& ecsGroup : ecsGroups)
+		{
+			fn(ecsGroup, deferredFunctions);
+		}
+		return;
+	}
+
+	struct BatchContext
+	{
+		const Collection::ArrayView<ECSGroupType>& m_ecsGroups;
+		Fn& m_fn;
+		uint32_t m_batchSize;
+		Collection::Vector<DeferredFunctionList> m_batchDeferredFunctions;
+
+		static void RunBatch(void* rawContext, const uint32_t batchIndex)
+		{
+			BatchContext& context = *static_cast<BatchContext*>(rawContext);
+			auto& batchDeferredFunctions = context.m_batchDeferredFunctions[batchIndex];
+
+			const size_t begin = static_cast<size_t>(batchIndex) * context.m_batchSize;
+			const size_t end = std::min(begin + context.m_batchSize, context.m_ecsGroups.Size());
+			for (size_t i = begin; i < end; ++i)
+			{
+				context.m_fn(context.m_ecsGroups[i], batchDeferredFunctions);
+			}
+		}
+	};
+
+	// Batches share the system's frame allocator, which gives each thread its own arena.
+	BatchContext context{ ecsGroups, fn, batchSize, Collection::Vector<DeferredFunctionList>(numBatches) };
+	for (uint32_t i = 0; i < numBatches; ++i)
+	{
+		if (deferredFunctions.GetFrameAllocator() != nullptr)
+		{
+			context.m_batchDeferredFunctions.Emplace(*deferredFunctions.GetFrameAllocator());
+		}
+		else
+		{
+			context.m_batchDeferredFunctions.Emplace();
+		}
+	}
+
+	Thread::JobCounter counter;
+	jobSystem.Submit(&BatchContext::RunBatch, &context, numBatches, counter);
+	jobSystem.Wait(counter);
+
+	for (auto& batchDeferredFunctions : context.m_batchDeferredFunctions)
+	{
+		deferredFunctions.AddAll(std::move(batchDeferredFunctions));
+	}
+}
+}
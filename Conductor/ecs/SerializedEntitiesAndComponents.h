@@ -11,6 +11,8 @@
 
 namespace ECS
 {
+class ComponentReflector;
+
 struct FullSerializedComponentHeader final
 {
 	static constexpr size_t k_unpaddedSize = 8;
@@ -65,6 +67,19 @@ struct RemovedEntitiesAndComponents final
 	Collection::Vector<uint32_t> m_removedEntityIDs;
 };
 
+/**
+ * The IDs of the entities and components which were added, removed, or changed between two serializations, sorted by
+ * ID. Entities and components which aren't listed are serialized identically in both serializations.
+ */
+struct SerializedChanges final
+{
+	Collection::VectorMap<ComponentType, Collection::Vector<uint64_t>> m_changedComponentIDs;
+	Collection::Vector<uint32_t> m_changedEntityIDs;
+
+	// Add the IDs of another set of changes to this one.
+	void Merge(const SerializedChanges& other);
+};
+
 // Read/write SerializedEntitiesAndComponents from/to byte representations.
 void WriteSerializedEntitiesAndComponentsTo(
 	const SerializedEntitiesAndComponents& serialization,
@@ -76,13 +91,36 @@ bool TryReadSerializedEntitiesAndComponentsFrom(
 	const Collection::ArrayView<const uint8_t> fileBytes,
 	SerializedEntitiesAndComponents& outSerialization);
 
+// Copy the entities with the given IDs and their components out of a serialization. The entity IDs must be sorted.
+// The filtered serialization lists the same component types in the same order, so the entities' serialized component
+// lists remain valid. The memory of outFilteredSerialization is reused.
+void FilterSerializedEntitiesAndComponents(
+	const SerializedEntitiesAndComponents& serialization,
+	const Collection::ArrayView<const uint32_t>& entityIDs,
+	SerializedEntitiesAndComponents& outFilteredSerialization);
+
 void DeltaCompressSerializedEntitiesAndComponentsTo(
 	const SerializedEntitiesAndComponents& lastSeenFrame,
 	const SerializedEntitiesAndComponents& newestFrame,
 	Collection::Vector<uint8_t>& outBytes);
+// Delta compress using the changes between the two frames, which lets runs of unchanged entities and components be
+// transmitted without comparing them.
+void DeltaCompressSerializedEntitiesAndComponentsTo(
+	const SerializedEntitiesAndComponents& lastSeenFrame,
+	const SerializedEntitiesAndComponents& newestFrame,
+	const SerializedChanges& changes,
+	Collection::Vector<uint8_t>& outBytes);
 bool TryDeltaDecompressSerializedEntitiesAndComponentsFrom(
 	const SerializedEntitiesAndComponents& lastSeenFrame,
 	const Collection::ArrayView<const uint8_t> deltaCompressedBytes,
 	SerializedEntitiesAndComponents& outDecompressedSerialization,
 	RemovedEntitiesAndComponents& outRemovedEntitiesAndComponents);
+
+// Build a dictionary of the byte sequences which the byte representations of serializations of the registered
+// component types have in common: section markers, component type names, templates of the entity and component headers,
+// and the default serialization of each component type. The dictionary only depends on which component types are
+// registered, so hosts and clients build identical dictionaries.
+void BuildSerializationDictionary(
+	const ComponentReflector& componentReflector,
+	Collection::Vector<uint8_t>& outDictionary);
 }
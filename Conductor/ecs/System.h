@@ -1,7 +1,10 @@
 #pragma once
 
+#include <ecs/Component.h>
+#include <ecs/DeferredFunction.h>
 #include <ecs/ECSGroup.h>
 #include <ecs/ECSGroupVector.h>
+#include <ecs/Entity.h>
 
 #include <collection/Vector.h>
 #include <unit/Time.h>
@@ -18,13 +21,17 @@ class EntityManager;
  * All systems must define an update function which encapsulates their logic with this signature:
  *   void Update(const Unit::Time::Millisecond delta,
  *      const Collection::ArrayView<ECSGroupType>& ecsGroups,
- *      Collection::Vector<std::function<void(EntityManager&)>>& deferredFunctions);
+ *      DeferredFunctionList& deferredFunctions);
  * 
  * Systems that have SystemBindingType::Extended must define all of the following:
  *   void NotifyOfEntityAdded(const EntityID id, const ECSGroupType& group);
  *   void NotifyOfEntityRemoved(const EntityID id, const ECSGroupType& group);
  *
  * Systems may, but are not required to, override the virtual functions of ECS::System.
+ *
+ * Systems which run where changes are tracked, such as on hosts, must call MarkChanged() with each component they write
+ * to, from their update or their deferred functions. Only marked components are recorded in the EntityManager's change
+ * journal, so unmarked writes aren't replicated.
  */
 class System
 {
@@ -33,18 +40,35 @@ public:
 		Collection::Vector<ECS::ComponentType>&& mutableTypes)
 		: m_immutableTypes(std::move(immutableTypes))
 		, m_mutableTypes(std::move(mutableTypes))
+		, m_changedComponentIDs()
 	{}
 
 	virtual ~System() {}
 
+	// Called once the system is registered with an EntityManager, before any entities are added to it.
+	virtual void NotifyOfRegistration(ECS::EntityManager&) {}
 	virtual void NotifyOfShutdown(ECS::EntityManager&) {}
 
 	const Collection::Vector<ECS::ComponentType>& GetImmutableTypes() const { return m_immutableTypes; }
 	const Collection::Vector<ECS::ComponentType>& GetMutableTypes() const { return m_mutableTypes; }
 
+	// Test if this system and another system can run concurrently. This is the run-time equivalent of
+	// SystemTempl::IsWriteCompatibleWithAll() and must follow the same rules.
+	bool IsWriteCompatibleWith(const System& other) const;
+
+protected:
+	// Record that the system wrote to a component. A system only runs on one thread at a time, so this is safe to call
+	// from a concurrently scheduled system.
+	void MarkChanged(const Component& component) { m_changedComponentIDs.Add(component.m_id); }
+
 private:
+	friend class EntityManager;
+
 	Collection::Vector<ECS::ComponentType> m_immutableTypes;
 	Collection::Vector<ECS::ComponentType> m_mutableTypes;
+
+	// The components marked as changed since the EntityManager last took them.
+	Collection::Vector<ComponentID> m_changedComponentIDs;
 };
 
 /**
@@ -56,6 +80,22 @@ enum class SystemBindingType
 	Extended
 };
 
+/**
+ * Systems are registered with a scheduling type which determines which other systems they can run concurrently with.
+ * Systems are exclusive unless they opt in to automatic scheduling, because a system can only run concurrently if
+ * all the state it touches is expressed in its component types.
+ */
+enum class SystemScheduling
+{
+	// The system runs once the previously registered systems that it isn't write compatible with have finished.
+	// It may run on any thread.
+	Automatic,
+	// The system runs by itself on the thread that updates the EntityManager, after all previously registered systems
+	// and before all subsequently registered systems. This is required for systems which share state that isn't
+	// expressed in their component types or which must run on a particular thread.
+	Exclusive,
+};
+
 namespace SystemDetail
 {
 template <typename TypeList, size_t... Indices>
@@ -117,3 +157,41 @@ public:
 	{}
 };
 }
+
+// Inline implementations.
+namespace ECS
+{
+inline bool System::IsWriteCompatibleWith(const System& other) const
+{
+	const auto writesToInputsOf = [](const System& writer, const System& reader)
+	{
+		if (reader.m_immutableTypes.IndexOf(Entity::k_type) != Collection::Vector<ComponentType>::sk_InvalidIndex)
+		{
+			return true;
+		}
+		for (const auto& mutableType : writer.m_mutableTypes)
+		{
+			if (reader.m_immutableTypes.IndexOf(mutableType) != Collection::Vector<ComponentType>::sk_InvalidIndex)
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+	const auto writesToOutputsOf = [](const System& writer, const System& other)
+	{
+		for (const auto& mutableType : writer.m_mutableTypes)
+		{
+			if (mutableType == Entity::k_type
+				|| other.m_mutableTypes.IndexOf(mutableType) != Collection::Vector<ComponentType>::sk_InvalidIndex)
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+
+	return !writesToInputsOf(*this, other) && !writesToOutputsOf(*this, other)
+		&& !writesToInputsOf(other, *this) && !writesToOutputsOf(other, *this);
+}
+}
@@ -7,8 +7,15 @@
 #include <collection/LocklessQueue.h>
 #include <collection/VectorMap.h>
 #include <mem/UniquePtr.h>
+#include <network/DatagramConnection.h>
+#include <network/DatagramSocket.h>
+#include <network/MessageFraming.h>
 #include <network/Socket.h>
+#include <network/SocketPoller.h>
+#include <network/TransportOptions.h>
+#include <unit/Time.h>
 
+#include <chrono>
 #include <string>
 #include <thread>
 
@@ -17,6 +24,8 @@ namespace Host
 /**
  * HostNetworkWorld abstracts away the network layer from HostWorld,
  * transmitting and receiving messages across the network to and from its clients.
+ * Clients connect over TCP or over UDP depending on the transport options. Over UDP, ECS updates are sent on sequenced
+ * streams so that a lost update never delays a newer one, and all other messages are sent reliably.
  */
 class HostNetworkWorld
 {
@@ -26,16 +35,38 @@ public:
 	static constexpr size_t k_outboundMessageCapacityPerClient = 128;
 	static constexpr Client::ClientID k_localClientID{ 1 };
 
-	HostNetworkWorld(const char* listenerPort);
+	HostNetworkWorld(const char* listenerPort, const Network::TransportOptions& transportOptions = {});
 
 	bool IsRunning() const;
 	void WaitForShutdown();
 
 	void NotifyOfConsoleInput(std::string&& input);
+	// Wake the network thread to transmit messages which were pushed to clients' outbound queues. Thread safe.
+	void NotifyOfOutboundMessages();
 
 	Collection::LocklessQueue<Client::MessageToHost>& GetClientToHostMessageQueue() { return m_clientToHostMessageQueue; }
 
 private:
+	// The number of messages popped from a client's outbound queue at once.
+	static constexpr size_t k_messageBatchSize = 16;
+
+	// The socket poller identifies client sockets by their client IDs and the listener socket by a key outside the
+	// range of client IDs. The datagram socket uses the listener's key because only one of them is used.
+	static constexpr uint64_t k_listenerPollKey = static_cast<uint64_t>(UINT16_MAX) + 1;
+	// The network thread sleeps until a socket has data to receive or it is woken to transmit messages. This bounds
+	// how long it sleeps in case a wake is missed.
+	static constexpr Unit::Time::Millisecond k_maxPollWaitTime{ 100 };
+	// Datagram connections need to be flushed regularly to resend messages and to send simulated delayed datagrams.
+	static constexpr Unit::Time::Millisecond k_maxDatagramPollWaitTime{ 5 };
+	// The most sockets the network thread learns are ready each time it wakes.
+	static constexpr size_t k_maxNumReadySockets = 64;
+	// Clients only send small messages, so their frames are limited to much less than MessageFraming::k_maxFrameSize.
+	// Datagram connections limit the memory used to reassemble clients' messages to the same size.
+	static constexpr size_t k_maxFrameSizeFromClient = 64 * 1024;
+	// Client sockets don't block, so the bytes a client's socket can't accept yet wait to be sent to it. A client which
+	// falls this far behind is disconnected rather than letting its waiting bytes grow without bound.
+	static constexpr size_t k_maxPendingTransmissionBytes = 16 * 1024 * 1024;
+
 	// Network connect clients are stored in unique pointers so that their address does not change
 	// even as the container holding them changes its ordering. This is necessary because Host::ConnectedClient
 	// holds a reference to a NetworkConnectedClient's message queue.
@@ -43,22 +74,58 @@ private:
 	{
 		Collection::LocklessQueue<Host::MessageToClient> m_hostToClientMessageQueue{ k_outboundMessageCapacityPerClient };
 		Network::Socket m_clientSocket{};
+		Network::FrameReassembler m_frameReassembler{ k_maxFrameSizeFromClient };
 		uint64_t m_nextSequenceNumber{ 0 };
+
+		// Only used by the datagram transport.
+		Network::DatagramAddress m_datagramAddress{};
+		Mem::UniquePtr<Network::DatagramConnection> m_datagramConnection{};
+
+		// Buffers reused to transmit each batch of messages. The message headers are serialized to
+		// m_transmissionHeaderBytes and the buffers sent are views into it and into the messages' payloads.
+		Collection::Vector<uint8_t> m_transmissionHeaderBytes{};
+		Collection::Vector<Collection::ArrayView<const uint8_t>> m_transmissionBuffers{};
+		// The transmitted bytes which the client's socket couldn't accept yet. They are sent ahead of any new messages
+		// once the socket is ready to send again. Only used by the stream transport.
+		Collection::Vector<uint8_t> m_pendingTransmissionBytes{};
+		bool m_isWaitingForSend{ false };
 	};
 
 	void NetworkThreadFunction();
 
+	Unit::Time::Millisecond GetNetworkTime() const;
+	bool IsClientConnected(
+		const NetworkConnectedClient& networkConnectedClient, const Unit::Time::Millisecond now) const;
+	NetworkConnectedClient& AddNetworkConnectedClient(Client::ClientID& outClientID);
+
+	void AcceptStreamClients();
+	void ReceiveFromStreamClient(const Client::ClientID clientID, NetworkConnectedClient& networkConnectedClient);
+	void ReceiveDatagrams(const Unit::Time::Millisecond now);
+	void TryAcceptDatagramClient(const Unit::Time::Millisecond now, const Network::DatagramAddress& address,
+		const Collection::ArrayView<const uint8_t>& datagram);
+	void ReceiveFromDatagramClient(const Client::ClientID clientID, NetworkConnectedClient& networkConnectedClient);
+
 	bool TryReceiveMessageFromClient(
 		const Collection::ArrayView<const uint8_t>& bytes,
 		const Client::ClientID expectedClientID,
 		NetworkConnectedClient& networkConnectedClient,
 		Client::MessageToHost& outMessage) const;
-	void TransmitMessageToClient(
-		const Host::MessageToClient& message,
+	void TransmitMessagesToClient(
+		const Collection::ArrayView<const Host::MessageToClient>& messages,
+		NetworkConnectedClient& networkConnectedClient);
+	void FlushPendingTransmission(NetworkConnectedClient& networkConnectedClient);
+	void TransmitMessagesToDatagramClient(
+		const Unit::Time::Millisecond now,
+		const Collection::ArrayView<const Host::MessageToClient>& messages,
 		NetworkConnectedClient& networkConnectedClient);
 
 private:
-	Network::Socket m_listenerSocket;
+	Network::TransportOptions m_transportOptions;
+	std::chrono::steady_clock::time_point m_startTime;
+
+	Network::SocketPoller m_socketPoller{};
+	Network::Socket m_listenerSocket{};
+	Network::DatagramSocket m_datagramSocket{};
 
 	Collection::LocklessQueue<std::string> m_consoleMessageQueue{ k_consoleMessageCapacity };
 	Collection::LocklessQueue<Client::MessageToHost> m_clientToHostMessageQueue{ k_inboundMessageCapacity };
@@ -3,10 +3,14 @@
 #include <client/ClientID.h>
 #include <collection/Vector.h>
 #include <host/MessageToClient.h>
+#include <host/TickOptions.h>
 #include <mem/UniquePtr.h>
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
 #include <thread>
 
 namespace Client { struct MessageToHost; }
@@ -20,15 +24,37 @@ class IHost;
 
 /**
  * HostWorld runs a headless game simulation which clients can connect to and interact with.
+ * The host is updated on a fixed schedule determined by its tick options, and the host thread sleeps between ticks.
  */
 class HostWorld final
 {
 public:
+	/**
+	 * Statistics about how well the host thread keeps to its tick schedule.
+	 */
+	struct TickStatistics
+	{
+		uint64_t m_numTicks{ 0 };
+		// Ticks which ended after the deadline of the tick that follows them.
+		uint64_t m_numOverrunTicks{ 0 };
+		// Ticks which were never run because the host fell further behind than it is allowed to catch up.
+		uint64_t m_numSkippedTicks{ 0 };
+		std::chrono::microseconds m_totalOverrunTime{ 0 };
+		std::chrono::microseconds m_maxOverrunTime{ 0 };
+		std::chrono::microseconds m_totalTickTime{ 0 };
+		std::chrono::microseconds m_maxTickTime{ 0 };
+	};
+
 	using HostFactory = std::function<Mem::UniquePtr<IHost>(const Conductor::IGameData&)>;
+	// Called on the host thread after each update's messages to clients are queued, which lets a network thread sleep
+	// until it has messages to transmit.
+	using OutboundMessagesCallback = std::function<void()>;
 
 	HostWorld(const Conductor::IGameData& gameData,
 		Collection::LocklessQueue<Client::MessageToHost>& networkInputQueue,
-		HostFactory&& hostFactory);
+		HostFactory&& hostFactory,
+		const TickOptions& tickOptions = {},
+		OutboundMessagesCallback&& outboundMessagesCallback = nullptr);
 
 	HostWorld() = delete;
 	HostWorld(const HostWorld&) = delete;
@@ -39,13 +65,26 @@ public:
 
 	~HostWorld();
 
-	uint32_t GetNumConnectedClients() const { return m_connectedClients.Size(); }
+	uint32_t GetNumConnectedClients() const;
+	TickStatistics GetTickStatistics() const;
 
 	void RequestShutdown();
 
 	void NotifyOfClientConnected(Mem::UniquePtr<ConnectedClient>&& connectedClient);
 
 private:
+	// The number of messages popped from the network input queue at once.
+	static constexpr size_t k_messageBatchSize = 16;
+	// Sleeps overshoot their deadline by up to the OS scheduler's granularity, so the host thread sleeps until shortly
+	// before each tick's deadline and yields for the remainder. The margin grows to the largest overshoot observed, up
+	// to the maximum, and then slowly shrinks back towards the minimum. The host thread raises the timer resolution on
+	// platforms where it is coarse so that overshoots stay within the maximum.
+	static constexpr std::chrono::microseconds k_minSleepMargin{ 500 };
+	static constexpr std::chrono::microseconds k_maxSleepMargin{ 2000 };
+	static constexpr uint32_t k_timerResolutionMilliseconds = 1;
+	// How often tick statistics are logged when the host has overrun ticks.
+	static constexpr std::chrono::seconds k_tickStatisticsLogInterval{ 30 };
+
 	enum class HostThreadStatus
 	{
 		Stopped,
@@ -54,6 +93,11 @@ private:
 	};
 
 	void HostThreadFunction();
+	void Tick();
+	void RecordTick(const std::chrono::steady_clock::time_point tickStartPoint,
+		const std::chrono::steady_clock::time_point tickEndPoint,
+		const std::chrono::steady_clock::time_point nextTickPoint);
+	void SleepUntil(const std::chrono::steady_clock::time_point wakePoint);
 	void ProcessMessageFromClient(Client::MessageToHost& message);
 
 	void NotifyOfClientDisconnected(const Client::ClientID clientID);
@@ -64,12 +108,23 @@ private:
 	const Conductor::IGameData& m_gameData;
 	Collection::LocklessQueue<Client::MessageToHost>& m_networkInputQueue;
 	HostFactory m_hostFactory;
+	OutboundMessagesCallback m_outboundMessagesCallback;
+	TickOptions m_tickOptions;
 	Mem::UniquePtr<IHost> m_host{};
-	std::atomic_flag m_hostLock{};
 
-	std::chrono::steady_clock::time_point m_lastUpdatePoint;
+	// The host mutex must be held while the host or the connected clients are accessed. The host condition is notified
+	// when the host is created and when shutdown is requested.
+	mutable std::mutex m_hostMutex{};
+	std::condition_variable m_hostCondition{};
+
 	std::thread m_hostThread{};
-	HostThreadStatus m_hostThreadStatus{ HostThreadStatus::Stopped };
+	std::atomic<HostThreadStatus> m_hostThreadStatus{ HostThreadStatus::Stopped };
+
+	// Tick statistics are written by the host thread while holding the host mutex.
+	TickStatistics m_tickStatistics{};
+	TickStatistics m_lastLoggedTickStatistics{};
+	std::chrono::steady_clock::time_point m_lastTickStatisticsLogPoint{};
+	std::chrono::microseconds m_sleepMargin{ k_minSleepMargin };
 
 	Collection::Vector<Mem::UniquePtr<ConnectedClient>> m_connectedClients{};
 };
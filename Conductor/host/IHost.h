@@ -1,9 +1,10 @@
 #pragma once
 
+#include <client/ClientID.h>
+#include <collection/VectorMap.h>
 #include <ecs/EntityManager.h>
 #include <network/ECSTransmitter.h>
-
-namespace Client { struct ClientID; }
+#include <scene/TrackedChunkSpatialIndex.h>
 
 namespace Input
 {
@@ -31,9 +32,44 @@ public:
 	void NotifyOfClientDisconnected(const Client::ClientID clientID);
 	void NotifyOfFrameAcknowledgement(const Client::ClientID clientID, const uint64_t frameIndex);
 
+	// Limit the entities transmitted to a client to those in the chunks within the given radius of the chunk the focus
+	// entity is in, such as the client's avatar. Clients without a focus entity are transmitted every networked entity.
+	void SetClientFocusEntity(
+		const Client::ClientID clientID, const ECS::EntityID focusEntityID, const int16_t radiusInChunks);
+	void ClearClientFocusEntity(const Client::ClientID clientID);
+
+	// Store the ECS state of this frame and prepare the ECS update transmissions of all connected clients.
 	void StoreECSFrame();
-	void SerializeECSUpdateTransmission(const Client::ClientID clientID, Collection::Vector<uint8_t>& outTransmission);
+	// Returns the ECS update transmission prepared for the given client by the last call to StoreECSFrame().
+	const Collection::Vector<uint8_t>& GetECSUpdateTransmission(const Client::ClientID clientID) const;
 
 	virtual void Update(const Unit::Time::Millisecond delta) = 0;
+
+protected:
+	// Called after a client connects and before a client disconnects, so that the game can create and delete the
+	// entities which represent the client, such as its avatar. Hosts which don't represent clients with entities don't
+	// need to implement these.
+	virtual void HandleClientConnected(const Client::ClientID clientID) {}
+	virtual void HandleClientDisconnected(const Client::ClientID clientID) {}
+
+private:
+	struct ClientFocus
+	{
+		ECS::EntityID m_entityID;
+		int16_t m_radiusInChunks;
+	};
+
+	// Write the IDs of the networked entities relevant to an interest area to outEntityIDs, sorted by ID. Entity
+	// hierarchies are relevant where their root entity is, and hierarchies without a position are relevant everywhere.
+	void FindRelevantEntityIDs(
+		const Network::InterestArea& interestArea, Collection::Vector<uint32_t>& outEntityIDs) const;
+
+	Collection::VectorMap<Client::ClientID, ClientFocus> m_clientFoci;
+
+	// Buckets the networked root entities by the chunk they are in. It persists from frame to frame and only moves
+	// the entities which changed, rather than being rebuilt for each frame.
+	Scene::TrackedChunkSpatialIndex m_networkedRootEntities;
+	// Memory reused to find the relevant entities of interest areas.
+	mutable Collection::Vector<ECS::EntityID> m_relevantRootEntityIDs;
 };
 }
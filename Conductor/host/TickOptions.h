@@ -0,0 +1,67 @@
+#pragma once
+
+#include <collection/ProgramParameters.h>
+#include <unit/Time.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+namespace Host
+{
+/**
+ * How often a HostWorld updates its host. The host is updated at a fixed rate with a fixed delta so that simulation
+ * step sizes don't depend on how fast the host thread runs.
+ */
+struct TickOptions
+{
+	static constexpr uint32_t k_defaultTickRate = 30;
+	static constexpr uint32_t k_maxTickRate = 1000;
+
+	// The number of ticks per second.
+	uint32_t m_tickRate{ k_defaultTickRate };
+	// The most ticks run back to back when the host falls behind schedule. If the host falls further behind than this,
+	// the missed ticks are skipped instead of being caught up on.
+	uint32_t m_maxCatchUpTicks{ 4 };
+
+	// The simulation delta of each tick. Deltas are whole milliseconds, so the tick rate is rounded up to a rate which
+	// divides a second into whole milliseconds (e.g. 60 Hz ticks every 16 ms).
+	Unit::Time::Millisecond CalcTickDelta() const;
+};
+
+constexpr const char* k_tickRateParameter = "-tickRate";
+constexpr const char* k_maxCatchUpTicksParameter = "-maxCatchUpTicks";
+
+// Read tick options from the program parameters:
+// -tickRate <ticks per second> sets the tick rate.
+// -maxCatchUpTicks <ticks> sets how many ticks may be run back to back to catch up.
+TickOptions ParseTickOptions(const Collection::ProgramParameters& params);
+}
+
+// Inline implementations.
+namespace Host
+{
+inline Unit::Time::Millisecond TickOptions::CalcTickDelta() const
+{
+	const uint32_t tickRate = (m_tickRate == 0) ? 1 : (m_tickRate < k_maxTickRate) ? m_tickRate : k_maxTickRate;
+	return Unit::Time::Millisecond(1000 / tickRate);
+}
+
+inline TickOptions ParseTickOptions(const Collection::ProgramParameters& params)
+{
+	TickOptions options;
+
+	std::string value;
+	if (params.TryGet(k_tickRateParameter, value))
+	{
+		const unsigned long tickRate = strtoul(value.c_str(), nullptr, 10);
+		options.m_tickRate = static_cast<uint32_t>((tickRate < TickOptions::k_maxTickRate)
+			? tickRate : TickOptions::k_maxTickRate);
+	}
+	if (params.TryGet(k_maxCatchUpTicksParameter, value))
+	{
+		options.m_maxCatchUpTicks = static_cast<uint32_t>(strtoul(value.c_str(), nullptr, 10));
+	}
+	return options;
+}
+}
@@ -33,5 +33,8 @@ public:
 	Client::ClientID m_clientID;
 	// Each InputComponent receives input from the keys of this map.
 	Collection::VectorMap<Util::StringHash, InputStateBuffer> m_inputMap;
+	// The sequence number of the client's last input state transmission applied to the input map. This lets the client
+	// know which of its input states the host has seen when it predicts the entity.
+	uint32_t m_lastAppliedInputSequenceNumber{ 0 };
 };
 }
@@ -25,15 +25,26 @@ public:
 	const InputStateBuffer* FindInput(const InputSource inputSource) const;
 	const InputStateBuffer* FindNamedInput(const Util::StringHash nameHash) const;
 
+	// Reset the input states read through FindInput and FindNamedInput, keeping only the latest state of each input.
+	// This is done once per update so that local consumers see each state change in the update it occurred in.
 	void ResetInputStates();
-	
-	Collection::Vector<uint8_t> SerializeFullTransmission() const;
+
+	// The input states which are transmitted accumulate separately from the input states read locally, so that each
+	// transmission contains every state change since the previous transmission regardless of how many updates passed.
+	// Transmissions are numbered by the client so that it can tell which of its input states the host has applied.
+	Collection::Vector<uint8_t> SerializeFullTransmission(const uint32_t sequenceNumber) const;
+	void ResetTransmissionInputStates();
 	void ApplyFullTransmission(const Collection::Vector<uint8_t>& transmissionBytes);
 
+	// The sequence number of the last transmission applied to this InputStateManager.
+	uint32_t GetLastAppliedSequenceNumber() const { return m_lastAppliedSequenceNumber; }
+
 private:
 	void NotifyOfInputMessage(const InputMessage& message);
 
 	Collection::VectorMap<Util::StringHash, InputStateBuffer> m_namedInputStateBuffers;
+	Collection::VectorMap<Util::StringHash, InputStateBuffer> m_transmissionInputStateBuffers;
 	Collection::VectorMap<InputSource, Util::StringHash> m_namedInputMapping;
+	uint32_t m_lastAppliedSequenceNumber{ 0 };
 };
 }
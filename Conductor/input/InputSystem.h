@@ -23,7 +23,7 @@ public:
 
 	void Update(const Unit::Time::Millisecond delta,
 		const Collection::ArrayView<ECSGroupType>& ecsGroups,
-		Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions);
+		ECS::DeferredFunctionList& deferredFunctions);
 
 private:
 	Collection::VectorMap<Client::ClientID, const Input::InputStateManager*> m_inputStateManagersPerClient;
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <network/DatagramSocket.h>
+
+#include <collection/ArrayView.h>
+#include <collection/Vector.h>
+#include <unit/Time.h>
+
+#include <cstdint>
+
+namespace Network
+{
+/**
+ * Network conditions to simulate on the datagrams a DatagramConnection sends, so that a connection over loopback
+ * behaves like one over a real network.
+ */
+struct SimulatedLinkConditions
+{
+	// The percentage of datagrams to drop, from 0 to 100.
+	uint32_t m_packetLossPercent{ 0 };
+	// How long to hold datagrams before sending them.
+	Unit::Time::Millisecond m_latency{ 0 };
+
+	bool IsEnabled() const { return m_packetLossPercent > 0 || m_latency.GetN() > 0; }
+};
+
+/**
+ * A DatagramConnection implements message channels on top of the datagrams exchanged with one peer. It doesn't own a
+ * socket: received datagrams are given to it, and the datagrams it wants to send are flushed through a callback.
+ *
+ * Two kinds of channel are supported:
+ * - The reliable channel delivers every message exactly once and in order. It is meant for rare, small messages such
+ *   as connection and disconnection, so each reliable message must fit in a single datagram. Unacknowledged messages
+ *   are resent periodically and the receiver only accepts the next message it expects.
+ * - Sequenced streams deliver only messages which are newer than the last message delivered on the same stream, and
+ *   may drop messages. Messages larger than a datagram are split into fragments and reassembled. This suits messages
+ *   which supersede older ones, such as ECS frames and input states, because a lost message never delays newer ones.
+ *
+ * Every datagram acknowledges the reliable messages received so far.
+ *
+ * The memory used to reassemble sequenced messages is limited so that a peer can't make a connection allocate an
+ * arbitrary amount of it. Reassembly buffers grow as fragments arrive, and when they would exceed the limit, the
+ * messages which have gone longest without receiving a fragment are abandoned.
+ */
+class DatagramConnection final
+{
+public:
+	static constexpr size_t k_numSequencedStreams = 4;
+	static constexpr size_t k_maxSequencedMessageSize = 1 << 24;
+	static constexpr size_t k_defaultMaxReassemblyBytes = 2 * k_maxSequencedMessageSize;
+
+	static constexpr Unit::Time::Millisecond k_reliableResendInterval{ 100 };
+	static constexpr Unit::Time::Millisecond k_keepAliveInterval{ 1000 };
+	static constexpr Unit::Time::Millisecond k_timeout{ 10000 };
+
+	// Sequenced messages with more fragments than fit in maxReassemblyBytes are never received.
+	DatagramConnection(const Unit::Time::Millisecond now, const SimulatedLinkConditions& simulatedLinkConditions,
+		const size_t maxReassemblyBytes = k_defaultMaxReassemblyBytes);
+
+	// Find the message in a datagram which carries the first reliable message a peer sends, without any connection
+	// state. This lets a connection request from an unknown peer be recognized before a connection is created for it.
+	static bool TryPeekFirstReliableMessage(const Collection::ArrayView<const uint8_t>& datagram,
+		Collection::ArrayView<const uint8_t>& outMessage);
+
+	// Queue a message for sending. The message is the concatenation of messageParts.
+	void SendReliable(const Unit::Time::Millisecond now,
+		const Collection::ArrayView<const Collection::ArrayView<const uint8_t>>& messageParts);
+	void SendSequenced(const Unit::Time::Millisecond now, const uint8_t stream,
+		const Collection::ArrayView<const Collection::ArrayView<const uint8_t>>& messageParts);
+
+	// Process a datagram received from the peer, storing any messages it completes.
+	void ReceiveDatagram(const Unit::Time::Millisecond now, const Collection::ArrayView<const uint8_t>& datagram);
+
+	// Call fn with each received message in the order they were received, and then forget them.
+	template <typename Fn>
+	void PopReceivedMessages(Fn&& fn);
+
+	// Call sendFn with each datagram that should be sent now. This includes resent reliable messages, acknowledgements,
+	// and keep alives, so it should be called regularly even when no messages are sent.
+	template <typename SendFn>
+	void Flush(const Unit::Time::Millisecond now, SendFn&& sendFn);
+
+	// True if nothing has been received from the peer for k_timeout.
+	bool HasTimedOut(const Unit::Time::Millisecond now) const;
+
+private:
+	struct UnackedReliableMessage
+	{
+		uint32_t m_sequenceNumber{ 0 };
+		Unit::Time::Millisecond m_lastSendTime{ 0 };
+		Collection::Vector<uint8_t> m_datagram{};
+	};
+
+	struct Reassembly
+	{
+		uint32_t m_sequenceNumber{ 0 };
+		uint32_t m_numFragments{ 0 };
+		uint32_t m_numReceivedFragments{ 0 };
+		uint32_t m_size{ 0 };
+		// When the reassembly last received a fragment, in fragments received by the connection.
+		uint64_t m_lastReceiveIndex{ 0 };
+		Collection::Vector<uint8_t> m_bytes{};
+		Collection::Vector<uint8_t> m_isFragmentReceived{};
+	};
+
+	struct SequencedStream
+	{
+		uint32_t m_nextSendSequenceNumber{ 0 };
+		bool m_hasDelivered{ false };
+		uint32_t m_lastDeliveredSequenceNumber{ 0 };
+		Collection::Vector<Reassembly> m_reassemblies{};
+	};
+
+	struct DelayedDatagram
+	{
+		Unit::Time::Millisecond m_sendTime{ 0 };
+		Collection::Vector<uint8_t> m_bytes{};
+	};
+
+	void BeginDatagram(const uint8_t packetType);
+	void EndDatagram(const Unit::Time::Millisecond now);
+	void ReceiveSequencedFragment(const uint8_t stream, const uint32_t sequenceNumber, const uint32_t fragmentIndex,
+		const uint32_t numFragments, const Collection::ArrayView<const uint8_t>& fragment);
+	// Grow the buffer of a stream's reassembly of the given message to hold numBytes, abandoning other reassemblies if
+	// needed to stay within the limit. Returns the grown reassembly, which abandoning others may have moved.
+	Reassembly& GrowReassembly(SequencedStream& stream, const uint32_t sequenceNumber, const size_t numBytes);
+	void RemoveReassembly(SequencedStream& stream, const size_t index);
+	void StoreReceivedMessage(const Collection::ArrayView<const uint8_t>& message);
+	// Queue resends, acknowledgements, keep alives, and delayed datagrams which are due for sending.
+	void PrepareFlush(const Unit::Time::Millisecond now);
+	void ClearFlushedDatagrams();
+	uint32_t NextRandom();
+
+	SimulatedLinkConditions m_simulatedLinkConditions;
+	uint32_t m_randomState;
+
+	Unit::Time::Millisecond m_lastReceiveTime;
+	Unit::Time::Millisecond m_lastSendTime;
+
+	// The reliable channel.
+	uint32_t m_nextReliableSendSequenceNumber{ 0 };
+	uint32_t m_numReliableMessagesReceived{ 0 };
+	bool m_isAckPending{ false };
+	Collection::Vector<UnackedReliableMessage> m_unackedReliableMessages{};
+
+	SequencedStream m_sequencedStreams[k_numSequencedStreams]{};
+	size_t m_maxReassemblyBytes;
+	size_t m_numReassemblyBytes{ 0 };
+	uint64_t m_numFragmentsReceived{ 0 };
+
+	// Datagrams being built or waiting to be flushed, stored contiguously. m_outboundDatagramEnds holds the end index
+	// of each complete datagram in m_outboundDatagramBytes.
+	Collection::Vector<uint8_t> m_outboundDatagramBytes{};
+	Collection::Vector<uint32_t> m_outboundDatagramEnds{};
+	Collection::Vector<DelayedDatagram> m_delayedDatagrams{};
+
+	// Received messages waiting to be popped, stored like outbound datagrams.
+	Collection::Vector<uint8_t> m_receivedMessageBytes{};
+	Collection::Vector<uint32_t> m_receivedMessageEnds{};
+};
+}
+
+// Inline implementations.
+namespace Network
+{
+template <typename Fn>
+inline void DatagramConnection::PopReceivedMessages(Fn&& fn)
+{
+	uint32_t begin = 0;
+	for (const uint32_t end : m_receivedMessageEnds)
+	{
+		fn(Collection::ArrayView<const uint8_t>(m_receivedMessageBytes.begin() + begin, end - begin));
+		begin = end;
+	}
+	m_receivedMessageBytes.Clear();
+	m_receivedMessageEnds.Clear();
+}
+
+template <typename SendFn>
+inline void DatagramConnection::Flush(const Unit::Time::Millisecond now, SendFn&& sendFn)
+{
+	PrepareFlush(now);
+
+	uint32_t begin = 0;
+	for (const uint32_t end : m_outboundDatagramEnds)
+	{
+		sendFn(Collection::ArrayView<const uint8_t>(m_outboundDatagramBytes.begin() + begin, end - begin));
+		begin = end;
+	}
+	ClearFlushedDatagrams();
+}
+}
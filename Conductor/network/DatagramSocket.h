@@ -0,0 +1,63 @@
+#pragma once
+
+#include <collection/ArrayView.h>
+#include <mem/UniquePtr.h>
+
+#include <cstdint>
+
+namespace Network
+{
+/**
+ * An IPv4 address and port which datagrams are sent to and received from. Stored in host byte order.
+ */
+struct DatagramAddress
+{
+	uint32_t m_ipv4Address{ 0 };
+	uint16_t m_port{ 0 };
+
+	bool operator==(const DatagramAddress& rhs) const
+	{
+		return m_ipv4Address == rhs.m_ipv4Address && m_port == rhs.m_port;
+	}
+	bool operator!=(const DatagramAddress& rhs) const { return !(*this == rhs); }
+};
+
+/**
+ * A non-blocking UDP socket. Like Socket, Socket.cpp implements it using winsock and SocketPosix.cpp implements it
+ * using POSIX sockets.
+ */
+class DatagramSocket
+{
+public:
+	struct DatagramSocketImpl;
+
+	// The largest datagram sent. Small enough to avoid IP fragmentation on typical paths.
+	static constexpr size_t k_maxDatagramSize = 1200;
+
+	DatagramSocket();
+	~DatagramSocket();
+
+	DatagramSocket(DatagramSocket&& other) noexcept;
+	DatagramSocket& operator=(DatagramSocket&& rhs) noexcept;
+
+	DatagramSocketImpl& GetImpl() { return *m_impl; }
+
+	// Test if this socket object actually represents a network socket.
+	bool IsValid() const;
+	// Close the socket.
+	void Close();
+
+	// Send the given bytes as one datagram to the given address.
+	void SendTo(const DatagramAddress& address, const Collection::ArrayView<const uint8_t>& bytes);
+	// Receive one pending datagram, writing the address it came from to outAddress. Receives only up to
+	// outBytes.Size(); the rest of a larger datagram is discarded. Returns the number of bytes read. Non-blocking.
+	size_t ReceiveFrom(DatagramAddress& outAddress, Collection::ArrayView<uint8_t>& outBytes);
+
+private:
+	Mem::UniquePtr<DatagramSocketImpl> m_impl;
+};
+
+// Create a datagram socket bound to the given port on all interfaces. A port of "0" binds to any free port.
+DatagramSocket CreateBoundDatagramSocket(const char* port);
+bool TryResolveDatagramAddress(const char* hostName, const char* port, DatagramAddress& outAddress);
+}
@@ -10,10 +10,23 @@ template <typename T> class Vector;
 
 namespace Network::DeltaCompression
 {
+/**
+ * The formats delta compression can produce. TryDecompress() recognizes both from their leading bytes.
+ * The bytewise format limits sections to 255 bytes and the decompressed size to less than 64 KiB.
+ * The wide format finds runs many bytes at a time and encodes sizes as variable length integers, so it has no limit
+ * on the size of sections or of the decompressed bytes.
+ */
+enum class Format : uint8_t
+{
+	Bytewise,
+	Wide
+};
+
 void Compress(
 	const Collection::ArrayView<const uint8_t>& lastSeenBytes,
 	const Collection::ArrayView<const uint8_t>& currentBytes,
-	Collection::Vector<uint8_t>& outCompressedBytes);
+	Collection::Vector<uint8_t>& outCompressedBytes,
+	const Format format = Format::Wide);
 
 // Decompresses into inOutDecompressedBytes without writing past the end of inOutDecompressedBytes.
 // Shrinks inOutDecompressedBytes to the size of the decompressed data.
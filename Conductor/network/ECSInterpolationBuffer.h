@@ -0,0 +1,95 @@
+#pragma once
+
+#include <collection/ProgramParameters.h>
+#include <ecs/ComponentID.h>
+#include <unit/Time.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+namespace ECS
+{
+class EntityManager;
+struct SerializedEntitiesAndComponents;
+}
+
+namespace Network
+{
+class ECSReceiver;
+
+/**
+ * An ECSInterpolationBuffer presents the frames in an ECSReceiver's frame history a fixed delay behind the host, so
+ * that entities move smoothly between frames rather than jumping whenever a frame arrives.
+ * The host stores one frame per tick, so a frame's index determines when the host stored it. The buffer estimates
+ * the offset between the host's frame timeline and the client's clock from the times frames arrive, and chooses the
+ * two frames which surround the current time minus the render delay. If the render delay is longer than the time
+ * frames take to arrive, there is always a newer frame to interpolate towards.
+ */
+class ECSInterpolationBuffer final
+{
+public:
+	static constexpr Unit::Time::Millisecond k_defaultRenderDelay{ 100 };
+
+	struct InterpolationPoint
+	{
+		uint64_t m_fromFrameIndex;
+		uint64_t m_toFrameIndex;
+		// How far to interpolate from the first frame to the second, from 0 to 1.
+		float m_t;
+	};
+
+	// The frame duration must match the host's tick delta.
+	void SetTiming(const Unit::Time::Millisecond frameDuration, const Unit::Time::Millisecond renderDelay);
+
+	// Record that a new frame was received at the given time.
+	void NotifyOfFrameReceived(const uint64_t frameIndex, const Unit::Time::Millisecond now);
+
+	// Choose the frames of the receiver's frame history to present at the given time. Frames missing from the history
+	// are skipped over. When the time is past the newest frame, the newest frame is presented as is.
+	// Returns false if the receiver has no frames.
+	bool TryFindInterpolationPoint(const ECSReceiver& receiver,
+		const Unit::Time::Millisecond now,
+		InterpolationPoint& outPoint) const;
+
+private:
+	// The clock offset follows the earliest arrivals, which were delayed the least by the network, and otherwise rises
+	// at this rate towards recent arrivals so that it tracks drift between the host's clock and the client's clock.
+	static constexpr double k_clockOffsetRiseRate = 1.0 / 128.0;
+
+	Unit::Time::Millisecond m_frameDuration{ 33 };
+	Unit::Time::Millisecond m_renderDelay{ k_defaultRenderDelay };
+
+	bool m_hasClockOffset{ false };
+	// The estimated client time at which the host stored frame 0, in milliseconds.
+	double m_clockOffset{ 0.0 };
+};
+
+// Set the SceneTransformComponents of the entity manager to the interpolation of their transforms in two frames.
+// Components which aren't in both frames are left as they are, as is the excluded component, such as the transform of
+// a predicted entity.
+void InterpolateSceneTransforms(const ECS::SerializedEntitiesAndComponents& fromFrame,
+	const ECS::SerializedEntitiesAndComponents& toFrame,
+	const float t,
+	const ECS::ComponentID& excludedComponentID,
+	ECS::EntityManager& entityManager);
+
+constexpr const char* k_renderDelayParameter = "-renderDelay";
+
+// Read the render delay from the program parameters: -renderDelay <milliseconds>.
+Unit::Time::Millisecond ParseRenderDelay(const Collection::ProgramParameters& params);
+}
+
+// Inline implementations.
+namespace Network
+{
+inline Unit::Time::Millisecond ParseRenderDelay(const Collection::ProgramParameters& params)
+{
+	std::string value;
+	if (params.TryGet(k_renderDelayParameter, value))
+	{
+		return Unit::Time::Millisecond(strtoull(value.c_str(), nullptr, 10));
+	}
+	return ECSInterpolationBuffer::k_defaultRenderDelay;
+}
+}
@@ -16,6 +16,14 @@ public:
 	uint64_t GetLastSeenFrameIndex() const { return m_frameIndex; }
 	float GetLastSeenCompressionRatio() const;
 
+	// The index of the oldest frame the history has room for, or k_invalidFrameIndex if no frame has been received.
+	uint64_t GetOldestStoredFrameIndex() const;
+	// Returns the received frame with the given index if it is in the frame history. Returns nullptr otherwise.
+	const ECS::SerializedEntitiesAndComponents* FindFrame(const uint64_t frameIndex) const;
+
+	// Decompress packet compressed transmissions using the given dictionary, which must match the transmitter's.
+	void SetPacketCompressionDictionary(Collection::Vector<uint8_t>&& dictionary);
+
 	// Receives a frame transmission. Returns a pointer to the frame if the frame is newer than any known frame.
 	// Returns nullptr otherwise.
 	const ECS::SerializedEntitiesAndComponents* TryReceiveFrameTransmission(
@@ -33,13 +41,19 @@ private:
 
 	// These return the frame index of the frame received, or k_invalidFrameIndex if the frame wasn't received.
 	uint64_t TryReceiveFullFrameTransmission(const uint8_t* const frameBegin, const uint8_t* const frameEnd);
-	uint64_t TryReceiveDeltaFrameTransmission(const uint8_t* const frameBegin, const uint8_t* const frameEnd);
+	// The compression ratio of a delta frame is based on the number of bytes it was transmitted with, which differs
+	// from the size of the frame bytes if the frame was packet compressed.
+	uint64_t TryReceiveDeltaFrameTransmission(
+		const uint8_t* const frameBegin, const uint8_t* const frameEnd, const size_t numTransmittedFrameBytes);
 
 	void StoreFrame(
 		const uint64_t newFrameIndex, const float compressionRatio, ECS::SerializedEntitiesAndComponents&& newFrame);
 
 private:
 	uint64_t m_frameIndex{ k_invalidFrameIndex };
+	Collection::Vector<uint8_t> m_packetCompressionDictionary;
+	// Scratch memory the bytes of packet compressed frames are decompressed into.
+	Collection::Vector<uint8_t> m_decompressedFrameBytes;
 	Collection::RingBuffer<HistoryEntry, k_historySize> m_frameHistory;
 };
 }
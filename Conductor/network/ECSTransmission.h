@@ -10,5 +10,11 @@ namespace Network
 static constexpr uint32_t k_fullFrameMarker = 0xF011FA3; // F0LLFAE
 static constexpr uint32_t k_deltaFrameMarker = 0xDE17AFA3; // DELTAFAE
 
+// A byte of flags follows the frame marker.
+static constexpr uint8_t k_noFrameFlags = 0;
+// The bytes after the flags are compressed with Network::PacketCompression.
+static constexpr uint8_t k_packetCompressedFrameFlag = 1 << 0;
+static constexpr uint8_t k_allFrameFlags = k_packetCompressedFrameFlag;
+
 static constexpr uint64_t k_invalidFrameIndex = UINT64_MAX;
 }
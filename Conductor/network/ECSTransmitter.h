@@ -1,35 +1,136 @@
 #pragma once
 
 #include <client/ClientID.h>
+#include <collection/Pair.h>
 #include <collection/RingBuffer.h>
 #include <collection/Vector.h>
 #include <collection/VectorMap.h>
 #include <ecs/SerializedEntitiesAndComponents.h>
+#include <network/ECSTransmission.h>
+#include <network/InterestManagement.h>
+
+#include <functional>
 
 namespace Network
 {
 /**
  * Transmits the state of entities and components based on what state connected clients are aware of.
+ * Each frame is stored with the changes since the frame before it, so a delta transmission only needs to compare the
+ * entities and components which changed since the frame the client last saw.
+ * Transmissions can additionally be packet compressed, which is only done when it makes them smaller.
+ * Transmissions are prepared for all clients at once. Clients which last saw the same frame share a transmission, so
+ * each delta is compressed once per frame no matter how many clients need it.
+ * Clients with an interest area are only transmitted the entities relevant to it. The interest area a client had when
+ * each stored frame was transmitted is remembered so that its baseline can be filtered the same way it was then.
+ * Clients share transmissions only if their interest areas match now and when they last saw a frame.
  */
 class ECSTransmitter final
 {
 public:
+	// Writes the IDs of the entities of the newest frame which are relevant to an interest area, sorted by ID.
+	using RelevantEntityFinder =
+		std::function<void(const InterestArea& interestArea, Collection::Vector<uint32_t>& outEntityIDs)>;
+
 	void NotifyOfClientConnected(const Client::ClientID clientID);
 	void NotifyOfClientDisconnected(const Client::ClientID clientID);
+	// Limit the entities transmitted to the client to those relevant to the given interest area, beginning with the
+	// next prepared transmission. An invalid interest area makes every entity relevant to the client.
+	void SetClientInterestArea(const Client::ClientID clientID, const InterestArea& interestArea);
 
-	void AddSerializedFrame(ECS::SerializedEntitiesAndComponents&& newFrame);
+	// Packet compress transmissions using the given dictionary. Receivers must use the same dictionary.
+	void EnablePacketCompression(Collection::Vector<uint8_t>&& dictionary);
+
+	// Add a frame along with the changes between it and the previous frame.
+	void AddSerializedFrame(ECS::SerializedEntitiesAndComponents&& newFrame, ECS::SerializedChanges&& changes);
+	// Returns null if no frames have been added.
+	const ECS::SerializedEntitiesAndComponents* FindNewestFrame() const;
 	void NotifyOfFrameAcknowledgement(const Client::ClientID clientID, uint64_t frameIndex);
 
-	void TransmitFrame(const Client::ClientID clientID, Collection::Vector<uint8_t>& outTransmission) const;
+	// Prepare the transmission of the newest frame for every connected client. Must be called after a frame is added.
+	// The entities relevant to each distinct interest area of the clients are found once with the given finder and
+	// kept with the frame, so that transmissions compressed against the frame later can be filtered the same way.
+	void PrepareTransmissions(const RelevantEntityFinder& findRelevantEntityIDs);
+	// Returns the transmission prepared for the given client, which is shared with any other clients that last saw
+	// the same frame. It remains valid until the next call to PrepareTransmissions().
+	const Collection::Vector<uint8_t>& GetPreparedTransmission(const Client::ClientID clientID) const;
+
 	void TransmitFullFrame(Collection::Vector<uint8_t>& outTransmission) const;
 
 private:
 	static constexpr size_t k_historySize = 16;
+	static constexpr uint32_t k_invalidTransmissionIndex = UINT32_MAX;
+
+	struct Frame
+	{
+		ECS::SerializedEntitiesAndComponents m_serialization;
+		ECS::SerializedChanges m_changes;
+		// The IDs of the entities relevant to each interest area the frame was transmitted with, sorted by ID.
+		Collection::Vector<Collection::Pair<InterestArea, Collection::Vector<uint32_t>>> m_relevantEntityIDs;
+	};
+
+	struct ClientState
+	{
+		uint64_t m_lastSeenFrameIndex{ k_invalidFrameIndex };
+		// The index of the client's transmission in m_preparedTransmissions.
+		uint32_t m_preparedTransmissionIndex{ k_invalidTransmissionIndex };
+
+		InterestArea m_interestArea{};
+		// The interest area each stored frame was transmitted to the client with, indexed by frame index modulo the
+		// history size.
+		InterestArea m_interestAreaHistory[k_historySize]{};
+	};
+
+	struct PreparedTransmission
+	{
+		// The frame the transmission is compressed against, or k_invalidFrameIndex for a full transmission.
+		uint64_t m_baselineFrameIndex{ k_invalidFrameIndex };
+		// The interest area the baseline frame was transmitted with and the one the newest frame is transmitted with.
+		InterestArea m_baselineInterestArea{};
+		InterestArea m_interestArea{};
+		Collection::Vector<uint8_t> m_bytes;
+
+		// Memory reused to filter frames to the relevant entities of the interest areas.
+		ECS::SerializedEntitiesAndComponents m_filteredBaselineFrame;
+		ECS::SerializedEntitiesAndComponents m_filteredFrame;
+	};
+
+	// Returns the frame to compress a transmission to a client who last saw the given frame against, or
+	// k_invalidFrameIndex if the client must receive a full transmission.
+	uint64_t FindBaselineFrameIndex(const uint64_t lastSeenFrameIndex) const;
+
+	void PrepareTransmission(PreparedTransmission& transmission) const;
+
+	// Returns the serialization of a frame as it is transmitted to clients with the given interest area, which is
+	// either the frame's serialization or outFilteredFrame. The frame must have been transmitted with the area.
+	const ECS::SerializedEntitiesAndComponents& FilterFrame(
+		const Frame& frame,
+		const InterestArea& interestArea,
+		ECS::SerializedEntitiesAndComponents& outFilteredFrame) const;
+
+	// Frames filtered by interest areas don't have changes to compress with, in which case changes is null.
+	void TransmitDeltaFrame(const uint64_t baselineFrameIndex,
+		const ECS::SerializedEntitiesAndComponents& lastSeenFrame,
+		const ECS::SerializedEntitiesAndComponents& newestFrame,
+		const ECS::SerializedChanges* const changes,
+		Collection::Vector<uint8_t>& outTransmission) const;
+	void TransmitFullFrame(
+		const ECS::SerializedEntitiesAndComponents& frame, Collection::Vector<uint8_t>& outTransmission) const;
+
+	// Packet compress the bytes of a transmission which follow its flags, if doing so makes them smaller.
+	void PacketCompressTransmission(const size_t flagsIndex, Collection::Vector<uint8_t>& inOutTransmission) const;
 
 	uint64_t m_frameIndex{ 0 };
 
-	Collection::VectorMap<Client::ClientID, uint64_t> m_lastSeenFramePerClient;
+	bool m_isPacketCompressionEnabled{ false };
+	Collection::Vector<uint8_t> m_packetCompressionDictionary;
+
+	Collection::VectorMap<Client::ClientID, ClientState> m_clientStates;
+
+	Collection::RingBuffer<Frame, k_historySize> m_frameHistory;
 
-	Collection::RingBuffer<ECS::SerializedEntitiesAndComponents, k_historySize> m_frameHistory;
+	// The transmissions prepared for the newest frame. Only the first m_numPreparedTransmissions are in use; the rest
+	// are kept so that their memory can be reused.
+	Collection::Vector<PreparedTransmission> m_preparedTransmissions;
+	uint32_t m_numPreparedTransmissions{ 0 };
 };
 }
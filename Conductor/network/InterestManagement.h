@@ -0,0 +1,27 @@
+#pragma once
+
+#include <scene/ChunkID.h>
+
+#include <cstdint>
+
+namespace Network
+{
+/**
+ * An interest area limits the entities transmitted to a client to those in the chunks near the client's focus.
+ * The chunks in an interest area are those whose origins are within its radius of the origin of its center chunk, as
+ * measured by Scene::ChunkSpatialIndex. Clients without a valid interest area are interested in every entity.
+ */
+struct InterestArea
+{
+	Scene::ChunkID m_centerChunkID{};
+	int16_t m_radiusInChunks{ 0 };
+
+	bool IsValid() const { return m_centerChunkID != Scene::ChunkID(); }
+
+	bool operator==(const InterestArea& rhs) const
+	{
+		return m_centerChunkID == rhs.m_centerChunkID && m_radiusInChunks == rhs.m_radiusInChunks;
+	}
+	bool operator!=(const InterestArea& rhs) const { return !(*this == rhs); }
+};
+}
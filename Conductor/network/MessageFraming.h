@@ -0,0 +1,67 @@
+#pragma once
+
+#include <collection/ArrayView.h>
+#include <collection/Vector.h>
+
+#include <cstdint>
+
+namespace Network
+{
+/**
+ * Messages sent over a socket are framed so that they can be separated again after the socket's stream coalesces or
+ * splits them. Each frame is a 32 bit little endian frame size followed by that many bytes of message.
+ */
+namespace MessageFraming
+{
+constexpr size_t k_frameHeaderSize = sizeof(uint32_t);
+// The largest frame which can be sent. Receivers which expect smaller frames use a lower limit.
+constexpr size_t k_maxFrameSize = 1 << 26;
+
+// Serialize a frame header with a placeholder size and return its index in outBytes. The frame is everything
+// serialized to outBytes after the header; call FinishFrame() with the index once it's serialized.
+size_t BeginFrame(Collection::Vector<uint8_t>& outBytes);
+// Write the size of the frame to the header at the given index. numExternalBytes is the number of bytes of the frame
+// which are sent from outside of inOutBytes, following the bytes serialized to inOutBytes.
+void FinishFrame(const size_t headerIndex, Collection::Vector<uint8_t>& inOutBytes, const size_t numExternalBytes = 0);
+}
+
+/**
+ * A FrameReassembler buffers the bytes received from a socket and separates them into complete frames.
+ * Bytes are received directly into the reassembler's buffer and complete frames are returned as views into it, so
+ * messages can be parsed in place. The buffer is reused like a ring: it only moves the bytes of a partially received
+ * frame back to its front when there isn't room to receive more after them, and it only grows to fit a frame larger
+ * than itself.
+ *
+ * Frame sizes come from the peer, so the buffer grows as a large frame's bytes arrive rather than all at once when its
+ * size is received, and frames larger than the reassembler's maximum frame size are rejected.
+ */
+class FrameReassembler final
+{
+public:
+	// The minimum number of bytes GetReceiveBuffer() makes room for.
+	static constexpr size_t k_minReceiveBufferSize = 4096;
+
+	explicit FrameReassembler(const size_t maxFrameSize = MessageFraming::k_maxFrameSize)
+		: m_maxFrameSize(maxFrameSize)
+	{}
+
+	// Get a buffer to receive bytes into. Invalidates the views returned by TryPopFrame().
+	Collection::ArrayView<uint8_t> GetReceiveBuffer();
+	// Add the given number of bytes received into the start of the buffer from GetReceiveBuffer().
+	void NotifyOfBytesReceived(const size_t numBytes);
+
+	// Get the next complete frame, excluding its header, if there is one.
+	bool TryPopFrame(Collection::ArrayView<const uint8_t>& outFrame);
+
+	// True if a frame declared a size larger than the maximum frame size. The stream can't be recovered from this.
+	bool HasInvalidFrame() const { return m_hasInvalidFrame; }
+
+private:
+	size_t m_maxFrameSize;
+	Collection::Vector<uint8_t> m_bytes{};
+	// The received bytes which haven't been popped yet are in the range [m_readIndex, m_writeIndex).
+	size_t m_readIndex{ 0 };
+	size_t m_writeIndex{ 0 };
+	bool m_hasInvalidFrame{ false };
+};
+}
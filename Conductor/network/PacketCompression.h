@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Collection
+{
+template <typename T> class ArrayView;
+template <typename T> class Vector;
+}
+
+namespace Network::PacketCompression
+{
+/**
+ * A dictionary-primed LZ77 compressor for transmissions. The dictionary is treated as if it came immediately before
+ * the compressed bytes, so byte sequences in it can be referenced without ever being transmitted; a good dictionary
+ * contains sequences that are common in transmissions but that a small transmission wouldn't repeat on its own.
+ * The same dictionary must be used to compress and to decompress.
+ */
+void Compress(
+	const Collection::ArrayView<const uint8_t>& dictionary,
+	const Collection::ArrayView<const uint8_t>& bytes,
+	Collection::Vector<uint8_t>& outCompressedBytes);
+
+// Decompresses the bytes between compressedBytesIter and compressedBytesEnd, appending them to outDecompressedBytes.
+bool TryDecompress(
+	const Collection::ArrayView<const uint8_t>& dictionary,
+	const uint8_t*& compressedBytesIter,
+	const uint8_t* const compressedBytesEnd,
+	Collection::Vector<uint8_t>& outDecompressedBytes);
+}
@@ -8,6 +8,9 @@ namespace Network
 bool TryInitializeSocketAPI();
 void ShutdownSocketAPI();
 
+/**
+ * A TCP socket. Socket.cpp implements sockets using winsock and SocketPosix.cpp implements them using POSIX sockets.
+ */
 class Socket
 {
 public:
@@ -32,11 +35,18 @@ public:
 	size_t AcceptPendingConnections(Socket* outSockets, const size_t maxAcceptCount);
 	// Close the socket.
 	void Close();
+	// Make sends and receives on this socket return immediately rather than wait for the socket to be ready.
+	// Returns false if the socket's mode couldn't be changed.
+	bool TrySetNonBlocking();
 
 	// Send the given buffer to this socket's endpoint.
 	void Send(const Collection::ArrayView<const uint8_t>& bytes);
+	// Send the given buffers to this socket's endpoint in order with as few system calls as possible. Returns the
+	// number of bytes sent, which is less than the size of the buffers only if the socket is non-blocking and its send
+	// buffer is full. The caller must send the rest of the bytes once the socket is ready to send again.
+	size_t SendBatch(const Collection::ArrayView<const Collection::ArrayView<const uint8_t>>& buffers);
 	// Receive any data pending on this socket. Receives only up to outBytes.Size().
-	// Returns the number of bytes read. Non-blocking.
+	// Returns the number of bytes read. Non-blocking. Closes the socket if its endpoint closed the connection.
 	size_t Receive(Collection::ArrayView<uint8_t>& outBytes);
 
 private:
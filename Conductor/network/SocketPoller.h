@@ -0,0 +1,54 @@
+#pragma once
+
+#include <mem/UniquePtr.h>
+#include <unit/Time.h>
+
+#include <cstdint>
+
+namespace Network
+{
+class DatagramSocket;
+class Socket;
+
+/**
+ * Waits for any of a set of sockets to have data to receive, so that a network thread can sleep until it has work.
+ * Sockets with bytes left to send can also be waited on until they are ready to send again.
+ * Each socket is identified by a key chosen when it is added.
+ * SocketPosix.cpp implements the poller with epoll, which Wake() interrupts through an eventfd. Socket.cpp implements
+ * it with WSAPoll, which can't be interrupted, so a wait there never blocks for longer than a millisecond.
+ */
+class SocketPoller
+{
+public:
+	struct PollerImpl;
+
+	// Keys may be any value except this one.
+	static constexpr uint64_t k_invalidKey = UINT64_MAX;
+
+	SocketPoller();
+	~SocketPoller();
+
+	SocketPoller(const SocketPoller&) = delete;
+	SocketPoller& operator=(const SocketPoller&) = delete;
+
+	bool TryAdd(Socket& socket, const uint64_t key);
+	bool TryAdd(DatagramSocket& socket, const uint64_t key);
+	// Stop watching the given socket. Sockets are removed automatically when they are closed.
+	void Remove(Socket& socket);
+	void Remove(DatagramSocket& socket);
+
+	// Set whether to also wait for the given socket to be ready to send. This should only be set while the socket has
+	// bytes left to send, because a socket with room in its send buffer is always ready to send.
+	void SetWaitForSend(Socket& socket, const uint64_t key, const bool isWaitingForSend);
+
+	// Block until a socket has data to receive or is ready to send, Wake() is called, or the timeout passes. Writes the
+	// keys of up to maxNumKeys ready sockets to outKeys and returns the number of keys written.
+	size_t Wait(const Unit::Time::Millisecond timeout, uint64_t* outKeys, const size_t maxNumKeys);
+
+	// Make a thread blocked in Wait() return. Thread safe.
+	void Wake();
+
+private:
+	Mem::UniquePtr<PollerImpl> m_impl;
+};
+}
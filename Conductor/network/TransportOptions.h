@@ -0,0 +1,64 @@
+#pragma once
+
+#include <network/DatagramConnection.h>
+
+#include <collection/ProgramParameters.h>
+
+#include <cstdlib>
+#include <string>
+
+namespace Network
+{
+enum class TransportType : uint8_t
+{
+	// Messages are framed and sent over a TCP socket.
+	Stream,
+	// Messages are sent over UDP using a DatagramConnection.
+	Datagram
+};
+
+/**
+ * How a host and its clients exchange messages. The host and its clients must use the same transport type.
+ */
+struct TransportOptions
+{
+	TransportType m_type{ TransportType::Stream };
+	// Only used by the datagram transport.
+	SimulatedLinkConditions m_simulatedLinkConditions{};
+};
+
+constexpr const char* k_datagramTransportParameter = "-udp";
+constexpr const char* k_simulatedPacketLossParameter = "-simulatedPacketLoss";
+constexpr const char* k_simulatedLatencyParameter = "-simulatedLatency";
+
+// Read transport options from the program parameters:
+// -udp selects the datagram transport.
+// -simulatedPacketLoss <percent> and -simulatedLatency <milliseconds> simulate network conditions on it.
+TransportOptions ParseTransportOptions(const Collection::ProgramParameters& params);
+}
+
+// Inline implementations.
+namespace Network
+{
+inline TransportOptions ParseTransportOptions(const Collection::ProgramParameters& params)
+{
+	TransportOptions options;
+
+	std::string value;
+	if (params.TryGet(k_datagramTransportParameter, value))
+	{
+		options.m_type = TransportType::Datagram;
+	}
+	if (params.TryGet(k_simulatedPacketLossParameter, value))
+	{
+		const unsigned long packetLossPercent = strtoul(value.c_str(), nullptr, 10);
+		options.m_simulatedLinkConditions.m_packetLossPercent =
+			static_cast<uint32_t>((packetLossPercent < 100) ? packetLossPercent : 100);
+	}
+	if (params.TryGet(k_simulatedLatencyParameter, value))
+	{
+		options.m_simulatedLinkConditions.m_latency = Unit::Time::Millisecond(strtoull(value.c_str(), nullptr, 10));
+	}
+	return options;
+}
+}
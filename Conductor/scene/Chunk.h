@@ -1,15 +1,12 @@
 #pragma once
 
-#include <file/Path.h>
 #include <math/Vector3.h>
 #include <scene/ChunkID.h>
 
-#include <iosfwd>
-
 namespace Collection
 {
 template <typename T>
-class Vector;
+class ArrayView;
 }
 
 namespace ECS
@@ -21,26 +18,32 @@ struct SerializedEntitiesAndComponents;
 
 namespace Scene
 {
+class ChunkStore;
+class OutOfPlayChunkSimulation;
+
 /**
  * A chunk is a discrete portion of a scene that can be saved and loaded from disk.
  * Because a scene only consists of entities, a chunk only consists of entities. A chunk on disk is a serialized
  * representation of the in-play data of entities; out-of-play data is serialized to a global archive.
  * Entities in a chunk are simluated within an EntityManager; the Chunk class is just used for saving and loading.
+ * Chunks are stored on disk by a ChunkStore. Chunks removed from play stay resident in an OutOfPlayChunkSimulation.
  */
 
  // The dimensions of a Chunk must always be a power of two.
 constexpr float k_chunkSideLengthMeters = 64.0f;
 constexpr uint32_t k_lgChunkSideLength = 6;
 
+// Queue a chunk to be saved to the chunk store. If outOfPlayChunks isn't null, the chunk also stays resident in it.
 void SaveInPlayChunk(const ChunkID chunkID,
 	const ECS::EntityManager& entityManager,
-	const Collection::Vector<const ECS::Entity*>& rootEntitiesInChunk,
-	std::ofstream& fileOutput);
-ECS::SerializedEntitiesAndComponents LoadChunkForPlay(const File::Path& sourcePath,
-	const File::Path& userPath,
-	const std::string& chunkFileName);
+	const Collection::ArrayView<const ECS::Entity* const>& rootEntitiesInChunk,
+	ChunkStore& chunkStore,
+	OutOfPlayChunkSimulation* const outOfPlayChunks);
+ECS::SerializedEntitiesAndComponents LoadChunkForPlay(ChunkStore& chunkStore, const ChunkID chunkID);
 
 Math::Vector3 CalcChunkOrigin(const ChunkID chunkID);
+// Find the ID of the chunk containing the given position.
+ChunkID CalcChunkID(const Math::Vector3& position);
 
 void CalcChunkCoords(const ChunkID chunkID,
 	Math::Vector3& outOrigin, Math::Vector3& outCenter, Math::Vector3& outMax);
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <collection/ArrayView.h>
+#include <file/MappedFile.h>
+#include <file/Path.h>
+#include <scene/ChunkID.h>
+
+#include <cstdint>
+#include <string>
+
+namespace ECS
+{
+struct SerializedEntitiesAndComponents;
+}
+
+namespace Scene
+{
+/**
+ * A chunk region is a cube of chunks which are stored together in one region file, so that streaming in an area of a
+ * scene opens a few region files rather than a file for every chunk.
+ *
+ * A region file begins with a header and an index with an entry for each chunk in the region. Each index entry holds
+ * the offset, size, and CRC-32 checksum of the chunk's serialized entities and components, which follow the index.
+ * Saving a chunk appends it to the end of the file before overwriting its index entry, so a save which is interrupted
+ * leaves the previous version of the chunk in place. The space taken by previous versions is reclaimed by compacting
+ * the file.
+ */
+
+// The dimensions of a chunk region must always be a power of two.
+constexpr uint32_t k_lgChunkRegionSideLength = 3;
+constexpr uint32_t k_chunkRegionSideLength = 1 << k_lgChunkRegionSideLength;
+constexpr uint32_t k_numChunksPerRegion =
+	k_chunkRegionSideLength * k_chunkRegionSideLength * k_chunkRegionSideLength;
+
+// Find the ID of the region containing the given chunk. Region IDs are the coordinates of regions in a grid of regions.
+ChunkID CalcChunkRegionID(const ChunkID chunkID);
+// Find the index of the entry of the given chunk in its region's index.
+uint32_t CalcChunkIndexInRegion(const ChunkID chunkID);
+
+std::string MakeChunkRegionFileName(const ChunkID regionID);
+
+// Calculate the CRC-32 checksum of the given bytes. A checksum can be calculated in pieces by passing the checksum
+// of the preceding bytes.
+uint32_t CalcChunkChecksum(const uint8_t* bytes, const size_t numBytes, const uint32_t checksum = 0);
+
+struct ChunkRegionIndexEntry final
+{
+	static constexpr size_t k_unpaddedSize = 16;
+
+	// The offset of the chunk from the start of the file. Chunks which aren't in the region have an offset of 0.
+	uint64_t m_offset;
+	uint32_t m_size;
+	uint32_t m_checksum;
+};
+
+/**
+ * A ChunkRegionFile memory maps a region file so that chunks can be deserialized directly from the mapping.
+ * A ChunkRegionFile may be read from multiple threads at once.
+ */
+class ChunkRegionFile final
+{
+public:
+	static constexpr uint32_t k_magic = 0x4E474552; // "REGN"
+	static constexpr uint32_t k_version = 1;
+	static constexpr size_t k_headerSize = 8;
+	static constexpr size_t k_indexOffset = k_headerSize;
+	static constexpr size_t k_dataOffset =
+		k_indexOffset + (k_numChunksPerRegion * ChunkRegionIndexEntry::k_unpaddedSize);
+
+	// Map the region file at the given path. Returns false if there isn't a valid region file at the path.
+	bool TryOpen(const File::Path& path);
+
+	// Find the serialized bytes of the given chunk within the mapping. Returns false if the chunk isn't in the region
+	// or if its bytes don't match its checksum.
+	bool TryFindChunkBytes(const ChunkID chunkID, Collection::ArrayView<const uint8_t>& outBytes) const;
+
+private:
+	File::MappedFile m_mappedFile;
+};
+
+struct ChunkToWrite final
+{
+	ChunkID m_chunkID;
+	const ECS::SerializedEntitiesAndComponents* m_serialization;
+};
+
+// Save chunks to the region file at the given path, creating the file if it doesn't exist. The chunks are synchronized
+// to disk before the index is updated to point at them, and the index is synchronized to disk before this returns.
+// Returns false if the file can't be written.
+bool TryWriteChunksToRegionFile(const File::Path& path, const Collection::ArrayView<const ChunkToWrite>& chunks);
+
+// Rewrite the region file at the given path without the previous versions of its chunks if they take up more space
+// than the current versions. The file must not be mapped while it is compacted.
+// Returns false if the file needed compacting and couldn't be rewritten.
+bool TryCompactRegionFile(const File::Path& path);
+}
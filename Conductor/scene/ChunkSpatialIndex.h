@@ -0,0 +1,80 @@
+#pragma once
+
+#include <collection/ArrayView.h>
+#include <collection/FlatIndexMap.h>
+#include <collection/SparseIndexMap.h>
+#include <collection/Vector.h>
+#include <ecs/EntityID.h>
+#include <scene/ChunkID.h>
+
+#include <cstdint>
+
+namespace Scene
+{
+/**
+ * A ChunkSpatialIndex tracks which chunk each of a set of entities is in. Entities are moved between chunks
+ * individually as they move, so the index persists from frame to frame rather than being rebuilt.
+ * Finding the chunk of an entity and the entities of a chunk are constant time; finding the entities in an area
+ * visits only the chunks in the area which contain entities.
+ */
+class ChunkSpatialIndex final
+{
+public:
+	ChunkSpatialIndex() = default;
+
+	// Place an entity in a chunk, moving it out of the chunk it was in if it was in a different chunk.
+	// Returns true if the entity wasn't already in the chunk.
+	bool Place(const ECS::EntityID entityID, const ChunkID chunkID);
+	// Remove an entity from the index if it is in it.
+	void Remove(const ECS::EntityID entityID);
+	void Clear();
+
+	uint32_t GetNumEntities() const { return m_placements.Size(); }
+
+	// Returns ChunkID() if the entity isn't in the index.
+	ChunkID FindChunkOf(const ECS::EntityID entityID) const;
+
+	// The entities in the given chunk, in no particular order. The view is invalidated by changes to the index.
+	Collection::ArrayView<const ECS::EntityID> GetEntitiesInChunk(const ChunkID chunkID) const;
+
+	// Add the entities in the chunks whose origins are within the given radius of the origin of the center chunk to
+	// outEntityIDs. This is the same measure of distance used by SceneAnchorSystem.
+	void FindEntitiesInChunkRadius(const ChunkID centerChunkID,
+		const int16_t radiusInChunks,
+		Collection::Vector<ECS::EntityID>& outEntityIDs) const;
+
+private:
+	struct Bucket
+	{
+		ChunkID m_chunkID;
+		Collection::Vector<ECS::EntityID> m_entityIDs;
+	};
+
+	struct Placement
+	{
+		ECS::EntityID m_entityID;
+		ChunkID m_chunkID;
+		// The index of the entity in its bucket's entity IDs.
+		uint32_t m_indexInBucket;
+	};
+
+	// Add an entity to the bucket of the given chunk, creating the bucket if it doesn't exist. Returns the index of the
+	// entity in the bucket.
+	uint32_t AddToBucket(const ECS::EntityID entityID, const ChunkID chunkID);
+	// Remove the entity with the given placement from its bucket, removing the bucket if it becomes empty.
+	void RemoveFromBucket(const Placement& placement);
+
+	template <typename Predicate>
+	void FindEntitiesInMatchingBuckets(const ChunkID minChunkID,
+		const ChunkID maxChunkID,
+		Predicate&& predicate,
+		Collection::Vector<ECS::EntityID>& outEntityIDs) const;
+
+	// Buckets only exist for chunks with entities in them.
+	Collection::Vector<Bucket> m_buckets;
+	Collection::FlatIndexMap m_bucketIndicesByChunk;
+
+	Collection::Vector<Placement> m_placements;
+	Collection::SparseIndexMap m_placementIndicesByEntity;
+};
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <collection/Vector.h>
+#include <collection/VectorMap.h>
+#include <ecs/SerializedEntitiesAndComponents.h>
+#include <file/Path.h>
+#include <scene/ChunkID.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Scene
+{
+class ChunkRegionFile;
+
+/**
+ * A ChunkStore loads and saves the chunks of a scene in chunk region files. Chunks are loaded from the user path if
+ * they have been saved there and otherwise from the source path; chunks are always saved to the user path.
+ *
+ * Region files are kept memory mapped between loads so that loading the chunks of a region opens it only once.
+ * Chunks can be loaded on multiple threads at once, including while chunks are being saved.
+ *
+ * Saves are queued and written to disk by the store's writer thread so that saving a chunk doesn't block on file I/O.
+ *
+ * Chunks which are stored in individual chunk files from before region files existed are still loaded when they aren't
+ * in a region file. They are moved into region files as they are saved.
+ */
+class ChunkStore final
+{
+public:
+	ChunkStore(const File::Path& sourcePath, const File::Path& userPath);
+	// Blocks until the queued saves are written.
+	~ChunkStore();
+
+	// Deserialize the given chunk directly from its stored bytes. Returns false if the chunk isn't stored or can't be
+	// read, in which case outSerialization is left empty.
+	bool TryLoadChunk(const ChunkID chunkID, ECS::SerializedEntitiesAndComponents& outSerialization);
+
+	// Queue a chunk to be written by the writer thread. If the chunk is queued again before it is written, only its
+	// newest serialization is written. Loads which begin after a chunk is queued load the queued chunk.
+	void QueueChunkSave(const ChunkID chunkID, ECS::SerializedEntitiesAndComponents&& serialization);
+
+	// Wait for the queued saves to be written and then compact the region files that chunks were saved to.
+	// This must not run while chunks are loading.
+	void CompactSavedRegions();
+
+private:
+	// Region files which don't exist are also tracked so that loading their chunks doesn't try to open them each time.
+	struct MappedRegion
+	{
+		ChunkID m_regionID;
+		bool m_isUserRegion;
+		std::shared_ptr<const ChunkRegionFile> m_regionFile;
+		uint64_t m_lastUseIndex;
+	};
+
+	// Limits the number of regions that stay mapped when they aren't in use.
+	static constexpr uint32_t k_maxMappedRegions = 64;
+
+	void WriterThreadFunction();
+	void WriteSavesInProgress(Collection::Vector<ChunkID>& outWrittenRegionIDs);
+
+	bool TryLoadQueuedChunk(const ChunkID chunkID, ECS::SerializedEntitiesAndComponents& outSerialization);
+	bool TryLoadChunkFromRegion(const ChunkID chunkID,
+		const bool isUserRegion,
+		ECS::SerializedEntitiesAndComponents& outSerialization);
+	bool TryLoadChunkFromChunkFile(const File::Path& directory,
+		const ChunkID chunkID,
+		ECS::SerializedEntitiesAndComponents& outSerialization) const;
+
+	std::shared_ptr<const ChunkRegionFile> FindOrMapRegion(const ChunkID regionID, const bool isUserRegion);
+	void UnmapRegion(const ChunkID regionID, const bool isUserRegion);
+
+	// The directory the scene's chunks will be loaded from the first time they are loaded.
+	File::Path m_sourcePath;
+	// The directory the scene's chunks will be stored in.
+	File::Path m_userPath;
+
+	// Guards the saves and the IDs of the regions that were saved to. Must be locked before m_mappedRegionsMutex when
+	// both are locked.
+	std::mutex m_saveMutex;
+	std::condition_variable m_saveCondition;
+	Collection::VectorMap<ChunkID, ECS::SerializedEntitiesAndComponents> m_queuedSaves;
+	// The saves which the writer thread is writing. Only the writer thread modifies them.
+	Collection::VectorMap<ChunkID, ECS::SerializedEntitiesAndComponents> m_savesInProgress;
+	Collection::Vector<ChunkID> m_savedRegionIDs;
+	bool m_isShuttingDown{ false };
+
+	std::mutex m_mappedRegionsMutex;
+	Collection::Vector<MappedRegion> m_mappedRegions;
+	uint64_t m_nextUseIndex{ 0 };
+
+	std::thread m_writerThread{};
+};
+}
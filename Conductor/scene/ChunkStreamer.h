@@ -0,0 +1,93 @@
+#pragma once
+
+#include <collection/Vector.h>
+#include <ecs/SerializedEntitiesAndComponents.h>
+#include <scene/ChunkID.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace Scene
+{
+class ChunkStore;
+
+/**
+ * A ChunkStreamer loads chunks from a ChunkStore on a fixed number of worker threads. Requested chunks are loaded in
+ * order of priority, and the priority of a chunk can be changed or its request cancelled until it begins loading.
+ *
+ * Chunks are requested either for play or as prefetches. Chunks requested for play are always loaded before prefetched
+ * chunks. Prefetch requests must be renewed between each call to CancelStalePrefetches or they are cancelled, so that
+ * chunks which are no longer ahead of anything aren't loaded.
+ *
+ * Loaded chunks are kept until they are taken, so a prefetched chunk is ready as soon as it is requested for play.
+ */
+class ChunkStreamer final
+{
+public:
+	static constexpr uint32_t k_defaultNumWorkers = 2;
+
+	explicit ChunkStreamer(ChunkStore& chunkStore, const uint32_t numWorkers = k_defaultNumWorkers);
+	// Cancels all requests and blocks until the chunks that are loading finish loading.
+	~ChunkStreamer();
+
+	// Request that a chunk be loaded, or change the priority of a chunk that was already requested. Chunks with lower
+	// priority values are loaded first. A prefetch request which is requested for play becomes a request for play.
+	void RequestChunk(const ChunkID chunkID, const float priority, const bool isPrefetch);
+
+	// Cancel the request of the given chunk and discard it if it has been loaded. A chunk which is loading when it is
+	// cancelled is discarded when it finishes loading. Chunks must be cancelled when they are saved, because a chunk
+	// loaded before it was saved is out of date.
+	void CancelChunk(const ChunkID chunkID);
+
+	// Cancel the prefetch requests which haven't been renewed since the last call to this function.
+	void CancelStalePrefetches();
+
+	// Cancel all requests and block until the chunks that are loading finish loading.
+	void CancelAllChunks();
+
+	// Take the serialization of a chunk if it has finished loading. Returns false if it hasn't finished loading.
+	bool TryTakeLoadedChunk(const ChunkID chunkID, ECS::SerializedEntitiesAndComponents& outSerialization);
+
+private:
+	enum class RequestState : uint8_t
+	{
+		Queued,
+		Loading,
+		Loaded
+	};
+
+	struct Request
+	{
+		ChunkID m_chunkID;
+		float m_priority;
+		// Identifies the request so that a worker can tell if the request it is loading was cancelled, even if the
+		// chunk was requested again meanwhile.
+		uint64_t m_requestIndex;
+		RequestState m_state;
+		bool m_isPrefetch;
+		bool m_isRenewed;
+		ECS::SerializedEntitiesAndComponents m_serialization;
+	};
+
+	void WorkerThreadFunction();
+
+	// Find the queued request which should be loaded next. Returns sk_InvalidIndex if no request is queued.
+	size_t FindNextRequestIndex() const;
+	size_t FindRequestIndex(const ChunkID chunkID) const;
+
+	ChunkStore& m_chunkStore;
+
+	// Guards the requests. The requests are searched linearly: there are at most a few hundred requests, and the
+	// priorities of queued requests change every frame, which would require an ordered structure to be rebuilt anyway.
+	std::mutex m_requestMutex;
+	std::condition_variable m_requestCondition;
+	Collection::Vector<Request> m_requests;
+	uint64_t m_nextRequestIndex{ 0 };
+	uint32_t m_numLoadingRequests{ 0 };
+	bool m_isShuttingDown{ false };
+
+	Collection::Vector<std::thread> m_workerThreads;
+};
+}
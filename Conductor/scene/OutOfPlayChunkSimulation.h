@@ -0,0 +1,98 @@
+#pragma once
+
+#include <collection/FlatIndexMap.h>
+#include <collection/Vector.h>
+#include <ecs/SerializedEntitiesAndComponents.h>
+#include <scene/ChunkID.h>
+#include <unit/Time.h>
+
+#include <cstdint>
+#include <functional>
+
+namespace Scene
+{
+class ChunkStore;
+
+/**
+ * An OutOfPlayChunkSimulation keeps chunks which were recently removed from play resident as their serialized entities
+ * and components, and runs a simplified simulation of them at a low rate. Serialized chunks are much smaller than
+ * their entities are in an EntityManager and aren't updated by its systems, so a large area of a scene can be kept
+ * alive around the chunks in play for little cost.
+ *
+ * A resident chunk is brought back into play by taking its serialization, which doesn't need to wait on a load.
+ * When there are too many resident chunks, the chunk which has been resident the longest is evicted. Evicted chunks
+ * which the simplified simulation modified are saved to the ChunkStore. Chunks which are being promoted back into
+ * play aren't evicted.
+ */
+class OutOfPlayChunkSimulation final
+{
+public:
+	// A simplified simulation of a chunk. It is given the time since the chunk was last simulated and returns true if
+	// it modified the chunk's serialization.
+	using SimulationFunction = std::function<bool(const ChunkID chunkID,
+		const Unit::Time::Millisecond elapsedTime,
+		ECS::SerializedEntitiesAndComponents& serialization)>;
+
+	static constexpr uint32_t k_defaultMaxNumChunks = 256;
+	static constexpr Unit::Time::Millisecond k_simulationPeriod{ 1000 };
+	// Limits how many chunks are simulated in one update so that simulating the resident chunks is spread over frames.
+	static constexpr uint32_t k_maxChunksSimulatedPerUpdate = 16;
+
+	explicit OutOfPlayChunkSimulation(ChunkStore& chunkStore, const uint32_t maxNumChunks = k_defaultMaxNumChunks);
+
+	void AddSimulationFunction(SimulationFunction&& function);
+
+	// Keep a chunk which was removed from play and saved resident. If the chunk is already resident, its serialization
+	// is replaced.
+	void AddChunk(const ChunkID chunkID, ECS::SerializedEntitiesAndComponents&& serialization);
+
+	bool HasChunk(const ChunkID chunkID) const;
+	uint32_t GetNumChunks() const { return m_chunks.Size(); }
+
+	// Mark a resident chunk as being promoted back into play so that it isn't evicted before it is taken.
+	// Returns false if the chunk isn't resident.
+	bool TryBeginPromotingChunk(const ChunkID chunkID);
+	// Unmark a chunk which was being promoted, leaving it resident.
+	void CancelPromotingChunk(const ChunkID chunkID);
+
+	// Take the serialization of a resident chunk so that it can be brought into play. Returns false if the chunk isn't
+	// resident.
+	bool TryTakeChunk(const ChunkID chunkID, ECS::SerializedEntitiesAndComponents& outSerialization);
+
+	// Simulate the resident chunks which haven't been simulated for at least k_simulationPeriod.
+	void Update(const Unit::Time::Millisecond delta);
+
+	// Save the resident chunks which were modified by the simplified simulation and then evict all resident chunks.
+	void SaveAndEvictAllChunks();
+
+private:
+	struct ResidentChunk
+	{
+		ChunkID m_chunkID;
+		ECS::SerializedEntitiesAndComponents m_serialization;
+		Unit::Time::Millisecond m_lastSimulatedTime;
+		// Orders the chunks by when they became resident so that the oldest is evicted first.
+		uint64_t m_residentIndex;
+		// Modified chunks are newer than the chunks in the ChunkStore.
+		bool m_isModified;
+		bool m_isPromoting;
+	};
+
+	// Evict the resident chunk at the given index, saving it if it was modified.
+	void EvictChunk(const uint32_t index);
+	void RemoveChunk(const uint32_t index);
+
+	ChunkStore& m_chunkStore;
+	uint32_t m_maxNumChunks;
+
+	Collection::Vector<SimulationFunction> m_simulationFunctions;
+
+	Collection::Vector<ResidentChunk> m_chunks;
+	Collection::FlatIndexMap m_chunkIndicesByChunk;
+	uint64_t m_nextResidentIndex{ 0 };
+
+	Unit::Time::Millisecond m_time{ 0 };
+	// The index of the next chunk to check for simulation. Chunks are checked round-robin across updates.
+	uint32_t m_nextSimulatedIndex{ 0 };
+};
+}
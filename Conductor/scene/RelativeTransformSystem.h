@@ -2,6 +2,7 @@
 
 #include <ecs/System.h>
 
+#include <collection/FlatIndexMap.h>
 #include <scene/SceneTransformComponent.h>
 
 namespace Scene
@@ -9,10 +10,13 @@ namespace Scene
 /**
  * The RelativeTransformSystem updates the scene transforms of entities in parent/child relationships.
  * An entity's transform is relative to their parent's transform.
+ * The system keeps the transform hierarchy in arrays ordered by depth, so parents are always updated before their
+ * children, and only recomputes the transforms of entities whose own transforms or ancestors' transforms changed.
  */
 class RelativeTransformSystem final : public ECS::SystemTempl<
 	Util::TypeList<ECS::Entity>,
-	Util::TypeList<SceneTransformComponent>>
+	Util::TypeList<SceneTransformComponent>,
+	ECS::SystemBindingType::Extended>
 {
 public:
 	RelativeTransformSystem() = default;
@@ -20,16 +24,49 @@ public:
 
 	void Update(const Unit::Time::Millisecond delta,
 		const Collection::ArrayView<ECSGroupType>& ecsGroups,
-		Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions);
+		ECS::DeferredFunctionList& deferredFunctions);
+
+	void NotifyOfEntityAdded(const ECS::EntityID id, const ECSGroupType& group);
+	void NotifyOfEntityRemoved(const ECS::EntityID id, const ECSGroupType& group);
 
 private:
-	void ProcessUpdateBuffer(ECS::EntityManager& entityManager);
-
-	struct UpdateEntry
-	{
-		const ECS::Entity* m_entity;
-		SceneTransformComponent* m_component;
-	};
-	Collection::Vector<UpdateEntry> m_updateBuffer;
+	static constexpr uint32_t k_noParentIndex = UINT32_MAX;
+
+	// Returns false if the groups no longer hold the entities and components the hierarchy was built from, or if any
+	// entity in the hierarchy has changed parents since the hierarchy was built.
+	bool IsHierarchyValid(const Collection::ArrayView<ECSGroupType>& ecsGroups) const;
+	void RebuildHierarchy(const Collection::ArrayView<ECSGroupType>& ecsGroups);
+
+	// Update the transforms of the hierarchy, skipping subtrees whose transforms haven't changed.
+	void PropagateTransforms(const bool forceFullPropagation);
+
+	// The nodes of the transform hierarchy, ordered by depth. The entity and component pointers are only dereferenced
+	// once IsHierarchyValid() has confirmed that the groups still hold them.
+	Collection::Vector<ECS::EntityID> m_nodeEntityIDs;
+	Collection::Vector<const ECS::Entity*> m_nodeEntities;
+	Collection::Vector<SceneTransformComponent*> m_nodeComponents;
+	// The index of the parent of each node, or k_noParentIndex if the node's parent doesn't have a transform.
+	Collection::Vector<uint32_t> m_nodeParentIndices;
+	// The parent entity of each node when the hierarchy was built.
+	Collection::Vector<const ECS::Entity*> m_nodeParentEntities;
+
+	// The matrices of each node as of the last propagation, which are compared against to detect changes.
+	Collection::Vector<Math::Matrix4x4> m_lastChildToParentMatrices;
+	Collection::Vector<Math::Matrix4x4> m_lastModelToWorldMatrices;
+	// Whether the model to world matrix of each node changed during the current propagation.
+	Collection::Vector<uint8_t> m_nodeChangedFlags;
+
+	// The node of each group when the hierarchy was built.
+	Collection::Vector<uint32_t> m_groupNodeIndices;
+
+	// Scratch memory for rebuilding the hierarchy.
+	Collection::FlatIndexMap m_groupIndicesByEntityID;
+	Collection::Vector<uint32_t> m_groupDepths;
+	Collection::Vector<uint32_t> m_groupParentIndices;
+	Collection::Vector<uint32_t> m_numNodesAtDepth;
+	Collection::Vector<uint32_t> m_depthStack;
+
+	// Set when entities are added or removed.
+	bool m_isHierarchyDirty{ true };
 };
 }
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <ecs/ComponentID.h>
 #include <ecs/System.h>
+#include <math/Vector3.h>
 
 #include <scene/AnchorComponent.h>
 #include <scene/ChunkID.h>
@@ -13,6 +15,9 @@ class UnboundedScene;
 /**
  * The SceneAnchorSystem loads chunks into an UnboundedScene near entities with an AnchorComponent,
  * and unloads chunks that get too far away from those entities.
+ *
+ * The velocity of each anchor is estimated from its movement so that chunks in the direction it is moving are loaded
+ * before chunks behind it, and so that chunks it is about to reach are prefetched before they need to be in play.
  */
 class SceneAnchorSystem final : public ECS::SystemTempl<
 	Util::TypeList<SceneTransformComponent, AnchorComponent>,
@@ -24,10 +29,36 @@ public:
 
 	void Update(const Unit::Time::Millisecond delta,
 		const Collection::ArrayView<ECSGroupType>& ecsGroups,
-		Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions);
+		ECS::DeferredFunctionList& deferredFunctions);
 
 private:
+	struct AnchorMotion
+	{
+		ECS::ComponentID m_anchorComponentID;
+		Math::Vector3 m_position;
+		Math::Vector3 m_velocity;
+	};
+
+	struct RequestedChunk
+	{
+		ChunkID m_chunkID;
+		float m_loadPriority;
+	};
+
+	// Add a chunk to the given chunks, or lower its priority if it is already in them and the given priority is lower.
+	// Returns the requested chunk.
+	static RequestedChunk& AddRequestedChunk(Collection::Vector<RequestedChunk>& requestedChunks,
+		const ChunkID chunkID,
+		const float loadPriority);
+
 	UnboundedScene& m_scene;
-	Collection::Vector<ChunkID> m_anchorChunkIDs;
+	// The chunks anchored in play. The extra bits of their IDs mark the chunks which are still anchored during updates.
+	Collection::Vector<RequestedChunk> m_anchorChunks;
+	// The chunks ahead of the anchors which are prefetched. These are found again each update.
+	Collection::Vector<RequestedChunk> m_prefetchChunks;
+
+	// The position and estimated velocity of each anchor as of the last update.
+	Collection::Vector<AnchorMotion> m_anchorMotions;
+	Collection::Vector<AnchorMotion> m_nextAnchorMotions;
 };
 }
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <collection/ArrayView.h>
+#include <collection/HashMap.h>
+#include <collection/Vector.h>
+#include <ecs/ChangeJournal.h>
+#include <ecs/EntityID.h>
+#include <scene/ChunkSpatialIndex.h>
+
+#include <cstdint>
+#include <functional>
+
+namespace ECS
+{
+class Entity;
+class EntityManager;
+}
+
+namespace Scene
+{
+/**
+ * A TrackedChunkSpatialIndex keeps a ChunkSpatialIndex of the root entities of an EntityManager up to date by observing
+ * the EntityManager's changes. Only the entities which were moved, reparented, created, deleted, or had components
+ * added or removed are visited when it is updated, so its cost is proportional to the number of changes rather than to
+ * the number of entities. Moves are found through the changes to SceneTransformComponents, so systems which move root
+ * entities must mark their transforms as changed.
+ * Root entities without a SceneTransformComponent aren't in any chunk, so they are listed as unplaced instead.
+ */
+class TrackedChunkSpatialIndex final
+{
+public:
+	// Only root entities which match the filter are indexed.
+	explicit TrackedChunkSpatialIndex(std::function<bool(const ECS::Entity&)>&& filter);
+	~TrackedChunkSpatialIndex();
+
+	TrackedChunkSpatialIndex(const TrackedChunkSpatialIndex&) = delete;
+	TrackedChunkSpatialIndex& operator=(const TrackedChunkSpatialIndex&) = delete;
+
+	// Begin observing the changes of an EntityManager, which must not have any entities yet. The EntityManager is
+	// observed until the index is destroyed.
+	void ObserveChangesOf(ECS::EntityManager& entityManager);
+
+	// Move the entities which changed since the last update to the chunks they are now in.
+	void Update(const ECS::EntityManager& entityManager);
+
+	const ChunkSpatialIndex& GetSpatialIndex() const { return m_spatialIndex; }
+	Collection::ArrayView<const ECS::EntityID> GetUnplacedEntityIDs() const
+	{
+		return m_unplacedEntityIDs.GetConstView();
+	}
+
+private:
+	// Index an entity as it is now, removing it from the index if it was deleted or no longer belongs in it.
+	void UpdateEntity(const ECS::EntityManager& entityManager, const ECS::EntityID entityID);
+	void RemoveEntity(const ECS::EntityID entityID);
+
+	std::function<bool(const ECS::Entity&)> m_filter;
+
+	ECS::EntityManager* m_observedEntityManager{ nullptr };
+	ECS::ChangeJournal m_changes{};
+
+	ChunkSpatialIndex m_spatialIndex{};
+	Collection::Vector<ECS::EntityID> m_unplacedEntityIDs{};
+
+	// The changes to transforms are recorded by component, so the indexed entities are mapped to and from the unique
+	// IDs of their transforms. Unplaced entities are mapped to an invalid transform ID.
+	Collection::HashMap<uint64_t, ECS::EntityID, Collection::I64HashFunctor> m_entityIDsByTransformID;
+	Collection::HashMap<uint64_t, uint64_t, Collection::I64HashFunctor> m_transformIDsByEntityID;
+};
+}
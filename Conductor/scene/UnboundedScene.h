@@ -1,9 +1,9 @@
 #pragma once
 
-#include <collection/HashMap.h>
 #include <collection/Vector.h>
 #include <collection/VectorMap.h>
 
+#include <ecs/CommandBuffer.h>
 #include <ecs/Entity.h>
 #include <ecs/SerializedEntitiesAndComponents.h>
 #include <ecs/System.h>
@@ -12,12 +12,14 @@
 #include <math/Vector3.h>
 #include <scene/Chunk.h>
 #include <scene/ChunkID.h>
+#include <scene/ChunkStore.h>
+#include <scene/ChunkStreamer.h>
+#include <scene/OutOfPlayChunkSimulation.h>
 #include <scene/SceneSaveComponent.h>
 #include <scene/SceneTransformComponent.h>
+#include <scene/TrackedChunkSpatialIndex.h>
 #include <unit/UnitTempl.h>
 
-#include <future>
-
 namespace ECS
 {
 class EntityManager;
@@ -39,6 +41,9 @@ namespace Scene
  * entities. Out-of-play chunks run an extremely simplified simulation. Chunks on the boundary of in-play and
  * out-of-play are called "transition" chunks which buffer the scene from in/out of play oscillations.
  *
+ * Only the most recently removed out-of-play chunks are simulated: they stay resident in an OutOfPlayChunkSimulation
+ * until they are brought back into play or evicted. Chunks which are evicted are only stored on disk.
+ *
  * UnboundedScenes are ECS::Systems and should not run concurrently with other systems because they add entities
  * and remove entities as they run.
  */
@@ -50,43 +55,46 @@ public:
 	UnboundedScene(const File::Path& sourcePath, const File::Path& userPath);
 	virtual ~UnboundedScene() {}
 
+	virtual void NotifyOfRegistration(ECS::EntityManager& entityManager) override;
 	virtual void NotifyOfShutdown(ECS::EntityManager& entityManager) override;
 
-	void BringChunkIntoPlay(const ChunkID chunkID);
+	// Bring a chunk into play, loading it with the given priority if it isn't loaded. Chunks with lower priority values
+	// are loaded first. Bringing a chunk which is loading into play again changes its priority.
+	void BringChunkIntoPlay(const ChunkID chunkID, const float loadPriority);
 	void RemoveChunkFromPlay(const ChunkID chunkID);
 
+	// Load a chunk which is expected to be brought into play soon so that it is ready when it is. Prefetches are loaded
+	// after chunks in play and must be renewed each update or they are cancelled.
+	void PrefetchChunk(const ChunkID chunkID, const float loadPriority);
+
+	// Add a simplified simulation which is run on the resident out-of-play chunks.
+	void AddOutOfPlaySimulationFunction(OutOfPlayChunkSimulation::SimulationFunction&& function);
+
 	void Update(const Unit::Time::Millisecond delta,
 		const Collection::ArrayView<ECSGroupType>& ecsGroups,
-		Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions);
+		ECS::DeferredFunctionList& deferredFunctions);
 
 private:
 	void FlushPendingChunks(ECS::EntityManager& entityManager);
-	void SaveChunkAndQueueEntitiesForUnload(ECS::EntityManager& entityManager, const ChunkID chunkID);
+	// Chunks are kept resident out of play after they are saved unless the scene is shutting down.
+	void SaveChunkAndQueueEntitiesForUnload(
+		ECS::EntityManager& entityManager, const ChunkID chunkID, const bool isKeptResident);
 
-	// The directory the scene's chunks will be loaded from the first time they are loaded.
-	File::Path m_sourcePath;
-	// The directory the scene's chunks will be stored in.
-	File::Path m_userPath;
+	// Loads chunks from the scene's source path and saves them to its user path.
+	ChunkStore m_chunkStore;
+	// Loads chunks from m_chunkStore in order of priority on a fixed number of threads.
+	ChunkStreamer m_chunkStreamer;
+	// Keeps recently removed chunks resident and runs a simplified simulation of them.
+	OutOfPlayChunkSimulation m_outOfPlayChunks;
 
-	// A spatial hash that buckets entities by the chunk they are in.
-	class ChunkHashFunctor
-	{
-		int64_t m_a;
-		int64_t m_b;
-		int64_t m_c;
-		int64_t m_d;
-
-	public:
-		ChunkHashFunctor();
-
-		uint64_t Hash(const Math::Vector3& position) const;
-		void Rehash();
-	};
-	Collection::HashMap<Math::Vector3, const ECS::Entity*, ChunkHashFunctor> m_spatialHashMap;
+	// Buckets the root entities of the scene by the chunk they are in. Only the entities which changed are moved
+	// between chunks when pending chunks are flushed, rather than every entity being visited each update.
+	TrackedChunkSpatialIndex m_spatialIndex;
 
 	Collection::Vector<ChunkID> m_chunksInPlay;
 	Collection::Vector<ChunkID> m_chunksPendingRemoval;
-	Collection::Vector<std::future<ECS::SerializedEntitiesAndComponents>> m_chunkLoadingFutures;
+	// The chunks in play whose entities haven't been loaded yet.
+	Collection::Vector<ChunkID> m_chunksLoading;
 
 	struct ChunkRefCount : public Unit::UnitTempl<ChunkRefCount, uint8_t>
 	{
@@ -100,6 +108,7 @@ private:
 	};
 	Collection::VectorMap<ChunkID, ChunkRefCount> m_transitionChunksToRefCounts;
 
-	Collection::Vector<ECS::EntityID> m_entitiesPendingUnload;
+	// Deletes the root entities of the chunks that were saved. Non-root entities are deleted by their parents.
+	ECS::CommandBuffer m_unloadCommands;
 };
 }
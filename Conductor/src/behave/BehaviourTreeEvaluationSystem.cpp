@@ -2,23 +2,34 @@
 
 #include <behave/BehaviourTreeEvaluator.h>
 #include <ecs/ECSGroup.h>
+#include <ecs/ParallelFor.h>
 
 void Behave::BehaviourTreeEvaluationSystem::Update(
 	const Unit::Time::Millisecond delta,
 	const Collection::ArrayView<ECSGroupType>& ecsGroups,
-	Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions) const
+	ECS::DeferredFunctionList& deferredFunctions)
 {
+	// Components with running trees are changed by evaluating them. They are marked before the parallel update because
+	// marking isn't thread safe.
+	for (const auto& ecsGroup : ecsGroups)
+	{
+		const auto& behaviourTreeComponent = ecsGroup.Get<const Behave::BehaviourTreeComponent>();
+		if (!behaviourTreeComponent.m_treeEvaluators.IsEmpty())
+		{
+			MarkChanged(behaviourTreeComponent);
+		}
+	}
+
 	// Update the entities in parallel, as their trees can't access other entities.
-	// TODO make this parallel with a vector of deferred functions for each parallel list.
-	std::for_each(ecsGroups.begin(), ecsGroups.end(),
-		[&](const ECSGroupType& ecsGroup)
+	ECS::ParallelFor(ecsGroups, deferredFunctions,
+		[&](const ECSGroupType& ecsGroup, ECS::DeferredFunctionList& batchFunctions)
 	{
 		// Update this entity's tree evaluators.
 		auto& entity = ecsGroup.Get<ECS::Entity>();
 		auto& behaviourTreeComponent = ecsGroup.Get<Behave::BehaviourTreeComponent>();
 		for (auto& evaluator : behaviourTreeComponent.m_treeEvaluators)
 		{
-			evaluator.Update(m_context, behaviourTreeComponent.m_referencedForests, entity, deferredFunctions);
+			evaluator.Update(m_context, behaviourTreeComponent.m_referencedForests, entity, batchFunctions);
 		}
 
 		// Destroy any evaluators which are no longer running a tree.
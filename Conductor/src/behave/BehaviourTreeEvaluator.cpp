@@ -15,7 +15,7 @@ const Behave::BehaviourTree* Behave::BehaviourTreeEvaluator::GetCurrentTree() co
 void Behave::BehaviourTreeEvaluator::Update(const BehaveContext& context,
 	const Collection::Vector<Asset::AssetHandle<BehaviourForest>>& forests,
 	ECS::Entity& entity,
-	Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions)
+	ECS::DeferredFunctionList& deferredFunctions)
 {
 	AMP_FATAL_ASSERT(!m_callStack.IsEmpty(), "Cannot update without a call stack.");
 
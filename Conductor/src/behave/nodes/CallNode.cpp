@@ -29,7 +29,7 @@ public:
 	virtual EvaluateResult Evaluate(const BehaveContext& context,
 		const Collection::Vector<Asset::AssetHandle<BehaviourForest>>& forests,
 		ECS::Entity& entity, BehaviourTreeEvaluator& treeEvaluator,
-		Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions) override
+		ECS::DeferredFunctionList& deferredFunctions) override
 	{
 		// Evaluate will be called twice during the lifetime of a CallBehaviourState.
 		// First, Evaluate is called when the state is first encountered. In this case, m_result is Running,
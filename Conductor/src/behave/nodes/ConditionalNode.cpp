@@ -26,7 +26,7 @@ public:
 		const Collection::Vector<Asset::AssetHandle<BehaviourForest>>& forests,
 		ECS::Entity& entity,
 		BehaviourTreeEvaluator& treeEvaluator,
-		Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions) override
+		ECS::DeferredFunctionList& deferredFunctions) override
 	{
 		// If m_childResult is Running, it means that a child has not been evaluated yet.
 		if (m_childResult == EvaluateResult::Running)
@@ -24,7 +24,7 @@ public:
 		const Collection::Vector<Asset::AssetHandle<BehaviourForest>>& forests,
 		ECS::Entity& entity,
 		BehaviourTreeEvaluator& treeEvaluator,
-		Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions) override
+		ECS::DeferredFunctionList& deferredFunctions) override
 	{
 		for (const auto& expression : m_node->GetExpressions())
 		{
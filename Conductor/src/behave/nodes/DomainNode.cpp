@@ -25,7 +25,7 @@ public:
 		const Collection::Vector<Asset::AssetHandle<BehaviourForest>>& forests,
 		ECS::Entity& entity,
 		BehaviourTreeEvaluator& treeEvaluator,
-		Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions) override
+		ECS::DeferredFunctionList& deferredFunctions) override
 	{
 		if (m_childResult != EvaluateResult::Running)
 		{
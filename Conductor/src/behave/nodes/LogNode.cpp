@@ -27,7 +27,7 @@ public:
 		const Collection::Vector<Asset::AssetHandle<BehaviourForest>>& forests,
 		ECS::Entity& entity,
 		BehaviourTreeEvaluator& treeEvaluator,
-		Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions) override
+		ECS::DeferredFunctionList& deferredFunctions) override
 	{
 		AMP_LOG("%s", m_node->GetMessage());
 		return EvaluateResult::Success;
@@ -2,95 +2,224 @@
 
 #include <mem/DeserializeLittleEndian.h>
 #include <mem/SerializeLittleEndian.h>
+#include <network/MessageFraming.h>
 
-Client::ClientNetworkWorld::ClientNetworkWorld(const char* hostName, const char* hostPort)
-	: m_socket(Network::CreateConnectedSocket(hostName, hostPort))
+#include <thread>
+
+namespace Internal_ClientNetworkWorld
+{
+void SerializeMessageToHost(const Client::MessageToHost& message, Collection::Vector<uint8_t>& outBytes)
+{
+	Mem::LittleEndian::Serialize(message.m_clientID.GetN(), outBytes);
+
+	const uint16_t tag = static_cast<uint16_t>(message.GetTag());
+	Mem::LittleEndian::Serialize(tag, outBytes);
+
+	message.Match(
+		[](const Client::MessageToHost_Connect&) {},
+		[](const Client::MessageToHost_Disconnect&) {},
+		[&](const Client::MessageToHost_FrameAcknowledgement& payload)
+		{
+			Mem::LittleEndian::Serialize(payload.m_frameIndex, outBytes);
+		},
+		[&](const Client::MessageToHost_InputStates& payload)
+		{
+			Mem::LittleEndian::Serialize(static_cast<uint32_t>(payload.m_bytes.Size()), outBytes);
+			outBytes.AddAll(payload.m_bytes.GetConstView());
+		});
+}
+}
+
+Client::ClientNetworkWorld::ClientNetworkWorld(
+	const char* hostName,
+	const char* hostPort,
+	const Network::TransportOptions& transportOptions)
+	: m_transportOptions(transportOptions)
+	, m_startTime(std::chrono::steady_clock::now())
+{
+	if (m_transportOptions.m_type == Network::TransportType::Datagram)
+	{
+		ConnectToDatagramHost(hostName, hostPort);
+	}
+	else
+	{
+		ConnectToStreamHost(hostName, hostPort);
+	}
+
+	// Start the network thread only if we receive the client ID because it runs until the client ID is invalid.
+	if (m_clientID.IsValid())
+	{
+		m_networkThread = std::thread(&ClientNetworkWorld::NetworkThreadFunction, this);
+	}
+}
+
+bool Client::ClientNetworkWorld::IsRunning() const
+{
+	return m_networkThread.joinable();
+}
+
+void Client::ClientNetworkWorld::WaitForShutdown()
+{
+	m_networkThread.join();
+}
+
+void Client::ClientNetworkWorld::ConnectToStreamHost(const char* hostName, const char* hostPort)
 {
-	if (m_socket.IsValid())
+	m_socket = Network::CreateConnectedSocket(hostName, hostPort);
+
+	// Get the client ID from the host.
+	bool isWaitingForClientID = true;
+	while (m_socket.IsValid() && isWaitingForClientID)
 	{
-		// Get the client ID from the host.
-		uint8_t inboundBuffer[4096];
-		Collection::ArrayView<uint8_t> inboundBufferView{ inboundBuffer, sizeof(inboundBuffer) };
+		Collection::ArrayView<uint8_t> inboundBufferView = m_frameReassembler.GetReceiveBuffer();
+		m_frameReassembler.NotifyOfBytesReceived(m_socket.Receive(inboundBufferView));
 
-		size_t numBytesReceived = m_socket.Receive(inboundBufferView);
-		while (m_socket.IsValid())
+		Collection::ArrayView<const uint8_t> frame{ nullptr, 0 };
+		while (isWaitingForClientID && m_frameReassembler.TryPopFrame(frame))
 		{
 			Host::MessageToClient messageFromHost;
-			if (TryReceiveMessageFromHost({ inboundBuffer, numBytesReceived }, messageFromHost))
+			if (TryReceiveMessageFromHost(frame, messageFromHost))
 			{
-				if (messageFromHost.Is<Host::NotifyOfHostConnected_MessageToClient>())
-				{
-					m_clientID = messageFromHost.Get<Host::NotifyOfHostConnected_MessageToClient>().m_clientID;
-					break;
-				}
-				// It's possible for messages to arrive out of order, so keep any other messages we encounter.
-				else if (!m_hostToClientMessages.TryPush(std::move(messageFromHost)))
-				{
-					// If we fill the entire inbound message queue without receiving our client ID, we almost certainly
-					// aren't going to get one.
-					break;
-				}
+				isWaitingForClientID = ReceiveMessageWhileWaitingForClientID(std::move(messageFromHost));
 			}
-			numBytesReceived = m_socket.Receive(inboundBufferView);
 		}
 
-		// Start the network thread only if we receive the client ID because it runs until the client ID is invalid.
-		if (m_clientID.IsValid())
+		if (m_frameReassembler.HasInvalidFrame())
 		{
-			m_networkThread = std::thread(&ClientNetworkWorld::NetworkThreadFunction, this);
+			m_socket.Close();
 		}
 	}
 }
 
-bool Client::ClientNetworkWorld::IsRunning() const
+void Client::ClientNetworkWorld::ConnectToDatagramHost(const char* hostName, const char* hostPort)
 {
-	return m_networkThread.joinable();
+	m_datagramSocket = Network::CreateBoundDatagramSocket("0");
+	if (!m_datagramSocket.IsValid() || !Network::TryResolveDatagramAddress(hostName, hostPort, m_hostAddress))
+	{
+		m_datagramSocket.Close();
+		return;
+	}
+
+	const Unit::Time::Millisecond connectStartTime = GetNetworkTime();
+	m_datagramConnection =
+		Mem::MakeUnique<Network::DatagramConnection>(connectStartTime, m_transportOptions.m_simulatedLinkConditions);
+
+	// Request a connection with a MessageToHost_Connect without a client ID. The host creates a client for the first
+	// such message it receives from this address and responds with the client ID.
+	m_transmissionBytes.Clear();
+	Internal_ClientNetworkWorld::SerializeMessageToHost(
+		Client::MessageToHost::Make<Client::MessageToHost_Connect>(ClientID()), m_transmissionBytes);
+	const Collection::ArrayView<const uint8_t> messageParts[] = { m_transmissionBytes.GetConstView() };
+	m_datagramConnection->SendReliable(connectStartTime, { messageParts, 1 });
+
+	// Get the client ID from the host.
+	bool isWaitingForClientID = true;
+	while (isWaitingForClientID)
+	{
+		const Unit::Time::Millisecond now = GetNetworkTime();
+		if ((now - connectStartTime) > k_datagramConnectTimeout)
+		{
+			AMP_LOG_WARNING("Timed out waiting for the host to respond to the connection request.");
+			m_datagramSocket.Close();
+			break;
+		}
+
+		FlushDatagramConnection(now);
+		ReceiveDatagramsFromHost(now);
+
+		m_datagramConnection->PopReceivedMessages([&](const Collection::ArrayView<const uint8_t>& message)
+		{
+			Host::MessageToClient messageFromHost;
+			if (isWaitingForClientID && TryReceiveMessageFromHost(message, messageFromHost))
+			{
+				isWaitingForClientID = ReceiveMessageWhileWaitingForClientID(std::move(messageFromHost));
+			}
+		});
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
 }
 
-void Client::ClientNetworkWorld::WaitForShutdown()
+bool Client::ClientNetworkWorld::ReceiveMessageWhileWaitingForClientID(Host::MessageToClient&& messageFromHost)
 {
-	m_networkThread.join();
+	if (messageFromHost.Is<Host::NotifyOfHostConnected_MessageToClient>())
+	{
+		m_clientID = messageFromHost.Get<Host::NotifyOfHostConnected_MessageToClient>().m_clientID;
+		return false;
+	}
+
+	// It's possible for messages to arrive out of order, so keep any other messages we encounter.
+	// If we fill the entire inbound message queue without receiving our client ID, we almost
+	// certainly aren't going to get one.
+	return m_hostToClientMessages.TryPush(std::move(messageFromHost));
 }
 
 void Client::ClientNetworkWorld::NetworkThreadFunction()
 {
+	const bool isDatagramTransport = (m_transportOptions.m_type == Network::TransportType::Datagram);
+
 	// Run the thread so long as the client ID is valid.
 	while (m_clientID.IsValid())
 	{
-		// Receive any pending data from the host.
-		uint8_t inboundBuffer[UINT16_MAX];
-		Collection::ArrayView<uint8_t> inboundBufferView{ inboundBuffer, sizeof(inboundBuffer) };
+		const Unit::Time::Millisecond now = GetNetworkTime();
 
-		size_t numBytesReceived = m_socket.Receive(inboundBufferView);
-		while (m_socket.IsValid() && numBytesReceived != 0)
+		// Receive any pending data from the host.
+		if (isDatagramTransport)
 		{
-			Host::MessageToClient messageFromHost;
-			if (TryReceiveMessageFromHost({ inboundBuffer, numBytesReceived }, messageFromHost))
+			ReceiveDatagramsFromHost(now);
+			m_datagramConnection->PopReceivedMessages([&](const Collection::ArrayView<const uint8_t>& message)
 			{
-				if (!m_hostToClientMessages.TryPush(std::move(messageFromHost)))
+				Host::MessageToClient messageFromHost;
+				if (TryReceiveMessageFromHost(message, messageFromHost))
 				{
-					// TODO(network)
-					break;
+					if (!m_hostToClientMessages.TryPush(std::move(messageFromHost)))
+					{
+						// TODO(network)
+						AMP_LOG_WARNING("Dropped a message from the host because the inbound queue is full.");
+					}
 				}
-			}
-			numBytesReceived = m_socket.Receive(inboundBufferView);
+			});
+		}
+		else
+		{
+			ReceiveFromStreamHost();
 		}
 
-		// Transmit client messages to the host.
-		Client::MessageToHost messageToHost;
-		while (m_socket.IsValid() && m_clientToHostMessages.TryPop(messageToHost))
+		// Transmit client messages to the host. Each batch of messages is sent together.
+		Client::MessageToHost messagesToHost[k_messageBatchSize];
+		size_t numMessages;
+		while (IsConnected(now)
+			&& (numMessages = m_clientToHostMessages.TryPopBatch(messagesToHost, k_messageBatchSize)) != 0)
 		{
-			if (messageToHost.Is<Client::MessageToHost_Disconnect>())
+			for (size_t i = 0; i < numMessages; ++i)
 			{
-				m_clientID = ClientID();
+				if (messagesToHost[i].Is<Client::MessageToHost_Disconnect>())
+				{
+					m_clientID = ClientID();
+				}
 			}
 
-			TransmitMessageToHost(messageToHost);
+			if (isDatagramTransport)
+			{
+				TransmitMessagesToDatagramHost(now, { messagesToHost, numMessages });
+			}
+			else
+			{
+				TransmitMessagesToHost({ messagesToHost, numMessages });
+			}
+		}
+
+		// Datagram connections send resent messages and acknowledgements even when there are no new messages.
+		if (isDatagramTransport)
+		{
+			FlushDatagramConnection(now);
 		}
 
-		// If the socket is no longer valid, we are no longer a client.
-		if (!m_socket.IsValid())
+		// If the connection is lost, we are no longer a client.
+		if (!IsConnected(now))
 		{
+			m_socket.Close();
+			m_datagramSocket.Close();
 			m_hostToClientMessages.TryPush(
 				Host::MessageToClient::Make<Host::NotifyOfHostDisconnected_MessageToClient>());
 			break;
@@ -100,6 +229,81 @@ void Client::ClientNetworkWorld::NetworkThreadFunction()
 	}
 }
 
+Unit::Time::Millisecond Client::ClientNetworkWorld::GetNetworkTime() const
+{
+	const auto elapsed = std::chrono::steady_clock::now() - m_startTime;
+	return Unit::Time::Millisecond(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+}
+
+bool Client::ClientNetworkWorld::IsConnected(const Unit::Time::Millisecond now) const
+{
+	if (m_transportOptions.m_type == Network::TransportType::Datagram)
+	{
+		return m_datagramSocket.IsValid() && !m_datagramConnection->HasTimedOut(now);
+	}
+	return m_socket.IsValid();
+}
+
+void Client::ClientNetworkWorld::ReceiveFromStreamHost()
+{
+	// Messages are parsed in place in the frame reassembler's buffer, starting with any which were received along
+	// with the client ID.
+	size_t numBytesReceived = 0;
+	do
+	{
+		m_frameReassembler.NotifyOfBytesReceived(numBytesReceived);
+
+		Collection::ArrayView<const uint8_t> frame{ nullptr, 0 };
+		while (m_frameReassembler.TryPopFrame(frame))
+		{
+			Host::MessageToClient messageFromHost;
+			if (TryReceiveMessageFromHost(frame, messageFromHost))
+			{
+				if (!m_hostToClientMessages.TryPush(std::move(messageFromHost)))
+				{
+					// TODO(network)
+					AMP_LOG_WARNING("Dropped a message from the host because the inbound queue is full.");
+				}
+			}
+		}
+
+		// A corrupt frame size means the host's messages can't be separated anymore.
+		if (m_frameReassembler.HasInvalidFrame())
+		{
+			m_socket.Close();
+			break;
+		}
+
+		Collection::ArrayView<uint8_t> inboundBufferView = m_frameReassembler.GetReceiveBuffer();
+		numBytesReceived = m_socket.Receive(inboundBufferView);
+	} while (m_socket.IsValid() && numBytesReceived != 0);
+}
+
+void Client::ClientNetworkWorld::ReceiveDatagramsFromHost(const Unit::Time::Millisecond now)
+{
+	uint8_t datagramBuffer[Network::DatagramSocket::k_maxDatagramSize];
+	Collection::ArrayView<uint8_t> datagramBufferView{ datagramBuffer, sizeof(datagramBuffer) };
+
+	Network::DatagramAddress address;
+	size_t numBytesReceived;
+	while ((numBytesReceived = m_datagramSocket.ReceiveFrom(address, datagramBufferView)) != 0)
+	{
+		// Ignore datagrams which didn't come from the host.
+		if (address == m_hostAddress)
+		{
+			m_datagramConnection->ReceiveDatagram(now, { datagramBuffer, numBytesReceived });
+		}
+	}
+}
+
+void Client::ClientNetworkWorld::FlushDatagramConnection(const Unit::Time::Millisecond now)
+{
+	m_datagramConnection->Flush(now, [&](const Collection::ArrayView<const uint8_t>& datagram)
+	{
+		m_datagramSocket.SendTo(m_hostAddress, datagram);
+	});
+}
+
 bool Client::ClientNetworkWorld::TryReceiveMessageFromHost(
 	const Collection::ArrayView<const uint8_t>& bytes,
 	Host::MessageToClient& outMessage) const
@@ -163,28 +367,41 @@ bool Client::ClientNetworkWorld::TryReceiveMessageFromHost(
 	}
 }
 
-void Client::ClientNetworkWorld::TransmitMessageToHost(const Client::MessageToHost& message)
+void Client::ClientNetworkWorld::TransmitMessagesToHost(
+	const Collection::ArrayView<const Client::MessageToHost>& messages)
 {
-	Collection::Vector<uint8_t> transmissionBuffer(4096);
+	m_transmissionBytes.Clear();
 
-	Mem::LittleEndian::Serialize(message.m_clientID.GetN(), transmissionBuffer);
+	for (const auto& message : messages)
+	{
+		const size_t frameHeaderIndex = Network::MessageFraming::BeginFrame(m_transmissionBytes);
+		Internal_ClientNetworkWorld::SerializeMessageToHost(message, m_transmissionBytes);
+		Network::MessageFraming::FinishFrame(frameHeaderIndex, m_transmissionBytes);
+	}
 
-	const uint16_t tag = static_cast<uint16_t>(message.GetTag());
-	Mem::LittleEndian::Serialize(tag, transmissionBuffer);
+	AMP_LOG("Sending [%u] bytes in [%zu] messages to host.", m_transmissionBytes.Size(), messages.Size());
+	m_socket.Send(m_transmissionBytes.GetConstView());
+}
 
-	message.Match(
-		[](const MessageToHost_Connect&) {},
-		[](const MessageToHost_Disconnect&) {},
-		[&](const MessageToHost_FrameAcknowledgement& payload)
+void Client::ClientNetworkWorld::TransmitMessagesToDatagramHost(
+	const Unit::Time::Millisecond now,
+	const Collection::ArrayView<const Client::MessageToHost>& messages)
+{
+	for (const auto& message : messages)
+	{
+		m_transmissionBytes.Clear();
+		Internal_ClientNetworkWorld::SerializeMessageToHost(message, m_transmissionBytes);
+		const Collection::ArrayView<const uint8_t> messageParts[] = { m_transmissionBytes.GetConstView() };
+
+		// Frame acknowledgements and input states supersede each other, so they're sent on sequenced streams to
+		// avoid waiting on lost messages. The stream is the message's tag so that each kind is sequenced independently.
+		if (message.Is<Client::MessageToHost_FrameAcknowledgement>() || message.Is<Client::MessageToHost_InputStates>())
 		{
-			Mem::LittleEndian::Serialize(payload.m_frameIndex, transmissionBuffer);
-		},
-		[&](const MessageToHost_InputStates& payload)
+			m_datagramConnection->SendSequenced(now, static_cast<uint8_t>(message.GetTag()), { messageParts, 1 });
+		}
+		else
 		{
-			Mem::LittleEndian::Serialize(static_cast<uint32_t>(payload.m_bytes.Size()), transmissionBuffer);
-			transmissionBuffer.AddAll(payload.m_bytes.GetConstView());
-		});
-
-	AMP_LOG("Sending [%u] bytes to host.", transmissionBuffer.Size());
-	m_socket.Send(transmissionBuffer.GetConstView());
+			m_datagramConnection->SendReliable(now, { messageParts, 1 });
+		}
+	}
 }
@@ -13,12 +13,17 @@ Client::ClientWorld::ClientWorld(const Conductor::IGameData& gameData,
 	IRenderInstance& renderInstance,
 	Collection::LocklessQueue<Input::InputMessage>& inputMessages,
 	Collection::LocklessQueue<Host::MessageToClient>& networkInputQueue,
-	ClientFactory&& clientFactory)
+	ClientFactory&& clientFactory,
+	const Host::TickOptions& tickOptions,
+	const Unit::Time::Millisecond renderDelay)
 	: m_gameData(gameData)
 	, m_renderInstance(renderInstance)
 	, m_inputMessages(inputMessages)
 	, m_networkInputQueue(networkInputQueue)
 	, m_clientFactory(std::move(clientFactory))
+	, m_tickOptions(tickOptions)
+	, m_renderDelay(renderDelay)
+	, m_startPoint()
 	, m_lastUpdatePoint()
 {}
 
@@ -56,35 +61,63 @@ void Client::ClientWorld::ClientThreadFunction()
 	m_renderInstance.InitOnClientThread();
 	m_client = m_clientFactory(m_gameData, m_renderInstance.GetSceneViewFrustum(), *m_connectedHost);
 	m_renderInstance.RegisterSystems(m_client->GetEntityManager());
-	m_lastUpdatePoint = std::chrono::steady_clock::now();
+
+	const Unit::Time::Millisecond tickDelta = m_tickOptions.CalcTickDelta();
+	m_client->SetNetworkTiming(tickDelta, m_renderDelay);
+
+	m_startPoint = std::chrono::steady_clock::now();
+	m_lastUpdatePoint = m_startPoint;
+	Unit::Time::Millisecond nextInputTransmissionTime{ 0 };
 
 	// Acknowledge the connection to the host.
 	m_connectedHost->Connect(nullptr);
 
 	while (m_clientThreadStatus == ClientThreadStatus::Running)
 	{
+		const Unit::Time::Millisecond now = GetClientTime();
+
 		// Process pending input from the network.
 		{
-			Host::MessageToClient message;
-			while (m_networkInputQueue.TryPop(message))
+			Host::MessageToClient messages[k_messageBatchSize];
+			size_t numMessages;
+			while ((numMessages = m_networkInputQueue.TryPopBatch(messages, k_messageBatchSize)) != 0)
 			{
-				ProcessMessageFromHost(message);
+				for (size_t i = 0; i < numMessages; ++i)
+				{
+					ProcessMessageFromHost(messages[i], now);
+				}
 			}
 		}
 
-		// Process pending player input and then queue it for transmission on the network.
+		// Process pending player input.
 		{
-			Input::InputMessage message;
-			while (m_inputMessages.TryPop(message))
+			Input::InputMessage messages[k_messageBatchSize];
+			size_t numMessages;
+			while ((numMessages = m_inputMessages.TryPopBatch(messages, k_messageBatchSize)) != 0)
 			{
-				ProcessInputMessage(message);
+				for (size_t i = 0; i < numMessages; ++i)
+				{
+					ProcessInputMessage(messages[i]);
+				}
 			}
+		}
+
+		// Transmit player input to the host once per host tick. Ticks which were missed aren't caught up on because
+		// each transmission contains the full input state.
+		if (now.GetN() >= nextInputTransmissionTime.GetN())
+		{
+			m_client->TransmitInputStates(now, tickDelta);
 
-			m_connectedHost->TransmitInputStates(m_client->SerializeInputStateTransmission());
+			nextInputTransmissionTime = Unit::Time::Millisecond(nextInputTransmissionTime.GetN() + tickDelta.GetN());
+			if (nextInputTransmissionTime.GetN() <= now.GetN())
+			{
+				nextInputTransmissionTime = Unit::Time::Millisecond(now.GetN() + tickDelta.GetN());
+			}
 		}
 
-		// TODO predict simulation state based on player input
-		// TODO interpolate between the last received server state and the predicted simulation state
+		// Present the host's simulation interpolated between the frames received from it, with the entity the player
+		// controls predicted from the player's input.
+		m_client->PresentNetworkedEntities(now);
 
 		const auto nowPoint = std::chrono::steady_clock::now();
 		const auto deltaMs = std::chrono::duration_cast<std::chrono::milliseconds>(nowPoint - m_lastUpdatePoint);
@@ -101,7 +134,13 @@ void Client::ClientWorld::ClientThreadFunction()
 	m_clientThreadStatus = ClientThreadStatus::Stopped;
 }
 
-void Client::ClientWorld::ProcessMessageFromHost(Host::MessageToClient& message)
+Unit::Time::Millisecond Client::ClientWorld::GetClientTime() const
+{
+	const auto elapsed = std::chrono::steady_clock::now() - m_startPoint;
+	return Unit::Time::Millisecond(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+}
+
+void Client::ClientWorld::ProcessMessageFromHost(Host::MessageToClient& message, const Unit::Time::Millisecond now)
 {
 	message.Match(
 		[](Host::NotifyOfHostConnected_MessageToClient& hostConnectedPayload)
@@ -112,9 +151,9 @@ void Client::ClientWorld::ProcessMessageFromHost(Host::MessageToClient& message)
 		{
 			NotifyOfHostDisconnected();
 		},
-		[this](Host::ECSUpdate_MessageToClient& ecsUpdatePayload)
+		[&](Host::ECSUpdate_MessageToClient& ecsUpdatePayload)
 		{
-			m_client->NotifyOfECSUpdateTransmission(ecsUpdatePayload.m_bytes);
+			m_client->NotifyOfECSUpdateTransmission(ecsUpdatePayload.m_bytes, now);
 		});
 }
 
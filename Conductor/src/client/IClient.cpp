@@ -1,8 +1,11 @@
 #include <client/IClient.h>
 
 #include <client/ConnectedHost.h>
+#include <input/InputComponent.h>
 #include <input/InputMessage.h>
 #include <input/InputSystem.h>
+#include <mem/DeserializeLittleEndian.h>
+#include <scene/SceneTransformComponent.h>
 
 namespace Client
 {
@@ -18,15 +21,27 @@ IClient::IClient(Asset::AssetManager& assetManager,
 	// The InputSystem is present for all clients.
 	Input::InputSystem& inputSystem = m_entityManager.RegisterSystem(Mem::MakeUnique<Input::InputSystem>());
 	inputSystem.AddClient(m_connectedHost.GetClientID(), m_inputStateManager);
+
+	// The host packet compresses transmissions with a dictionary built from the component types.
+	Collection::Vector<uint8_t> packetCompressionDictionary;
+	ECS::BuildSerializationDictionary(componentReflector, packetCompressionDictionary);
+	m_ecsReceiver.SetPacketCompressionDictionary(std::move(packetCompressionDictionary));
+}
+
+void IClient::SetNetworkTiming(const Unit::Time::Millisecond tickDelta, const Unit::Time::Millisecond renderDelay)
+{
+	m_ecsInterpolationBuffer.SetTiming(tickDelta, renderDelay);
 }
 
-void IClient::NotifyOfECSUpdateTransmission(const Collection::Vector<uint8_t>& transmissionBytes)
+void IClient::NotifyOfECSUpdateTransmission(
+	const Collection::Vector<uint8_t>& transmissionBytes, const Unit::Time::Millisecond now)
 {
 	const ECS::SerializedEntitiesAndComponents* const newFrame =
 		m_ecsReceiver.TryReceiveFrameTransmission(transmissionBytes.GetConstView());
 	if (newFrame != nullptr)
 	{
-		m_entityManager.SetNetworkedEntitiesToFullSerialization(*newFrame);
+		// The frame is applied to the entity manager when it is presented.
+		m_ecsInterpolationBuffer.NotifyOfFrameReceived(m_ecsReceiver.GetLastSeenFrameIndex(), now);
 		m_connectedHost.TransmitFrameAcknowledgement(m_ecsReceiver.GetLastSeenFrameIndex());
 	}
 }
@@ -36,13 +51,188 @@ void IClient::NotifyOfInputMessage(const Input::InputMessage& message)
 	m_inputCallbackRegistry.NotifyOfInputMessage(message);
 }
 
-Collection::Vector<uint8_t> IClient::SerializeInputStateTransmission() const
+void IClient::TransmitInputStates(const Unit::Time::Millisecond now, const Unit::Time::Millisecond tickDelta)
+{
+	const uint32_t sequenceNumber = m_nextInputSequenceNumber++;
+	Collection::Vector<uint8_t> transmissionBytes = m_inputStateManager.SerializeFullTransmission(sequenceNumber);
+
+	// Keep the input states until the host has applied them so that prediction can replay them.
+	if (m_unappliedInputStates.Size() >= k_maxUnappliedInputStates)
+	{
+		m_unappliedInputStates.Remove(0, 1);
+	}
+	UnappliedInputStates& unappliedInputStates = m_unappliedInputStates.Emplace();
+	unappliedInputStates.m_sequenceNumber = sequenceNumber;
+	unappliedInputStates.m_delta = tickDelta;
+	unappliedInputStates.m_bytes.AddAll(transmissionBytes.GetConstView());
+
+	m_connectedHost.TransmitInputStates(std::move(transmissionBytes));
+
+	m_lastInputTransmissionTime = now;
+	m_inputStateManager.ResetTransmissionInputStates();
+}
+
+void IClient::PresentNetworkedEntities(const Unit::Time::Millisecond now)
 {
-	return m_inputStateManager.SerializeFullTransmission();
+	Network::ECSInterpolationBuffer::InterpolationPoint interpolationPoint;
+	if (!m_ecsInterpolationBuffer.TryFindInterpolationPoint(m_ecsReceiver, now, interpolationPoint))
+	{
+		return;
+	}
+	const ECS::SerializedEntitiesAndComponents& fromFrame =
+		*m_ecsReceiver.FindFrame(interpolationPoint.m_fromFrameIndex);
+	const ECS::SerializedEntitiesAndComponents& toFrame =
+		*m_ecsReceiver.FindFrame(interpolationPoint.m_toFrameIndex);
+
+	// The entities and components only change when the frame being interpolated from changes. Transforms are
+	// interpolated every time because they change between frames, except for the predicted transform of the
+	// controlled entity.
+	const bool isFromFrameChanged = (interpolationPoint.m_fromFrameIndex != m_presentedFrameIndex);
+	if (isFromFrameChanged)
+	{
+		m_entityManager.SetNetworkedEntitiesToFullSerialization(fromFrame);
+		m_presentedFrameIndex = interpolationPoint.m_fromFrameIndex;
+	}
+	Network::InterpolateSceneTransforms(
+		fromFrame, toFrame, interpolationPoint.m_t, m_controlledTransformComponentID, m_entityManager);
+
+	// Changing the frame being interpolated from sets the controlled entity to its state in that frame, so it must be
+	// predicted again.
+	PresentControlledEntity(now, isFromFrameChanged);
+}
+
+void IClient::PresentControlledEntity(const Unit::Time::Millisecond now, const bool isPredictionOverwritten)
+{
+	const uint64_t newestFrameIndex = m_ecsReceiver.GetLastSeenFrameIndex();
+	const ECS::SerializedEntitiesAndComponents* const newestFrame = m_ecsReceiver.FindFrame(newestFrameIndex);
+	if (newestFrame == nullptr)
+	{
+		return;
+	}
+
+	// Find the controlled entity and its state in the newest frame once per frame.
+	const bool isNewFrame = (newestFrameIndex != m_controlledEntityFrameIndex);
+	if (isNewFrame)
+	{
+		m_controlledEntityFrameIndex = newestFrameIndex;
+		m_controlledEntityID = FindControlledEntityID(*newestFrame);
+
+		m_controlledEntitySerialization.m_components.Clear();
+		m_controlledEntitySerialization.m_entities.m_bytes.Clear();
+		m_controlledEntitySerialization.m_entities.m_views.Clear();
+		if (m_controlledEntityID != ECS::EntityID())
+		{
+			const uint32_t entityID = m_controlledEntityID.GetUniqueID();
+			ECS::FilterSerializedEntitiesAndComponents(*newestFrame, { &entityID, 1 }, m_controlledEntitySerialization);
+		}
+	}
+
+	ECS::Entity* const controlledEntity = (m_controlledEntityID != ECS::EntityID())
+		? m_entityManager.FindEntity(m_controlledEntityID)
+		: nullptr;
+	if (controlledEntity == nullptr)
+	{
+		m_controlledTransformComponentID = ECS::ComponentID();
+		return;
+	}
+
+	// Between frames, the prediction is only advanced by the input recorded since it was last advanced.
+	if (!isNewFrame && !isPredictionOverwritten && m_controlledTransformComponentID != ECS::ComponentID())
+	{
+		const Unit::Time::Millisecond timeSincePrediction{ (now.GetN() > m_lastPredictionTime.GetN())
+			? (now.GetN() - m_lastPredictionTime.GetN()) : 0 };
+		PredictControlledEntity(*controlledEntity, m_inputStateManager, timeSincePrediction);
+		m_lastPredictionTime = now;
+		return;
+	}
+
+	// Set the controlled entity to its state in the newest frame rather than to its interpolated state.
+	m_entityManager.ApplyFullSerializationToExistingComponents(m_controlledEntitySerialization);
+	m_controlledTransformComponentID = controlledEntity->FindComponentID<Scene::SceneTransformComponent>();
+
+	// Forget the input states the host had applied in the newest frame.
+	const Input::InputComponent* const inputComponent =
+		m_entityManager.FindComponent<Input::InputComponent>(*controlledEntity);
+	if (inputComponent != nullptr)
+	{
+		const uint32_t lastAppliedSequenceNumber = inputComponent->m_lastAppliedInputSequenceNumber;
+
+		size_t numAppliedInputStates = 0;
+		while (numAppliedInputStates < m_unappliedInputStates.Size()
+			&& m_unappliedInputStates[numAppliedInputStates].m_sequenceNumber <= lastAppliedSequenceNumber)
+		{
+			++numAppliedInputStates;
+		}
+		m_unappliedInputStates.Remove(0, numAppliedInputStates);
+	}
+
+	// Replay the input states the host hadn't applied, and then the current input states since the last transmission.
+	for (const auto& unappliedInputStates : m_unappliedInputStates)
+	{
+		m_predictionInputStateManager.ApplyFullTransmission(unappliedInputStates.m_bytes);
+		PredictControlledEntity(*controlledEntity, m_predictionInputStateManager, unappliedInputStates.m_delta);
+	}
+
+	const Unit::Time::Millisecond timeSinceTransmission{ (now.GetN() > m_lastInputTransmissionTime.GetN())
+		? (now.GetN() - m_lastInputTransmissionTime.GetN()) : 0 };
+	PredictControlledEntity(*controlledEntity, m_inputStateManager, timeSinceTransmission);
+	m_lastPredictionTime = now;
 }
 
 void IClient::PostUpdate()
 {
 	m_inputStateManager.ResetInputStates();
 }
+
+ECS::EntityID IClient::FindControlledEntityID(const ECS::SerializedEntitiesAndComponents& frame) const
+{
+	// Find the index of the InputComponent type in the frame's component types.
+	uint32_t inputComponentTypeIndex = UINT32_MAX;
+	for (uint32_t i = 0, iEnd = frame.m_components.Size(); i < iEnd; ++i)
+	{
+		if (frame.m_components[i].first == Input::InputComponent::k_type)
+		{
+			inputComponentTypeIndex = i;
+			break;
+		}
+	}
+	if (inputComponentTypeIndex == UINT32_MAX)
+	{
+		return ECS::EntityID();
+	}
+
+	// Find the entity with an InputComponent which receives this client's input. The client an InputComponent receives
+	// input from doesn't change, so the entity manager's copy of the component is checked rather than deserializing it.
+	for (const auto& entityView : frame.m_entities.m_views)
+	{
+		const uint8_t* const viewBytes = &frame.m_entities.m_bytes[entityView.m_beginIndex];
+		const uint8_t* const viewEnd = viewBytes + (entityView.m_endIndex - entityView.m_beginIndex);
+
+		ECS::FullSerializedEntityHeader header;
+		memcpy(&header, viewBytes, ECS::FullSerializedEntityHeader::k_unpaddedSize);
+
+		const uint8_t* componentListIter = viewBytes + ECS::FullSerializedEntityHeader::k_unpaddedSize;
+		for (uint32_t i = 0; i < header.m_numComponents; ++i)
+		{
+			const auto maybeTypeIndex = Mem::LittleEndian::DeserializeUi16(componentListIter, viewEnd);
+			const auto maybeUniqueID = Mem::LittleEndian::DeserializeUi64(componentListIter, viewEnd);
+			if (!maybeTypeIndex.second || !maybeUniqueID.second)
+			{
+				break;
+			}
+			if (maybeTypeIndex.first != inputComponentTypeIndex)
+			{
+				continue;
+			}
+
+			const auto* const inputComponent = static_cast<const Input::InputComponent*>(m_entityManager.FindComponent(
+				ECS::ComponentID(Input::InputComponent::k_type, maybeUniqueID.first)));
+			if (inputComponent != nullptr && inputComponent->m_clientID == m_connectedHost.GetClientID())
+			{
+				return header.m_entityID;
+			}
+		}
+	}
+	return ECS::EntityID();
+}
 }
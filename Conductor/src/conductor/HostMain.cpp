@@ -3,6 +3,7 @@
 #include <asset/AssetManager.h>
 #include <host/HostNetworkWorld.h>
 #include <network/Socket.h>
+#include <network/TransportOptions.h>
 
 #include <iostream>
 
@@ -22,7 +23,7 @@ Conductor::ApplicationErrorCode Conductor::HostMain(
 	}
 
 	// Setup the network world and verify it is running.
-	Host::HostNetworkWorld hostNetworkWorld{ port };
+	Host::HostNetworkWorld hostNetworkWorld{ port, Network::ParseTransportOptions(params) };
 	if (!hostNetworkWorld.IsRunning())
 	{
 		Network::ShutdownSocketAPI();
@@ -32,8 +33,9 @@ Conductor::ApplicationErrorCode Conductor::HostMain(
 	// Initialize asset types, register component types, and load game data.
 	Mem::UniquePtr<IGameData> gameData = gameDataFactory(assetManager, dataDirectory, userDirectory);
 
-	// Create and run a host.
-	Host::HostWorld hostWorld{ *gameData, hostNetworkWorld.GetClientToHostMessageQueue(), std::move(hostFactory) };
+	// Create and run a host. The host wakes the network thread whenever it has messages for the network thread to send.
+	Host::HostWorld hostWorld{ *gameData, hostNetworkWorld.GetClientToHostMessageQueue(), std::move(hostFactory),
+		Host::ParseTickOptions(params), [&hostNetworkWorld]() { hostNetworkWorld.NotifyOfOutboundMessages(); } };
 	
 	// Create a thread that processes console input for as long as the network thread is running.
 	std::thread consoleInputThread{ [&hostNetworkWorld]()
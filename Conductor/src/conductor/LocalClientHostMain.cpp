@@ -40,8 +40,10 @@ Conductor::ApplicationErrorCode Conductor::LocalClientHostMain(
 
 	// Create the client and connect it to a new host.
 	Client::ClientWorld clientWorld{ *gameData, *renderInstance, inputToClientMessages,
-		hostToClientMessages, std::move(clientFactory) };
-	Host::HostWorld hostWorld{ *gameData, clientToHostMessages, std::move(hostFactory) };
+		hostToClientMessages, std::move(clientFactory), Host::ParseTickOptions(params),
+		Network::ParseRenderDelay(params) };
+	Host::HostWorld hostWorld{ *gameData, clientToHostMessages, std::move(hostFactory),
+		Host::ParseTickOptions(params) };
 	
 	constexpr Client::ClientID clientID = Host::HostNetworkWorld::k_localClientID;
 	hostWorld.NotifyOfClientConnected(Mem::MakeUnique<Host::ConnectedClient>(clientID, hostToClientMessages));
@@ -8,6 +8,7 @@
 #include <collection/LocklessQueue.h>
 #include <input/InputMessage.h>
 #include <network/Socket.h>
+#include <network/TransportOptions.h>
 
 Conductor::ApplicationErrorCode Conductor::RemoteClientMain(
 	const Collection::ProgramParameters& params,
@@ -40,7 +41,7 @@ Conductor::ApplicationErrorCode Conductor::RemoteClientMain(
 		renderInstanceFactory(assetManager, dataDirectory, clientToRenderInstanceMessages, inputToClientMessages);
 
 	// Establish a connection to the networked host.
-	Client::ClientNetworkWorld clientNetworkWorld{ hostName, hostPort };
+	Client::ClientNetworkWorld clientNetworkWorld{ hostName, hostPort, Network::ParseTransportOptions(params) };
 	if (!clientNetworkWorld.IsRunning())
 	{
 		Network::ShutdownSocketAPI();
@@ -49,7 +50,8 @@ Conductor::ApplicationErrorCode Conductor::RemoteClientMain(
 
 	// Create a client and notify it of the connection.
 	Client::ClientWorld clientWorld{ *gameData, *renderInstance, inputToClientMessages,
-		clientNetworkWorld.GetHostToClientMessageQueue(), std::move(clientFactory) };
+		clientNetworkWorld.GetHostToClientMessageQueue(), std::move(clientFactory),
+		Host::ParseTickOptions(params), Network::ParseRenderDelay(params) };
 	clientWorld.NotifyOfHostConnected(Mem::MakeUnique<Client::ConnectedHost>(
 		clientNetworkWorld.GetClientID(), clientNetworkWorld.GetClientToHostMessageQueue()));
 
@@ -0,0 +1,59 @@
+#include <ecs/Archetype.h>
+
+#include <dev/Dev.h>
+
+#include <algorithm>
+
+namespace ECS
+{
+ArchetypeID ArchetypeRegistry::FindOrAddArchetype(const Collection::ArrayView<const ComponentType>& componentTypes)
+{
+	m_scratchSignature.Clear();
+	m_scratchSignature.AddAll(componentTypes);
+	return FindOrAddSortedSignature();
+}
+
+ArchetypeID ArchetypeRegistry::FindOrAddArchetype(const Collection::ArrayView<const ComponentID>& componentIDs)
+{
+	m_scratchSignature.Clear();
+	for (const auto& componentID : componentIDs)
+	{
+		m_scratchSignature.Add(componentID.GetType());
+	}
+	return FindOrAddSortedSignature();
+}
+
+Collection::ArrayView<const ComponentType> ArchetypeRegistry::GetSignature(const ArchetypeID archetypeID) const
+{
+	AMP_FATAL_ASSERT(archetypeID.GetUniqueID() < m_archetypes.Size(), "Invalid archetype ID.");
+	return m_archetypes[archetypeID.GetUniqueID()].m_signature.GetConstView();
+}
+
+ArchetypeID ArchetypeRegistry::FindOrAddSortedSignature()
+{
+	std::sort(m_scratchSignature.begin(), m_scratchSignature.end());
+
+	uint64_t signatureHash = 14695981039346656037ull;
+	for (const auto& componentType : m_scratchSignature)
+	{
+		signatureHash = (signatureHash ^ componentType.GetTypeHash().Get()) * 1099511628211ull;
+	}
+
+	for (size_t i = 0, iEnd = m_archetypes.Size(); i < iEnd; ++i)
+	{
+		const Archetype& archetype = m_archetypes[i];
+		if (archetype.m_signatureHash == signatureHash && archetype.m_signature == m_scratchSignature)
+		{
+			return ArchetypeID(static_cast<uint16_t>(i));
+		}
+	}
+
+	AMP_FATAL_ASSERT(m_archetypes.Size() < ArchetypeID::sk_invalidValue, "Ran out of archetype IDs.");
+
+	const ArchetypeID archetypeID{ static_cast<uint16_t>(m_archetypes.Size()) };
+	Archetype& archetype = m_archetypes.Emplace();
+	archetype.m_signatureHash = signatureHash;
+	archetype.m_signature.AddAll(m_scratchSignature.GetConstView());
+	return archetypeID;
+}
+}
@@ -30,6 +30,7 @@ void ComponentReflector::RegisterComponentType(const char* const componentTypeNa
 	m_componentAlignmentsInBytes[componentType] = alignOfComponent;
 	m_mandatoryComponentFunctions[componentType] = mandatoryFunctions;
 	m_componentInspectorInfoTypeHashes[componentType] = inspectorInfoTypeHash;
+	m_typeIndices.Set(componentType.GetTypeHash().Get(), m_typeIndices.Size());
 }
 
 bool ComponentReflector::IsRegistered(const ComponentType componentType) const
@@ -75,7 +76,9 @@ Mem::InspectorInfoTypeHash ComponentReflector::GetTypeHashOfComponent(const Comp
 	return typeHashIter->second;
 }
 
-Component* ComponentReflector::TryBasicConstructComponent(const ComponentID reservedID, ComponentVector& destination) const
+Component* ComponentReflector::TryBasicConstructComponent(const ComponentID reservedID,
+	const ArchetypeID archetypeID,
+	ComponentVector& destination) const
 {
 	const auto iter = m_mandatoryComponentFunctions.Find(reservedID.GetType());
 	if (iter == m_mandatoryComponentFunctions.end())
@@ -85,13 +88,14 @@ Component* ComponentReflector::TryBasicConstructComponent(const ComponentID rese
 		return nullptr;
 	}
 
-	return &iter->second.m_basicConstructFunction(reservedID, destination);
+	return &iter->second.m_basicConstructFunction(reservedID, archetypeID, destination);
 }
 
 Component* ComponentReflector::TryMakeComponent(Asset::AssetManager& assetManager,
 	const uint8_t*& bytes,
 	const uint8_t* bytesEnd,
 	const ComponentID reservedID,
+	const ArchetypeID archetypeID,
 	ComponentVector& destination) const
 {
 	const auto iter = m_mandatoryComponentFunctions.Find(reservedID.GetType());
@@ -102,7 +106,7 @@ Component* ComponentReflector::TryMakeComponent(Asset::AssetManager& assetManage
 		return nullptr;
 	}
 
-	Component& component = iter->second.m_basicConstructFunction(reservedID, destination);
+	Component& component = iter->second.m_basicConstructFunction(reservedID, archetypeID, destination);
 	iter->second.m_applyFullSerializationFunction(assetManager, component, bytes, bytesEnd);
 	return &component;
 }
@@ -7,7 +7,6 @@
 #include <random>
 
 ECS::ComponentVector::ComponentVector()
-	: m_keyLookup(ComponentIDHashFunctor(), 6)
 {}
 
 ECS::ComponentVector::~ComponentVector()
@@ -22,16 +21,24 @@ ECS::ComponentVector::ComponentVector(
 	const Unit::ByteCount64 componentAlignment)
 	: m_componentReflector(&componentReflector)
 	, m_componentType(componentType)
-	, m_allocator(componentAlignment.GetN(), componentSize.GetN())
-	, m_keyLookup(ComponentIDHashFunctor(), 6)
+	, m_componentAlignment(static_cast<uint32_t>(componentAlignment.GetN()))
+	, m_componentSize(static_cast<uint32_t>(componentSize.GetN()))
+	, m_columns()
+	, m_slots()
+	, m_freeSlotIndices()
+	, m_slotIndices()
 {
 }
 
 ECS::ComponentVector::ComponentVector(ComponentVector&& other) noexcept
 	: m_componentReflector(other.m_componentReflector)
 	, m_componentType(other.m_componentType)
-	, m_allocator(std::move(other.m_allocator))
-	, m_keyLookup(std::move(other.m_keyLookup))
+	, m_componentAlignment(other.m_componentAlignment)
+	, m_componentSize(other.m_componentSize)
+	, m_columns(std::move(other.m_columns))
+	, m_slots(std::move(other.m_slots))
+	, m_freeSlotIndices(std::move(other.m_freeSlotIndices))
+	, m_slotIndices(std::move(other.m_slotIndices))
 {
 }
 
@@ -41,8 +48,12 @@ ECS::ComponentVector& ECS::ComponentVector::operator=(ComponentVector&& rhs) noe
 
 	m_componentReflector = rhs.m_componentReflector;
 	m_componentType = rhs.m_componentType;
-	m_allocator = std::move(rhs.m_allocator);
-	m_keyLookup = std::move(rhs.m_keyLookup);
+	m_componentAlignment = rhs.m_componentAlignment;
+	m_componentSize = rhs.m_componentSize;
+	m_columns = std::move(rhs.m_columns);
+	m_slots = std::move(rhs.m_slots);
+	m_freeSlotIndices = std::move(rhs.m_freeSlotIndices);
+	m_slotIndices = std::move(rhs.m_slotIndices);
 	
 	return *this;
 }
@@ -52,56 +63,132 @@ void ECS::ComponentVector::Clear()
 	if (m_componentReflector != nullptr)
 	{
 		const auto& componentFunctions = m_componentReflector->FindComponentFunctions(m_componentType);
-		for (size_t i = 0, n = m_keyLookup.GetNumBuckets(); i < n; ++i)
+		for (const auto& slot : m_slots)
 		{
-			for (auto&& componentPtr : m_keyLookup.GetBucketViewAt(i).m_values)
+			if (slot.m_component != nullptr)
 			{
-				componentFunctions.m_destructorFunction(*componentPtr);
-				m_allocator.Free(componentPtr);
+				componentFunctions.m_destructorFunction(*slot.m_component);
+				m_columns[slot.m_columnIndex].m_allocator.Free(slot.m_component);
 			}
 		}
+		m_slots.Clear();
+		m_freeSlotIndices.Clear();
+		m_slotIndices.Clear();
 	}
 }
 
 ECS::Component* ECS::ComponentVector::Find(const ComponentID& key)
 {
-	const auto iter = m_keyLookup.Find(key);
-	return (iter != nullptr) ? *iter : nullptr;
+	// Implemented using the const variant.
+	return const_cast<Component*>(static_cast<const ComponentVector*>(this)->Find(key));
 }
 
 const ECS::Component* ECS::ComponentVector::Find(const ComponentID& key) const
 {
-	const auto iter = m_keyLookup.Find(key);
-	return (iter != nullptr) ? *iter : nullptr;
+	const uint32_t slotIndex = m_slotIndices.Find(key.GetUniqueID());
+	return (slotIndex != Collection::FlatIndexMap::k_invalidIndex) ? m_slots[slotIndex].m_component : nullptr;
+}
+
+ECS::Component* ECS::ComponentVector::Relocate(const ComponentID id, const ArchetypeID archetypeID)
+{
+	const uint32_t existingSlotIndex = m_slotIndices.Find(id.GetUniqueID());
+	if (existingSlotIndex == Collection::FlatIndexMap::k_invalidIndex)
+	{
+		return nullptr;
+	}
+	const Slot& existingSlot = m_slots[existingSlotIndex];
+	if (m_columns[existingSlot.m_columnIndex].m_archetypeID == archetypeID)
+	{
+		return existingSlot.m_component;
+	}
+
+	Slot oldSlot;
+	TryRemoveSlot(id, oldSlot);
+
+	// Construct a component in the new column, swap the old component's state into it, and destroy the old one.
+	const auto& componentFunctions = m_componentReflector->FindComponentFunctions(m_componentType);
+	Component& relocatedComponent = componentFunctions.m_basicConstructFunction(id, archetypeID, *this);
+	componentFunctions.m_swapFunction(relocatedComponent, *oldSlot.m_component);
+	DestroyAndFree(oldSlot);
+
+	return &relocatedComponent;
 }
 
 void ECS::ComponentVector::Remove(const ComponentID id)
 {
-	Component* component = nullptr;
-	if (!m_keyLookup.TryRemove(id, &component))
+	Slot slot;
+	if (!TryRemoveSlot(id, slot))
 	{
 		return;
 	}
 
-	m_componentReflector->DestroyComponent(*component);
-	m_allocator.Free(component);
+	DestroyAndFree(slot);
 }
 
 void ECS::ComponentVector::RemoveSorted(const Collection::ArrayView<const uint64_t> ids)
 {
-	const auto componentFunctions = m_componentReflector->FindComponentFunctions(m_componentType);
-
-	Component* component = nullptr;
 	for (auto&& componentIDValue : ids)
 	{
 		const ComponentID componentID{ m_componentType, componentIDValue };
-		Component* component = nullptr;
-		if (!m_keyLookup.TryRemove(componentID, &component))
+		Slot slot;
+		if (!TryRemoveSlot(componentID, slot))
 		{
 			return;
 		}
 
-		componentFunctions.m_destructorFunction(*component);
-		m_allocator.Free(component);
+		DestroyAndFree(slot);
+	}
+}
+
+uint32_t ECS::ComponentVector::FindOrAddColumn(const ArchetypeID archetypeID)
+{
+	// Components of recently added archetypes are the most likely to be created, so search from the back.
+	for (uint32_t i = m_columns.Size(); i > 0; --i)
+	{
+		if (m_columns[i - 1].m_archetypeID == archetypeID)
+		{
+			return i - 1;
+		}
 	}
+
+	m_columns.Emplace(archetypeID, Collection::LinearBlockAllocator(m_componentAlignment, m_componentSize));
+	return m_columns.Size() - 1;
+}
+
+void ECS::ComponentVector::AddSlot(const ComponentID id, const Slot& slot)
+{
+	uint32_t slotIndex;
+	if (!m_freeSlotIndices.IsEmpty())
+	{
+		slotIndex = m_freeSlotIndices.Back();
+		m_freeSlotIndices.RemoveLast();
+		m_slots[slotIndex] = slot;
+	}
+	else
+	{
+		slotIndex = m_slots.Size();
+		m_slots.Add(slot);
+	}
+	m_slotIndices.Set(id.GetUniqueID(), slotIndex);
+}
+
+bool ECS::ComponentVector::TryRemoveSlot(const ComponentID id, Slot& outSlot)
+{
+	const uint32_t slotIndex = m_slotIndices.Find(id.GetUniqueID());
+	if (slotIndex == Collection::FlatIndexMap::k_invalidIndex)
+	{
+		return false;
+	}
+
+	outSlot = m_slots[slotIndex];
+	m_slots[slotIndex] = Slot();
+	m_freeSlotIndices.Add(slotIndex);
+	m_slotIndices.Remove(id.GetUniqueID());
+	return true;
+}
+
+void ECS::ComponentVector::DestroyAndFree(const Slot& slot)
+{
+	m_componentReflector->DestroyComponent(*slot.m_component);
+	m_columns[slot.m_columnIndex].m_allocator.Free(slot.m_component);
 }
@@ -2,80 +2,147 @@
 
 #include <dev/Dev.h>
 
-#include <array>
+#include <algorithm>
 
-void ECS::ECSGroupVector::Add(const Collection::Vector<void*>& pointers)
+void ECS::ECSGroupVector::Add(const EntityID entityID, const Collection::Vector<void*>& pointers)
 {
 	AMP_FATAL_ASSERT(pointers.Size() == m_groupSize,
 		"Can only add ECS groups with the correct group size.");
-	
-	for (const auto& ptr : pointers)
+	AMP_FATAL_ASSERT(!Contains(entityID), "An entity can only have one ECS group in an ECS vector.");
+
+	m_groupIndices.Set(entityID.GetUniqueID(), m_entityIDs.Size());
+	m_entityIDs.Add(entityID);
+	m_data.AddAll(pointers.GetConstView());
+}
+
+bool ECS::ECSGroupVector::TryRemove(const EntityID entityID, Collection::Vector<void*>& outPointers)
+{
+	const uint32_t groupIndex = m_groupIndices.Find(entityID.GetUniqueID());
+	if (groupIndex == Collection::SparseIndexMap::k_invalidIndex)
+	{
+		return false;
+	}
+
+	const void* const* const group = m_data.begin() + (groupIndex * m_groupSize);
+	for (size_t i = 0; i < m_groupSize; ++i)
 	{
-		m_data.Add(ptr);
+		outPointers.Add(const_cast<void*>(group[i]));
 	}
+
+	// Leave a tombstone to be cleaned up by Compact().
+	m_groupIndices.Remove(entityID.GetUniqueID());
+	m_entityIDs[groupIndex] = EntityID();
+	++m_numRemovedGroups;
+
+	return true;
 }
 
-void ECS::ECSGroupVector::Remove(const Collection::Vector<void*>& pointers)
+bool ECS::ECSGroupVector::Contains(const EntityID entityID) const
 {
-	AMP_FATAL_ASSERT(pointers.Size() == m_groupSize,
-		"Can only remove ECS groups with the correct group size.");
+	return m_groupIndices.Find(entityID.GetUniqueID()) != Collection::SparseIndexMap::k_invalidIndex;
+}
 
-	for (auto iter = m_data.begin(), iterEnd = m_data.end(); iter < iterEnd; iter += m_groupSize)
+void ECS::ECSGroupVector::Compact()
+{
+	const uint32_t numGroups = m_entityIDs.Size();
+	if (m_numRemovedGroups == 0 && m_numSortedGroups == numGroups)
 	{
-		bool isMatch = true;
-		for (size_t i = 0, iEnd = m_groupSize; i < iEnd; ++i)
+		return;
+	}
+
+	// The first group whose index changes; the group indices only need to be updated from here on.
+	uint32_t firstChangedIndex = m_numSortedGroups;
+
+	// Remove the tombstones while preserving the order of the remaining groups.
+	uint32_t numLiveGroups = 0;
+	uint32_t numLiveSortedGroups = 0;
+	if (m_numRemovedGroups > 0)
+	{
+		for (uint32_t i = 0; i < numGroups; ++i)
 		{
-			if (iter[i] != pointers[i])
+			if (m_entityIDs[i] == EntityID())
 			{
-				isMatch = false;
-				break;
+				firstChangedIndex = std::min(firstChangedIndex, i);
+				continue;
 			}
-		}
 
-		if (isMatch)
-		{
-			const std::ptrdiff_t groupIndex = std::distance(m_data.begin(), iter);
-			m_data.Remove(groupIndex, groupIndex + m_groupSize);
-			return;
+			if (numLiveGroups != i)
+			{
+				m_entityIDs[numLiveGroups] = m_entityIDs[i];
+				std::copy_n(m_data.begin() + (i * m_groupSize), m_groupSize,
+					m_data.begin() + (numLiveGroups * m_groupSize));
+			}
+			if (i < m_numSortedGroups)
+			{
+				++numLiveSortedGroups;
+			}
+			++numLiveGroups;
 		}
+		m_entityIDs.Remove(numLiveGroups, m_entityIDs.Size());
+		m_data.Remove(numLiveGroups * m_groupSize, m_data.Size());
+	}
+	else
+	{
+		numLiveGroups = numGroups;
+		numLiveSortedGroups = m_numSortedGroups;
 	}
 
-	AMP_FATAL_ERROR("Failed to remove the given group.");
-}
-
-namespace Internal_ECSGroupVector
-{
-template <uint32_t GroupSize>
-void SortGroups(Collection::Vector<void*>& data, const uint32_t numGroups)
-{
-	using ArrayType = std::array<size_t, GroupSize>;
+	// Sort the added groups by their first pointer and merge them with the already sorted groups.
+	if (numLiveSortedGroups < numLiveGroups && m_groupSize > 0)
+	{
+		const auto compareGroups = [this](const uint32_t lhs, const uint32_t rhs)
+		{
+			return m_data[lhs * m_groupSize] < m_data[rhs * m_groupSize];
+		};
 
-	Collection::ArrayView<ArrayType> view{ reinterpret_cast<ArrayType*>(&data[0]), numGroups };
+		m_scratchOrder.Clear();
+		for (uint32_t i = 0; i < numLiveGroups; ++i)
+		{
+			m_scratchOrder.Add(i);
+		}
+		uint32_t* const sortedEnd = m_scratchOrder.begin() + numLiveSortedGroups;
+		std::sort(sortedEnd, m_scratchOrder.end(), compareGroups);
+		std::inplace_merge(m_scratchOrder.begin(), sortedEnd, m_scratchOrder.end(), compareGroups);
 
-	std::sort(view.begin(), view.end(), [](const ArrayType& lhs, const ArrayType& rhs)
-	{
-		return lhs[0] < rhs[0];
-	});
-}
-}
+		uint32_t firstMovedIndex = 0;
+		while (firstMovedIndex < numLiveGroups && m_scratchOrder[firstMovedIndex] == firstMovedIndex)
+		{
+			++firstMovedIndex;
+		}
 
-void ECS::ECSGroupVector::Sort()
-{
-	using namespace Internal_ECSGroupVector;
+		if (firstMovedIndex < numLiveGroups)
+		{
+			firstChangedIndex = std::min(firstChangedIndex, firstMovedIndex);
 
-	if (IsEmpty())
-	{
-		return;
+			m_scratchData.Clear();
+			m_scratchEntityIDs.Clear();
+			m_scratchData.EnsureCapacity(m_data.Size());
+			m_scratchEntityIDs.EnsureCapacity(numLiveGroups);
+			for (const auto& groupIndex : m_scratchOrder)
+			{
+				m_scratchEntityIDs.Add(m_entityIDs[groupIndex]);
+				m_scratchData.AddAll({ m_data.begin() + (groupIndex * m_groupSize), m_groupSize });
+			}
+			std::swap(m_data, m_scratchData);
+			std::swap(m_entityIDs, m_scratchEntityIDs);
+		}
 	}
 
-	switch (m_groupSize)
+	// Update the indices of the groups which moved.
+	for (uint32_t i = firstChangedIndex; i < numLiveGroups; ++i)
 	{
-	case 0: SortGroups<0>(m_data, Size()); break;
-	case 1: SortGroups<1>(m_data, Size()); break;
-	case 2: SortGroups<2>(m_data, Size()); break;
-	case 3: SortGroups<3>(m_data, Size()); break;
-	case 4: SortGroups<4>(m_data, Size()); break;
-	case 5: SortGroups<5>(m_data, Size()); break;
-	default: AMP_FATAL_ERROR("Encountered an ECS group with more elements than expected."); break;
+		m_groupIndices.Set(m_entityIDs[i].GetUniqueID(), i);
 	}
+
+	m_numSortedGroups = numLiveGroups;
+	m_numRemovedGroups = 0;
+}
+
+void ECS::ECSGroupVector::Clear()
+{
+	m_data.Clear();
+	m_entityIDs.Clear();
+	m_groupIndices.Clear();
+	m_numSortedGroups = 0;
+	m_numRemovedGroups = 0;
 }
@@ -11,129 +11,25 @@
 #include <collection/ArrayView.h>
 #include <mem/DeserializeLittleEndian.h>
 #include <mem/SerializeLittleEndian.h>
+#include <thread/JobSystem.h>
+#include <util/BitUtil.h>
 
 #include <algorithm>
-#include <execution>
+#include <thread>
 #include <set>
 
 namespace ECS
 {
 namespace Internal_EntityManager
 {
-// TODO(network) this should live in SerializedEntitiesAndComponents to consolidate all the serialization and
-//               deserialization code
-void FullySerializeEntitiesAndComponents(
-	const ECS::ComponentReflector& componentReflector,
-	const ECS::EntityManager& entityManager,
-	Collection::Vector<const Entity*>& entities,
-	SerializedEntitiesAndComponents& serialization)
-{
-	// Sort the components to serialize by type and ID.
-	struct ComponentIDWithPointer
-	{
-		uint64_t m_id;
-		const Component* m_component;
-	};
-	Collection::VectorMap<ComponentType, Collection::Vector<ComponentIDWithPointer>> componentsToSerializeByType;
-	for (const auto& entity : entities)
-	{
-		for (const auto& componentID : entity->GetComponentIDs())
-		{
-			const Component* const component = entityManager.FindComponent(componentID);
-			componentsToSerializeByType[componentID.GetType()].Add({ componentID.GetUniqueID(), component });
-		}
-	}
-
-	for (auto& entry : componentsToSerializeByType)
-	{
-		Collection::Vector<ComponentIDWithPointer>& components = entry.second;
-		std::sort(components.begin(), components.end(),
-			[](const auto& lhs, const auto& rhs) { return lhs.m_id < rhs.m_id; });
-	}
-
-	// Serialize the component data.
-	for (const auto& entry : componentsToSerializeByType)
-	{
-		const ComponentType componentType = entry.first;
-		const auto& components = entry.second;
-
-		const auto componentFunctions = componentReflector.FindComponentFunctions(componentType);
-
-		auto& componentBytesAndViews = serialization.FindOrCreateComponentsEntry(componentType);
-		auto& componentBytes = componentBytesAndViews.m_bytes;
-		auto& componentViews = componentBytesAndViews.m_views;
-
-		for (const auto& componentIDWithPointer : components)
-		{
-			const Component& component = *componentIDWithPointer.m_component;
-			const uint32_t componentViewBeginIndex = componentBytes.Size();
-
-			FullSerializedComponentHeader componentHeader;
-			componentHeader.m_uniqueID = component.m_id.GetUniqueID();
-
-			componentBytes.Resize(componentBytes.Size() + FullSerializedComponentHeader::k_unpaddedSize);
-			memcpy(componentBytes.begin() + componentViewBeginIndex,
-				&componentHeader,
-				FullSerializedComponentHeader::k_unpaddedSize);
-
-			componentFunctions.m_fullSerializationFunction(component, componentBytes);
-
-			componentViews.Add({ componentViewBeginIndex, componentBytes.Size() });
-		}
-	}
-
-	// Sort the entities by ID.
-	std::sort(entities.begin(), entities.end(),
-		[](const auto& lhs, const auto& rhs) { return lhs->GetID() < rhs->GetID(); });
-
-	// Serialize the entity data.
-	for (const auto& entity : entities)
-	{
-		FullSerializedEntityHeader entityHeader;
-		entityHeader.m_entityID = entity->GetID();
-
-		// We serialize the parent ID but not the child IDs because the child list will be reconstructed by the
-		// children of this entity.
-		if (entity->GetParent() != nullptr)
-		{
-			entityHeader.m_parentEntityID = entity->GetParent()->GetID();
-		}
-		entityHeader.m_numComponents = entity->GetComponentIDs().Size();
-		entityHeader.m_flags = entity->GetFlags();
-		entityHeader.m_layer = entity->GetLayer();
-
-		const size_t numRequiredBytes =
-			FullSerializedEntityHeader::k_unpaddedSize + (entityHeader.m_numComponents * sizeof(ComponentID));
-
-		const uint32_t entityByteIndex = serialization.m_entities.m_bytes.Size();
-		serialization.m_entities.m_bytes.EnsureCapacity(entityByteIndex + static_cast<uint32_t>(numRequiredBytes));
-		serialization.m_entities.m_bytes.Resize(entityByteIndex + FullSerializedEntityHeader::k_unpaddedSize);
-		memcpy(
-			&serialization.m_entities.m_bytes[entityByteIndex],
-			&entityHeader,
-			FullSerializedEntityHeader::k_unpaddedSize);
+// The number of component type indices which have a bit in an entity's component type mask.
+constexpr uint32_t k_numMaskedTypeIndices = 64;
 
-		for (const auto& componentID : entity->GetComponentIDs())
-		{
-			uint16_t componentTypeIndex = UINT16_MAX;
-			for (size_t i = 0, iEnd = serialization.m_components.Size(); i < iEnd; ++i)
-			{
-				if (serialization.m_components[i].first == componentID.GetType())
-				{
-					componentTypeIndex = static_cast<uint16_t>(i);
-					break;
-				}
-			}
-			AMP_FATAL_ASSERT(componentTypeIndex != UINT16_MAX,
-				"Under no circumstances should we fail to find a component type index!");
-
-			Mem::LittleEndian::Serialize(componentTypeIndex, serialization.m_entities.m_bytes);
-			Mem::LittleEndian::Serialize(componentID.GetUniqueID(), serialization.m_entities.m_bytes);
-		}
+// The number of bytes each component ID of a serialized entity takes: a component type index and a unique ID.
+constexpr uint32_t k_numSerializedComponentIDBytes = sizeof(uint16_t) + sizeof(uint64_t);
 
-		serialization.m_entities.m_views.Add({ entityByteIndex, serialization.m_entities.m_bytes.Size() });
-	}
-}
+// Serializations with fewer components than this aren't worth the overhead of the job system.
+constexpr uint32_t k_minNumComponentsToSerializeInParallel = 256;
 
 void ReconstructComponentIDs(
 	const SerializedEntitiesAndComponents& serialization,
@@ -164,16 +60,173 @@ void ReconstructComponentIDs(
 		outIDs[i] = ComponentID(componentType, componentUniqueID);
 	}
 }
+
+// Serialize a component's header and, unless it's a tag component, its data.
+void SerializeComponent(
+	const ComponentReflector::MandatoryComponentFunctions& componentFunctions,
+	const uint64_t uniqueID,
+	const Component* const component,
+	Collection::Vector<uint8_t>& outBytes)
+{
+	FullSerializedComponentHeader componentHeader;
+	componentHeader.m_uniqueID = uniqueID;
+
+	const uint32_t headerIndex = outBytes.Size();
+	outBytes.Resize(headerIndex + FullSerializedComponentHeader::k_unpaddedSize);
+	memcpy(outBytes.begin() + headerIndex, &componentHeader, FullSerializedComponentHeader::k_unpaddedSize);
+
+	// Tag components are never instantiated, so they are serialized as just their header.
+	if (component != nullptr)
+	{
+		componentFunctions.m_fullSerializationFunction(*component, outBytes);
+	}
+}
+
+uint64_t GetIDFromHeader(const FullSerializedComponentHeader& header)
+{
+	return header.m_uniqueID;
+}
+
+uint64_t GetIDFromHeader(const FullSerializedEntityHeader& header)
+{
+	return header.m_entityID.GetUniqueID();
+}
+
+template <typename HeaderType>
+uint64_t GetSerializedElementID(const SerializedBytesWithViews& elements, const uint32_t elementIndex)
+{
+	HeaderType header;
+	memcpy(&header, &elements.m_bytes[elements.m_views[elementIndex].m_beginIndex], HeaderType::k_unpaddedSize);
+	return GetIDFromHeader(header);
+}
+
+// Find the index of the first element at or after beginIndex with an ID that isn't less than the given ID.
+template <typename HeaderType>
+uint32_t FindLowerBoundOfSerializedID(
+	const SerializedBytesWithViews& elements, const uint32_t beginIndex, const uint64_t id)
+{
+	uint32_t lowIndex = beginIndex;
+	uint32_t highIndex = elements.m_views.Size();
+	while (lowIndex < highIndex)
+	{
+		const uint32_t midIndex = lowIndex + ((highIndex - lowIndex) / 2);
+		if (GetSerializedElementID<HeaderType>(elements, midIndex) < id)
+		{
+			lowIndex = midIndex + 1;
+		}
+		else
+		{
+			highIndex = midIndex;
+		}
+	}
+	return lowIndex;
+}
+
+// Copy the elements in [beginIndex, endIndex) to the end of outElements. The elements of a serialization are stored
+// contiguously in the order of their views, so a run of them is copied at once.
+void CopySerializedElements(
+	const SerializedBytesWithViews& elements,
+	const uint32_t beginIndex,
+	const uint32_t endIndex,
+	SerializedBytesWithViews& outElements)
+{
+	if (beginIndex == endIndex)
+	{
+		return;
+	}
+
+	const uint32_t bytesBeginIndex = elements.m_views[beginIndex].m_beginIndex;
+	const uint32_t bytesEndIndex = elements.m_views[endIndex - 1].m_endIndex;
+	const uint32_t outBytesBeginIndex = outElements.m_bytes.Size();
+	outElements.m_bytes.AddAll({ &elements.m_bytes[bytesBeginIndex], bytesEndIndex - bytesBeginIndex });
+
+	for (uint32_t i = beginIndex; i < endIndex; ++i)
+	{
+		const SerializedByteView& view = elements.m_views[i];
+		outElements.m_views.Add({ view.m_beginIndex - bytesBeginIndex + outBytesBeginIndex,
+			view.m_endIndex - bytesBeginIndex + outBytesBeginIndex });
+	}
+}
+
+bool AreSerializedElementsEqual(
+	const SerializedBytesWithViews& lhsElements, const uint32_t lhsIndex,
+	const SerializedBytesWithViews& rhsElements, const uint32_t rhsIndex)
+{
+	const SerializedByteView& lhsView = lhsElements.m_views[lhsIndex];
+	const SerializedByteView& rhsView = rhsElements.m_views[rhsIndex];
+	const uint32_t numBytes = lhsView.m_endIndex - lhsView.m_beginIndex;
+	return (numBytes == (rhsView.m_endIndex - rhsView.m_beginIndex))
+		&& memcmp(&lhsElements.m_bytes[lhsView.m_beginIndex], &rhsElements.m_bytes[rhsView.m_beginIndex], numBytes)
+			== 0;
+}
+
+// Maps the unique IDs of serialized components to the archetypes of the serialized entities that reference them
+// so that components can be allocated in the correct archetype before their entities are created.
+class SerializedComponentArchetypes final
+{
+public:
+	void Build(ArchetypeRegistry& archetypeRegistry, const SerializedEntitiesAndComponents& serialization)
+	{
+		Collection::Vector<ComponentID> componentIDs;
+		for (const auto& entityView : serialization.m_entities.m_views)
+		{
+			const uint8_t* const viewBytes = &serialization.m_entities.m_bytes[entityView.m_beginIndex];
+			const size_t viewSizeInBytes = (entityView.m_endIndex - entityView.m_beginIndex);
+
+			FullSerializedEntityHeader header;
+			memcpy(&header, viewBytes, FullSerializedEntityHeader::k_unpaddedSize);
+
+			const size_t numComponentIDBytes = header.m_numComponents * k_numSerializedComponentIDBytes;
+			if ((numComponentIDBytes + FullSerializedEntityHeader::k_unpaddedSize) > viewSizeInBytes)
+			{
+				continue;
+			}
+
+			componentIDs.Clear();
+			ReconstructComponentIDs(
+				serialization,
+				header.m_numComponents,
+				viewBytes + FullSerializedEntityHeader::k_unpaddedSize,
+				viewBytes + viewSizeInBytes,
+				componentIDs);
+
+			const ArchetypeID archetypeID = archetypeRegistry.FindOrAddArchetype(componentIDs.GetConstView());
+			for (const auto& componentID : componentIDs)
+			{
+				m_entries.Add({ componentID.GetUniqueID(), archetypeID });
+			}
+		}
+
+		std::sort(m_entries.begin(), m_entries.end(),
+			[](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+	}
+
+	ArchetypeID Find(const uint64_t componentUniqueID) const
+	{
+		const auto* const iter = std::lower_bound(m_entries.begin(), m_entries.end(), componentUniqueID,
+			[](const auto& entry, const uint64_t value) { return entry.first < value; });
+		if (iter == m_entries.end() || iter->first != componentUniqueID)
+		{
+			return ArchetypeID();
+		}
+		return iter->second;
+	}
+
+private:
+	Collection::Vector<Collection::Pair<uint64_t, ArchetypeID>> m_entries;
+};
 }
 
 EntityManager::EntityManager(
 	Asset::AssetManager& assetManager,
 	const ComponentReflector& componentReflector,
 	const EntityID firstEntityID,
-	const uint64_t firstComponentID)
+	const uint64_t firstComponentID,
+	const ComponentStorageMode storageMode)
 	: m_assetManager(assetManager)
 	, m_componentReflector(componentReflector)
 	, m_entities(EntityIDHashFunctor(), 7)
+	, m_storageMode(storageMode)
 	, m_nextEntityID(firstEntityID)
 	, m_nextComponentID(firstComponentID)
 {
@@ -182,14 +235,11 @@ EntityManager::EntityManager(
 EntityManager::~EntityManager()
 {
 	// Allow this EntityManager's systems to clean up using it.
-	for (auto& group : m_concurrentSystemGroups)
+	for (auto& registeredSystem : m_systems)
 	{
-		for (auto& registeredSystem : group.m_systems)
-		{
-			registeredSystem.m_system->NotifyOfShutdown(*this);
-		}
+		registeredSystem.m_system->NotifyOfShutdown(*this);
 	}
-	m_concurrentSystemGroups.Clear();
+	m_systems.Clear();
 }
 
 
@@ -198,6 +248,21 @@ Entity& EntityManager::CreateEntityWithComponents(
 	const EntityFlags flags,
 	const EntityLayer layer,
 	const EntityID requestedID)
+{
+	Entity& entity = EmplaceEntityWithComponents(componentTypes, flags, layer, requestedID);
+
+	// Add the entity to the system execution groups.
+	AddECSPointersToSystems(entity);
+
+	// Return the entity after it is fully initialized.
+	return entity;
+}
+
+Entity& EntityManager::EmplaceEntityWithComponents(
+	const Collection::ArrayView<const ComponentType>& componentTypes,
+	const EntityFlags flags,
+	const EntityLayer layer,
+	const EntityID requestedID)
 {
 	// Determine the entity's ID.
 	EntityID entityID;
@@ -217,21 +282,20 @@ Entity& EntityManager::CreateEntityWithComponents(
 
 	// Create the entity.
 	Entity& entity = m_entities.Emplace(entityID, entityID);
+	RecordEntityChange(entityID);
 
-	// Set the entity's flags and layer.
+	// Set the entity's flags, layer, and archetype.
 	entity.m_flags = flags;
 	entity.m_layer = layer;
+	entity.m_archetypeID = ResolveArchetype(componentTypes);
 
 	// Create the entity's components.
 	for (const auto& componentType : componentTypes)
 	{
 		AddComponentToEntity(componentType, entity);
 	}
+	IndexComponentIDsOfEntity(entity);
 
-	// Add the entity to the system execution groups.
-	AddECSPointersToSystems(entity);
-
-	// Return the entity after it is fully initialized.
 	return entity;
 }
 
@@ -240,6 +304,12 @@ Collection::Vector<Entity*> EntityManager::CreateEntitiesFromFullSerialization(
 {
 	using namespace Internal_EntityManager;
 
+	SerializedComponentArchetypes componentArchetypes;
+	if (m_storageMode == ComponentStorageMode::Archetype)
+	{
+		componentArchetypes.Build(m_archetypeRegistry, serialization);
+	}
+
 	// Create all serialized components.
 	for (const auto& entry : serialization.m_components)
 	{
@@ -263,7 +333,8 @@ Collection::Vector<Entity*> EntityManager::CreateEntitiesFromFullSerialization(
 			const uint8_t* componentBegin = viewBytes + FullSerializedComponentHeader::k_unpaddedSize;
 			const uint8_t* const componentEnd = viewBytes + componentView.m_endIndex;
 
-			Component& component = componentFunctions.m_basicConstructFunction(componentID, *componentVector);
+			Component& component = componentFunctions.m_basicConstructFunction(
+				componentID, componentArchetypes.Find(header.m_uniqueID), *componentVector);
 			componentFunctions.m_applyFullSerializationFunction(
 				m_assetManager, component, componentBegin, componentEnd);
 		}
@@ -301,10 +372,13 @@ Collection::Vector<Entity*> EntityManager::CreateEntitiesFromFullSerialization(
 		// TODO(ecs) handle entity IDs which are already in use, perhaps with a fixup map
 
 		Entity& entity = m_entities.Emplace(header.m_entityID, header.m_entityID);
+		RecordEntityChange(header.m_entityID);
 		entity.m_componentIDs = std::move(componentIDs);
+		IndexComponentIDsOfEntity(entity);
 
 		entity.m_flags = header.m_flags;
 		entity.m_layer = header.m_layer;
+		entity.m_archetypeID = ResolveArchetype(entity.m_componentIDs.GetConstView());
 
 		Entity* const parentEntity = FindEntity(header.m_parentEntityID);
 		SetParentEntity(entity, parentEntity);
@@ -322,6 +396,12 @@ void EntityManager::SetNetworkedEntitiesToFullSerialization(const SerializedEnti
 {
 	using namespace Internal_EntityManager;
 
+	SerializedComponentArchetypes componentArchetypes;
+	if (m_storageMode == ComponentStorageMode::Archetype)
+	{
+		componentArchetypes.Build(m_archetypeRegistry, serialization);
+	}
+
 	// Create or apply the serialized components.
 	for (const auto& entry : serialization.m_components)
 	{
@@ -348,7 +428,8 @@ void EntityManager::SetNetworkedEntitiesToFullSerialization(const SerializedEnti
 			Component* component = FindComponent(componentID);
 			if (component == nullptr)
 			{
-				component = &componentFunctions.m_basicConstructFunction(componentID, *componentVector);
+				component = &componentFunctions.m_basicConstructFunction(
+					componentID, componentArchetypes.Find(header.m_uniqueID), *componentVector);
 			}
 			componentFunctions.m_applyFullSerializationFunction(
 				m_assetManager, *component, componentBegin, componentEnd);
@@ -366,7 +447,7 @@ void EntityManager::SetNetworkedEntitiesToFullSerialization(const SerializedEnti
 		FullSerializedEntityHeader header;
 		memcpy(&header, viewBytes, FullSerializedEntityHeader::k_unpaddedSize);
 
-		const size_t numComponentIDBytes = header.m_numComponents * (sizeof(uint16_t) + sizeof(uint64_t));
+		const size_t numComponentIDBytes = header.m_numComponents * k_numSerializedComponentIDBytes;
 		if ((numComponentIDBytes + FullSerializedEntityHeader::k_unpaddedSize) > viewSizeInBytes)
 		{
 			AMP_LOG_WARNING("Serialized entity view isn't large enough for all its component IDs.");
@@ -385,18 +466,32 @@ void EntityManager::SetNetworkedEntitiesToFullSerialization(const SerializedEnti
 			serializedComponentListEnd,
 			reconstructedComponentIDs);
 
+		// Sort the reconstructed IDs so that they can be compared to the entity's sorted IDs.
+		SortComponentIDsByTypeIndex(reconstructedComponentIDs);
+
 		Entity* entity = FindEntity(header.m_entityID);
 		if (entity == nullptr)
 		{
 			// Create the entity with the serialized components.
 			entity = &m_entities.Emplace(header.m_entityID, header.m_entityID);
+			RecordEntityChange(header.m_entityID);
 			entity->m_componentIDs = reconstructedComponentIDs;
+			IndexComponentIDsOfEntity(*entity);
+			entity->m_archetypeID = ResolveArchetype(entity->m_componentIDs.GetConstView());
 			entitiesToAddToSystems.Add(entity);
 		}
 		else if (entity->m_componentIDs != reconstructedComponentIDs)
 		{
 			// When the entity's components change, it needs to be refreshed in the system execution groups.
 			RemoveECSPointersFromSystems(*entity);
+			RecordEntityChange(entity->GetID());
+			entity->m_componentIDs = reconstructedComponentIDs;
+			IndexComponentIDsOfEntity(*entity);
+
+			// Its components also move to the storage of its new archetype.
+			entity->m_archetypeID = ResolveArchetype(entity->m_componentIDs.GetConstView());
+			RelocateComponentsToArchetype(*entity);
+
 			entitiesToAddToSystems.Add(entity);
 		}
 
@@ -434,147 +529,808 @@ void EntityManager::SetNetworkedEntitiesToFullSerialization(const SerializedEnti
 	}
 }
 
+void EntityManager::ApplyFullSerializationToExistingComponents(const SerializedEntitiesAndComponents& serialization)
+{
+	for (const auto& entry : serialization.m_components)
+	{
+		if (GetComponentVector(entry.first) == nullptr)
+		{
+			continue;
+		}
+
+		// Tag components have no state to apply.
+		const auto componentFunctions = m_componentReflector.FindComponentFunctions(entry.first);
+		if (componentFunctions.m_applyFullSerializationFunction == nullptr)
+		{
+			continue;
+		}
+
+		for (const auto& componentView : entry.second.m_views)
+		{
+			const uint8_t* const viewBytes = &entry.second.m_bytes[componentView.m_beginIndex];
+
+			FullSerializedComponentHeader header;
+			memcpy(&header, viewBytes, FullSerializedComponentHeader::k_unpaddedSize);
+
+			Component* const component = FindComponent(ComponentID{ entry.first, header.m_uniqueID });
+			if (component == nullptr)
+			{
+				continue;
+			}
+
+			const uint8_t* componentBegin = viewBytes + FullSerializedComponentHeader::k_unpaddedSize;
+			const uint8_t* const componentEnd = viewBytes + componentView.m_endIndex;
+			componentFunctions.m_applyFullSerializationFunction(
+				m_assetManager, *component, componentBegin, componentEnd);
+		}
+	}
+}
+
 void EntityManager::FullySerializeEntitiesAndComponents(
 	const Collection::ArrayView<const Entity*>& entities,
 	SerializedEntitiesAndComponents& serialization) const
 {
-	auto entitiesCopy = Collection::Vector<const Entity*>(static_cast<uint32_t>(entities.Size()));
-	entitiesCopy.AddAll(entities);
+	std::unique_lock<std::mutex> lock{ m_fullSerializationScratch.m_mutex };
+
+	Collection::Vector<const Entity*>& entitiesToSerialize = m_fullSerializationScratch.m_entities;
+	entitiesToSerialize.Clear();
+	entitiesToSerialize.AddAll(entities);
 
-	Internal_EntityManager::FullySerializeEntitiesAndComponents(
-		m_componentReflector, *this, entitiesCopy, serialization);
+	FullySerializeScratchEntities(serialization);
 }
 
 void EntityManager::FullySerializeAllEntitiesAndComponentsMatchingFilter(
 	const std::function<bool(const Entity&)>& filter,
 	SerializedEntitiesAndComponents& serialization) const
 {
-	Collection::Vector<const Entity*> entitiesInLayer;
+	std::unique_lock<std::mutex> lock{ m_fullSerializationScratch.m_mutex };
+
+	Collection::Vector<const Entity*>& entitiesToSerialize = m_fullSerializationScratch.m_entities;
+	entitiesToSerialize.Clear();
 	for (const auto& entity : m_entities.GetValueView())
 	{
 		if (filter(*entity))
 		{
-			entitiesInLayer.Add(entity);
+			entitiesToSerialize.Add(entity);
 		}
 	}
 
-	Internal_EntityManager::FullySerializeEntitiesAndComponents(
-		m_componentReflector, *this, entitiesInLayer, serialization);
+	FullySerializeScratchEntities(serialization);
 }
 
-void EntityManager::SetParentEntity(Entity& entity, Entity* parentEntity)
+// TODO(network) this should live in SerializedEntitiesAndComponents to consolidate all the serialization and
+//               deserialization code
+void EntityManager::FullySerializeScratchEntities(SerializedEntitiesAndComponents& serialization) const
 {
-	// Detach the entity from its existing parent, if it has one.
-	if (entity.m_parent != nullptr)
-	{
-		Entity& parent = *entity.m_parent;
-		const size_t indexInParent = parent.m_children.IndexOf(&entity);
-		parent.m_children.SwapWithAndRemoveLast(indexInParent);
-	}
+	using namespace Internal_EntityManager;
 
-	// Attach the entity to the given parent.
-	entity.m_parent = parentEntity;
-	if (parentEntity != nullptr)
+	FullSerializationScratch& scratch = m_fullSerializationScratch;
+
+	// Group the components to serialize by type index. The groups keep their memory between serializations.
+	const uint32_t numComponentTypes = m_componentReflector.GetNumComponentTypes();
+	while (scratch.m_componentsByTypeIndex.Size() < numComponentTypes)
 	{
-		parentEntity->m_children.Add(&entity);
+		scratch.m_componentsByTypeIndex.Emplace();
+		scratch.m_serializedTypeIndices.Add(UINT16_MAX);
+		scratch.m_lastNumBytesByTypeIndex.Add(0);
 	}
-}
+	scratch.m_typesToSerialize.Clear();
 
-void EntityManager::DeleteEntities(const Collection::ArrayView<const EntityID>& entitiesToDelete)
-{
-	// Detach the entities from their parents and delete the entities.
-	// Recursively traverse their children to delete them as well.
-	Collection::Vector<Entity*> allEntitiesToDelete;
-	for (const auto& entityID : entitiesToDelete)
+	uint32_t numComponents = 0;
+	uint32_t numEntityBytes = 0;
+	for (const auto& entity : scratch.m_entities)
 	{
-		Entity* const entity = m_entities.Find(entityID);
-		if (entity == nullptr)
+		const Collection::Vector<ComponentID>& componentIDs = entity->GetComponentIDs();
+		numComponents += componentIDs.Size();
+		numEntityBytes += FullSerializedEntityHeader::k_unpaddedSize
+			+ (componentIDs.Size() * k_numSerializedComponentIDBytes);
+
+		for (const auto& componentID : componentIDs)
 		{
-			continue;
+			const uint32_t typeIndex = m_componentReflector.FindTypeIndex(componentID.GetType());
+			AMP_FATAL_ASSERT(typeIndex != ComponentReflector::k_invalidTypeIndex,
+				"Cannot serialize a component of an unregistered type.");
+
+			auto& components = scratch.m_componentsByTypeIndex[typeIndex];
+			if (components.IsEmpty())
+			{
+				scratch.m_typesToSerialize.Add({ componentID.GetType(), typeIndex });
+			}
+			components.Add({ componentID.GetUniqueID(), FindComponent(componentID) });
 		}
+	}
 
-		if (entity->m_parent != nullptr)
+	// Find or create the entries of the types in the serialization in type order before any job runs so that the
+	// entries don't move while the jobs write to them.
+	std::sort(scratch.m_typesToSerialize.begin(), scratch.m_typesToSerialize.end(),
+		[](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+	for (const auto& entry : scratch.m_typesToSerialize)
+	{
+		size_t serializedTypeIndex = serialization.m_components.IndexOf([&](const auto& componentsEntry)
+			{
+				return componentsEntry.first == entry.first;
+			});
+		if (serializedTypeIndex == decltype(serialization.m_components)::sk_InvalidIndex)
 		{
-			Entity& parent = *entity->m_parent;
-			const size_t indexInParent = parent.m_children.IndexOf(entity);
-			parent.m_children.SwapWithAndRemoveLast(indexInParent);
+			serializedTypeIndex = serialization.m_components.Size();
+			serialization.m_components.Emplace(entry.first, SerializedBytesWithViews());
 		}
-		allEntitiesToDelete.Add(entity);
+		AMP_FATAL_ASSERT(serializedTypeIndex < UINT16_MAX, "Too many component types to serialize.");
+		scratch.m_serializedTypeIndices[entry.second] = static_cast<uint16_t>(serializedTypeIndex);
 	}
 
-	while (!allEntitiesToDelete.IsEmpty())
+	// Serialize the components of each type in their own job and the entities in one more job.
+	struct SerializationContext
 	{
-		Entity& entity = *allEntitiesToDelete.Back();
-		allEntitiesToDelete.RemoveLast();
+		const EntityManager& m_entityManager;
+		FullSerializationScratch& m_scratch;
+		SerializedEntitiesAndComponents& m_serialization;
+		uint32_t m_numEntityBytes;
 
-		// Queue the children not already in entitiesToDelete for removal.
-		for (const auto& child : entity.m_children)
+		static void RunJob(void* rawContext, const uint32_t jobIndex)
 		{
-			bool shouldQueue = true;
-			for (const auto& requestedID : entitiesToDelete)
+			SerializationContext& context = *static_cast<SerializationContext*>(rawContext);
+			if (jobIndex < context.m_scratch.m_typesToSerialize.Size())
 			{
-				if (child->m_id == requestedID)
-				{
-					shouldQueue = false;
-					break;
-				}
+				context.m_entityManager.FullySerializeScratchComponentsOfType(
+					context.m_scratch.m_typesToSerialize[jobIndex].second, context.m_serialization);
 			}
-			if (shouldQueue)
+			else
 			{
-				allEntitiesToDelete.Add(child);
+				context.m_entityManager.FullySerializeScratchEntityHeaders(
+					context.m_numEntityBytes, context.m_serialization);
 			}
 		}
+	};
 
-		// Delete the entity.
-		RemoveECSPointersFromSystems(entity);
-
-		for (const auto& componentID : entity.GetComponentIDs())
+	SerializationContext context{ *this, scratch, serialization, numEntityBytes };
+	const uint32_t numJobs = scratch.m_typesToSerialize.Size() + 1;
+	if (numComponents < k_minNumComponentsToSerializeInParallel)
+	{
+		for (uint32_t i = 0; i < numJobs; ++i)
 		{
-			RemoveComponent(componentID);
+			SerializationContext::RunJob(&context, i);
 		}
-		m_entities.TryRemove(entity.GetID());
+	}
+	else
+	{
+		Thread::JobSystem& jobSystem = Thread::JobSystem::GetEngineJobSystem();
+		Thread::JobCounter counter;
+		jobSystem.Submit(&SerializationContext::RunJob, &context, numJobs, counter);
+		jobSystem.Wait(counter);
 	}
 }
 
-Entity* EntityManager::FindEntity(const EntityID id)
+void EntityManager::FullySerializeScratchComponentsOfType(
+	const uint32_t typeIndex,
+	SerializedEntitiesAndComponents& serialization) const
 {
-	return m_entities.Find(id);
-}
+	FullSerializationScratch& scratch = m_fullSerializationScratch;
 
-const Entity* EntityManager::FindEntity(const EntityID id) const
-{
-	return m_entities.Find(id);
-}
+	// Sort the components to serialize by ID.
+	auto& components = scratch.m_componentsByTypeIndex[typeIndex];
+	std::sort(components.begin(), components.end(),
+		[](const auto& lhs, const auto& rhs) { return lhs.m_uniqueID < rhs.m_uniqueID; });
 
-Component* EntityManager::FindComponent(const ComponentID id)
-{
-	// Implemented using the const variant.
-	return const_cast<Component*>(static_cast<const EntityManager*>(this)->FindComponent(id));
+	const ComponentType componentType = serialization.m_components[scratch.m_serializedTypeIndices[typeIndex]].first;
+	const auto componentFunctions = m_componentReflector.FindComponentFunctions(componentType);
+
+	auto& componentBytesAndViews = serialization.m_components[scratch.m_serializedTypeIndices[typeIndex]].second;
+	auto& componentBytes = componentBytesAndViews.m_bytes;
+	auto& componentViews = componentBytesAndViews.m_views;
+
+	// Components usually serialize to about as many bytes as they did in the last serialization.
+	const uint32_t componentBytesBeginIndex = componentBytes.Size();
+	componentBytes.EnsureCapacity(componentBytesBeginIndex + scratch.m_lastNumBytesByTypeIndex[typeIndex]);
+	componentViews.EnsureCapacity(componentViews.Size() + components.Size());
+
+	// Serialize the component data.
+	for (const auto& componentToSerialize : components)
+	{
+		const uint32_t componentViewBeginIndex = componentBytes.Size();
+		Internal_EntityManager::SerializeComponent(
+			componentFunctions, componentToSerialize.m_uniqueID, componentToSerialize.m_component, componentBytes);
+		componentViews.Add({ componentViewBeginIndex, componentBytes.Size() });
+	}
+
+	scratch.m_lastNumBytesByTypeIndex[typeIndex] = componentBytes.Size() - componentBytesBeginIndex;
+	components.Clear();
 }
 
-const Component* EntityManager::FindComponent(const ComponentID id) const
+void EntityManager::FullySerializeScratchEntityHeaders(
+	const uint32_t numEntityBytes,
+	SerializedEntitiesAndComponents& serialization) const
 {
-	const Collection::Pair<const ComponentType, ComponentVector>* const componentsEntry =
-		m_components.Find(id.GetType());
-	if (componentsEntry == m_components.end())
+	const FullSerializationScratch& scratch = m_fullSerializationScratch;
+	Collection::Vector<const Entity*>& entities = m_fullSerializationScratch.m_entities;
+
+	// Sort the entities by ID.
+	std::sort(entities.begin(), entities.end(),
+		[](const auto& lhs, const auto& rhs) { return lhs->GetID() < rhs->GetID(); });
+
+	auto& entityBytes = serialization.m_entities.m_bytes;
+	auto& entityViews = serialization.m_entities.m_views;
+	entityBytes.EnsureCapacity(entityBytes.Size() + numEntityBytes);
+	entityViews.EnsureCapacity(entityViews.Size() + entities.Size());
+
+	// Serialize the entity data.
+	for (const auto& entity : entities)
 	{
-		return nullptr;
+		const uint32_t entityByteIndex = entityBytes.Size();
+		SerializeEntity(*entity, scratch.m_serializedTypeIndices, entityBytes);
+		entityViews.Add({ entityByteIndex, entityBytes.Size() });
 	}
-	const ComponentVector& components = componentsEntry->second;
-	return components.Find(id);
 }
 
-ComponentVector* EntityManager::GetComponentVector(const ComponentType componentType)
+void EntityManager::SerializeEntity(const Entity& entity,
+	const Collection::Vector<uint16_t>& serializedTypeIndices,
+	Collection::Vector<uint8_t>& outBytes) const
 {
-	// Components with size 0 are tag components and are never instantiated.
-	const Unit::ByteCount64 componentSize = m_componentReflector.GetSizeOfComponentInBytes(componentType);
-	if (componentSize.GetN() == 0)
+	FullSerializedEntityHeader entityHeader;
+	entityHeader.m_entityID = entity.GetID();
+
+	// We serialize the parent ID but not the child IDs because the child list will be reconstructed by the
+	// children of this entity.
+	if (entity.GetParent() != nullptr)
 	{
-		return nullptr;
+		entityHeader.m_parentEntityID = entity.GetParent()->GetID();
 	}
+	entityHeader.m_numComponents = entity.GetComponentIDs().Size();
+	entityHeader.m_flags = entity.GetFlags();
+	entityHeader.m_layer = entity.GetLayer();
 
-	ComponentVector& componentVector = m_components[componentType];
-	if (componentVector.GetComponentType() == ComponentType())
+	const uint32_t entityByteIndex = outBytes.Size();
+	outBytes.Resize(entityByteIndex + FullSerializedEntityHeader::k_unpaddedSize);
+	memcpy(&outBytes[entityByteIndex], &entityHeader, FullSerializedEntityHeader::k_unpaddedSize);
+
+	for (const auto& componentID : entity.GetComponentIDs())
+	{
+		// Component type indices are the indices of the types in the serialization, not dense type indices.
+		const uint32_t typeIndex = m_componentReflector.FindTypeIndex(componentID.GetType());
+		const uint16_t componentTypeIndex = serializedTypeIndices[typeIndex];
+
+		Mem::LittleEndian::Serialize(componentTypeIndex, outBytes);
+		Mem::LittleEndian::Serialize(componentID.GetUniqueID(), outBytes);
+	}
+}
+
+void EntityManager::SerializeChangesOfEntitiesMatchingFilter(
+	const std::function<bool(const Entity&)>& filter,
+	const SerializedEntitiesAndComponents& previousSerialization,
+	SerializedEntitiesAndComponents& serialization,
+	SerializedChanges& outChanges)
+{
+	using namespace Internal_EntityManager;
+	using ElementChange = IncrementalSerializationScratch::ElementChange;
+
+	AMP_FATAL_ASSERT(serialization.m_components.IsEmpty() && serialization.m_entities.m_views.IsEmpty(),
+		"Incremental serializations must be made into an empty serialization.");
+	AMP_FATAL_ASSERT(m_changeJournal.IsEnabled(), "Incremental serializations require change tracking.");
+
+	IncrementalSerializationScratch& scratch = m_incrementalSerializationScratch;
+	const uint32_t numComponentTypes = m_componentReflector.GetNumComponentTypes();
+	while (scratch.m_componentChangesByTypeIndex.Size() < numComponentTypes)
+	{
+		scratch.m_componentChangesByTypeIndex.Emplace();
+	}
+	scratch.m_serializedTypeIndices.Clear();
+	scratch.m_serializedTypeIndices.Resize(numComponentTypes, UINT16_MAX);
+	scratch.m_changedTypes.Clear();
+	scratch.m_entityChanges.Clear();
+	scratch.m_newTypes.Clear();
+
+	// Keep the types of the previous serialization in the same order so that the component type indices of the
+	// unchanged serialized entities stay correct.
+	for (const auto& entry : previousSerialization.m_components)
+	{
+		const uint32_t typeIndex = m_componentReflector.FindTypeIndex(entry.first);
+		AMP_FATAL_ASSERT(typeIndex != ComponentReflector::k_invalidTypeIndex,
+			"Cannot serialize a component of an unregistered type.");
+		scratch.m_serializedTypeIndices[typeIndex] = static_cast<uint16_t>(serialization.m_components.Size());
+		serialization.m_components.Emplace(entry.first, SerializedBytesWithViews());
+	}
+
+	const auto addComponentChange = [&](const ComponentID componentID, const ElementChange::Kind kind)
+	{
+		const uint32_t typeIndex = m_componentReflector.FindTypeIndex(componentID.GetType());
+		if (typeIndex == ComponentReflector::k_invalidTypeIndex)
+		{
+			return;
+		}
+
+		auto& componentChanges = scratch.m_componentChangesByTypeIndex[typeIndex];
+		if (componentChanges.IsEmpty())
+		{
+			scratch.m_changedTypes.Add({ componentID.GetType(), typeIndex });
+		}
+		componentChanges.Add({ componentID.GetUniqueID(), kind });
+	};
+
+	// Remove the components that changed entities had in the previous serialization and rewrite the changed entities
+	// that still match the filter along with all their current components.
+	m_changeJournal.Consolidate();
+	const SerializedBytesWithViews& previousEntities = previousSerialization.m_entities;
+	for (const auto& entityID : m_changeJournal.GetChangedEntityIDs())
+	{
+		const uint32_t previousIndex =
+			FindLowerBoundOfSerializedID<FullSerializedEntityHeader>(previousEntities, 0, entityID.GetUniqueID());
+		if (previousIndex < previousEntities.m_views.Size()
+			&& GetSerializedElementID<FullSerializedEntityHeader>(previousEntities, previousIndex)
+				== entityID.GetUniqueID())
+		{
+			const SerializedByteView& entityView = previousEntities.m_views[previousIndex];
+			const uint8_t* const viewBytes = &previousEntities.m_bytes[entityView.m_beginIndex];
+			const size_t viewSizeInBytes = (entityView.m_endIndex - entityView.m_beginIndex);
+
+			FullSerializedEntityHeader header;
+			memcpy(&header, viewBytes, FullSerializedEntityHeader::k_unpaddedSize);
+			AMP_FATAL_ASSERT((FullSerializedEntityHeader::k_unpaddedSize
+				+ (header.m_numComponents * k_numSerializedComponentIDBytes)) <= viewSizeInBytes,
+				"The previous serialization was constructed incorrectly.");
+
+			scratch.m_componentIDs.Clear();
+			ReconstructComponentIDs(
+				previousSerialization,
+				header.m_numComponents,
+				viewBytes + FullSerializedEntityHeader::k_unpaddedSize,
+				viewBytes + viewSizeInBytes,
+				scratch.m_componentIDs);
+			for (const auto& componentID : scratch.m_componentIDs)
+			{
+				addComponentChange(componentID, ElementChange::Kind::Remove);
+			}
+		}
+
+		const Entity* const entity = FindEntity(entityID);
+		if (entity != nullptr && filter(*entity))
+		{
+			scratch.m_entityChanges.Add({ entityID.GetUniqueID(), ElementChange::Kind::Rewrite });
+			for (const auto& componentID : entity->GetComponentIDs())
+			{
+				addComponentChange(componentID, ElementChange::Kind::Rewrite);
+			}
+		}
+		else
+		{
+			scratch.m_entityChanges.Add({ entityID.GetUniqueID(), ElementChange::Kind::Remove });
+		}
+	}
+
+	// Components which may have been written to are rewritten if they are in the previous serialization. Components
+	// which aren't belong to entities that don't match the filter or that changed and are handled above.
+	for (const auto& componentID : m_changeJournal.GetChangedComponentIDs())
+	{
+		addComponentChange(componentID, ElementChange::Kind::RewriteIfPresent);
+	}
+
+	// Sort the changes by ID and then by precedence, and add the types of rewritten components which aren't in the
+	// previous serialization after its types.
+	const auto compareChanges = [](const ElementChange& lhs, const ElementChange& rhs)
+	{
+		return (lhs.m_id < rhs.m_id) || (lhs.m_id == rhs.m_id && lhs.m_kind < rhs.m_kind);
+	};
+	for (const auto& entry : scratch.m_changedTypes)
+	{
+		const uint32_t typeIndex = entry.second;
+		auto& componentChanges = scratch.m_componentChangesByTypeIndex[typeIndex];
+		std::sort(componentChanges.begin(), componentChanges.end(), compareChanges);
+
+		const bool hasRewrites = componentChanges.IndexOf([](const ElementChange& change)
+			{
+				return change.m_kind == ElementChange::Kind::Rewrite;
+			}) != Collection::Vector<ElementChange>::sk_InvalidIndex;
+		if (scratch.m_serializedTypeIndices[typeIndex] == UINT16_MAX && hasRewrites)
+		{
+			scratch.m_newTypes.Add(entry);
+		}
+	}
+	std::sort(scratch.m_entityChanges.begin(), scratch.m_entityChanges.end(), compareChanges);
+
+	std::sort(scratch.m_newTypes.begin(), scratch.m_newTypes.end(),
+		[](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+	for (const auto& entry : scratch.m_newTypes)
+	{
+		AMP_FATAL_ASSERT(serialization.m_components.Size() < UINT16_MAX, "Too many component types to serialize.");
+		scratch.m_serializedTypeIndices[entry.second] = static_cast<uint16_t>(serialization.m_components.Size());
+		serialization.m_components.Emplace(entry.first, SerializedBytesWithViews());
+	}
+
+	// Apply the changes to the components of each type.
+	const EntityManager& constThis = *this;
+	Collection::Vector<uint64_t> changedComponentIDs;
+	for (uint32_t i = 0, iEnd = serialization.m_components.Size(); i < iEnd; ++i)
+	{
+		auto& entry = serialization.m_components[i];
+		const uint32_t typeIndex = m_componentReflector.FindTypeIndex(entry.first);
+		const auto& componentFunctions = m_componentReflector.FindComponentFunctions(entry.first);
+		const SerializedBytesWithViews* const previousComponents =
+			(i < previousSerialization.m_components.Size()) ? &previousSerialization.m_components[i].second : nullptr;
+
+		changedComponentIDs.Clear();
+		ApplyChangesToSerializedElements<FullSerializedComponentHeader>(
+			previousComponents,
+			scratch.m_componentChangesByTypeIndex[typeIndex].GetConstView(),
+			[&](const uint64_t uniqueID, Collection::Vector<uint8_t>& outBytes)
+			{
+				const Component* const component = constThis.FindComponent(ComponentID(entry.first, uniqueID));
+				SerializeComponent(componentFunctions, uniqueID, component, outBytes);
+			},
+			entry.second,
+			changedComponentIDs);
+
+		if (!changedComponentIDs.IsEmpty())
+		{
+			outChanges.m_changedComponentIDs[entry.first].AddAll(changedComponentIDs.GetConstView());
+		}
+	}
+
+	for (const auto& entry : scratch.m_changedTypes)
+	{
+		scratch.m_componentChangesByTypeIndex[entry.second].Clear();
+	}
+
+	// Apply the changes to the entities.
+	ApplyChangesToSerializedElements<FullSerializedEntityHeader>(
+		&previousEntities,
+		scratch.m_entityChanges.GetConstView(),
+		[&](const uint64_t entityID, Collection::Vector<uint8_t>& outBytes)
+		{
+			const Entity* const entity = FindEntity(EntityID(static_cast<uint32_t>(entityID)));
+			SerializeEntity(*entity, scratch.m_serializedTypeIndices, outBytes);
+		},
+		serialization.m_entities,
+		outChanges.m_changedEntityIDs);
+
+	m_changeJournal.Clear();
+}
+
+template <typename HeaderType, typename IDType, typename WriteElementFn>
+void EntityManager::ApplyChangesToSerializedElements(
+	const SerializedBytesWithViews* const previousElements,
+	const Collection::ArrayView<const IncrementalSerializationScratch::ElementChange>& changes,
+	WriteElementFn&& writeElementFn,
+	SerializedBytesWithViews& outElements,
+	Collection::Vector<IDType>& outChangedElementIDs)
+{
+	using namespace Internal_EntityManager;
+	using ElementChange = IncrementalSerializationScratch::ElementChange;
+
+	const uint32_t numPreviousElements = (previousElements != nullptr) ? previousElements->m_views.Size() : 0;
+	if (previousElements != nullptr)
+	{
+		outElements.m_bytes.EnsureCapacity(previousElements->m_bytes.Size());
+		outElements.m_views.EnsureCapacity(numPreviousElements);
+	}
+
+	uint32_t previousIndex = 0;
+	for (size_t i = 0, iEnd = changes.Size(); i < iEnd; ++i)
+	{
+		// The changes are sorted by precedence, so only the first change of each element applies.
+		const ElementChange& change = changes[i];
+		if (i > 0 && changes[i - 1].m_id == change.m_id)
+		{
+			continue;
+		}
+
+		// Copy the run of unchanged elements before the changed element.
+		bool wasPresent = false;
+		if (previousElements != nullptr)
+		{
+			const uint32_t changedIndex =
+				FindLowerBoundOfSerializedID<HeaderType>(*previousElements, previousIndex, change.m_id);
+			CopySerializedElements(*previousElements, previousIndex, changedIndex, outElements);
+			previousIndex = changedIndex;
+
+			wasPresent = (previousIndex < numPreviousElements)
+				&& (GetSerializedElementID<HeaderType>(*previousElements, previousIndex) == change.m_id);
+		}
+
+		const bool shouldRewrite = (change.m_kind == ElementChange::Kind::Rewrite)
+			|| (change.m_kind == ElementChange::Kind::RewriteIfPresent && wasPresent);
+		if (shouldRewrite)
+		{
+			const uint32_t elementBeginIndex = outElements.m_bytes.Size();
+			writeElementFn(change.m_id, outElements.m_bytes);
+			outElements.m_views.Add({ elementBeginIndex, outElements.m_bytes.Size() });
+
+			// Elements which may have been written to often serialize identically, in which case they didn't change.
+			if (!wasPresent || !AreSerializedElementsEqual(
+				*previousElements, previousIndex, outElements, outElements.m_views.Size() - 1))
+			{
+				outChangedElementIDs.Add(static_cast<IDType>(change.m_id));
+			}
+		}
+		else if (change.m_kind == ElementChange::Kind::Remove && wasPresent)
+		{
+			outChangedElementIDs.Add(static_cast<IDType>(change.m_id));
+		}
+
+		if (wasPresent)
+		{
+			++previousIndex;
+		}
+	}
+
+	// Copy the run of unchanged elements after the last changed element.
+	if (previousElements != nullptr)
+	{
+		CopySerializedElements(*previousElements, previousIndex, numPreviousElements, outElements);
+	}
+}
+
+void EntityManager::SetParentEntity(Entity& entity, Entity* parentEntity)
+{
+	RecordEntityChange(entity.GetID());
+
+	// Detach the entity from its existing parent, if it has one.
+	if (entity.m_parent != nullptr)
+	{
+		Entity& parent = *entity.m_parent;
+		const size_t indexInParent = parent.m_children.IndexOf(&entity);
+		parent.m_children.SwapWithAndRemoveLast(indexInParent);
+	}
+
+	// Attach the entity to the given parent.
+	entity.m_parent = parentEntity;
+	if (parentEntity != nullptr)
+	{
+		parentEntity->m_children.Add(&entity);
+	}
+}
+
+void EntityManager::DeleteEntities(const Collection::ArrayView<const EntityID>& entitiesToDelete)
+{
+	// Detach the entities from their parents. This happens before any children are gathered so that an entity which
+	// is both requested and a descendant of another requested entity is only gathered once.
+	Collection::Vector<Entity*> allEntitiesToDelete;
+	for (const auto& entityID : entitiesToDelete)
+	{
+		Entity* const entity = m_entities.Find(entityID);
+		if (entity == nullptr)
+		{
+			continue;
+		}
+
+		if (entity->m_parent != nullptr)
+		{
+			Entity& parent = *entity->m_parent;
+			const size_t indexInParent = parent.m_children.IndexOf(entity);
+			parent.m_children.SwapWithAndRemoveLast(indexInParent);
+			entity->m_parent = nullptr;
+		}
+		allEntitiesToDelete.Add(entity);
+	}
+
+	// Recursively gather the children of the entities to delete them as well.
+	for (size_t i = 0; i < allEntitiesToDelete.Size(); ++i)
+	{
+		allEntitiesToDelete.AddAll(allEntitiesToDelete[i]->m_children.GetConstView());
+	}
+
+	// Remove all the entities from the system execution groups at once, then delete them.
+	RemoveECSPointersFromSystems(allEntitiesToDelete.GetConstView());
+
+	for (const auto& entity : allEntitiesToDelete)
+	{
+		RecordEntityChange(entity->GetID());
+		for (const auto& componentID : entity->GetComponentIDs())
+		{
+			RemoveComponent(componentID);
+		}
+		m_entities.TryRemove(entity->GetID());
+	}
+}
+
+void EntityManager::ApplyCommandBuffer(CommandBuffer& commandBuffer)
+{
+	// Create the entities, then set their parents once they all exist so that an entity can be parented to an entity
+	// created after it, then add them to the system execution groups together.
+	if (!commandBuffer.m_entityCreations.IsEmpty())
+	{
+		Collection::Vector<Entity*> createdEntities{ commandBuffer.m_entityCreations.Size() };
+		for (const auto& creation : commandBuffer.m_entityCreations)
+		{
+			const Collection::ArrayView<const ComponentType> componentTypes{
+				commandBuffer.m_creationComponentTypes.begin() + creation.m_componentTypesBeginIndex,
+				creation.m_componentTypesEndIndex - creation.m_componentTypesBeginIndex };
+
+			createdEntities.Add(&EmplaceEntityWithComponents(
+				componentTypes, creation.m_flags, creation.m_layer, creation.m_requestedID));
+		}
+
+		for (size_t i = 0, iEnd = createdEntities.Size(); i < iEnd; ++i)
+		{
+			const EntityID parentID = commandBuffer.m_entityCreations[i].m_parentID;
+			if (parentID == EntityID())
+			{
+				continue;
+			}
+
+			Entity* const parentEntity = FindEntity(parentID);
+			if (parentEntity != nullptr)
+			{
+				SetParentEntity(*createdEntities[i], parentEntity);
+			}
+		}
+
+		AddECSPointersToSystems(createdEntities.GetConstView());
+	}
+
+	// Remove the entities whose components change from the system execution groups, change their components and
+	// archetypes, and then add them back.
+	if (!commandBuffer.m_componentChanges.IsEmpty())
+	{
+		Collection::Vector<Entity*> changedEntities;
+		for (const auto& change : commandBuffer.m_componentChanges)
+		{
+			Entity* const entity = FindEntity(change.m_entityID);
+			if (entity != nullptr)
+			{
+				changedEntities.Add(entity);
+			}
+		}
+		std::sort(changedEntities.begin(), changedEntities.end());
+		changedEntities.Remove(
+			std::unique(changedEntities.begin(), changedEntities.end()) - changedEntities.begin(),
+			changedEntities.Size());
+
+		RemoveECSPointersFromSystems(changedEntities.GetConstView());
+
+		for (const auto& change : commandBuffer.m_componentChanges)
+		{
+			Entity* const entity = FindEntity(change.m_entityID);
+			if (entity == nullptr)
+			{
+				continue;
+			}
+
+			const size_t componentIndex = entity->m_componentIDs.IndexOf([&](const ComponentID& componentID)
+				{
+					return componentID.GetType() == change.m_componentType;
+				});
+			const bool hasComponent = (componentIndex != Collection::Vector<ComponentID>::sk_InvalidIndex);
+
+			if (change.m_isAddition && !hasComponent)
+			{
+				AddComponentToEntity(change.m_componentType, *entity);
+			}
+			else if (!change.m_isAddition && hasComponent)
+			{
+				RemoveComponent(entity->m_componentIDs[componentIndex]);
+				entity->m_componentIDs.Remove(componentIndex, componentIndex + 1);
+			}
+		}
+
+		for (const auto& entity : changedEntities)
+		{
+			RecordEntityChange(entity->GetID());
+			IndexComponentIDsOfEntity(*entity);
+
+			const ArchetypeID archetypeID = ResolveArchetype(entity->m_componentIDs.GetConstView());
+			if (entity->m_archetypeID != archetypeID)
+			{
+				entity->m_archetypeID = archetypeID;
+				RelocateComponentsToArchetype(*entity);
+			}
+		}
+
+		AddECSPointersToSystems(changedEntities.GetConstView());
+	}
+
+	// Set the parents of entities. This doesn't affect the system execution groups.
+	for (const auto& parentChange : commandBuffer.m_parentChanges)
+	{
+		Entity* const entity = FindEntity(parentChange.m_entityID);
+		if (entity == nullptr)
+		{
+			continue;
+		}
+
+		Entity* parentEntity = nullptr;
+		if (parentChange.m_parentID != EntityID())
+		{
+			parentEntity = FindEntity(parentChange.m_parentID);
+			if (parentEntity == nullptr)
+			{
+				continue;
+			}
+		}
+
+		if (entity->m_parent != parentEntity)
+		{
+			SetParentEntity(*entity, parentEntity);
+		}
+	}
+
+	// Delete the entities. An entity may have been queued for deletion more than once.
+	if (!commandBuffer.m_entityDeletions.IsEmpty())
+	{
+		Collection::Vector<EntityID>& entityDeletions = commandBuffer.m_entityDeletions;
+		std::sort(entityDeletions.begin(), entityDeletions.end());
+		entityDeletions.Remove(
+			std::unique(entityDeletions.begin(), entityDeletions.end()) - entityDeletions.begin(),
+			entityDeletions.Size());
+
+		DeleteEntities(entityDeletions.GetConstView());
+	}
+
+	commandBuffer.Clear();
+}
+
+Entity* EntityManager::FindEntity(const EntityID id)
+{
+	return m_entities.Find(id);
+}
+
+const Entity* EntityManager::FindEntity(const EntityID id) const
+{
+	return m_entities.Find(id);
+}
+
+Component* EntityManager::FindComponent(const ComponentID id)
+{
+	// Implemented using the const variant. The component may be written to, so it is recorded as changed.
+	Component* const component = const_cast<Component*>(static_cast<const EntityManager*>(this)->FindComponent(id));
+	if (component != nullptr)
+	{
+		RecordComponentChange(id);
+	}
+	return component;
+}
+
+const Component* EntityManager::FindComponent(const ComponentID id) const
+{
+	const uint32_t typeIndex = m_componentReflector.FindTypeIndex(id.GetType());
+	if (typeIndex >= m_components.Size())
+	{
+		return nullptr;
+	}
+	return m_components[typeIndex].Find(id);
+}
+
+Component* EntityManager::FindComponent(const Entity& entity, const ComponentType componentType)
+{
+	// Implemented using the const variant. The component may be written to, so it is recorded as changed.
+	Component* const component = const_cast<Component*>(
+		static_cast<const EntityManager*>(this)->FindComponent(entity, componentType));
+	if (component != nullptr)
+	{
+		RecordComponentChange(component->m_id);
+	}
+	return component;
+}
+
+const Component* EntityManager::FindComponent(const Entity& entity, const ComponentType componentType) const
+{
+	const ComponentID* const componentID = FindComponentIDOfEntity(entity, componentType);
+	if (componentID == nullptr)
+	{
+		return nullptr;
+	}
+	return FindComponent(*componentID);
+}
+
+ComponentVector* EntityManager::GetComponentVector(const ComponentType componentType)
+{
+	// Components with size 0 are tag components and are never instantiated.
+	const Unit::ByteCount64 componentSize = m_componentReflector.GetSizeOfComponentInBytes(componentType);
+	if (componentSize.GetN() == 0)
+	{
+		return nullptr;
+	}
+
+	const uint32_t typeIndex = m_componentReflector.FindTypeIndex(componentType);
+	if (typeIndex == ComponentReflector::k_invalidTypeIndex)
+	{
+		return nullptr;
+	}
+	while (m_components.Size() <= typeIndex)
+	{
+		m_components.Emplace();
+	}
+
+	ComponentVector& componentVector = m_components[typeIndex];
+	if (componentVector.GetComponentType() == ComponentType())
 	{
 		// This is a type that has not yet been encountered and therefore must be initialized.
 		const Unit::ByteCount64 componentAlignment = m_componentReflector.GetAlignOfComponentInBytes(componentType);
@@ -582,11 +1338,103 @@ ComponentVector* EntityManager::GetComponentVector(const ComponentType component
 		componentVector = ComponentVector(m_componentReflector, componentType, componentSize, componentAlignment);
 	}
 	AMP_FATAL_ASSERT(componentVector.GetComponentType() == componentType,
-		"Mismatch between component vector type and the key it is stored at.");
+		"Mismatch between component vector type and the type index it is stored at.");
 
 	return &componentVector;
 }
 
+const ComponentID* EntityManager::FindComponentIDOfEntity(
+	const Entity& entity, const ComponentType componentType) const
+{
+	const uint32_t typeIndex = m_componentReflector.FindTypeIndex(componentType);
+	if (typeIndex < Internal_EntityManager::k_numMaskedTypeIndices)
+	{
+		// The component's position is the number of the entity's components with lower type indices.
+		const uint64_t typeBit = uint64_t{ 1 } << typeIndex;
+		if ((entity.m_componentTypeMask & typeBit) == 0)
+		{
+			return nullptr;
+		}
+		return &entity.m_componentIDs[Util::CountSetBits(entity.m_componentTypeMask & (typeBit - 1))];
+	}
+
+	// Components with types outside the mask are sorted after all the others.
+	for (uint32_t i = Util::CountSetBits(entity.m_componentTypeMask),
+		iEnd = entity.m_componentIDs.Size(); i < iEnd; ++i)
+	{
+		if (entity.m_componentIDs[i].GetType() == componentType)
+		{
+			return &entity.m_componentIDs[i];
+		}
+	}
+	return nullptr;
+}
+
+void EntityManager::SortComponentIDsByTypeIndex(Collection::Vector<ComponentID>& componentIDs) const
+{
+	// Unregistered types have the invalid type index, which sorts them last.
+	std::sort(componentIDs.begin(), componentIDs.end(), [&](const ComponentID& lhs, const ComponentID& rhs)
+		{
+			const uint32_t lhsTypeIndex = m_componentReflector.FindTypeIndex(lhs.GetType());
+			const uint32_t rhsTypeIndex = m_componentReflector.FindTypeIndex(rhs.GetType());
+			if (lhsTypeIndex != rhsTypeIndex)
+			{
+				return lhsTypeIndex < rhsTypeIndex;
+			}
+			return lhs.GetUniqueID() < rhs.GetUniqueID();
+		});
+}
+
+void EntityManager::IndexComponentIDsOfEntity(Entity& entity) const
+{
+	SortComponentIDsByTypeIndex(entity.m_componentIDs);
+
+	entity.m_componentTypeMask = 0;
+	for (const auto& componentID : entity.m_componentIDs)
+	{
+		const uint32_t typeIndex = m_componentReflector.FindTypeIndex(componentID.GetType());
+		if (typeIndex < Internal_EntityManager::k_numMaskedTypeIndices)
+		{
+			entity.m_componentTypeMask |= uint64_t{ 1 } << typeIndex;
+		}
+	}
+}
+
+ArchetypeID EntityManager::ResolveArchetype(const Collection::ArrayView<const ComponentType>& componentTypes)
+{
+	if (m_storageMode != ComponentStorageMode::Archetype)
+	{
+		return ArchetypeID();
+	}
+	return m_archetypeRegistry.FindOrAddArchetype(componentTypes);
+}
+
+ArchetypeID EntityManager::ResolveArchetype(const Collection::ArrayView<const ComponentID>& componentIDs)
+{
+	if (m_storageMode != ComponentStorageMode::Archetype)
+	{
+		return ArchetypeID();
+	}
+	return m_archetypeRegistry.FindOrAddArchetype(componentIDs);
+}
+
+void EntityManager::RelocateComponentsToArchetype(const Entity& entity)
+{
+	if (m_storageMode != ComponentStorageMode::Archetype)
+	{
+		return;
+	}
+
+	for (const auto& componentID : entity.m_componentIDs)
+	{
+		ComponentVector* const componentVector = GetComponentVector(componentID.GetType());
+		if (componentVector != nullptr)
+		{
+			componentVector->Relocate(componentID, entity.m_archetypeID);
+		}
+	}
+}
+
 void EntityManager::AddComponentToEntity(const ComponentType componentType, Entity& entity)
 {
 	const ComponentID componentID{ componentType, m_nextComponentID };
@@ -594,7 +1442,7 @@ void EntityManager::AddComponentToEntity(const ComponentType componentType, Enti
 	ComponentVector* const componentVector = GetComponentVector(componentType);
 	if (componentVector != nullptr)
 	{
-		if (!m_componentReflector.TryBasicConstructComponent(componentID, *componentVector))
+		if (!m_componentReflector.TryBasicConstructComponent(componentID, entity.m_archetypeID, *componentVector))
 		{
 			AMP_LOG_WARNING("Failed to create component of type [%s].", Util::ReverseHash(componentType.GetTypeHash()));
 			return;
@@ -613,7 +1461,8 @@ void EntityManager::AddComponentToEntity(
 	ComponentVector* const componentVector = GetComponentVector(componentType);
 	if (componentVector != nullptr)
 	{
-		if (!m_componentReflector.TryMakeComponent(m_assetManager, bytes, bytesEnd, componentID, *componentVector))
+		if (!m_componentReflector.TryMakeComponent(
+			m_assetManager, bytes, bytesEnd, componentID, entity.m_archetypeID, *componentVector))
 		{
 			AMP_LOG_WARNING("Failed to create component of type [%s].", Util::ReverseHash(componentType.GetTypeHash()));
 			return;
@@ -627,10 +1476,13 @@ void EntityManager::AddComponentToEntity(
 void EntityManager::RemoveComponent(const ComponentID id)
 {
 	// Delete the component.
-	Collection::Pair<const ComponentType, ComponentVector>* const componentsEntry =
-		m_components.Find(id.GetType());
-	ComponentVector& components = componentsEntry->second;
-	components.Remove(id);
+	const uint32_t typeIndex = m_componentReflector.FindTypeIndex(id.GetType());
+	if (typeIndex >= m_components.Size())
+	{
+		// Tag components are never instantiated.
+		return;
+	}
+	m_components[typeIndex].Remove(id);
 }
 
 EntityManager::RegisteredSystem::RegisteredSystem()
@@ -640,20 +1492,65 @@ EntityManager::RegisteredSystem::RegisteredSystem()
 	, m_notifyEntityRemovedFunction(nullptr)
 	, m_ecsGroups()
 	, m_deferredFunctions()
+	, m_scheduling(SystemScheduling::Exclusive)
+	, m_dependentIndices()
 {}
 
 EntityManager::RegisteredSystem::RegisteredSystem(
 	Mem::UniquePtr<System>&& system,
 	SystemUpdateFn updateFunction,
 	NotifyOfEntityFn notifyEntityAddedFunction,
-	NotifyOfEntityFn notifyEntityRemovedFunction)
+	NotifyOfEntityFn notifyEntityRemovedFunction,
+	SystemScheduling scheduling,
+	FrameAllocator& frameAllocator)
 	: m_system(std::move(system))
 	, m_updateFunction(updateFunction)
 	, m_notifyEntityAddedFunction(notifyEntityAddedFunction)
 	, m_notifyEntityRemovedFunction(notifyEntityRemovedFunction)
 	, m_ecsGroups(m_system->GetImmutableTypes().Size() + m_system->GetMutableTypes().Size())
+	, m_deferredFunctions(frameAllocator)
+	, m_scheduling(scheduling)
+	, m_dependentIndices()
 {}
 
+void EntityManager::AddLastSystemToGraph()
+{
+	const uint32_t newSystemIndex = m_systems.Size() - 1;
+	RegisteredSystem& newSystem = m_systems[newSystemIndex];
+
+	// The new system depends on every previously registered system it can't run concurrently with.
+	for (uint32_t i = 0; i < newSystemIndex; ++i)
+	{
+		RegisteredSystem& registeredSystem = m_systems[i];
+
+		const bool isExclusive = (registeredSystem.m_scheduling == SystemScheduling::Exclusive)
+			|| (newSystem.m_scheduling == SystemScheduling::Exclusive);
+		if (isExclusive || !registeredSystem.m_system->IsWriteCompatibleWith(*newSystem.m_system))
+		{
+			registeredSystem.m_dependentIndices.Add(newSystemIndex);
+			++newSystem.m_numDependencies;
+		}
+	}
+
+	m_systemSchedule.m_updateContexts.Add({ nullptr, Unit::Time::Millisecond(0) });
+	m_systemSchedule.m_numUnfinishedDependencies.Add(0);
+	m_systemSchedule.m_updateCounters.Add(Mem::MakeUnique<Thread::JobCounter>());
+}
+
+void EntityManager::ReleaseSystemDependents(const uint32_t systemIndex)
+{
+	++m_systemSchedule.m_numFinishedSystems;
+	for (const auto& dependentIndex : m_systems[systemIndex].m_dependentIndices)
+	{
+		uint32_t& numUnfinishedDependencies = m_systemSchedule.m_numUnfinishedDependencies[dependentIndex];
+		--numUnfinishedDependencies;
+		if (numUnfinishedDependencies == 0)
+		{
+			m_systemSchedule.m_readySystems.Add(dependentIndex);
+		}
+	}
+}
+
 namespace Internal_EntityManager
 {
 bool TryGatherPointers(EntityManager& entityManager, const Collection::Vector<ECS::ComponentType>& componentTypes,
@@ -674,7 +1571,10 @@ bool TryGatherPointers(EntityManager& entityManager, const Collection::Vector<EC
 			foundAll = false;
 			break;
 		}
-		pointers.Add(entityManager.FindComponent(id));
+		// Gathering a component's pointer doesn't write to it, so it is found through the const variant, which doesn't
+		// record the component as changed.
+		const Component* const component = static_cast<const EntityManager&>(entityManager).FindComponent(id);
+		pointers.Add(const_cast<Component*>(component));
 	}
 	return foundAll;
 };
@@ -690,96 +1590,219 @@ void EntityManager::AddECSPointersToSystems(Collection::ArrayView<Entity* const>
 {
 	using namespace Internal_EntityManager;
 
-	for (auto& executionGroup : m_concurrentSystemGroups)
+	// Gather the entity pointers and component pointers each system needs.
+	for (auto& registeredSystem : m_systems)
 	{
-		// Gather the entity pointers and component pointers each member of the execution group needs.
-		for (auto& registeredSystem : executionGroup.m_systems)
-		{
-			const Collection::Vector<ECS::ComponentType>& immutableTypes =
-				registeredSystem.m_system->GetImmutableTypes();
-			const Collection::Vector<ECS::ComponentType>& mutableTypes =
-				registeredSystem.m_system->GetMutableTypes();
+		const Collection::Vector<ECS::ComponentType>& immutableTypes =
+			registeredSystem.m_system->GetImmutableTypes();
+		const Collection::Vector<ECS::ComponentType>& mutableTypes =
+			registeredSystem.m_system->GetMutableTypes();
 
-			for (auto& entity : entitiesToAdd)
+		for (auto& entity : entitiesToAdd)
+		{
+			Collection::Vector<void*> pointers;
+			if (!TryGatherPointers(*this, immutableTypes, *entity, pointers))
 			{
-				Collection::Vector<void*> pointers;
-				if (!TryGatherPointers(*this, immutableTypes, *entity, pointers))
-				{
-					continue;
-				}
-				if (!TryGatherPointers(*this, mutableTypes, *entity, pointers))
-				{
-					continue;
-				}
-
-				registeredSystem.m_ecsGroups.Add(pointers);
-				registeredSystem.m_notifyEntityAddedFunction(registeredSystem, entity->GetID(), pointers);
+				continue;
+			}
+			if (!TryGatherPointers(*this, mutableTypes, *entity, pointers))
+			{
+				continue;
 			}
 
-			// Sort the group vector in order to make the memory accesses as fast as possible.
-			registeredSystem.m_ecsGroups.Sort();
+			registeredSystem.m_ecsGroups.Add(entity->GetID(), pointers);
+			registeredSystem.m_notifyEntityAddedFunction(registeredSystem, entity->GetID(), pointers);
 		}
 	}
 }
 
 void EntityManager::RemoveECSPointersFromSystems(Entity& entity)
 {
-	using namespace Internal_EntityManager;
+	Entity* const entityPtr = &entity;
+	RemoveECSPointersFromSystems(Collection::ArrayView<Entity* const>{ &entityPtr, 1 });
+}
 
-	for (auto& executionGroup : m_concurrentSystemGroups)
+void EntityManager::RemoveECSPointersFromSystems(Collection::ArrayView<Entity* const> entitiesToRemove)
+{
+	Collection::Vector<void*> pointers;
+	for (auto& registeredSystem : m_systems)
 	{
-		for (auto& registeredSystem : executionGroup.m_systems)
+		for (const auto& entity : entitiesToRemove)
 		{
-			const Collection::Vector<ECS::ComponentType>& immutableTypes =
-				registeredSystem.m_system->GetImmutableTypes();
-			const Collection::Vector<ECS::ComponentType>& mutableTypes =
-				registeredSystem.m_system->GetMutableTypes();
-
-			Collection::Vector<void*> pointers;
-			if (!TryGatherPointers(*this, immutableTypes, entity, pointers))
-			{
-				continue;
-			}
-			if (!TryGatherPointers(*this, mutableTypes, entity, pointers))
+			pointers.Clear();
+			if (!registeredSystem.m_ecsGroups.TryRemove(entity->GetID(), pointers))
 			{
 				continue;
 			}
 
-			registeredSystem.m_ecsGroups.Remove(pointers);
-			registeredSystem.m_notifyEntityRemovedFunction(registeredSystem, entity.GetID(), pointers);
+			registeredSystem.m_notifyEntityRemovedFunction(registeredSystem, entity->GetID(), pointers);
 		}
 	}
 }
 
+void EntityManager::AddChangeObserver(ChangeJournal& journal)
+{
+	AMP_FATAL_ASSERT(m_changeObservers.IndexOf(&journal) == m_changeObservers.sk_InvalidIndex,
+		"A journal can only observe an EntityManager once.");
+	m_changeObservers.Add(&journal);
+}
+
+void EntityManager::RemoveChangeObserver(ChangeJournal& journal)
+{
+	const size_t observerIndex = m_changeObservers.IndexOf(&journal);
+	if (observerIndex != m_changeObservers.sk_InvalidIndex)
+	{
+		m_changeObservers.SwapWithAndRemoveLast(observerIndex);
+	}
+}
+
+void EntityManager::RecordComponentChange(const ComponentID id)
+{
+	m_changeJournal.RecordComponentChange(id);
+	for (auto& observer : m_changeObservers)
+	{
+		observer->RecordComponentChange(id);
+	}
+}
+
+void EntityManager::RecordEntityChange(const EntityID id)
+{
+	m_changeJournal.RecordEntityChange(id);
+	for (auto& observer : m_changeObservers)
+	{
+		observer->RecordEntityChange(id);
+	}
+}
+
+void EntityManager::RecordChangesOfSystem(RegisteredSystem& registeredSystem)
+{
+	// Only the components the system marked as written are recorded. Changes to entities are made through the
+	// EntityManager, which records them itself.
+	Collection::Vector<ComponentID>& changedComponentIDs = registeredSystem.m_system->m_changedComponentIDs;
+	for (const auto& componentID : changedComponentIDs)
+	{
+		RecordComponentChange(componentID);
+	}
+	changedComponentIDs.Clear();
+}
+
 void EntityManager::Update(const Unit::Time::Millisecond delta)
 {
-	// Update the concurrent system groups.
-	for (auto& concurrentGroup : m_concurrentSystemGroups)
+	Thread::JobSystem& jobSystem = Thread::JobSystem::GetEngineJobSystem();
+	SystemSchedule& schedule = m_systemSchedule;
+
+	const auto updateSystem = [](void* rawContext, uint32_t)
 	{
-		// The systems in each group can update in parallel.
-		// If the group has only one system, run it directly on this thread.
-		if (concurrentGroup.m_systems.Size() == 1)
+		const SystemUpdateContext& context = *static_cast<const SystemUpdateContext*>(rawContext);
+		context.m_registeredSystem->m_updateFunction(*context.m_registeredSystem, context.m_delta);
+	};
+
+	// The systems which don't depend on any others are ready to run immediately. The systems are only pointed to
+	// during the update because registering systems may move them.
+	const uint32_t numSystems = m_systems.Size();
+	Collection::Vector<SystemUpdateContext>& updateContexts = schedule.m_updateContexts;
+	for (uint32_t i = 0; i < numSystems; ++i)
+	{
+		updateContexts[i] = { &m_systems[i], delta };
+
+		schedule.m_numUnfinishedDependencies[i] = m_systems[i].m_numDependencies;
+		if (m_systems[i].m_numDependencies == 0)
 		{
-			concurrentGroup.m_systems.Front().m_updateFunction(concurrentGroup.m_systems.Front(), delta);
+			schedule.m_readySystems.Add(i);
 		}
-		else
+	}
+	schedule.m_numFinishedSystems = 0;
+
+	while (schedule.m_numFinishedSystems < numSystems)
+	{
+		// Start the ready systems in registration order, unless deferred functions are waiting to run.
+		if (schedule.m_systemsAwaitingDeferredFunctions.IsEmpty() && !schedule.m_readySystems.IsEmpty())
 		{
-			std::for_each(std::execution::par, concurrentGroup.m_systems.begin(), concurrentGroup.m_systems.end(),
-				[&](RegisteredSystem& registeredSystem)
+			std::sort(schedule.m_readySystems.begin(), schedule.m_readySystems.end());
+			for (const auto& systemIndex : schedule.m_readySystems)
+			{
+				// Exclusive systems and systems that can't run concurrently with anything run on this thread.
+				const bool runOnThisThread = (m_systems[systemIndex].m_scheduling == SystemScheduling::Exclusive)
+					|| (schedule.m_readySystems.Size() == 1 && schedule.m_runningSystems.IsEmpty());
+				if (runOnThisThread)
 				{
-					registeredSystem.m_updateFunction(registeredSystem, delta);
-				});
+					updateSystem(&updateContexts[systemIndex], 0);
+					schedule.m_systemsAwaitingDeferredFunctions.Add(systemIndex);
+				}
+				else
+				{
+					jobSystem.Submit(updateSystem, &updateContexts[systemIndex], 1,
+						*schedule.m_updateCounters[systemIndex]);
+					schedule.m_runningSystems.Add(systemIndex);
+				}
+			}
+			schedule.m_readySystems.Clear();
 		}
 
-		// Resolve deferred functions single-threaded.
-		for (auto& registeredSystem : concurrentGroup.m_systems)
+		// Gather the systems which finished running.
+		bool anySystemFinished = false;
+		for (size_t i = 0; i < schedule.m_runningSystems.Size();)
 		{
-			for (auto& deferredFunction : registeredSystem.m_deferredFunctions)
+			const uint32_t systemIndex = schedule.m_runningSystems[i];
+			if (schedule.m_updateCounters[systemIndex]->IsDone())
 			{
-				deferredFunction(*this);
+				schedule.m_systemsAwaitingDeferredFunctions.Add(systemIndex);
+				schedule.m_runningSystems.SwapWithAndRemoveLast(i);
+				anySystemFinished = true;
+			}
+			else
+			{
+				++i;
+			}
+		}
+
+		// Resolve deferred functions single-threaded once no systems are running, then release the systems which
+		// depend on the finished systems.
+		if (schedule.m_runningSystems.IsEmpty())
+		{
+			std::sort(schedule.m_systemsAwaitingDeferredFunctions.begin(),
+				schedule.m_systemsAwaitingDeferredFunctions.end());
+			for (const auto& systemIndex : schedule.m_systemsAwaitingDeferredFunctions)
+			{
+				RegisteredSystem& registeredSystem = m_systems[systemIndex];
+				for (auto& deferredFunction : registeredSystem.m_deferredFunctions)
+				{
+					deferredFunction(*this);
+				}
+				registeredSystem.m_deferredFunctions.Clear();
+
+				// The system's deferred functions may also have marked components as changed.
+				RecordChangesOfSystem(registeredSystem);
+				ReleaseSystemDependents(systemIndex);
+			}
+			schedule.m_systemsAwaitingDeferredFunctions.Clear();
+		}
+		else if (!anySystemFinished)
+		{
+			// Systems which have no deferred functions release their dependents without waiting for the others.
+			for (size_t i = 0; i < schedule.m_systemsAwaitingDeferredFunctions.Size();)
+			{
+				const uint32_t systemIndex = schedule.m_systemsAwaitingDeferredFunctions[i];
+				if (m_systems[systemIndex].m_deferredFunctions.IsEmpty())
+				{
+					ReleaseSystemDependents(systemIndex);
+					schedule.m_systemsAwaitingDeferredFunctions.SwapWithAndRemoveLast(i);
+				}
+				else
+				{
+					++i;
+				}
+			}
+
+			// Help the running systems finish while waiting on them.
+			if (!jobSystem.TryExecuteJob())
+			{
+				std::this_thread::yield();
 			}
-			registeredSystem.m_deferredFunctions.Clear();
 		}
 	}
+
+	// Every deferred function has run and been destroyed, so nothing references the frame's transient memory.
+	m_frameAllocator.Reset();
 }
 }
@@ -0,0 +1,30 @@
+#include <ecs/FrameAllocator.h>
+
+#include <thread/JobSystem.h>
+
+namespace ECS
+{
+FrameAllocator::FrameAllocator()
+	: m_threadArenas(Thread::JobSystem::GetEngineJobSystem().GetNumThreads())
+{
+	const uint32_t numThreads = Thread::JobSystem::GetEngineJobSystem().GetNumThreads();
+	for (uint32_t i = 0; i < numThreads; ++i)
+	{
+		m_threadArenas.Emplace();
+	}
+}
+
+void* FrameAllocator::Alloc(const size_t sizeInBytes, const size_t alignmentInBytes)
+{
+	const uint32_t threadIndex = Thread::JobSystem::GetEngineJobSystem().GetCurrentThreadIndex();
+	return m_threadArenas[threadIndex].Alloc(sizeInBytes, alignmentInBytes);
+}
+
+void FrameAllocator::Reset()
+{
+	for (auto& arena : m_threadArenas)
+	{
+		arena.Reset();
+	}
+}
+}
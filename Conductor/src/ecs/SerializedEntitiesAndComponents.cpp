@@ -1,10 +1,13 @@
 #include <ecs/SerializedEntitiesAndComponents.h>
 
 #include <ecs/ComponentID.h>
+#include <ecs/ComponentReflector.h>
+#include <ecs/ComponentVector.h>
 #include <mem/DeserializeLittleEndian.h>
 #include <mem/SerializeLittleEndian.h>
 #include <network/DeltaCompression.h>
 
+#include <algorithm>
 #include <ostream>
 
 ECS::SerializedBytesWithViews& ECS::SerializedEntitiesAndComponents::FindOrCreateComponentsEntry(
@@ -34,6 +37,29 @@ const ECS::SerializedBytesWithViews* ECS::SerializedEntitiesAndComponents::FindC
 	return nullptr;
 }
 
+namespace Internal_SerializedEntitiesAndComponents
+{
+template <typename IDType>
+void MergeSortedIDs(const Collection::Vector<IDType>& ids, Collection::Vector<IDType>& inOutIDs)
+{
+	const size_t numExistingIDs = inOutIDs.Size();
+	inOutIDs.AddAll(ids.GetConstView());
+	std::inplace_merge(inOutIDs.begin(), inOutIDs.begin() + numExistingIDs, inOutIDs.end());
+	inOutIDs.Remove(std::unique(inOutIDs.begin(), inOutIDs.end()) - inOutIDs.begin(), inOutIDs.Size());
+}
+}
+
+void ECS::SerializedChanges::Merge(const SerializedChanges& other)
+{
+	using namespace Internal_SerializedEntitiesAndComponents;
+
+	for (const auto& entry : other.m_changedComponentIDs)
+	{
+		MergeSortedIDs(entry.second, m_changedComponentIDs[entry.first]);
+	}
+	MergeSortedIDs(other.m_changedEntityIDs, m_changedEntityIDs);
+}
+
 void ECS::WriteSerializedEntitiesAndComponentsTo(
 	const SerializedEntitiesAndComponents& serialization, std::ostream& fileOutput)
 {
@@ -191,6 +217,7 @@ static const uint32_t k_elementsRemovedSectionMarker = 'RMOV';
 
 static const uint8_t k_elementDeltaMarker = 0xDE;
 static const uint8_t k_elementAddedMarker = 0xAD;
+static const uint8_t k_elementsUnchangedMarker = 0xCC;
 
 template <typename T>
 Collection::ArrayView<const uint8_t> CreateByteView(const Collection::Vector<T>& v)
@@ -228,6 +255,71 @@ uint32_t GetIDFromHeader<ECS::FullSerializedEntityHeader, uint32_t>(const ECS::F
 	return header.m_entityID.GetUniqueID();
 }
 
+template <typename HeaderType, typename IDType>
+IDType GetElementID(const ECS::SerializedBytesWithViews& bytesWithViews, const size_t elementIndex)
+{
+	const HeaderType& header = *reinterpret_cast<const HeaderType*>(
+		&bytesWithViews.m_bytes[bytesWithViews.m_views[elementIndex].m_beginIndex]);
+	return GetIDFromHeader<HeaderType, IDType>(header);
+}
+
+// Find the index of the first element at or after beginIndex with an ID that isn't less than the given ID.
+template <typename HeaderType, typename IDType>
+uint32_t FindLowerBoundOfID(
+	const ECS::SerializedBytesWithViews& bytesWithViews, const uint32_t beginIndex, const IDType id)
+{
+	uint32_t lowIndex = beginIndex;
+	uint32_t highIndex = bytesWithViews.m_views.Size();
+	while (lowIndex < highIndex)
+	{
+		const uint32_t midIndex = lowIndex + ((highIndex - lowIndex) / 2);
+		if (GetElementID<HeaderType, IDType>(bytesWithViews, midIndex) < id)
+		{
+			lowIndex = midIndex + 1;
+		}
+		else
+		{
+			highIndex = midIndex;
+		}
+	}
+	return lowIndex;
+}
+
+// Transmit an element as a delta against its last seen version, or in full if it wasn't seen before.
+template <typename IDType>
+void DeltaCompressElement(
+	const Collection::Vector<uint8_t>& lastSeenBytes,
+	const ECS::SerializedByteView* const lastSeenView,
+	const IDType newestElementID,
+	const Collection::ArrayView<const uint8_t>& rawNewestElement,
+	Collection::Vector<uint8_t>& outBytes)
+{
+	if (lastSeenView != nullptr)
+	{
+		// Transmit a delta marker.
+		Mem::LittleEndian::Serialize(k_elementDeltaMarker, outBytes);
+		Mem::LittleEndian::Serialize(newestElementID, outBytes);
+
+		// Transmit the delta compressed element.
+		const size_t lastSeenElementSize = lastSeenView->m_endIndex - lastSeenView->m_beginIndex;
+		const uint8_t* const rawLastSeenElement = &lastSeenBytes[lastSeenView->m_beginIndex];
+
+		Network::DeltaCompression::Compress(
+			{ rawLastSeenElement, lastSeenElementSize },
+			rawNewestElement,
+			outBytes);
+	}
+	else
+	{
+		// Transmit an element added marker.
+		Mem::LittleEndian::Serialize(k_elementAddedMarker, outBytes);
+		Mem::LittleEndian::Serialize(newestElementID, outBytes);
+
+		// Transmit the entire added element.
+		outBytes.AddAll(rawNewestElement);
+	}
+}
+
 template <typename HeaderType, typename IDType>
 void DeltaCompressSortedLists(
 	const ECS::SerializedBytesWithViews& lastSeenBytesWithViews,
@@ -277,32 +369,105 @@ void DeltaCompressSortedLists(
 		}
 
 		// If the IDs match, we can perform delta compression. If they don't, this is a new element.
-		if (lastSeenElementID == newestElementID)
-		{
-			// Transmit a delta marker.
-			Mem::LittleEndian::Serialize(k_elementDeltaMarker, outBytes);
-			Mem::LittleEndian::Serialize(newestElementID, outBytes);
+		const ECS::SerializedByteView* const lastSeenView =
+			(lastSeenElementID == newestElementID) ? lastSeenViewsIter : nullptr;
+		DeltaCompressElement<IDType>(lastSeenBytes, lastSeenView, newestElementID,
+			{ rawNewestElement, newestElementSize }, outBytes);
+	}
 
-			// Transmit the delta compressed element.
-			const size_t lastSeenElementSize = lastSeenViewsIter->m_endIndex - lastSeenViewsIter->m_beginIndex;
-			const uint8_t* const rawLastSeenElement = &lastSeenBytes[lastSeenViewsIter->m_beginIndex];
+	// Transmit the list of elements that were removed.
+	Mem::LittleEndian::Serialize(k_elementsRemovedSectionMarker, outBytes);
+	Mem::LittleEndian::Serialize(static_cast<uint32_t>(removedElementIDs.Size()), outBytes);
+	outBytes.AddAll(CreateByteView(removedElementIDs));
+}
 
-			Network::DeltaCompression::Compress(
-				{ rawLastSeenElement, lastSeenElementSize },
-				{ rawNewestElement, newestElementSize },
+// Transmit the newest elements in [newestBeginIndex, newestEndIndex), which are unchanged since the last seen frame, as
+// a run of last seen elements.
+template <typename HeaderType, typename IDType>
+void TransmitUnchangedElements(
+	const ECS::SerializedBytesWithViews& lastSeenBytesWithViews,
+	const ECS::SerializedBytesWithViews& newestBytesWithViews,
+	const uint32_t newestBeginIndex,
+	const uint32_t newestEndIndex,
+	Collection::Vector<uint8_t>& outBytes)
+{
+	if (newestBeginIndex == newestEndIndex)
+	{
+		return;
+	}
+
+	// The unchanged elements are consecutive in the last seen frame because any element between them that was removed
+	// would be a change.
+	const IDType firstElementID = GetElementID<HeaderType, IDType>(newestBytesWithViews, newestBeginIndex);
+	const uint32_t lastSeenBeginIndex =
+		FindLowerBoundOfID<HeaderType, IDType>(lastSeenBytesWithViews, 0, firstElementID);
+	const uint32_t numElements = newestEndIndex - newestBeginIndex;
+	AMP_FATAL_ASSERT((lastSeenBeginIndex + numElements) <= lastSeenBytesWithViews.m_views.Size()
+		&& GetElementID<HeaderType, IDType>(lastSeenBytesWithViews, lastSeenBeginIndex + numElements - 1)
+			== GetElementID<HeaderType, IDType>(newestBytesWithViews, newestEndIndex - 1),
+		"Unchanged elements must be consecutive in the last seen frame. The changes between the frames are incomplete.");
+
+	Mem::LittleEndian::Serialize(k_elementsUnchangedMarker, outBytes);
+	Mem::LittleEndian::Serialize(lastSeenBeginIndex, outBytes);
+	Mem::LittleEndian::Serialize(numElements, outBytes);
+}
+
+// Delta compress sorted lists like DeltaCompressSortedLists, but only visit the elements with the given sorted IDs.
+// All other elements are identical in both lists, so they are transmitted as runs of last seen elements.
+template <typename HeaderType, typename IDType>
+void DeltaCompressChangedElementsOfSortedLists(
+	const ECS::SerializedBytesWithViews& lastSeenBytesWithViews,
+	const ECS::SerializedBytesWithViews& newestBytesWithViews,
+	const Collection::ArrayView<const IDType>& changedElementIDs,
+	Collection::Vector<uint8_t>& outBytes)
+{
+	// Transmit the views.
+	Network::DeltaCompression::Compress(
+		CreateByteView(lastSeenBytesWithViews.m_views),
+		CreateByteView(newestBytesWithViews.m_views),
+		outBytes);
+
+	const uint32_t numNewestElements = newestBytesWithViews.m_views.Size();
+	const uint32_t numLastSeenElements = lastSeenBytesWithViews.m_views.Size();
+
+	uint32_t newestIndex = 0;
+	Collection::Vector<IDType> removedElementIDs;
+	for (const auto& changedElementID : changedElementIDs)
+	{
+		// Transmit the unchanged elements before the changed element.
+		const uint32_t changedNewestIndex =
+			FindLowerBoundOfID<HeaderType, IDType>(newestBytesWithViews, newestIndex, changedElementID);
+		TransmitUnchangedElements<HeaderType, IDType>(
+			lastSeenBytesWithViews, newestBytesWithViews, newestIndex, changedNewestIndex, outBytes);
+		newestIndex = changedNewestIndex;
+
+		const uint32_t lastSeenIndex =
+			FindLowerBoundOfID<HeaderType, IDType>(lastSeenBytesWithViews, 0, changedElementID);
+		const bool wasSeen = (lastSeenIndex < numLastSeenElements)
+			&& (GetElementID<HeaderType, IDType>(lastSeenBytesWithViews, lastSeenIndex) == changedElementID);
+
+		const bool isInNewest = (newestIndex < numNewestElements)
+			&& (GetElementID<HeaderType, IDType>(newestBytesWithViews, newestIndex) == changedElementID);
+		if (isInNewest)
+		{
+			const ECS::SerializedByteView& newestView = newestBytesWithViews.m_views[newestIndex];
+			const ECS::SerializedByteView* const lastSeenView =
+				wasSeen ? &lastSeenBytesWithViews.m_views[lastSeenIndex] : nullptr;
+			DeltaCompressElement<IDType>(lastSeenBytesWithViews.m_bytes, lastSeenView, changedElementID,
+				{ &newestBytesWithViews.m_bytes[newestView.m_beginIndex], newestView.m_endIndex - newestView.m_beginIndex },
 				outBytes);
+			++newestIndex;
 		}
-		else
+		else if (wasSeen)
 		{
-			// Transmit an element added marker.
-			Mem::LittleEndian::Serialize(k_elementAddedMarker, outBytes);
-			Mem::LittleEndian::Serialize(newestElementID, outBytes);
-
-			// Transmit the entire added element.
-			outBytes.AddAll({ rawNewestElement, newestElementSize });
+			removedElementIDs.Add(changedElementID);
 		}
 	}
 
+	// Transmit the unchanged elements after the last changed element.
+	TransmitUnchangedElements<HeaderType, IDType>(
+		lastSeenBytesWithViews, newestBytesWithViews, newestIndex, numNewestElements, outBytes);
+
 	// Transmit the list of elements that were removed.
 	Mem::LittleEndian::Serialize(k_elementsRemovedSectionMarker, outBytes);
 	Mem::LittleEndian::Serialize(static_cast<uint32_t>(removedElementIDs.Size()), outBytes);
@@ -367,24 +532,73 @@ bool TryDeltaDecompressSortedLists(
 	const auto& lastSeenBytes = lastSeenBytesWithViews.m_bytes;
 	auto& outNewestBytes = outNewestBytesWithViews.m_bytes;
 
+	const ECS::SerializedByteView* const lastSeenViewsBegin = lastSeenBytesWithViews.m_views.begin();
 	const ECS::SerializedByteView* const lastSeenViewsEnd = lastSeenBytesWithViews.m_views.end();
-	const ECS::SerializedByteView* lastSeenViewsIter = lastSeenBytesWithViews.m_views.begin();
-	for (const auto& newestView : outNewestBytesWithViews.m_views)
+	const ECS::SerializedByteView* lastSeenViewsIter = lastSeenViewsBegin;
+	for (size_t newestIndex = 0; newestIndex < numNewestElements;)
 	{
-		// Validate the view's indices.
-		if (newestView.m_beginIndex > newestView.m_endIndex)
+		// Read the marker.
+		auto maybeElementMarker = Mem::LittleEndian::DeserializeUi8(deltaCompressedIter, deltaCompressedEnd);
+		if (!maybeElementMarker.second)
 		{
 			return false;
 		}
+		const uint8_t elementMarker = maybeElementMarker.first;
 
-		// Read the marker and the element ID.
-		auto maybeElementMarker = Mem::LittleEndian::DeserializeUi8(deltaCompressedIter, deltaCompressedEnd);
-		if (!maybeElementMarker.second)
+		// Copy runs of unchanged elements from the last seen elements.
+		if (elementMarker == k_elementsUnchangedMarker)
+		{
+			const auto maybeLastSeenBeginIndex =
+				Mem::LittleEndian::DeserializeUi32(deltaCompressedIter, deltaCompressedEnd);
+			const auto maybeNumElements = Mem::LittleEndian::DeserializeUi32(deltaCompressedIter, deltaCompressedEnd);
+			if (!maybeLastSeenBeginIndex.second || !maybeNumElements.second)
+			{
+				return false;
+			}
+
+			// The run must not go back before elements that were already visited or go past the end of either list.
+			const size_t lastSeenBeginIndex = maybeLastSeenBeginIndex.first;
+			const size_t numElements = maybeNumElements.first;
+			if (lastSeenBeginIndex < static_cast<size_t>(lastSeenViewsIter - lastSeenViewsBegin)
+				|| (lastSeenBeginIndex + numElements) > lastSeenBytesWithViews.m_views.Size()
+				|| (newestIndex + numElements) > numNewestElements)
+			{
+				return false;
+			}
+
+			for (size_t i = 0; i < numElements; ++i)
+			{
+				const ECS::SerializedByteView& lastSeenView = lastSeenViewsBegin[lastSeenBeginIndex + i];
+				const ECS::SerializedByteView& newestView = outNewestBytesWithViews.m_views[newestIndex + i];
+				if (newestView.m_beginIndex > newestView.m_endIndex
+					|| (newestView.m_endIndex - newestView.m_beginIndex)
+						!= (lastSeenView.m_endIndex - lastSeenView.m_beginIndex))
+				{
+					return false;
+				}
+
+				if (outNewestBytes.Size() < newestView.m_endIndex)
+				{
+					outNewestBytes.Resize(newestView.m_endIndex, 0);
+				}
+				memcpy(&outNewestBytes[newestView.m_beginIndex], &lastSeenBytes[lastSeenView.m_beginIndex],
+					newestView.m_endIndex - newestView.m_beginIndex);
+			}
+
+			lastSeenViewsIter = lastSeenViewsBegin + lastSeenBeginIndex + numElements;
+			newestIndex += numElements;
+			continue;
+		}
+
+		// Validate the view's indices.
+		const ECS::SerializedByteView& newestView = outNewestBytesWithViews.m_views[newestIndex];
+		++newestIndex;
+		if (newestView.m_beginIndex > newestView.m_endIndex)
 		{
 			return false;
 		}
-		const uint8_t elementMarker = maybeElementMarker.first;
 
+		// Read the element ID.
 		IDType newestElementID;
 		if (!TryDeserializeID<HeaderType, IDType>(deltaCompressedIter, deltaCompressedEnd, newestElementID))
 		{
@@ -484,13 +698,16 @@ bool TryDeltaDecompressSortedLists(
 }
 }
 
-void ECS::DeltaCompressSerializedEntitiesAndComponentsTo(
-	const SerializedEntitiesAndComponents& lastSeenFrame,
-	const SerializedEntitiesAndComponents& newestFrame,
+namespace Internal_SerializedEntitiesAndComponents
+{
+// Delta compress a frame against the last seen frame. If the changes between the frames are known, only the changed
+// elements are compared.
+void DeltaCompressFrame(
+	const ECS::SerializedEntitiesAndComponents& lastSeenFrame,
+	const ECS::SerializedEntitiesAndComponents& newestFrame,
+	const ECS::SerializedChanges* const changes,
 	Collection::Vector<uint8_t>& outBytes)
 {
-	using namespace Internal_SerializedEntitiesAndComponents;
-
 	// Transmit the components.
 	Mem::LittleEndian::Serialize(static_cast<uint32_t>(newestFrame.m_components.Size()), outBytes);
 	for (const auto& entry : newestFrame.m_components)
@@ -525,8 +742,20 @@ void ECS::DeltaCompressSerializedEntitiesAndComponentsTo(
 		}
 
 		// Delta compress the component views and bytes when there are last seen components.
-		DeltaCompressSortedLists<ECS::FullSerializedComponentHeader, uint64_t>(
-			*lastSeenComponents, entry.second, outBytes);
+		if (changes == nullptr)
+		{
+			DeltaCompressSortedLists<ECS::FullSerializedComponentHeader, uint64_t>(
+				*lastSeenComponents, entry.second, outBytes);
+			continue;
+		}
+
+		const auto* const changedComponentIDs = changes->m_changedComponentIDs.Find(entry.first);
+		const Collection::ArrayView<const uint64_t> changedComponentIDsView =
+			(changedComponentIDs != changes->m_changedComponentIDs.end())
+			? changedComponentIDs->second.GetConstView()
+			: Collection::ArrayView<const uint64_t>(nullptr, 0);
+		DeltaCompressChangedElementsOfSortedLists<ECS::FullSerializedComponentHeader, uint64_t>(
+			*lastSeenComponents, entry.second, changedComponentIDsView, outBytes);
 	}
 
 	// TODO(network) handle component types that were removed entirely since the last seen frame
@@ -536,8 +765,140 @@ void ECS::DeltaCompressSerializedEntitiesAndComponentsTo(
 	Mem::LittleEndian::Serialize(static_cast<uint32_t>(newestFrame.m_entities.m_views.Size()), outBytes);
 
 	// Scan over the sorted entity lists to transmit the entity data.
-	DeltaCompressSortedLists<ECS::FullSerializedEntityHeader, uint32_t>(
-		lastSeenFrame.m_entities, newestFrame.m_entities, outBytes);
+	if (changes == nullptr)
+	{
+		DeltaCompressSortedLists<ECS::FullSerializedEntityHeader, uint32_t>(
+			lastSeenFrame.m_entities, newestFrame.m_entities, outBytes);
+	}
+	else
+	{
+		DeltaCompressChangedElementsOfSortedLists<ECS::FullSerializedEntityHeader, uint32_t>(
+			lastSeenFrame.m_entities, newestFrame.m_entities, changes->m_changedEntityIDs.GetConstView(), outBytes);
+	}
+}
+}
+
+void ECS::FilterSerializedEntitiesAndComponents(
+	const SerializedEntitiesAndComponents& serialization,
+	const Collection::ArrayView<const uint32_t>& entityIDs,
+	SerializedEntitiesAndComponents& outFilteredSerialization)
+{
+	using namespace Internal_SerializedEntitiesAndComponents;
+
+	// List the same component types as the serialization, reusing the memory of the existing entries.
+	Collection::Vector<Collection::Pair<ComponentType, SerializedBytesWithViews>>& filteredComponents =
+		outFilteredSerialization.m_components;
+	while (filteredComponents.Size() < serialization.m_components.Size())
+	{
+		filteredComponents.Emplace(ComponentType(), SerializedBytesWithViews());
+	}
+	filteredComponents.Remove(serialization.m_components.Size(), filteredComponents.Size());
+	for (size_t i = 0, iEnd = filteredComponents.Size(); i < iEnd; ++i)
+	{
+		filteredComponents[i].first = serialization.m_components[i].first;
+		filteredComponents[i].second.m_bytes.Clear();
+		filteredComponents[i].second.m_views.Clear();
+	}
+
+	SerializedBytesWithViews& filteredEntities = outFilteredSerialization.m_entities;
+	filteredEntities.m_bytes.Clear();
+	filteredEntities.m_views.Clear();
+
+	// Copy the entities. Both lists are sorted by entity ID, so each search begins where the previous one ended.
+	// The views of their components are gathered into the filtered component lists, still pointing at the bytes of
+	// the original serialization.
+	const SerializedBytesWithViews& entities = serialization.m_entities;
+	uint32_t entityIndex = 0;
+	for (const uint32_t entityID : entityIDs)
+	{
+		entityIndex = FindLowerBoundOfID<FullSerializedEntityHeader, uint32_t>(entities, entityIndex, entityID);
+		if (entityIndex == entities.m_views.Size())
+		{
+			break;
+		}
+		if (GetElementID<FullSerializedEntityHeader, uint32_t>(entities, entityIndex) != entityID)
+		{
+			continue;
+		}
+
+		const SerializedByteView& entityView = entities.m_views[entityIndex];
+		const uint8_t* const viewBegin = &entities.m_bytes[entityView.m_beginIndex];
+		const uint32_t viewSize = entityView.m_endIndex - entityView.m_beginIndex;
+
+		const uint32_t filteredBeginIndex = filteredEntities.m_bytes.Size();
+		filteredEntities.m_bytes.AddAll({ viewBegin, viewSize });
+		filteredEntities.m_views.Add({ filteredBeginIndex, filteredEntities.m_bytes.Size() });
+
+		FullSerializedEntityHeader header;
+		memcpy(&header, viewBegin, FullSerializedEntityHeader::k_unpaddedSize);
+
+		const uint8_t* componentListIter = viewBegin + FullSerializedEntityHeader::k_unpaddedSize;
+		const uint8_t* const componentListEnd = viewBegin + viewSize;
+		for (uint32_t i = 0; i < header.m_numComponents; ++i)
+		{
+			const auto maybeComponentTypeIndex =
+				Mem::LittleEndian::DeserializeUi16(componentListIter, componentListEnd);
+			const auto maybeComponentUniqueID =
+				Mem::LittleEndian::DeserializeUi64(componentListIter, componentListEnd);
+			if (!maybeComponentTypeIndex.second || !maybeComponentUniqueID.second
+				|| maybeComponentTypeIndex.first >= serialization.m_components.Size())
+			{
+				AMP_LOG_WARNING("Serialized entity view isn't large enough for all its component IDs.");
+				break;
+			}
+			const uint16_t componentTypeIndex = maybeComponentTypeIndex.first;
+			const uint64_t componentUniqueID = maybeComponentUniqueID.first;
+
+			const SerializedBytesWithViews& components = serialization.m_components[componentTypeIndex].second;
+			const uint32_t componentIndex =
+				FindLowerBoundOfID<FullSerializedComponentHeader, uint64_t>(components, 0, componentUniqueID);
+			if (componentIndex < components.m_views.Size()
+				&& GetElementID<FullSerializedComponentHeader, uint64_t>(components, componentIndex) == componentUniqueID)
+			{
+				filteredComponents[componentTypeIndex].second.m_views.Add(components.m_views[componentIndex]);
+			}
+		}
+	}
+
+	// Sort each type's component views by component ID and copy the components' bytes.
+	for (size_t i = 0, iEnd = filteredComponents.Size(); i < iEnd; ++i)
+	{
+		const Collection::Vector<uint8_t>& bytes = serialization.m_components[i].second.m_bytes;
+		SerializedBytesWithViews& filtered = filteredComponents[i].second;
+
+		const auto getID = [&](const SerializedByteView& view)
+		{
+			FullSerializedComponentHeader header;
+			memcpy(&header, &bytes[view.m_beginIndex], FullSerializedComponentHeader::k_unpaddedSize);
+			return header.m_uniqueID;
+		};
+		std::sort(filtered.m_views.begin(), filtered.m_views.end(),
+			[&](const SerializedByteView& lhs, const SerializedByteView& rhs) { return getID(lhs) < getID(rhs); });
+
+		for (auto& view : filtered.m_views)
+		{
+			const uint32_t filteredBeginIndex = filtered.m_bytes.Size();
+			filtered.m_bytes.AddAll({ &bytes[view.m_beginIndex], view.m_endIndex - view.m_beginIndex });
+			view = { filteredBeginIndex, filtered.m_bytes.Size() };
+		}
+	}
+}
+
+void ECS::DeltaCompressSerializedEntitiesAndComponentsTo(
+	const SerializedEntitiesAndComponents& lastSeenFrame,
+	const SerializedEntitiesAndComponents& newestFrame,
+	Collection::Vector<uint8_t>& outBytes)
+{
+	Internal_SerializedEntitiesAndComponents::DeltaCompressFrame(lastSeenFrame, newestFrame, nullptr, outBytes);
+}
+
+void ECS::DeltaCompressSerializedEntitiesAndComponentsTo(
+	const SerializedEntitiesAndComponents& lastSeenFrame,
+	const SerializedEntitiesAndComponents& newestFrame,
+	const SerializedChanges& changes,
+	Collection::Vector<uint8_t>& outBytes)
+{
+	Internal_SerializedEntitiesAndComponents::DeltaCompressFrame(lastSeenFrame, newestFrame, &changes, outBytes);
 }
 
 bool ECS::TryDeltaDecompressSerializedEntitiesAndComponentsFrom(
@@ -668,3 +1029,64 @@ bool ECS::TryDeltaDecompressSerializedEntitiesAndComponentsFrom(
 
 	return true;
 }
+
+void ECS::BuildSerializationDictionary(
+	const ComponentReflector& componentReflector,
+	Collection::Vector<uint8_t>& outDictionary)
+{
+	using namespace Internal_SerializedEntitiesAndComponents;
+
+	// Component type names are written as strings in both full and delta serializations. Delta serializations precede
+	// each name with a section marker. Each name is followed by the default serialization of its component type after
+	// a header template, which for memory-imaged component types is the full memory image of a default component.
+	// Tag components are never instantiated, so they are serialized as just their header.
+	Mem::LittleEndian::Serialize(k_fullComponentsSectionMarker, outDictionary);
+	componentReflector.ForEachComponentType([&](const ComponentType componentType)
+		{
+			Mem::LittleEndian::Serialize(k_deltaComponentsSectionMarker, outDictionary);
+			Mem::LittleEndian::Serialize(Util::ReverseHash(componentType.GetTypeHash()), outDictionary);
+
+			const ComponentID defaultComponentID{ componentType, 0 };
+			FullSerializedComponentHeader componentHeader;
+			componentHeader.m_uniqueID = defaultComponentID.GetUniqueID();
+
+			const uint32_t headerIndex = outDictionary.Size();
+			outDictionary.Resize(headerIndex + FullSerializedComponentHeader::k_unpaddedSize);
+			memcpy(&outDictionary[headerIndex], &componentHeader, FullSerializedComponentHeader::k_unpaddedSize);
+
+			const ComponentReflector::MandatoryComponentFunctions& componentFunctions =
+				componentReflector.FindComponentFunctions(componentType);
+			if (componentFunctions.m_basicConstructFunction == nullptr)
+			{
+				return;
+			}
+
+			ComponentVector defaultComponents{ componentReflector,
+				componentType,
+				componentReflector.GetSizeOfComponentInBytes(componentType),
+				componentReflector.GetAlignOfComponentInBytes(componentType) };
+			const Component* const defaultComponent =
+				componentReflector.TryBasicConstructComponent(defaultComponentID, ArchetypeID(), defaultComponents);
+			if (defaultComponent != nullptr)
+			{
+				componentFunctions.m_fullSerializationFunction(*defaultComponent, outDictionary);
+			}
+		});
+
+	Mem::LittleEndian::Serialize(k_elementsRemovedSectionMarker, outDictionary);
+	Mem::LittleEndian::Serialize(k_entitiesSectionMarker, outDictionary);
+
+	// Entities are serialized as a header followed by the type index and unique ID of each of their components. The
+	// header template is a networked root entity with a single component.
+	FullSerializedEntityHeader entityHeader;
+	entityHeader.m_numComponents = 1;
+	entityHeader.m_flags = EntityFlags::Networked;
+	entityHeader.m_layer = EntityLayer();
+
+	const uint32_t entityHeaderIndex = outDictionary.Size();
+	outDictionary.Resize(entityHeaderIndex + FullSerializedEntityHeader::k_unpaddedSize);
+	memcpy(&outDictionary[entityHeaderIndex], &entityHeader, FullSerializedEntityHeader::k_unpaddedSize);
+
+	Mem::LittleEndian::Serialize(uint16_t(0), outDictionary);
+	Mem::LittleEndian::Serialize(uint64_t(0), outDictionary);
+}
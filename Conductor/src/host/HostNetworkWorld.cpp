@@ -3,11 +3,27 @@
 #include <client/ConnectedHost.h>
 #include <mem/DeserializeLittleEndian.h>
 #include <mem/SerializeLittleEndian.h>
+#include <network/MessageFraming.h>
 
-Host::HostNetworkWorld::HostNetworkWorld(const char* listenerPort)
-	: m_listenerSocket(Network::CreateAndBindListenerSocket(listenerPort))
+#include <algorithm>
+
+Host::HostNetworkWorld::HostNetworkWorld(const char* listenerPort, const Network::TransportOptions& transportOptions)
+	: m_transportOptions(transportOptions)
+	, m_startTime(std::chrono::steady_clock::now())
 {
-	if (m_listenerSocket.TryListen())
+	bool isListening = false;
+	if (m_transportOptions.m_type == Network::TransportType::Datagram)
+	{
+		m_datagramSocket = Network::CreateBoundDatagramSocket(listenerPort);
+		isListening = m_socketPoller.TryAdd(m_datagramSocket, k_listenerPollKey);
+	}
+	else
+	{
+		m_listenerSocket = Network::CreateAndBindListenerSocket(listenerPort);
+		isListening = m_listenerSocket.TryListen() && m_socketPoller.TryAdd(m_listenerSocket, k_listenerPollKey);
+	}
+
+	if (isListening)
 	{
 		// Add the default local client for the server administrator.
 		m_networkConnectedClients[k_localClientID] = Mem::MakeUnique<NetworkConnectedClient>();
@@ -35,6 +51,12 @@ void Host::HostNetworkWorld::WaitForShutdown()
 void Host::HostNetworkWorld::NotifyOfConsoleInput(std::string&& input)
 {
 	m_consoleMessageQueue.TryPush(std::move(input));
+	m_socketPoller.Wake();
+}
+
+void Host::HostNetworkWorld::NotifyOfOutboundMessages()
+{
+	m_socketPoller.Wake();
 }
 
 namespace Internal_HostNetworkWorld
@@ -49,13 +71,72 @@ void ProcessConsoleMessage(Client::ConnectedHost& localHost, const std::string&
 	// TODO(network) kick clients
 	// TODO(network) print client list
 }
+
+// Serialize everything about a message except an ECS update's payload, which is sent from the message to avoid
+// copying it. Returns the size of the payload which follows the serialized bytes.
+size_t SerializeMessageToClient(
+	const Host::MessageToClient& message,
+	const uint64_t sequenceNumber,
+	Collection::Vector<uint8_t>& outBytes)
+{
+	Mem::LittleEndian::Serialize(sequenceNumber, outBytes);
+
+	const uint16_t tag = static_cast<uint16_t>(message.GetTag());
+	Mem::LittleEndian::Serialize(tag, outBytes);
+
+	size_t numPayloadBytes = 0;
+	message.Match(
+		[&](const Host::NotifyOfHostConnected_MessageToClient& payload)
+		{
+			Mem::LittleEndian::Serialize(payload.m_clientID.GetN(), outBytes);
+		},
+		[](const Host::NotifyOfHostDisconnected_MessageToClient&) {},
+		[&](const Host::ECSUpdate_MessageToClient& payload)
+		{
+			Mem::LittleEndian::Serialize(static_cast<uint32_t>(payload.m_bytes.Size()), outBytes);
+			numPayloadBytes = payload.m_bytes.Size();
+		});
+	return numPayloadBytes;
+}
+
+// Add the bytes of the given buffers which follow the first numBytesSent of them to outBytes.
+void AddUnsentBytes(
+	const Collection::ArrayView<const Collection::ArrayView<const uint8_t>>& buffers,
+	const size_t numBytesSent,
+	Collection::Vector<uint8_t>& outBytes)
+{
+	size_t numBytesToSkip = numBytesSent;
+	for (const auto& buffer : buffers)
+	{
+		if (numBytesToSkip >= buffer.Size())
+		{
+			numBytesToSkip -= buffer.Size();
+			continue;
+		}
+		outBytes.AddAll({ buffer.begin() + numBytesToSkip, buffer.Size() - numBytesToSkip });
+		numBytesToSkip = 0;
+	}
+}
 }
 
 void Host::HostNetworkWorld::NetworkThreadFunction()
 {
+	const bool isDatagramTransport = (m_transportOptions.m_type == Network::TransportType::Datagram);
+	const Unit::Time::Millisecond maxPollWaitTime = isDatagramTransport ? k_maxDatagramPollWaitTime : k_maxPollWaitTime;
+
 	// Run the thread so long as the default local client is not disconnected.
 	while (m_networkConnectedClients.Find(k_localClientID) != m_networkConnectedClients.end())
 	{
+		// Sleep until a socket has data to receive or the thread is woken to process console or outbound messages.
+		uint64_t readySocketKeys[k_maxNumReadySockets];
+		const size_t numReadySockets = m_socketPoller.Wait(maxPollWaitTime, readySocketKeys, k_maxNumReadySockets);
+		const auto isSocketReady = [&](const uint64_t key)
+		{
+			return std::find(readySocketKeys, readySocketKeys + numReadySockets, key)
+				!= readySocketKeys + numReadySockets;
+		};
+		const Unit::Time::Millisecond now = GetNetworkTime();
+
 		// Process console messages.
 		{
 			// Create a Client::ConnectedHost for the local client to make processing simpler.
@@ -69,26 +150,17 @@ void Host::HostNetworkWorld::NetworkThreadFunction()
 			}
 		}
 
-		// Accept client connection requests.
-		constexpr size_t k_maxNewClients = 8;
-		Network::Socket newClientSockets[k_maxNewClients];
-		const size_t numNewClients = m_listenerSocket.AcceptPendingConnections(newClientSockets, k_maxNewClients);
-		
-		for (size_t i = 0; i < numNewClients; ++i)
+		// Accept client connection requests. Over UDP, connection requests arrive with the other datagrams.
+		if (isSocketReady(k_listenerPollKey))
 		{
-			const Client::ClientID clientID{
-				static_cast<uint16_t>(k_localClientID.GetN() + m_networkConnectedClients.Size() + 1) };
-
-			AMP_LOG("New client connection accepted. ID: %u", clientID.GetN());
-
-			Mem::UniquePtr<NetworkConnectedClient>& networkConnectedClient = m_networkConnectedClients[clientID];
-			networkConnectedClient = Mem::MakeUnique<NetworkConnectedClient>();
-			networkConnectedClient->m_clientSocket = std::move(newClientSockets[i]);
-
-			auto& message = Host::MessageToClient::Make<NotifyOfHostConnected_MessageToClient>();
-			auto& payload = message.Get<NotifyOfHostConnected_MessageToClient>();
-			payload.m_clientID = clientID;
-			networkConnectedClient->m_hostToClientMessageQueue.TryPush(std::move(message));
+			if (isDatagramTransport)
+			{
+				ReceiveDatagrams(now);
+			}
+			else
+			{
+				AcceptStreamClients();
+			}
 		}
 
 		// Process the network connected clients.
@@ -96,36 +168,27 @@ void Host::HostNetworkWorld::NetworkThreadFunction()
 		for (auto& entry : m_networkConnectedClients)
 		{
 			const Client::ClientID clientID = entry.first;
-			Mem::UniquePtr<NetworkConnectedClient>& networkConnectedClient = entry.second;
+			NetworkConnectedClient& networkConnectedClient = *entry.second;
 
 			// Receive any pending data from the client.
 			if (clientID != k_localClientID)
 			{
-				uint8_t inboundBuffer[4096];
-				Collection::ArrayView<uint8_t> inboundBufferView{ inboundBuffer, sizeof(inboundBuffer) };
-				
-				size_t numBytesReceived = networkConnectedClient->m_clientSocket.Receive(inboundBufferView);
-				while (networkConnectedClient->m_clientSocket.IsValid() && numBytesReceived != 0)
+				if (isDatagramTransport)
+				{
+					ReceiveFromDatagramClient(clientID, networkConnectedClient);
+				}
+				else if (isSocketReady(clientID.GetN()))
 				{
-					Client::MessageToHost messageFromClient;
-					if (TryReceiveMessageFromClient(
-						{ inboundBuffer, numBytesReceived },
-						clientID,
-						*networkConnectedClient,
-						messageFromClient))
+					// A ready socket has data to receive, room to send the bytes waiting to be sent to it, or both.
+					ReceiveFromStreamClient(clientID, networkConnectedClient);
+					if (networkConnectedClient.m_clientSocket.IsValid())
 					{
-						// TODO(network) should there be separate queues for each client?
-						if (!m_clientToHostMessageQueue.TryPush(std::move(messageFromClient)))
-						{
-							// TODO(network)
-							break;
-						}
+						FlushPendingTransmission(networkConnectedClient);
 					}
-					numBytesReceived = networkConnectedClient->m_clientSocket.Receive(inboundBufferView);
 				}
 
-				// If the socket is no longer valid, this client is no longer valid.
-				if (!networkConnectedClient->m_clientSocket.IsValid())
+				// If the client's connection is lost, this client is no longer valid.
+				if (!IsClientConnected(networkConnectedClient, now))
 				{
 					disconnectedClientIDs.Add(clientID);
 					continue;
@@ -133,22 +196,63 @@ void Host::HostNetworkWorld::NetworkThreadFunction()
 			}
 
 			// TODO(network) Process client to host messages, including disconnection messages.
-			
-			// TODO(network) Check if the client disconnected without notice.
 
 			// Transmit host messages to each client.
-			Host::MessageToClient messageToClient;
-			while (networkConnectedClient->m_hostToClientMessageQueue.TryPop(messageToClient))
+			Host::MessageToClient messagesToClient[k_messageBatchSize];
+			size_t numMessages;
+			while ((numMessages = networkConnectedClient.m_hostToClientMessageQueue.TryPopBatch(
+				messagesToClient, k_messageBatchSize)) != 0)
 			{
-				if (messageToClient.Is<Host::NotifyOfHostDisconnected_MessageToClient>())
+				for (size_t i = 0; i < numMessages; ++i)
 				{
-					disconnectedClientIDs.Add(clientID);
+					if (messagesToClient[i].Is<Host::NotifyOfHostDisconnected_MessageToClient>())
+					{
+						disconnectedClientIDs.Add(clientID);
+					}
 				}
 
 				// Messages to the local client are exchanged via shared thread-safe queue and don't use a socket.
-				if (clientID != k_localClientID)
+				// Messages to clients whose connections were lost while transmitting are dropped.
+				if (clientID == k_localClientID || !IsClientConnected(networkConnectedClient, now))
 				{
-					TransmitMessageToClient(messageToClient, *networkConnectedClient);
+					continue;
+				}
+				if (isDatagramTransport)
+				{
+					TransmitMessagesToDatagramClient(now, { messagesToClient, numMessages }, networkConnectedClient);
+				}
+				else
+				{
+					TransmitMessagesToClient({ messagesToClient, numMessages }, networkConnectedClient);
+				}
+			}
+
+			if (clientID != k_localClientID)
+			{
+				// Datagram connections send resent messages and acknowledgements even when there are no new messages.
+				if (isDatagramTransport)
+				{
+					networkConnectedClient.m_datagramConnection->Flush(now,
+						[&](const Collection::ArrayView<const uint8_t>& datagram)
+						{
+							m_datagramSocket.SendTo(networkConnectedClient.m_datagramAddress, datagram);
+						});
+				}
+				else
+				{
+					// Stream sockets are only waited on to be ready to send while bytes are waiting to be sent to them.
+					const bool isWaitingForSend = !networkConnectedClient.m_pendingTransmissionBytes.IsEmpty();
+					if (isWaitingForSend != networkConnectedClient.m_isWaitingForSend)
+					{
+						m_socketPoller.SetWaitForSend(
+							networkConnectedClient.m_clientSocket, clientID.GetN(), isWaitingForSend);
+						networkConnectedClient.m_isWaitingForSend = isWaitingForSend;
+					}
+				}
+
+				if (!IsClientConnected(networkConnectedClient, now))
+				{
+					disconnectedClientIDs.Add(clientID);
 				}
 			}
 		}
@@ -156,13 +260,199 @@ void Host::HostNetworkWorld::NetworkThreadFunction()
 		// Remove any clients that are no longer connected.
 		for (const auto& clientID : disconnectedClientIDs)
 		{
-			m_networkConnectedClients.TryRemove(clientID);
+			const auto entry = m_networkConnectedClients.Find(clientID);
+			if (entry != m_networkConnectedClients.end())
+			{
+				m_socketPoller.Remove(entry->second->m_clientSocket);
+				m_networkConnectedClients.TryRemove(clientID);
+			}
+		}
+	}
+}
+
+Unit::Time::Millisecond Host::HostNetworkWorld::GetNetworkTime() const
+{
+	const auto elapsed = std::chrono::steady_clock::now() - m_startTime;
+	return Unit::Time::Millisecond(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+}
+
+bool Host::HostNetworkWorld::IsClientConnected(
+	const NetworkConnectedClient& networkConnectedClient, const Unit::Time::Millisecond now) const
+{
+	if (networkConnectedClient.m_datagramConnection != nullptr)
+	{
+		return !networkConnectedClient.m_datagramConnection->HasTimedOut(now);
+	}
+	return networkConnectedClient.m_clientSocket.IsValid();
+}
+
+Host::HostNetworkWorld::NetworkConnectedClient& Host::HostNetworkWorld::AddNetworkConnectedClient(
+	Client::ClientID& outClientID)
+{
+	const Client::ClientID clientID{
+		static_cast<uint16_t>(k_localClientID.GetN() + m_networkConnectedClients.Size() + 1) };
+	outClientID = clientID;
+
+	AMP_LOG("New client connection accepted. ID: %u", clientID.GetN());
+
+	Mem::UniquePtr<NetworkConnectedClient>& networkConnectedClient = m_networkConnectedClients[clientID];
+	networkConnectedClient = Mem::MakeUnique<NetworkConnectedClient>();
+
+	auto message = Host::MessageToClient::Make<NotifyOfHostConnected_MessageToClient>();
+	auto& payload = message.Get<NotifyOfHostConnected_MessageToClient>();
+	payload.m_clientID = clientID;
+	networkConnectedClient->m_hostToClientMessageQueue.TryPush(std::move(message));
+
+	return *networkConnectedClient;
+}
+
+void Host::HostNetworkWorld::AcceptStreamClients()
+{
+	constexpr size_t k_maxNewClients = 8;
+	Network::Socket newClientSockets[k_maxNewClients];
+	const size_t numNewClients = m_listenerSocket.AcceptPendingConnections(newClientSockets, k_maxNewClients);
+
+	for (size_t i = 0; i < numNewClients; ++i)
+	{
+		Client::ClientID clientID;
+		NetworkConnectedClient& networkConnectedClient = AddNetworkConnectedClient(clientID);
+		Network::Socket& clientSocket = networkConnectedClient.m_clientSocket;
+		clientSocket = std::move(newClientSockets[i]);
+
+		// Client sockets don't block so that a client which is slow to receive can't stall the network thread.
+		if (clientSocket.IsValid() && !clientSocket.TrySetNonBlocking())
+		{
+			clientSocket.Close();
+		}
+		m_socketPoller.TryAdd(clientSocket, clientID.GetN());
+	}
+}
+
+void Host::HostNetworkWorld::ReceiveFromStreamClient(
+	const Client::ClientID clientID,
+	NetworkConnectedClient& networkConnectedClient)
+{
+	Network::Socket& clientSocket = networkConnectedClient.m_clientSocket;
+	Network::FrameReassembler& frameReassembler = networkConnectedClient.m_frameReassembler;
+
+	Collection::ArrayView<uint8_t> inboundBufferView = frameReassembler.GetReceiveBuffer();
+	size_t numBytesReceived = clientSocket.Receive(inboundBufferView);
+	while (clientSocket.IsValid() && numBytesReceived != 0)
+	{
+		frameReassembler.NotifyOfBytesReceived(numBytesReceived);
+
+		// Parse each complete message in place in the reassembler's buffer.
+		Collection::ArrayView<const uint8_t> frame{ nullptr, 0 };
+		while (frameReassembler.TryPopFrame(frame))
+		{
+			Client::MessageToHost messageFromClient;
+			if (TryReceiveMessageFromClient(frame, clientID, networkConnectedClient, messageFromClient))
+			{
+				// All clients share the queue to the host, which supports multiple producers.
+				if (!m_clientToHostMessageQueue.TryPush(std::move(messageFromClient)))
+				{
+					// TODO(network)
+					AMP_LOG_WARNING("Dropped a message from client [%u] because the inbound queue is full.",
+						clientID.GetN());
+				}
+			}
 		}
 
-		std::this_thread::yield();
+		// A corrupt frame size means the client's messages can't be separated anymore.
+		if (frameReassembler.HasInvalidFrame())
+		{
+			clientSocket.Close();
+			break;
+		}
+
+		inboundBufferView = frameReassembler.GetReceiveBuffer();
+		numBytesReceived = clientSocket.Receive(inboundBufferView);
 	}
 }
 
+void Host::HostNetworkWorld::ReceiveDatagrams(const Unit::Time::Millisecond now)
+{
+	uint8_t datagramBuffer[Network::DatagramSocket::k_maxDatagramSize];
+	Collection::ArrayView<uint8_t> datagramBufferView{ datagramBuffer, sizeof(datagramBuffer) };
+
+	Network::DatagramAddress address;
+	size_t numBytesReceived;
+	while ((numBytesReceived = m_datagramSocket.ReceiveFrom(address, datagramBufferView)) != 0)
+	{
+		const Collection::ArrayView<const uint8_t> datagram{ datagramBuffer, numBytesReceived };
+
+		// Give the datagram to the connection of the client it came from.
+		const auto entry = std::find_if(m_networkConnectedClients.begin(), m_networkConnectedClients.end(),
+			[&](const auto& entry)
+			{
+				return entry.second->m_datagramConnection != nullptr && entry.second->m_datagramAddress == address;
+			});
+		if (entry != m_networkConnectedClients.end())
+		{
+			entry->second->m_datagramConnection->ReceiveDatagram(now, datagram);
+		}
+		else
+		{
+			TryAcceptDatagramClient(now, address, datagram);
+		}
+	}
+}
+
+void Host::HostNetworkWorld::TryAcceptDatagramClient(
+	const Unit::Time::Millisecond now,
+	const Network::DatagramAddress& address,
+	const Collection::ArrayView<const uint8_t>& datagram)
+{
+	// A datagram from an unknown address only creates a client if it contains a connection request: a
+	// MessageToHost_Connect without a client ID, which the client sends reliably until the host responds. The datagram
+	// is checked before any connection state is allocated for the address.
+	Collection::ArrayView<const uint8_t> message{ nullptr, 0 };
+	if (!Network::DatagramConnection::TryPeekFirstReliableMessage(datagram, message))
+	{
+		return;
+	}
+
+	const uint8_t* bytesIter = message.begin();
+	const auto maybeClientID = Mem::LittleEndian::DeserializeUi16(bytesIter, message.end());
+	const auto maybeTag = Mem::LittleEndian::DeserializeUi16(bytesIter, message.end());
+	const bool isConnectionRequest = maybeClientID.second && !Client::ClientID(maybeClientID.first).IsValid()
+		&& maybeTag.second && maybeTag.first == 0; // MessageToHost_Connect
+	if (!isConnectionRequest)
+	{
+		return;
+	}
+
+	auto datagramConnection = Mem::MakeUnique<Network::DatagramConnection>(
+		now, m_transportOptions.m_simulatedLinkConditions, k_maxFrameSizeFromClient);
+	datagramConnection->ReceiveDatagram(now, datagram);
+
+	Client::ClientID clientID;
+	NetworkConnectedClient& networkConnectedClient = AddNetworkConnectedClient(clientID);
+	networkConnectedClient.m_datagramAddress = address;
+	networkConnectedClient.m_datagramConnection = std::move(datagramConnection);
+}
+
+void Host::HostNetworkWorld::ReceiveFromDatagramClient(
+	const Client::ClientID clientID,
+	NetworkConnectedClient& networkConnectedClient)
+{
+	networkConnectedClient.m_datagramConnection->PopReceivedMessages(
+		[&](const Collection::ArrayView<const uint8_t>& message)
+		{
+			Client::MessageToHost messageFromClient;
+			if (TryReceiveMessageFromClient(message, clientID, networkConnectedClient, messageFromClient))
+			{
+				// All clients share the queue to the host, which supports multiple producers.
+				if (!m_clientToHostMessageQueue.TryPush(std::move(messageFromClient)))
+				{
+					// TODO(network)
+					AMP_LOG_WARNING("Dropped a message from client [%u] because the inbound queue is full.",
+						clientID.GetN());
+				}
+			}
+		});
+}
+
 bool Host::HostNetworkWorld::TryReceiveMessageFromClient(
 	const Collection::ArrayView<const uint8_t>& bytes,
 	const Client::ClientID expectedClientID,
@@ -242,29 +532,107 @@ bool Host::HostNetworkWorld::TryReceiveMessageFromClient(
 	}
 }
 
-void Host::HostNetworkWorld::TransmitMessageToClient(
-	const Host::MessageToClient& message, NetworkConnectedClient& networkConnectedClient)
+void Host::HostNetworkWorld::TransmitMessagesToClient(
+	const Collection::ArrayView<const Host::MessageToClient>& messages,
+	NetworkConnectedClient& networkConnectedClient)
 {
-	Collection::Vector<uint8_t> transmissionBuffer(4096);
+	Collection::Vector<uint8_t>& headerBytes = networkConnectedClient.m_transmissionHeaderBytes;
+	Collection::Vector<Collection::ArrayView<const uint8_t>>& buffers = networkConnectedClient.m_transmissionBuffers;
 
-	const uint64_t sequenceNumber = networkConnectedClient.m_nextSequenceNumber++;
-	Mem::LittleEndian::Serialize(sequenceNumber, transmissionBuffer);
+	// Serialize all the headers before creating any views into them because serializing may reallocate headerBytes.
+	size_t headerEnds[k_messageBatchSize];
+	AMP_FATAL_ASSERT(messages.Size() <= k_messageBatchSize, "Can't transmit more than [%zu] messages at once.",
+		k_messageBatchSize);
 
-	const uint16_t tag = static_cast<uint16_t>(message.GetTag());
-	Mem::LittleEndian::Serialize(tag, transmissionBuffer);
+	headerBytes.Clear();
+	for (size_t i = 0, iEnd = messages.Size(); i < iEnd; ++i)
+	{
+		const Host::MessageToClient& message = messages[i];
 
-	message.Match(
-		[&](const NotifyOfHostConnected_MessageToClient& payload)
-		{
-			Mem::LittleEndian::Serialize(payload.m_clientID.GetN(), transmissionBuffer);
-		},
-		[](const NotifyOfHostDisconnected_MessageToClient&) {},
-		[&](const ECSUpdate_MessageToClient& payload)
+		const size_t frameHeaderIndex = Network::MessageFraming::BeginFrame(headerBytes);
+		const size_t numPayloadBytes = Internal_HostNetworkWorld::SerializeMessageToClient(
+			message, networkConnectedClient.m_nextSequenceNumber++, headerBytes);
+		Network::MessageFraming::FinishFrame(frameHeaderIndex, headerBytes, numPayloadBytes);
+
+		headerEnds[i] = headerBytes.Size();
+	}
+
+	// Send each header followed by its message's payload, if any, without copying the payloads.
+	buffers.Clear();
+	size_t headerBegin = 0;
+	size_t numBytes = 0;
+	for (size_t i = 0, iEnd = messages.Size(); i < iEnd; ++i)
+	{
+		buffers.Add({ headerBytes.begin() + headerBegin, headerEnds[i] - headerBegin });
+		numBytes += headerEnds[i] - headerBegin;
+		headerBegin = headerEnds[i];
+
+		if (messages[i].Is<ECSUpdate_MessageToClient>())
 		{
-			Mem::LittleEndian::Serialize(static_cast<uint32_t>(payload.m_bytes.Size()), transmissionBuffer);
-			transmissionBuffer.AddAll(payload.m_bytes.GetConstView());
-		});
+			const Collection::Vector<uint8_t>& payloadBytes = messages[i].Get<ECSUpdate_MessageToClient>().m_bytes;
+			if (!payloadBytes.IsEmpty())
+			{
+				buffers.Add(payloadBytes.GetConstView());
+				numBytes += payloadBytes.Size();
+			}
+		}
+	}
 
-	AMP_LOG("Sending [%u] bytes to client.", transmissionBuffer.Size());
-	networkConnectedClient.m_clientSocket.Send(transmissionBuffer.GetConstView());
+	AMP_LOG("Sending [%zu] bytes in [%zu] messages to client.", numBytes, messages.Size());
+
+	// The messages are only sent directly when no bytes are waiting to be sent so that the stream stays in order. The
+	// bytes the socket doesn't accept are copied to wait until it is ready to send again.
+	Network::Socket& clientSocket = networkConnectedClient.m_clientSocket;
+	Collection::Vector<uint8_t>& pendingBytes = networkConnectedClient.m_pendingTransmissionBytes;
+	const size_t numBytesSent = pendingBytes.IsEmpty() ? clientSocket.SendBatch(buffers.GetConstView()) : 0;
+	Internal_HostNetworkWorld::AddUnsentBytes(buffers.GetConstView(), numBytesSent, pendingBytes);
+
+	if (clientSocket.IsValid() && pendingBytes.Size() > k_maxPendingTransmissionBytes)
+	{
+		AMP_LOG_WARNING("Disconnecting a client with [%zu] bytes waiting to be sent to it.", pendingBytes.Size());
+		clientSocket.Close();
+	}
+}
+
+void Host::HostNetworkWorld::FlushPendingTransmission(NetworkConnectedClient& networkConnectedClient)
+{
+	Collection::Vector<uint8_t>& pendingBytes = networkConnectedClient.m_pendingTransmissionBytes;
+	if (pendingBytes.IsEmpty())
+	{
+		return;
+	}
+
+	const Collection::ArrayView<const uint8_t> buffers[] = { pendingBytes.GetConstView() };
+	const size_t numBytesSent = networkConnectedClient.m_clientSocket.SendBatch({ buffers, 1 });
+	pendingBytes.Remove(0, numBytesSent);
+}
+
+void Host::HostNetworkWorld::TransmitMessagesToDatagramClient(
+	const Unit::Time::Millisecond now,
+	const Collection::ArrayView<const Host::MessageToClient>& messages,
+	NetworkConnectedClient& networkConnectedClient)
+{
+	Collection::Vector<uint8_t>& headerBytes = networkConnectedClient.m_transmissionHeaderBytes;
+	Network::DatagramConnection& datagramConnection = *networkConnectedClient.m_datagramConnection;
+
+	for (const auto& message : messages)
+	{
+		headerBytes.Clear();
+		Internal_HostNetworkWorld::SerializeMessageToClient(
+			message, networkConnectedClient.m_nextSequenceNumber++, headerBytes);
+
+		// ECS updates supersede each other, so they're sent on a sequenced stream to avoid waiting on lost updates.
+		// The stream is the message's tag so that the sequencing of different kinds of messages is independent.
+		if (message.Is<ECSUpdate_MessageToClient>())
+		{
+			const Collection::ArrayView<const uint8_t> messageParts[] = {
+				headerBytes.GetConstView(), message.Get<ECSUpdate_MessageToClient>().m_bytes.GetConstView() };
+			datagramConnection.SendSequenced(now, static_cast<uint8_t>(message.GetTag()), { messageParts, 2 });
+		}
+		else
+		{
+			const Collection::ArrayView<const uint8_t> messageParts[] = { headerBytes.GetConstView() };
+			datagramConnection.SendReliable(now, { messageParts, 1 });
+		}
+	}
 }
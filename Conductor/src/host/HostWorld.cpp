@@ -6,19 +6,32 @@
 #include <host/ConnectedClient.h>
 #include <host/IHost.h>
 
+#include <algorithm>
+
+#if defined(_WIN32)
+// Windows includes and library, for the timer resolution.
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <timeapi.h>
+#pragma comment (lib, "Winmm.lib")
+#endif
+
 namespace Host
 {
 HostWorld::HostWorld(const Conductor::IGameData& gameData,
 	Collection::LocklessQueue<Client::MessageToHost>& networkInputQueue,
-	HostFactory&& hostFactory)
+	HostFactory&& hostFactory,
+	const TickOptions& tickOptions,
+	OutboundMessagesCallback&& outboundMessagesCallback)
 	: m_gameData(gameData)
 	, m_networkInputQueue(networkInputQueue)
 	, m_hostFactory(std::move(hostFactory))
-	, m_lastUpdatePoint()
+	, m_outboundMessagesCallback(std::move(outboundMessagesCallback))
+	, m_tickOptions(tickOptions)
 {
-	// Acquire the host lock before the host thread is created because the host thread will release it once
-	// the host is created. The memory order of this initial operation doesn't matter.
-	m_hostLock.test_and_set();
+	// The status is set before the host thread is created so that a shutdown requested before the host thread starts
+	// isn't overwritten.
+	m_hostThreadStatus = HostThreadStatus::Running;
 	m_hostThread = std::thread(&HostWorld::HostThreadFunction, this);
 }
 
@@ -28,14 +41,35 @@ HostWorld::~HostWorld()
 	m_hostThread.join();
 }
 
+uint32_t HostWorld::GetNumConnectedClients() const
+{
+	std::lock_guard<std::mutex> lock{ m_hostMutex };
+	return m_connectedClients.Size();
+}
+
+HostWorld::TickStatistics HostWorld::GetTickStatistics() const
+{
+	std::lock_guard<std::mutex> lock{ m_hostMutex };
+	return m_tickStatistics;
+}
+
 void HostWorld::RequestShutdown()
 {
-	m_hostThreadStatus = HostThreadStatus::ShutdownRequested;
+	{
+		// The status is changed while holding the host mutex so that the host thread can't miss the notification
+		// between checking the status and sleeping.
+		std::lock_guard<std::mutex> lock{ m_hostMutex };
+		HostThreadStatus expectedStatus = HostThreadStatus::Running;
+		m_hostThreadStatus.compare_exchange_strong(expectedStatus, HostThreadStatus::ShutdownRequested);
+	}
+	m_hostCondition.notify_all();
 }
 
 void HostWorld::NotifyOfClientConnected(Mem::UniquePtr<ConnectedClient>&& connectedClient)
 {
-	while (m_hostLock.test_and_set(std::memory_order_acquire));
+	// Clients may be connected from other threads before the host thread has created the host.
+	std::unique_lock<std::mutex> lock{ m_hostMutex };
+	m_hostCondition.wait(lock, [this]() { return m_host != nullptr; });
 
 	const Client::ClientID clientID = connectedClient->GetClientID();
 	const Input::InputStateManager& clientInputManager = connectedClient->GetClientInputStateManager();
@@ -45,13 +79,11 @@ void HostWorld::NotifyOfClientConnected(Mem::UniquePtr<ConnectedClient>&& connec
 	m_connectedClients.Add(std::move(connectedClient));
 
 	m_host->NotifyOfClientConnected(clientID, clientInputManager);
-
-	m_hostLock.clear(std::memory_order_release);
 }
 
 void HostWorld::NotifyOfClientDisconnected(const Client::ClientID clientID)
 {
-	while (m_hostLock.test_and_set(std::memory_order_acquire));
+	std::lock_guard<std::mutex> lock{ m_hostMutex };
 
 	const size_t clientIndex = m_connectedClients.IndexOf([&](const Mem::UniquePtr<ConnectedClient>& connectedClient)
 	{
@@ -67,60 +99,171 @@ void HostWorld::NotifyOfClientDisconnected(const Client::ClientID clientID)
 		swap(m_connectedClients[clientIndex], m_connectedClients.Back());
 		m_connectedClients.RemoveLast();
 	}
-
-	m_hostLock.clear(std::memory_order_release);
 }
 
 void HostWorld::HostThreadFunction()
 {
-	m_hostThreadStatus = HostThreadStatus::Running;
-	m_host = m_hostFactory(m_gameData);
-	m_lastUpdatePoint = std::chrono::steady_clock::now();
+	{
+		std::lock_guard<std::mutex> lock{ m_hostMutex };
+		m_host = m_hostFactory(m_gameData);
+	}
+	// Wake any threads waiting to connect clients to the host.
+	m_hostCondition.notify_all();
 
-	// Unlock the host. It was locked in the HostWorld constructor.
-	m_hostLock.clear(std::memory_order_release);
+#if defined(_WIN32)
+	// The default timer resolution on Windows is about 15.6ms, which is too coarse to sleep between ticks with.
+	timeBeginPeriod(k_timerResolutionMilliseconds);
+#endif
+
+	const auto tickDuration = std::chrono::milliseconds(m_tickOptions.CalcTickDelta().GetN());
+	const auto maxCatchUpDuration = tickDuration * m_tickOptions.m_maxCatchUpTicks;
+
+	auto nextTickPoint = std::chrono::steady_clock::now();
+	m_lastTickStatisticsLogPoint = nextTickPoint;
 
 	while (m_hostThreadStatus == HostThreadStatus::Running)
 	{
-		// Process pending input from the network.
-		Client::MessageToHost message;
-		while (m_networkInputQueue.TryPop(message))
+		const auto tickStartPoint = std::chrono::steady_clock::now();
+		Tick();
+
+		if (m_outboundMessagesCallback)
+		{
+			m_outboundMessagesCallback();
+		}
+
+		nextTickPoint += tickDuration;
+		const auto tickEndPoint = std::chrono::steady_clock::now();
+		RecordTick(tickStartPoint, tickEndPoint, nextTickPoint);
+
+		if (tickEndPoint < nextTickPoint)
 		{
-			ProcessMessageFromClient(message);
+			SleepUntil(nextTickPoint);
 		}
+		else if (tickEndPoint - nextTickPoint > maxCatchUpDuration)
+		{
+			// The host is further behind than it may catch up on, so skip the ticks it missed and start the next tick
+			// immediately. Ticks run back to back while the host is behind by less than this.
+			const auto numSkippedTicks = static_cast<uint64_t>((tickEndPoint - nextTickPoint) / tickDuration);
+			nextTickPoint += tickDuration * numSkippedTicks;
 
-		// Lock the host while the it and connected clients shouldn't be modified.
-		while (m_hostLock.test_and_set(std::memory_order_acquire));
+			std::lock_guard<std::mutex> lock{ m_hostMutex };
+			m_tickStatistics.m_numSkippedTicks += numSkippedTicks;
+		}
+	}
 
-		// Update the game simulation.
-		const auto nowPoint = std::chrono::steady_clock::now();
-		const auto deltaMs = std::chrono::duration_cast<std::chrono::milliseconds>(nowPoint - m_lastUpdatePoint);
-		m_host->Update(Unit::Time::Millisecond(deltaMs.count()));
-		m_lastUpdatePoint = nowPoint;
+	// Destroy the host while holding the host mutex. No other threads should attempt to modify it at this point.
+	{
+		std::lock_guard<std::mutex> lock{ m_hostMutex };
+		m_host.Reset();
+	}
 
-		// Store a copy of the ECS state to use when transmitting ECS state.
-		m_host->StoreECSFrame();
+#if defined(_WIN32)
+	timeEndPeriod(k_timerResolutionMilliseconds);
+#endif
+	m_hostThreadStatus = HostThreadStatus::Stopped;
+}
 
-		// Transmit ECS state to clients. So long as the host implements the networked part of their game simulation
-		// using entities and components, this is all that needs to be sent.
-		Collection::Vector<uint8_t> ecsUpdateTransmission;
-		for (auto& connectedClient : m_connectedClients)
+void HostWorld::Tick()
+{
+	// Process pending input from the network.
+	Client::MessageToHost messages[k_messageBatchSize];
+	size_t numMessages;
+	while ((numMessages = m_networkInputQueue.TryPopBatch(messages, k_messageBatchSize)) != 0)
+	{
+		for (size_t i = 0; i < numMessages; ++i)
 		{
-			ecsUpdateTransmission.Clear();
-			m_host->SerializeECSUpdateTransmission(connectedClient->GetClientID(), ecsUpdateTransmission);
-			connectedClient->TransmitECSUpdate(ecsUpdateTransmission);
+			ProcessMessageFromClient(messages[i]);
 		}
+	}
 
-		// Unlock the host when the it and connected clients may be modified again.
-		m_hostLock.clear(std::memory_order_release);
+	// Lock the host while the it and connected clients shouldn't be modified.
+	std::lock_guard<std::mutex> lock{ m_hostMutex };
 
-		std::this_thread::yield();
+	// Update the game simulation with the fixed tick delta.
+	m_host->Update(m_tickOptions.CalcTickDelta());
+
+	// Store a copy of the ECS state to use when transmitting ECS state. This prepares the transmissions of all
+	// connected clients, which clients who last saw the same frame share.
+	m_host->StoreECSFrame();
+
+	// Transmit ECS state to clients. So long as the host implements the networked part of their game simulation
+	// using entities and components, this is all that needs to be sent.
+	for (auto& connectedClient : m_connectedClients)
+	{
+		connectedClient->TransmitECSUpdate(m_host->GetECSUpdateTransmission(connectedClient->GetClientID()));
 	}
+}
 
-	// Lock the host permanently before destroying it. No other threads should attempt to modify it at this point.
-	while (m_hostLock.test_and_set(std::memory_order_acquire));
-	m_host.Reset();
-	m_hostThreadStatus = HostThreadStatus::Stopped;
+void HostWorld::RecordTick(const std::chrono::steady_clock::time_point tickStartPoint,
+	const std::chrono::steady_clock::time_point tickEndPoint,
+	const std::chrono::steady_clock::time_point nextTickPoint)
+{
+	using namespace std::chrono;
+
+	std::lock_guard<std::mutex> lock{ m_hostMutex };
+
+	const microseconds tickTime = duration_cast<microseconds>(tickEndPoint - tickStartPoint);
+	m_tickStatistics.m_numTicks += 1;
+	m_tickStatistics.m_totalTickTime += tickTime;
+	m_tickStatistics.m_maxTickTime = (std::max)(m_tickStatistics.m_maxTickTime, tickTime);
+
+	if (tickEndPoint > nextTickPoint)
+	{
+		const microseconds overrunTime = duration_cast<microseconds>(tickEndPoint - nextTickPoint);
+		m_tickStatistics.m_numOverrunTicks += 1;
+		m_tickStatistics.m_totalOverrunTime += overrunTime;
+		m_tickStatistics.m_maxOverrunTime = (std::max)(m_tickStatistics.m_maxOverrunTime, overrunTime);
+	}
+
+	// Periodically log how far the host fell behind schedule, if it did.
+	if (tickEndPoint - m_lastTickStatisticsLogPoint < k_tickStatisticsLogInterval)
+	{
+		return;
+	}
+	const uint64_t numTicks = m_tickStatistics.m_numTicks - m_lastLoggedTickStatistics.m_numTicks;
+	const uint64_t numOverrunTicks = m_tickStatistics.m_numOverrunTicks - m_lastLoggedTickStatistics.m_numOverrunTicks;
+	const uint64_t numSkippedTicks = m_tickStatistics.m_numSkippedTicks - m_lastLoggedTickStatistics.m_numSkippedTicks;
+	if (numOverrunTicks > 0 || numSkippedTicks > 0)
+	{
+		const microseconds overrunTime =
+			m_tickStatistics.m_totalOverrunTime - m_lastLoggedTickStatistics.m_totalOverrunTime;
+		const long long averageOverrunMicroseconds =
+			(numOverrunTicks > 0) ? (overrunTime.count() / static_cast<long long>(numOverrunTicks)) : 0;
+		AMP_LOG_WARNING("Host overran %llu of %llu ticks by an average of %lldus and skipped %llu ticks.",
+			static_cast<unsigned long long>(numOverrunTicks),
+			static_cast<unsigned long long>(numTicks),
+			averageOverrunMicroseconds,
+			static_cast<unsigned long long>(numSkippedTicks));
+	}
+	m_lastLoggedTickStatistics = m_tickStatistics;
+	m_lastTickStatisticsLogPoint = tickEndPoint;
+}
+
+void HostWorld::SleepUntil(const std::chrono::steady_clock::time_point wakePoint)
+{
+	using namespace std::chrono;
+
+	// Sleep until shortly before the wake point, waking early if shutdown is requested.
+	const steady_clock::time_point sleepEndPoint = wakePoint - m_sleepMargin;
+	if (steady_clock::now() < sleepEndPoint)
+	{
+		std::unique_lock<std::mutex> lock{ m_hostMutex };
+		m_hostCondition.wait_until(lock, sleepEndPoint,
+			[this]() { return m_hostThreadStatus != HostThreadStatus::Running; });
+		lock.unlock();
+
+		// Widen the margin to any overshoot of the sleep and otherwise shrink it slowly. The margin is limited so that
+		// an occasional long overshoot doesn't make the host thread yield for much of each tick.
+		const microseconds overshoot = duration_cast<microseconds>(steady_clock::now() - sleepEndPoint);
+		const microseconds shrunkMargin = m_sleepMargin - (m_sleepMargin / 64);
+		m_sleepMargin = (std::min)((std::max)({ overshoot, shrunkMargin, k_minSleepMargin }), k_maxSleepMargin);
+	}
+
+	// Yield for the remainder of the time.
+	while (steady_clock::now() < wakePoint && m_hostThreadStatus == HostThreadStatus::Running)
+	{
+		std::this_thread::yield();
+	}
 }
 
 void HostWorld::ProcessMessageFromClient(Client::MessageToHost& message)
@@ -149,17 +292,15 @@ void HostWorld::ProcessMessageFromClient(Client::MessageToHost& message)
 
 void HostWorld::NotifyOfFrameAcknowledgement(const Client::ClientID clientID, const uint64_t frameIndex)
 {
-	while (m_hostLock.test_and_set(std::memory_order_acquire));
+	std::lock_guard<std::mutex> lock{ m_hostMutex };
 
 	m_host->NotifyOfFrameAcknowledgement(clientID, frameIndex);
-
-	m_hostLock.clear(std::memory_order_release);
 }
 
 void HostWorld::NotifyOfInputStateTransmission(const Client::ClientID clientID,
 	const Collection::Vector<uint8_t>& transmissionBytes)
 {
-	while (m_hostLock.test_and_set(std::memory_order_acquire));
+	std::lock_guard<std::mutex> lock{ m_hostMutex };
 
 	for (auto& connectedClient : m_connectedClients)
 	{
@@ -169,7 +310,5 @@ void HostWorld::NotifyOfInputStateTransmission(const Client::ClientID clientID,
 			break;
 		}
 	}
-
-	m_hostLock.clear(std::memory_order_release);
 }
 }
@@ -2,25 +2,62 @@
 
 #include <client/ClientID.h>
 #include <input/InputSystem.h>
+#include <scene/Chunk.h>
+#include <scene/SceneTransformComponent.h>
+
+#include <algorithm>
 
 namespace Host
 {
+namespace Internal_IHost
+{
+bool IsNetworked(const ECS::Entity& entity)
+{
+	return (entity.GetFlags() & ECS::EntityFlags::Networked) != ECS::EntityFlags::None;
+}
+
+void AddEntityHierarchyIDs(const ECS::Entity& entity, Collection::Vector<uint32_t>& outEntityIDs)
+{
+	outEntityIDs.Add(entity.GetID().GetUniqueID());
+	for (const auto& child : entity.GetChildren())
+	{
+		AddEntityHierarchyIDs(*child, outEntityIDs);
+	}
+}
+}
+
 IHost::IHost(Asset::AssetManager& assetManager, const ECS::ComponentReflector& componentReflector)
 	// Entities and components the host creates begin their IDs at 0.
-	: m_entityManager(assetManager, componentReflector, ECS::EntityID(0), 0)
+	// The host simulates the entire world, so it stores components by archetype for faster system iteration.
+	: m_entityManager(assetManager, componentReflector, ECS::EntityID(0), 0, ECS::ComponentStorageMode::Archetype)
 	, m_ecsTransmitter()
 	, m_inputSystem(m_entityManager.RegisterSystem(Mem::MakeUnique<Input::InputSystem>()))
+	, m_clientFoci()
+	, m_networkedRootEntities(Internal_IHost::IsNetworked)
+	, m_relevantRootEntityIDs()
 {
+	// The host tracks changes to its entities so that it only serializes what changed each frame, and so that the
+	// index of its networked entities only moves the entities which changed.
+	m_entityManager.SetChangeTrackingEnabled(true);
+	m_networkedRootEntities.ObserveChangesOf(m_entityManager);
+
+	// Transmissions are packet compressed with a dictionary built from the component types, which clients build too.
+	Collection::Vector<uint8_t> packetCompressionDictionary;
+	ECS::BuildSerializationDictionary(componentReflector, packetCompressionDictionary);
+	m_ecsTransmitter.EnablePacketCompression(std::move(packetCompressionDictionary));
 }
 
 void IHost::NotifyOfClientConnected(const Client::ClientID clientID, const Input::InputStateManager& inputStateManager)
 {
 	m_ecsTransmitter.NotifyOfClientConnected(clientID);
 	m_inputSystem.AddClient(clientID, inputStateManager);
+	HandleClientConnected(clientID);
 }
 
 void IHost::NotifyOfClientDisconnected(const Client::ClientID clientID)
 {
+	HandleClientDisconnected(clientID);
+	m_clientFoci.TryRemove(clientID);
 	m_inputSystem.RemoveClient(clientID);
 	m_ecsTransmitter.NotifyOfClientDisconnected(clientID);
 }
@@ -30,23 +67,99 @@ void IHost::NotifyOfFrameAcknowledgement(const Client::ClientID clientID, const
 	m_ecsTransmitter.NotifyOfFrameAcknowledgement(clientID, frameIndex);
 }
 
+void IHost::SetClientFocusEntity(
+	const Client::ClientID clientID,
+	const ECS::EntityID focusEntityID,
+	const int16_t radiusInChunks)
+{
+	m_clientFoci[clientID] = { focusEntityID, radiusInChunks };
+}
+
+void IHost::ClearClientFocusEntity(const Client::ClientID clientID)
+{
+	if (m_clientFoci.TryRemove(clientID))
+	{
+		m_ecsTransmitter.SetClientInterestArea(clientID, Network::InterestArea());
+	}
+}
+
 void IHost::StoreECSFrame()
 {
+	using namespace Internal_IHost;
+
 	ECS::SerializedEntitiesAndComponents serializedFrame;
-	m_entityManager.FullySerializeAllEntitiesAndComponentsMatchingFilter(
-		[](const ECS::Entity& entity)
+	ECS::SerializedChanges changes;
+
+	// The first frame is fully serialized. Every frame after it applies the changes since the previous frame to it.
+	const ECS::SerializedEntitiesAndComponents* const previousFrame = m_ecsTransmitter.FindNewestFrame();
+	if (previousFrame == nullptr)
+	{
+		m_entityManager.FullySerializeAllEntitiesAndComponentsMatchingFilter(IsNetworked, serializedFrame);
+		m_entityManager.ClearChangeJournal();
+	}
+	else
+	{
+		m_entityManager.SerializeChangesOfEntitiesMatchingFilter(IsNetworked, *previousFrame, serializedFrame, changes);
+	}
+
+	// Move the networked entities which changed this frame to the chunks they are now in. The index is updated even
+	// when no clients have focus entities so that the changes it observes don't accumulate.
+	m_networkedRootEntities.Update(m_entityManager);
+
+	if (!m_clientFoci.IsEmpty())
+	{
+		// Move the interest area of each client with a focus entity to the chunk the entity is in. The interest area
+		// stays where it is if the focus entity has no position, such as while it is being recreated. The focus
+		// transforms are only read, so they are found through a const reference to keep them out of the change journal.
+		const ECS::EntityManager& constEntityManager = m_entityManager;
+		for (const auto& entry : m_clientFoci)
 		{
-			return (entity.GetFlags() & ECS::EntityFlags::Networked) != ECS::EntityFlags::None;
-		},
-		serializedFrame);
+			const ECS::Entity* const focusEntity = constEntityManager.FindEntity(entry.second.m_entityID);
+			const Scene::SceneTransformComponent* const transformComponent = (focusEntity != nullptr)
+				? constEntityManager.FindComponent<Scene::SceneTransformComponent>(*focusEntity)
+				: nullptr;
+			if (transformComponent != nullptr)
+			{
+				const Scene::ChunkID chunkID =
+					Scene::CalcChunkID(transformComponent->m_modelToWorldMatrix.GetTranslation());
+				m_ecsTransmitter.SetClientInterestArea(entry.first, { chunkID, entry.second.m_radiusInChunks });
+			}
+		}
+	}
 
-	m_ecsTransmitter.AddSerializedFrame(std::move(serializedFrame));
+	m_ecsTransmitter.AddSerializedFrame(std::move(serializedFrame), std::move(changes));
+	m_ecsTransmitter.PrepareTransmissions(
+		[this](const Network::InterestArea& interestArea, Collection::Vector<uint32_t>& outEntityIDs)
+		{
+			FindRelevantEntityIDs(interestArea, outEntityIDs);
+		});
 }
 
-void IHost::SerializeECSUpdateTransmission(
-	const Client::ClientID clientID,
-	Collection::Vector<uint8_t>& outTransmission)
+const Collection::Vector<uint8_t>& IHost::GetECSUpdateTransmission(const Client::ClientID clientID) const
 {
-	m_ecsTransmitter.TransmitFrame(clientID, outTransmission);
+	return m_ecsTransmitter.GetPreparedTransmission(clientID);
+}
+
+void IHost::FindRelevantEntityIDs(
+	const Network::InterestArea& interestArea,
+	Collection::Vector<uint32_t>& outEntityIDs) const
+{
+	using namespace Internal_IHost;
+
+	m_relevantRootEntityIDs.Clear();
+	m_relevantRootEntityIDs.AddAll(m_networkedRootEntities.GetUnplacedEntityIDs());
+	m_networkedRootEntities.GetSpatialIndex().FindEntitiesInChunkRadius(
+		interestArea.m_centerChunkID, interestArea.m_radiusInChunks, m_relevantRootEntityIDs);
+
+	// Descendants which aren't networked aren't in the frame, so they are skipped when the frame is filtered.
+	outEntityIDs.Clear();
+	for (const auto& rootEntityID : m_relevantRootEntityIDs)
+	{
+		const ECS::Entity* const rootEntity = m_entityManager.FindEntity(rootEntityID);
+		AMP_FATAL_ASSERT(rootEntity != nullptr,
+			"Entities must be removed from the index of networked entities when they are deleted.");
+		AddEntityHierarchyIDs(*rootEntity, outEntityIDs);
+	}
+	std::sort(outEntityIDs.begin(), outEntityIDs.end());
 }
 }
@@ -12,7 +12,7 @@ const Mem::InspectorInfoTypeHash InputComponent::k_inspectorInfoTypeHash = MakeI
 
 void InputComponent::FullySerialize(const InputComponent& component, Collection::Vector<uint8_t>& outBytes)
 {
-	// Only the client ID and desired inputs are saved.
+	// Only the client ID, desired inputs, and last applied input sequence number are saved.
 	Mem::LittleEndian::Serialize(component.m_clientID.GetN(), outBytes);
 
 	Mem::LittleEndian::Serialize(component.m_inputMap.Size(), outBytes);
@@ -21,6 +21,8 @@ void InputComponent::FullySerialize(const InputComponent& component, Collection:
 		const char* const inputName = Util::ReverseHash(entry.first);
 		Mem::LittleEndian::Serialize(inputName, outBytes);
 	}
+
+	Mem::LittleEndian::Serialize(component.m_lastAppliedInputSequenceNumber, outBytes);
 }
 
 void InputComponent::ApplyFullSerialization(
@@ -31,6 +33,7 @@ void InputComponent::ApplyFullSerialization(
 	{
 		return;
 	}
+	component.m_clientID = Client::ClientID(maybeClientID.first);
 
 	const auto maybeNumInputs = Mem::LittleEndian::DeserializeUi32(bytes, bytesEnd);
 	if (!maybeNumInputs.second)
@@ -47,5 +50,12 @@ void InputComponent::ApplyFullSerialization(
 		const Util::StringHash inputNameHash = Util::CalcHash(inputNameBuffer);
 		component.m_inputMap[inputNameHash];
 	}
+
+	// The sequence number is absent from serializations made before it was added.
+	const auto maybeSequenceNumber = Mem::LittleEndian::DeserializeUi32(bytes, bytesEnd);
+	if (maybeSequenceNumber.second)
+	{
+		component.m_lastAppliedInputSequenceNumber = maybeSequenceNumber.first;
+	}
 }
 }
@@ -5,15 +5,33 @@
 #include <mem/DeserializeLittleEndian.h>
 #include <mem/SerializeLittleEndian.h>
 
+namespace Internal_InputStateManager
+{
+void ResetInputStateBuffers(Collection::VectorMap<Util::StringHash, Input::InputStateBuffer>& inputStateBuffers)
+{
+	for (auto& entry : inputStateBuffers)
+	{
+		Input::InputStateBuffer& inputStateBuffer = entry.second;
+		if (inputStateBuffer.m_count > 0)
+		{
+			inputStateBuffer.m_values[0] = inputStateBuffer.m_values[inputStateBuffer.m_count - 1];
+			inputStateBuffer.m_count = 1;
+		}
+	}
+}
+}
+
 namespace Input
 {
 InputStateManager::InputStateManager()
 	: m_namedInputStateBuffers()
+	, m_transmissionInputStateBuffers()
 	, m_namedInputMapping()
 {}
 
 InputStateManager::InputStateManager(CallbackRegistry& callbackRegistry)
 	: m_namedInputStateBuffers()
+	, m_transmissionInputStateBuffers()
 	, m_namedInputMapping()
 {
 	callbackRegistry.RegisterInputCallback<>([this](const InputMessage& message) { NotifyOfInputMessage(message); });
@@ -39,25 +57,19 @@ const InputStateBuffer* InputStateManager::FindNamedInput(const Util::StringHash
 
 void InputStateManager::ResetInputStates()
 {
-	for (auto& entry : m_namedInputStateBuffers)
-	{
-		InputStateBuffer& inputStateBuffer = entry.second;
-		if (inputStateBuffer.m_count > 0)
-		{
-			inputStateBuffer.m_values[0] = inputStateBuffer.m_values[inputStateBuffer.m_count - 1];
-			inputStateBuffer.m_count = 1;
-		}
-	}
+	Internal_InputStateManager::ResetInputStateBuffers(m_namedInputStateBuffers);
 }
 
-Collection::Vector<uint8_t> InputStateManager::SerializeFullTransmission() const
+Collection::Vector<uint8_t> InputStateManager::SerializeFullTransmission(const uint32_t sequenceNumber) const
 {
 	Collection::Vector<uint8_t> outBytes;
 
-	const uint32_t numInputs = m_namedInputStateBuffers.Size();
+	Mem::LittleEndian::Serialize(sequenceNumber, outBytes);
+
+	const uint32_t numInputs = m_transmissionInputStateBuffers.Size();
 	Mem::LittleEndian::Serialize(numInputs, outBytes);
 
-	for (const auto& entry : m_namedInputStateBuffers)
+	for (const auto& entry : m_transmissionInputStateBuffers)
 	{
 		const char* const inputName = Util::ReverseHash(entry.first);
 		const InputStateBuffer& inputStateBuffer = entry.second;
@@ -69,6 +81,11 @@ Collection::Vector<uint8_t> InputStateManager::SerializeFullTransmission() const
 	return outBytes;
 }
 
+void InputStateManager::ResetTransmissionInputStates()
+{
+	Internal_InputStateManager::ResetInputStateBuffers(m_transmissionInputStateBuffers);
+}
+
 void InputStateManager::ApplyFullTransmission(const Collection::Vector<uint8_t>& transmissionBytes)
 {
 	m_namedInputStateBuffers.Clear();
@@ -76,6 +93,13 @@ void InputStateManager::ApplyFullTransmission(const Collection::Vector<uint8_t>&
 	const uint8_t* iter = transmissionBytes.begin();
 	const uint8_t* const iterEnd = transmissionBytes.end();
 
+	const auto maybeSequenceNumber = Mem::LittleEndian::DeserializeUi32(iter, iterEnd);
+	if (!maybeSequenceNumber.second)
+	{
+		return;
+	}
+	m_lastAppliedSequenceNumber = maybeSequenceNumber.first;
+
 	const auto maybeNumInputs = Mem::LittleEndian::DeserializeUi32(iter, iterEnd);
 	if (!maybeNumInputs.second)
 	{
@@ -172,18 +196,19 @@ void InputStateManager::NotifyOfInputMessage(const InputMessage& message)
 		[](const InputMessage_ControllerAdded& controllerAdded) {},
 		[&](const InputMessage_ControllerRemoved& controllerRemoved)
 		{
-			m_namedInputStateBuffers.RemoveAllMatching(
-				[&](const auto& entry) -> bool
+			const auto isFromRemovedController = [&](const auto& entry) -> bool
+			{
+				for (const auto& nameEntry : m_namedInputMapping)
 				{
-					for (const auto& nameEntry : m_namedInputMapping)
+					if (nameEntry.first.m_deviceID == controllerRemoved.m_controllerID)
 					{
-						if (nameEntry.first.m_deviceID == controllerRemoved.m_controllerID)
-						{
-							return true;
-						}
+						return true;
 					}
-					return false;
-				});
+				}
+				return false;
+			};
+			m_namedInputStateBuffers.RemoveAllMatching(isFromRemovedController);
+			m_transmissionInputStateBuffers.RemoveAllMatching(isFromRemovedController);
 		});
 
 	// Map the inputs to names and store them.
@@ -201,10 +226,19 @@ void InputStateManager::NotifyOfInputMessage(const InputMessage& message)
 		}
 		const Util::StringHash nameHash = iter->second;
 
-		InputStateBuffer& stateBuffer = m_namedInputStateBuffers[nameHash];
-		if (stateBuffer.m_count < InputStateBuffer::k_capacity)
-		{
-			stateBuffer.m_values[stateBuffer.m_count++] = inputValues[i];
+		// When a buffer is full, its last state is replaced so that it always ends with the latest state. This matters
+		// most for the transmitted states, which accumulate over several updates.
+		for (auto* const inputStateBuffers : { &m_namedInputStateBuffers, &m_transmissionInputStateBuffers })
+		{
+			InputStateBuffer& stateBuffer = (*inputStateBuffers)[nameHash];
+			if (stateBuffer.m_count < InputStateBuffer::k_capacity)
+			{
+				stateBuffer.m_values[stateBuffer.m_count++] = inputValues[i];
+			}
+			else
+			{
+				stateBuffer.m_values[InputStateBuffer::k_capacity - 1] = inputValues[i];
+			}
 		}
 	}
 }
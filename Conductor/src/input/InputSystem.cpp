@@ -19,16 +19,18 @@ void InputSystem::RemoveClient(const Client::ClientID clientID)
 
 void InputSystem::Update(const Unit::Time::Millisecond delta,
 	const Collection::ArrayView<ECSGroupType>& ecsGroups,
-	Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions)
+	ECS::DeferredFunctionList& deferredFunctions)
 {
 	for (const auto& ecsGroup : ecsGroups)
 	{
 		auto& inputComponent = ecsGroup.Get<InputComponent>();
 		auto& inputMap = inputComponent.m_inputMap;
 
-		// Clear the component's state buffers.
+		// Clear the component's state buffers. The component only changes if it had or receives any input.
+		bool isChanged = false;
 		for (auto& entry : inputMap)
 		{
+			isChanged = isChanged || (entry.second.m_count != 0);
 			entry.second.m_count = 0;
 		}
 		
@@ -36,9 +38,16 @@ void InputSystem::Update(const Unit::Time::Millisecond delta,
 		const auto clientInputManagerIter = m_inputStateManagersPerClient.Find(inputComponent.m_clientID);
 		if (clientInputManagerIter == m_inputStateManagersPerClient.end())
 		{
+			if (isChanged)
+			{
+				MarkChanged(inputComponent);
+			}
 			continue;
 		}
 		const InputStateManager& clientInputManager = *clientInputManagerIter->second;
+		const uint32_t lastAppliedSequenceNumber = clientInputManager.GetLastAppliedSequenceNumber();
+		isChanged = isChanged || (inputComponent.m_lastAppliedInputSequenceNumber != lastAppliedSequenceNumber);
+		inputComponent.m_lastAppliedInputSequenceNumber = lastAppliedSequenceNumber;
 
 		for (auto& entry : inputMap)
 		{
@@ -49,8 +58,14 @@ void InputSystem::Update(const Unit::Time::Millisecond delta,
 			if (clientInputBuffer != nullptr)
 			{
 				stateBuffer = *clientInputBuffer;
+				isChanged = isChanged || (stateBuffer.m_count != 0);
 			}
 		}
+
+		if (isChanged)
+		{
+			MarkChanged(inputComponent);
+		}
 	}
 }
 }
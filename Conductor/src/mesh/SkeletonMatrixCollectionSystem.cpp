@@ -3,22 +3,28 @@
 #include <ecs/EntityManager.h>
 #include <scene/SceneTransformComponent.h>
 
+#include <cstring>
+
 namespace Mesh
 {
 void SkeletonMatrixCollectionSystem::Update(
 	const Unit::Time::Millisecond delta,
 	const Collection::ArrayView<ECSGroupType>& ecsGroups,
-	Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions) const
+	ECS::DeferredFunctionList& deferredFunctions)
 {
 	deferredFunctions.Add(
-		[ecsGroups](ECS::EntityManager& entityManager)
+		[this, ecsGroups](ECS::EntityManager& entityManager)
 		{
+			// The bone transforms are only read, so they are found without recording them as changed.
+			const ECS::EntityManager& constEntityManager = entityManager;
 			for (const auto& group : ecsGroups)
 			{
 				const auto& skeletonRootComponent = group.Get<const SkeletonRootComponent>();
 				auto& meshComponent = group.Get<MeshComponent>();
 
+				// The component is only marked as changed if any of its bone matrices changed.
 				const uint32_t numBones = skeletonRootComponent.m_boneTransformComponentIDs.Size();
+				bool isChanged = (meshComponent.m_boneToWorldMatrices.Size() != numBones);
 				meshComponent.m_boneToWorldMatrices.Resize(numBones);
 
 				for (size_t i = 0; i < numBones; ++i)
@@ -29,16 +35,24 @@ void SkeletonMatrixCollectionSystem::Update(
 						"Encountered a bone transform component ID which wasn't for a SceneTransformComponent.");
 
 					const auto* const boneTransformComponent = static_cast<const Scene::SceneTransformComponent*>(
-						entityManager.FindComponent(boneTransformComponentID));
-					if (boneTransformComponent != nullptr)
-					{
-						meshComponent.m_boneToWorldMatrices[i] = boneTransformComponent->m_modelToWorldMatrix;
-					}
-					else
+						constEntityManager.FindComponent(boneTransformComponentID));
+					const Math::Matrix4x4 boneToWorldMatrix = (boneTransformComponent != nullptr)
+						? boneTransformComponent->m_modelToWorldMatrix
+						: Math::Matrix4x4();
+
+					Math::Matrix4x4& meshBoneToWorldMatrix = meshComponent.m_boneToWorldMatrices[i];
+					if (memcmp(meshBoneToWorldMatrix.GetData(), boneToWorldMatrix.GetData(), sizeof(Math::Matrix4x4))
+						!= 0)
 					{
-						meshComponent.m_boneToWorldMatrices[i] = Math::Matrix4x4();
+						meshBoneToWorldMatrix = boneToWorldMatrix;
+						isChanged = true;
 					}
 				}
+
+				if (isChanged)
+				{
+					MarkChanged(meshComponent);
+				}
 			}
 		});
 }
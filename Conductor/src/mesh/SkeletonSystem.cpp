@@ -58,7 +58,7 @@ void CreateBoneEntities(
 
 void SkeletonSystem::Update(const Unit::Time::Millisecond delta,
 	const Collection::ArrayView<ECSGroupType>& ecsGroups,
-	Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions)
+	ECS::DeferredFunctionList& deferredFunctions)
 {
 	// Transfer all the new entities to the processing list.
 	m_meshComponentsOfEntitiesToProcess.AddAll(m_newEntityMeshComponents.GetConstView());
@@ -91,9 +91,10 @@ void SkeletonSystem::Update(const Unit::Time::Millisecond delta,
 			// Create an entity for each bone and set the parents accordingly.
 			// This must be deferred so it can access the entity manager.
 			deferredFunctions.Add(
-				[&entity, &skeletonRootComponent, mesh](ECS::EntityManager& entityManager)
+				[this, &entity, &skeletonRootComponent, mesh](ECS::EntityManager& entityManager)
 				{
 					Internal_SkeletonSystem::CreateBoneEntities(entityManager, entity, skeletonRootComponent, *mesh);
+					MarkChanged(skeletonRootComponent);
 				});
 			break;
 		}
@@ -0,0 +1,527 @@
+#include <network/DatagramConnection.h>
+
+#include <mem/DeserializeLittleEndian.h>
+#include <mem/SerializeLittleEndian.h>
+
+namespace Network
+{
+namespace Internal_DatagramConnection
+{
+// Every datagram begins with a header of the protocol ID, the packet type, and the number of reliable messages the
+// sender has received, which acknowledges them.
+// A reliable packet follows the header with the message's sequence number and then the message.
+// A sequenced packet follows the header with the stream, the message's sequence number, the fragment index, and the
+// number of fragments, and then the fragment.
+constexpr uint16_t k_protocolID = 0xC0DA;
+
+enum class PacketType : uint8_t
+{
+	Ack = 0,
+	Reliable,
+	Sequenced,
+	Count
+};
+
+constexpr size_t k_headerSize = sizeof(uint16_t) + sizeof(uint8_t) + sizeof(uint32_t);
+constexpr size_t k_ackIndexInHeader = sizeof(uint16_t) + sizeof(uint8_t);
+constexpr size_t k_reliableHeaderSize = k_headerSize + sizeof(uint32_t);
+constexpr size_t k_sequencedHeaderSize =
+	k_headerSize + sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint16_t) + sizeof(uint16_t);
+
+constexpr size_t k_maxReliableMessageSize = DatagramSocket::k_maxDatagramSize - k_reliableHeaderSize;
+constexpr size_t k_fragmentSize = DatagramSocket::k_maxDatagramSize - k_sequencedHeaderSize;
+constexpr size_t k_maxNumFragments =
+	(DatagramConnection::k_maxSequencedMessageSize + k_fragmentSize - 1) / k_fragmentSize;
+static_assert(k_maxNumFragments <= UINT16_MAX, "Fragment indices must fit in 16 bits.");
+
+// Sequenced streams keep partially received messages for this many sequence numbers at once.
+constexpr size_t k_maxNumReassemblies = 4;
+
+// True if sequence number a is newer than sequence number b, accounting for wrap around.
+bool IsNewer(const uint32_t a, const uint32_t b)
+{
+	return static_cast<int32_t>(a - b) > 0;
+}
+
+size_t GetTotalSize(const Collection::ArrayView<const Collection::ArrayView<const uint8_t>>& parts)
+{
+	size_t totalSize = 0;
+	for (const auto& part : parts)
+	{
+		totalSize += part.Size();
+	}
+	return totalSize;
+}
+
+// Add numBytes bytes to outBytes, starting at the given offset into the concatenation of parts.
+void AddPartsRange(
+	const Collection::ArrayView<const Collection::ArrayView<const uint8_t>>& parts,
+	size_t offset,
+	size_t numBytes,
+	Collection::Vector<uint8_t>& outBytes)
+{
+	for (const auto& part : parts)
+	{
+		if (numBytes == 0)
+		{
+			return;
+		}
+		if (offset >= part.Size())
+		{
+			offset -= part.Size();
+			continue;
+		}
+
+		const size_t numPartBytes = ((part.Size() - offset) < numBytes) ? (part.Size() - offset) : numBytes;
+		outBytes.AddAll({ part.begin() + offset, numPartBytes });
+		numBytes -= numPartBytes;
+		offset = 0;
+	}
+}
+}
+
+DatagramConnection::DatagramConnection(
+	const Unit::Time::Millisecond now,
+	const SimulatedLinkConditions& simulatedLinkConditions,
+	const size_t maxReassemblyBytes)
+	: m_simulatedLinkConditions(simulatedLinkConditions)
+	, m_randomState(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(this)) | 1)
+	, m_lastReceiveTime(now)
+	, m_lastSendTime(now)
+	, m_maxReassemblyBytes(maxReassemblyBytes)
+{
+}
+
+bool DatagramConnection::TryPeekFirstReliableMessage(
+	const Collection::ArrayView<const uint8_t>& datagram,
+	Collection::ArrayView<const uint8_t>& outMessage)
+{
+	using namespace Internal_DatagramConnection;
+
+	const uint8_t* bytesIter = datagram.begin();
+	const uint8_t* const bytesEnd = datagram.end();
+
+	const auto maybeProtocolID = Mem::LittleEndian::DeserializeUi16(bytesIter, bytesEnd);
+	const auto maybePacketType = Mem::LittleEndian::DeserializeUi8(bytesIter, bytesEnd);
+	const auto maybeAck = Mem::LittleEndian::DeserializeUi32(bytesIter, bytesEnd);
+	const auto maybeSequenceNumber = Mem::LittleEndian::DeserializeUi32(bytesIter, bytesEnd);
+	if (!maybeProtocolID.second || maybeProtocolID.first != k_protocolID
+		|| !maybePacketType.second || maybePacketType.first != static_cast<uint8_t>(PacketType::Reliable)
+		|| !maybeAck.second || !maybeSequenceNumber.second || maybeSequenceNumber.first != 0)
+	{
+		return false;
+	}
+
+	outMessage = { bytesIter, static_cast<size_t>(bytesEnd - bytesIter) };
+	return true;
+}
+
+void DatagramConnection::SendReliable(
+	const Unit::Time::Millisecond now,
+	const Collection::ArrayView<const Collection::ArrayView<const uint8_t>>& messageParts)
+{
+	using namespace Internal_DatagramConnection;
+
+	const size_t messageSize = GetTotalSize(messageParts);
+	AMP_FATAL_ASSERT(messageSize <= k_maxReliableMessageSize,
+		"Reliable messages of size [%zu] exceed the maximum size [%zu].", messageSize, k_maxReliableMessageSize);
+
+	const size_t datagramBegin = m_outboundDatagramBytes.Size();
+	const uint32_t sequenceNumber = m_nextReliableSendSequenceNumber++;
+
+	BeginDatagram(static_cast<uint8_t>(PacketType::Reliable));
+	Mem::LittleEndian::Serialize(sequenceNumber, m_outboundDatagramBytes);
+	AddPartsRange(messageParts, 0, messageSize, m_outboundDatagramBytes);
+
+	// Keep a copy of the datagram to resend until it's acknowledged.
+	UnackedReliableMessage& unackedMessage = m_unackedReliableMessages.Emplace();
+	unackedMessage.m_sequenceNumber = sequenceNumber;
+	unackedMessage.m_lastSendTime = now;
+	unackedMessage.m_datagram.AddAll(
+		{ m_outboundDatagramBytes.begin() + datagramBegin, m_outboundDatagramBytes.Size() - datagramBegin });
+
+	EndDatagram(now);
+}
+
+void DatagramConnection::SendSequenced(
+	const Unit::Time::Millisecond now,
+	const uint8_t stream,
+	const Collection::ArrayView<const Collection::ArrayView<const uint8_t>>& messageParts)
+{
+	using namespace Internal_DatagramConnection;
+
+	AMP_FATAL_ASSERT(stream < k_numSequencedStreams, "Sequenced stream [%u] is out of range.", stream);
+
+	const size_t messageSize = GetTotalSize(messageParts);
+	AMP_FATAL_ASSERT(messageSize <= k_maxSequencedMessageSize,
+		"Sequenced messages of size [%zu] exceed the maximum size [%zu].", messageSize, k_maxSequencedMessageSize);
+
+	const uint32_t sequenceNumber = m_sequencedStreams[stream].m_nextSendSequenceNumber++;
+	const size_t numFragments = (messageSize == 0) ? 1 : ((messageSize + k_fragmentSize - 1) / k_fragmentSize);
+
+	for (size_t i = 0; i < numFragments; ++i)
+	{
+		const size_t fragmentOffset = i * k_fragmentSize;
+		const size_t fragmentSize =
+			((messageSize - fragmentOffset) < k_fragmentSize) ? (messageSize - fragmentOffset) : k_fragmentSize;
+
+		BeginDatagram(static_cast<uint8_t>(PacketType::Sequenced));
+		Mem::LittleEndian::Serialize(stream, m_outboundDatagramBytes);
+		Mem::LittleEndian::Serialize(sequenceNumber, m_outboundDatagramBytes);
+		Mem::LittleEndian::Serialize(static_cast<uint16_t>(i), m_outboundDatagramBytes);
+		Mem::LittleEndian::Serialize(static_cast<uint16_t>(numFragments), m_outboundDatagramBytes);
+		AddPartsRange(messageParts, fragmentOffset, fragmentSize, m_outboundDatagramBytes);
+		EndDatagram(now);
+	}
+}
+
+void DatagramConnection::ReceiveDatagram(
+	const Unit::Time::Millisecond now,
+	const Collection::ArrayView<const uint8_t>& datagram)
+{
+	using namespace Internal_DatagramConnection;
+
+	const uint8_t* bytesIter = datagram.begin();
+	const uint8_t* const bytesEnd = datagram.end();
+
+	const auto maybeProtocolID = Mem::LittleEndian::DeserializeUi16(bytesIter, bytesEnd);
+	const auto maybePacketType = Mem::LittleEndian::DeserializeUi8(bytesIter, bytesEnd);
+	const auto maybeAck = Mem::LittleEndian::DeserializeUi32(bytesIter, bytesEnd);
+	if (!maybeProtocolID.second || maybeProtocolID.first != k_protocolID
+		|| !maybePacketType.second || maybePacketType.first >= static_cast<uint8_t>(PacketType::Count)
+		|| !maybeAck.second)
+	{
+		return;
+	}
+
+	m_lastReceiveTime = now;
+
+	// Forget the reliable messages the peer has received.
+	const uint32_t ack = maybeAck.first;
+	for (size_t i = 0; i < m_unackedReliableMessages.Size(); /* CONTROLLED IN LOOP */)
+	{
+		if (IsNewer(ack, m_unackedReliableMessages[i].m_sequenceNumber))
+		{
+			m_unackedReliableMessages.Remove(i, i + 1);
+			continue;
+		}
+		++i;
+	}
+
+	switch (static_cast<PacketType>(maybePacketType.first))
+	{
+	case PacketType::Ack:
+	{
+		break;
+	}
+	case PacketType::Reliable:
+	{
+		const auto maybeSequenceNumber = Mem::LittleEndian::DeserializeUi32(bytesIter, bytesEnd);
+		if (!maybeSequenceNumber.second)
+		{
+			return;
+		}
+
+		// Only the next expected message is accepted. The sender resends any later messages after this one is
+		// acknowledged, and earlier messages were already received.
+		if (maybeSequenceNumber.first == m_numReliableMessagesReceived)
+		{
+			StoreReceivedMessage({ bytesIter, static_cast<size_t>(bytesEnd - bytesIter) });
+			++m_numReliableMessagesReceived;
+		}
+		m_isAckPending = true;
+		break;
+	}
+	case PacketType::Sequenced:
+	{
+		const auto maybeStream = Mem::LittleEndian::DeserializeUi8(bytesIter, bytesEnd);
+		const auto maybeSequenceNumber = Mem::LittleEndian::DeserializeUi32(bytesIter, bytesEnd);
+		const auto maybeFragmentIndex = Mem::LittleEndian::DeserializeUi16(bytesIter, bytesEnd);
+		const auto maybeNumFragments = Mem::LittleEndian::DeserializeUi16(bytesIter, bytesEnd);
+		if (!maybeStream.second || !maybeSequenceNumber.second || !maybeFragmentIndex.second
+			|| !maybeNumFragments.second)
+		{
+			return;
+		}
+
+		const uint32_t fragmentIndex = maybeFragmentIndex.first;
+		const uint32_t numFragments = maybeNumFragments.first;
+		const size_t fragmentSize = static_cast<size_t>(bytesEnd - bytesIter);
+		const bool isLastFragment = (fragmentIndex + 1) == numFragments;
+		if (maybeStream.first >= k_numSequencedStreams
+			|| numFragments == 0 || numFragments > k_maxNumFragments || fragmentIndex >= numFragments
+			|| fragmentSize > k_fragmentSize || (!isLastFragment && fragmentSize != k_fragmentSize))
+		{
+			AMP_LOG_WARNING("Received an invalid sequenced fragment.");
+			return;
+		}
+
+		ReceiveSequencedFragment(maybeStream.first, maybeSequenceNumber.first, fragmentIndex, numFragments,
+			{ bytesIter, fragmentSize });
+		break;
+	}
+	default:
+	{
+		break;
+	}
+	}
+}
+
+bool DatagramConnection::HasTimedOut(const Unit::Time::Millisecond now) const
+{
+	return (now - m_lastReceiveTime) > k_timeout;
+}
+
+void DatagramConnection::BeginDatagram(const uint8_t packetType)
+{
+	using namespace Internal_DatagramConnection;
+
+	Mem::LittleEndian::Serialize(k_protocolID, m_outboundDatagramBytes);
+	Mem::LittleEndian::Serialize(packetType, m_outboundDatagramBytes);
+	Mem::LittleEndian::Serialize(m_numReliableMessagesReceived, m_outboundDatagramBytes);
+}
+
+void DatagramConnection::EndDatagram(const Unit::Time::Millisecond now)
+{
+	// Every datagram acknowledges the reliable messages received so far, even if the simulation drops it.
+	m_isAckPending = false;
+	m_lastSendTime = now;
+
+	const uint32_t datagramBegin = m_outboundDatagramEnds.IsEmpty() ? 0 : m_outboundDatagramEnds.Back();
+	if (m_simulatedLinkConditions.IsEnabled())
+	{
+		if ((NextRandom() % 100) < m_simulatedLinkConditions.m_packetLossPercent)
+		{
+			m_outboundDatagramBytes.Remove(datagramBegin, m_outboundDatagramBytes.Size());
+			return;
+		}
+		if (m_simulatedLinkConditions.m_latency.GetN() > 0)
+		{
+			DelayedDatagram& delayedDatagram = m_delayedDatagrams.Emplace();
+			delayedDatagram.m_sendTime = now + m_simulatedLinkConditions.m_latency;
+			delayedDatagram.m_bytes.AddAll({ m_outboundDatagramBytes.begin() + datagramBegin,
+				m_outboundDatagramBytes.Size() - datagramBegin });
+			m_outboundDatagramBytes.Remove(datagramBegin, m_outboundDatagramBytes.Size());
+			return;
+		}
+	}
+
+	m_outboundDatagramEnds.Add(m_outboundDatagramBytes.Size());
+}
+
+void DatagramConnection::ReceiveSequencedFragment(
+	const uint8_t streamIndex,
+	const uint32_t sequenceNumber,
+	const uint32_t fragmentIndex,
+	const uint32_t numFragments,
+	const Collection::ArrayView<const uint8_t>& fragment)
+{
+	using namespace Internal_DatagramConnection;
+
+	SequencedStream& stream = m_sequencedStreams[streamIndex];
+	if (stream.m_hasDelivered && !IsNewer(sequenceNumber, stream.m_lastDeliveredSequenceNumber))
+	{
+		return;
+	}
+
+	const auto deliver = [&](const Collection::ArrayView<const uint8_t>& message)
+	{
+		StoreReceivedMessage(message);
+		stream.m_hasDelivered = true;
+		stream.m_lastDeliveredSequenceNumber = sequenceNumber;
+
+		// Messages older than the delivered one will never be delivered, so stop reassembling them.
+		for (size_t i = 0; i < stream.m_reassemblies.Size(); /* CONTROLLED IN LOOP */)
+		{
+			if (!IsNewer(stream.m_reassemblies[i].m_sequenceNumber, sequenceNumber))
+			{
+				RemoveReassembly(stream, i);
+				continue;
+			}
+			++i;
+		}
+	};
+
+	if (numFragments == 1)
+	{
+		deliver(fragment);
+		return;
+	}
+
+	// Messages which can't fit in the reassembly limit would only evict other messages before being abandoned.
+	if ((numFragments * k_fragmentSize) > m_maxReassemblyBytes)
+	{
+		AMP_LOG_WARNING("Received a fragment of a sequenced message with [%u] fragments, which exceeds the limit.",
+			numFragments);
+		return;
+	}
+
+	size_t reassemblyIndex = stream.m_reassemblies.IndexOf(
+		[&](const Reassembly& reassembly) { return reassembly.m_sequenceNumber == sequenceNumber; });
+	if (reassemblyIndex == stream.m_reassemblies.sk_InvalidIndex)
+	{
+		// Make room by abandoning the oldest message being reassembled.
+		if (stream.m_reassemblies.Size() >= k_maxNumReassemblies)
+		{
+			size_t oldestIndex = 0;
+			for (size_t i = 1, iEnd = stream.m_reassemblies.Size(); i < iEnd; ++i)
+			{
+				if (IsNewer(stream.m_reassemblies[oldestIndex].m_sequenceNumber,
+					stream.m_reassemblies[i].m_sequenceNumber))
+				{
+					oldestIndex = i;
+				}
+			}
+			RemoveReassembly(stream, oldestIndex);
+		}
+
+		reassemblyIndex = stream.m_reassemblies.Size();
+		Reassembly& reassembly = stream.m_reassemblies.Emplace();
+		reassembly.m_sequenceNumber = sequenceNumber;
+		reassembly.m_numFragments = numFragments;
+		reassembly.m_isFragmentReceived.Resize(numFragments, 0);
+	}
+
+	{
+		Reassembly& existingReassembly = stream.m_reassemblies[reassemblyIndex];
+		if (existingReassembly.m_numFragments != numFragments
+			|| existingReassembly.m_isFragmentReceived[fragmentIndex] != 0)
+		{
+			return;
+		}
+		existingReassembly.m_lastReceiveIndex = ++m_numFragmentsReceived;
+	}
+
+	const size_t fragmentOffset = fragmentIndex * k_fragmentSize;
+	Reassembly& reassembly = GrowReassembly(stream, sequenceNumber, fragmentOffset + fragment.Size());
+
+	reassembly.m_isFragmentReceived[fragmentIndex] = 1;
+	memcpy(reassembly.m_bytes.begin() + fragmentOffset, fragment.begin(), fragment.Size());
+	if ((fragmentIndex + 1) == numFragments)
+	{
+		reassembly.m_size = static_cast<uint32_t>(fragmentOffset + fragment.Size());
+	}
+
+	++reassembly.m_numReceivedFragments;
+	if (reassembly.m_numReceivedFragments == numFragments)
+	{
+		deliver({ reassembly.m_bytes.begin(), reassembly.m_size });
+	}
+}
+
+DatagramConnection::Reassembly& DatagramConnection::GrowReassembly(
+	SequencedStream& stream,
+	const uint32_t sequenceNumber,
+	const size_t numBytes)
+{
+	const auto isGrowingReassembly =
+		[&](const Reassembly& reassembly) { return reassembly.m_sequenceNumber == sequenceNumber; };
+
+	Reassembly* reassembly = stream.m_reassemblies.Find(isGrowingReassembly);
+	const size_t oldSize = reassembly->m_bytes.Size();
+	if (numBytes <= oldSize)
+	{
+		return *reassembly;
+	}
+
+	// Abandon the messages which have gone longest without receiving a fragment until the growth fits. The messages
+	// are searched linearly because there are at most k_maxNumReassemblies per stream. This always succeeds because a
+	// single message is never larger than the limit.
+	const size_t growth = numBytes - oldSize;
+	while ((m_numReassemblyBytes + growth) > m_maxReassemblyBytes)
+	{
+		SequencedStream* stalestStream = nullptr;
+		size_t stalestIndex = 0;
+		for (auto& otherStream : m_sequencedStreams)
+		{
+			for (size_t i = 0, iEnd = otherStream.m_reassemblies.Size(); i < iEnd; ++i)
+			{
+				const Reassembly& other = otherStream.m_reassemblies[i];
+				if (&other != reassembly
+					&& (stalestStream == nullptr
+						|| other.m_lastReceiveIndex < stalestStream->m_reassemblies[stalestIndex].m_lastReceiveIndex))
+				{
+					stalestStream = &otherStream;
+					stalestIndex = i;
+				}
+			}
+		}
+		AMP_FATAL_ASSERT(stalestStream != nullptr, "A single reassembly exceeded the reassembly limit.");
+
+		// Removing a reassembly may move the growing one within its stream.
+		RemoveReassembly(*stalestStream, stalestIndex);
+		reassembly = stream.m_reassemblies.Find(isGrowingReassembly);
+	}
+
+	reassembly->m_bytes.Resize(static_cast<uint32_t>(numBytes));
+	m_numReassemblyBytes += growth;
+	return *reassembly;
+}
+
+void DatagramConnection::RemoveReassembly(SequencedStream& stream, const size_t index)
+{
+	m_numReassemblyBytes -= stream.m_reassemblies[index].m_bytes.Size();
+	stream.m_reassemblies.SwapWithAndRemoveLast(index);
+}
+
+void DatagramConnection::StoreReceivedMessage(const Collection::ArrayView<const uint8_t>& message)
+{
+	m_receivedMessageBytes.AddAll(message);
+	m_receivedMessageEnds.Add(m_receivedMessageBytes.Size());
+}
+
+void DatagramConnection::PrepareFlush(const Unit::Time::Millisecond now)
+{
+	using namespace Internal_DatagramConnection;
+
+	// Resend reliable messages which haven't been acknowledged in a while, updating their acknowledgement.
+	for (auto& unackedMessage : m_unackedReliableMessages)
+	{
+		if ((now - unackedMessage.m_lastSendTime) >= k_reliableResendInterval)
+		{
+			unackedMessage.m_lastSendTime = now;
+			memcpy(unackedMessage.m_datagram.begin() + k_ackIndexInHeader,
+				&m_numReliableMessagesReceived, sizeof(m_numReliableMessagesReceived));
+			m_outboundDatagramBytes.AddAll(unackedMessage.m_datagram.GetConstView());
+			EndDatagram(now);
+		}
+	}
+
+	// Send a datagram just to acknowledge reliable messages or to keep the connection alive if nothing else was sent.
+	if (m_isAckPending || (now - m_lastSendTime) >= k_keepAliveInterval)
+	{
+		BeginDatagram(static_cast<uint8_t>(PacketType::Ack));
+		EndDatagram(now);
+	}
+
+	// Release the datagrams which were delayed by the simulated latency. They are delayed by the same amount, so they
+	// are ordered by their send time.
+	size_t numReleasedDatagrams = 0;
+	for (const auto& delayedDatagram : m_delayedDatagrams)
+	{
+		if (delayedDatagram.m_sendTime > now)
+		{
+			break;
+		}
+		m_outboundDatagramBytes.AddAll(delayedDatagram.m_bytes.GetConstView());
+		m_outboundDatagramEnds.Add(m_outboundDatagramBytes.Size());
+		++numReleasedDatagrams;
+	}
+	m_delayedDatagrams.Remove(0, numReleasedDatagrams);
+}
+
+void DatagramConnection::ClearFlushedDatagrams()
+{
+	m_outboundDatagramBytes.Clear();
+	m_outboundDatagramEnds.Clear();
+}
+
+uint32_t DatagramConnection::NextRandom()
+{
+	// xorshift32
+	m_randomState ^= m_randomState << 13;
+	m_randomState ^= m_randomState >> 17;
+	m_randomState ^= m_randomState << 5;
+	return m_randomState;
+}
+}
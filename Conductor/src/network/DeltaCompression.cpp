@@ -4,12 +4,17 @@
 #include <collection/Vector.h>
 #include <mem/DeserializeLittleEndian.h>
 #include <mem/SerializeLittleEndian.h>
+#include <util/BitUtil.h>
+
+#include <immintrin.h>
 
 namespace Network
 {
 namespace Internal_DeltaCompression
 {
 constexpr uint16_t k_identicalBytesMarker = UINT16_MAX;
+// Bytewise compressed bytes begin with their size, which must be less than this marker.
+constexpr uint16_t k_wideFormatMarker = UINT16_MAX - 1;
 
 constexpr uint8_t k_unchangedSectionTypeID = 0x0F;
 constexpr uint8_t k_changedSectionTypeID = 0xF0;
@@ -17,24 +22,192 @@ constexpr uint8_t k_trailingSectionTypeID = 0xAA;
 constexpr uint8_t k_maxSectionSize = UINT8_MAX;
 
 constexpr uint8_t k_terminalMarker = 0xDD;
+
+// Wide section headers are variable length integers which store the section's size above the section's type.
+constexpr uint64_t k_wideUnchangedSectionType = 0;
+constexpr uint64_t k_wideChangedSectionType = 1;
+constexpr uint32_t k_wideSectionTypeNumBits = 1;
+constexpr uint64_t k_wideSectionTypeMask = (1 << k_wideSectionTypeNumBits) - 1;
+
+// The shortest run of unchanged bytes worth ending a changed section for.
+constexpr size_t k_minWideUnchangedRunLength = 4;
+
+// Returns the number of bytes at the start of lhs and rhs which are equal, up to count. Compares 32 or 16 bytes at a
+// time depending on the instruction sets available.
+size_t CountEqualBytes(const uint8_t* const lhs, const uint8_t* const rhs, const size_t count)
+{
+	size_t i = 0;
+#if defined(__AVX2__)
+	for (; (i + sizeof(__m256i)) <= count; i += sizeof(__m256i))
+	{
+		const __m256i lhsBytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+		const __m256i rhsBytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+		const uint32_t equalMask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lhsBytes, rhsBytes)));
+		if (equalMask != UINT32_MAX)
+		{
+			return i + Util::CountTrailingZeros(~equalMask);
+		}
+	}
+#endif
+	for (; (i + sizeof(__m128i)) <= count; i += sizeof(__m128i))
+	{
+		const __m128i lhsBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+		const __m128i rhsBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+		const uint32_t equalMask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(lhsBytes, rhsBytes)));
+		if (equalMask != UINT16_MAX)
+		{
+			return i + Util::CountTrailingZeros(~equalMask);
+		}
+	}
+	while (i < count && lhs[i] == rhs[i])
+	{
+		++i;
+	}
+	return i;
+}
+
+// Returns the number of bytes at the start of lhs and rhs which are unequal, up to count.
+size_t CountUnequalBytes(const uint8_t* const lhs, const uint8_t* const rhs, const size_t count)
+{
+	size_t i = 0;
+#if defined(__AVX2__)
+	for (; (i + sizeof(__m256i)) <= count; i += sizeof(__m256i))
+	{
+		const __m256i lhsBytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+		const __m256i rhsBytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+		const uint32_t equalMask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lhsBytes, rhsBytes)));
+		if (equalMask != 0)
+		{
+			return i + Util::CountTrailingZeros(equalMask);
+		}
+	}
+#endif
+	for (; (i + sizeof(__m128i)) <= count; i += sizeof(__m128i))
+	{
+		const __m128i lhsBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+		const __m128i rhsBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+		const uint32_t equalMask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(lhsBytes, rhsBytes)));
+		if (equalMask != 0)
+		{
+			return i + Util::CountTrailingZeros(equalMask);
+		}
+	}
+	while (i < count && lhs[i] != rhs[i])
+	{
+		++i;
+	}
+	return i;
+}
+
+void SerializeWideSection(
+	const uint64_t sectionType,
+	const uint8_t* const sectionBytes,
+	const size_t sectionSize,
+	Collection::Vector<uint8_t>& outCompressedBytes)
+{
+	Mem::LittleEndian::SerializeVarUint(
+		(static_cast<uint64_t>(sectionSize) << k_wideSectionTypeNumBits) | sectionType, outCompressedBytes);
+	if (sectionType == k_wideChangedSectionType)
+	{
+		outCompressedBytes.AddAll({ sectionBytes, sectionSize });
+	}
+}
+
+void CompressBytewise(
+	const Collection::ArrayView<const uint8_t>& lastSeenBytes,
+	const Collection::ArrayView<const uint8_t>& currentBytes,
+	Collection::Vector<uint8_t>& outCompressedBytes);
+
+void CompressWide(
+	const Collection::ArrayView<const uint8_t>& lastSeenBytes,
+	const Collection::ArrayView<const uint8_t>& currentBytes,
+	Collection::Vector<uint8_t>& outCompressedBytes);
+
+bool TryDecompressBytewise(
+	const uint16_t numBytesBeforeCompression,
+	const Collection::ArrayView<const uint8_t>& lastSeenBytes,
+	const uint8_t*& compressedIter,
+	const uint8_t* const compressedBytesEnd,
+	Collection::ArrayView<uint8_t>& inOutDecompressedBytes);
+
+bool TryDecompressWide(
+	const Collection::ArrayView<const uint8_t>& lastSeenBytes,
+	const uint8_t*& compressedIter,
+	const uint8_t* const compressedBytesEnd,
+	Collection::ArrayView<uint8_t>& inOutDecompressedBytes);
 }
 
 void DeltaCompression::Compress(
 	const Collection::ArrayView<const uint8_t>& lastSeenBytes,
 	const Collection::ArrayView<const uint8_t>& currentBytes,
-	Collection::Vector<uint8_t>& outCompressedBytes)
+	Collection::Vector<uint8_t>& outCompressedBytes,
+	const Format format)
 {
 	using namespace Internal_DeltaCompression;
 
 	// If the last seen bytes are identical to the current bytes, all we serialize is k_identicalBytesMarker.
 	if (lastSeenBytes.Size() == currentBytes.Size()
-		&& memcmp(lastSeenBytes.begin(), currentBytes.begin(), currentBytes.Size()) == 0)
+		&& CountEqualBytes(lastSeenBytes.begin(), currentBytes.begin(), currentBytes.Size()) == currentBytes.Size())
 	{
 		Mem::LittleEndian::Serialize(k_identicalBytesMarker, outCompressedBytes);
 		return;
 	}
 
+	if (format == Format::Wide)
+	{
+		CompressWide(lastSeenBytes, currentBytes, outCompressedBytes);
+	}
+	else
+	{
+		CompressBytewise(lastSeenBytes, currentBytes, outCompressedBytes);
+	}
+}
+
+bool DeltaCompression::TryDecompress(
+	const Collection::ArrayView<const uint8_t>& lastSeenBytes,
+	const uint8_t*& compressedIter,
+	const uint8_t* const compressedBytesEnd,
+	Collection::ArrayView<uint8_t>& inOutDecompressedBytes)
+{
+	using namespace Internal_DeltaCompression;
+
+	// The first two bytes are k_identicalBytesMarker, k_wideFormatMarker, or the bytewise size before compression.
+	const auto maybeFirstTwoBytes = Mem::LittleEndian::DeserializeUi16(compressedIter, compressedBytesEnd);
+	if (!maybeFirstTwoBytes.second)
+	{
+		return false;
+	}
+
+	// If the first two bytes are k_identicalBytesMarker, the decompressed bytes are the lastSeenBytes.
+	if (maybeFirstTwoBytes.first == k_identicalBytesMarker)
+	{
+		if (lastSeenBytes.Size() > inOutDecompressedBytes.Size())
+		{
+			AMP_LOG_ERROR("Insufficient capacity to copy lastSeenBytes.");
+			return false;
+		}
+		memcpy(inOutDecompressedBytes.begin(), lastSeenBytes.begin(), lastSeenBytes.Size());
+		inOutDecompressedBytes = { inOutDecompressedBytes.begin(), lastSeenBytes.Size() };
+		return true;
+	}
+
+	if (maybeFirstTwoBytes.first == k_wideFormatMarker)
+	{
+		return TryDecompressWide(lastSeenBytes, compressedIter, compressedBytesEnd, inOutDecompressedBytes);
+	}
+
+	return TryDecompressBytewise(
+		maybeFirstTwoBytes.first, lastSeenBytes, compressedIter, compressedBytesEnd, inOutDecompressedBytes);
+}
+
+void Internal_DeltaCompression::CompressBytewise(
+	const Collection::ArrayView<const uint8_t>& lastSeenBytes,
+	const Collection::ArrayView<const uint8_t>& currentBytes,
+	Collection::Vector<uint8_t>& outCompressedBytes)
+{
 	// To decompress later, we need to know the size before compression.
+	AMP_FATAL_ASSERT(currentBytes.Size() < k_wideFormatMarker,
+		"The bytewise format can't compress [%zu] bytes; use the wide format instead.", currentBytes.Size());
 	Mem::LittleEndian::Serialize(static_cast<uint16_t>(currentBytes.Size()), outCompressedBytes);
 
 	// We delta compress by searching for runs of identical bytes. To encode this, the compressed bytes consist of three
@@ -126,82 +299,200 @@ void DeltaCompression::Compress(
 	Mem::LittleEndian::Serialize(k_terminalMarker, outCompressedBytes);
 }
 
-bool DeltaCompression::TryDecompress(
+void Internal_DeltaCompression::CompressWide(
+	const Collection::ArrayView<const uint8_t>& lastSeenBytes,
+	const Collection::ArrayView<const uint8_t>& currentBytes,
+	Collection::Vector<uint8_t>& outCompressedBytes)
+{
+	// The wide format begins with its marker and the size before compression.
+	Mem::LittleEndian::Serialize(k_wideFormatMarker, outCompressedBytes);
+	Mem::LittleEndian::SerializeVarUint(currentBytes.Size(), outCompressedBytes);
+
+	// Each byte is either copied from the same offset in the last seen bytes by an unchanged section, or is stored in
+	// a changed section. Short runs of unchanged bytes are stored in changed sections because ending a changed section
+	// for them would cost more than they save. Bytes past the end of the last seen bytes are always changed.
+	const size_t minByteCount =
+		(lastSeenBytes.Size() < currentBytes.Size()) ? lastSeenBytes.Size() : currentBytes.Size();
+	const uint8_t* const lastSeen = lastSeenBytes.begin();
+	const uint8_t* const current = currentBytes.begin();
+
+	size_t changedRunBegin = 0;
+	size_t i = 0;
+	while (i < minByteCount)
+	{
+		const size_t unchangedRunLength = CountEqualBytes(lastSeen + i, current + i, minByteCount - i);
+		if (unchangedRunLength >= k_minWideUnchangedRunLength)
+		{
+			if (changedRunBegin < i)
+			{
+				SerializeWideSection(k_wideChangedSectionType,
+					current + changedRunBegin, i - changedRunBegin, outCompressedBytes);
+			}
+			SerializeWideSection(k_wideUnchangedSectionType, nullptr, unchangedRunLength, outCompressedBytes);
+
+			i += unchangedRunLength;
+			changedRunBegin = i;
+			continue;
+		}
+
+		i += unchangedRunLength;
+		i += CountUnequalBytes(lastSeen + i, current + i, minByteCount - i);
+	}
+
+	if (changedRunBegin < currentBytes.Size())
+	{
+		SerializeWideSection(k_wideChangedSectionType,
+			current + changedRunBegin, currentBytes.Size() - changedRunBegin, outCompressedBytes);
+	}
+}
+
+bool Internal_DeltaCompression::TryDecompressWide(
 	const Collection::ArrayView<const uint8_t>& lastSeenBytes,
 	const uint8_t*& compressedIter,
 	const uint8_t* const compressedBytesEnd,
 	Collection::ArrayView<uint8_t>& inOutDecompressedBytes)
 {
-	using namespace Internal_DeltaCompression;
-
-	// The first two bytes are either k_identicalBytesMarker or the size before compression.
-	const auto maybeFirstTwoBytes = Mem::LittleEndian::DeserializeUi16(compressedIter, compressedBytesEnd);
-	if (!maybeFirstTwoBytes.second)
+	const auto maybeNumBytesBeforeCompression =
+		Mem::LittleEndian::DeserializeVarUint(compressedIter, compressedBytesEnd);
+	if (!maybeNumBytesBeforeCompression.second)
 	{
+		AMP_LOG_ERROR("Failed to read the size before compression during delta-decompression.");
 		return false;
 	}
+	const uint64_t numBytesBeforeCompression = maybeNumBytesBeforeCompression.first;
+	if (numBytesBeforeCompression > inOutDecompressedBytes.Size())
+	{
+		AMP_LOG_ERROR("Insufficient capacity to perform delta-decompression.");
+		return false;
+	}
+	uint8_t* const out = inOutDecompressedBytes.begin();
+	inOutDecompressedBytes = { out, static_cast<size_t>(numBytesBeforeCompression) };
 
-	// If the first two bytes are k_identicalBytesMarker, the decompressed bytes are the lastSeenBytes.
-	if (maybeFirstTwoBytes.first == k_identicalBytesMarker)
+	// The sections cover the decompressed bytes exactly, so decompression ends when they are filled.
+	size_t outIndex = 0;
+	while (outIndex < numBytesBeforeCompression)
 	{
-		if (lastSeenBytes.Size() > inOutDecompressedBytes.Size())
+		const auto maybeSectionHeader = Mem::LittleEndian::DeserializeVarUint(compressedIter, compressedBytesEnd);
+		if (!maybeSectionHeader.second)
 		{
-			AMP_LOG_ERROR("Insufficient capacity to copy lastSeenBytes.");
+			AMP_LOG_ERROR("Failed to read a section header during delta-decompression.");
 			return false;
 		}
-		memcpy(inOutDecompressedBytes.begin(), lastSeenBytes.begin(), lastSeenBytes.Size());
-		inOutDecompressedBytes = { inOutDecompressedBytes.begin(), lastSeenBytes.Size() };
-		return true;
+		const uint64_t sectionHeader = maybeSectionHeader.first;
+
+		const uint64_t sectionType = sectionHeader & k_wideSectionTypeMask;
+		const uint64_t sectionSizeInBytes = sectionHeader >> k_wideSectionTypeNumBits;
+		if (sectionSizeInBytes == 0 || sectionSizeInBytes > (numBytesBeforeCompression - outIndex))
+		{
+			AMP_LOG_ERROR("Encountered a section of invalid size [%llu] during delta-decompression.",
+				static_cast<unsigned long long>(sectionSizeInBytes));
+			return false;
+		}
+		const size_t sectionSize = static_cast<size_t>(sectionSizeInBytes);
+
+		if (sectionType == k_wideUnchangedSectionType)
+		{
+			if (sectionSize > lastSeenBytes.Size() || outIndex > (lastSeenBytes.Size() - sectionSize))
+			{
+				AMP_LOG_ERROR("Unexpectedly encountered the end of the last seen bytes during delta-decompression.");
+				return false;
+			}
+			memcpy(out + outIndex, lastSeenBytes.begin() + outIndex, sectionSize);
+		}
+		else
+		{
+			if (sectionSize > static_cast<size_t>(compressedBytesEnd - compressedIter))
+			{
+				AMP_LOG_ERROR("Unexpectedly encountered the end of the compressed bytes during delta-decompression.");
+				return false;
+			}
+			memcpy(out + outIndex, compressedIter, sectionSize);
+			compressedIter += sectionSize;
+		}
+		outIndex += sectionSize;
 	}
 
+	return true;
+}
+
+bool Internal_DeltaCompression::TryDecompressBytewise(
+	const uint16_t numBytesBeforeCompression,
+	const Collection::ArrayView<const uint8_t>& lastSeenBytes,
+	const uint8_t*& compressedIter,
+	const uint8_t* const compressedBytesEnd,
+	Collection::ArrayView<uint8_t>& inOutDecompressedBytes)
+{
 	// Decompress in sections.
-	const uint16_t numBytesBeforeCompression = maybeFirstTwoBytes.first;
 	if (numBytesBeforeCompression > inOutDecompressedBytes.Size())
 	{
 		AMP_LOG_ERROR("Insufficient capacity to perform delta-decompression.");
 		return false;
 	}
-	uint8_t* outIter = inOutDecompressedBytes.begin();
-	inOutDecompressedBytes = { outIter, numBytesBeforeCompression };
+	uint8_t* const out = inOutDecompressedBytes.begin();
+	inOutDecompressedBytes = { out, numBytesBeforeCompression };
 
 	// Delta compressed bytes are divided into sections, each of which has a two byte header:
-	// a one byte section type ID and a one byte size.
-	const uint8_t* lastSeenIter = lastSeenBytes.begin();
-	const uint8_t* const lastSeenEnd = lastSeenBytes.end();
-	uint8_t sectionTypeID = k_terminalMarker;
-	while ((compressedIter + 1) < compressedBytesEnd)
+	// a one byte section type ID and a one byte size. The sections end at a terminal marker.
+	// The compressed bytes come from the network, so every section is checked against the end of the compressed
+	// bytes, the last seen bytes, and the decompressed bytes before it is copied.
+	size_t outIndex = 0;
+	size_t lastSeenIndex = 0;
+	while (true)
 	{
-		sectionTypeID = *(compressedIter++);
+		if (compressedIter >= compressedBytesEnd)
+		{
+			AMP_LOG_ERROR("Delta-decompression reached the end of the compressed bytes without a terminal marker.");
+			return false;
+		}
+
+		const uint8_t sectionTypeID = *(compressedIter++);
 		if (sectionTypeID == k_terminalMarker)
 		{
 			break;
 		}
-		const uint8_t sectionSizeInBytes = *(compressedIter++);
+
+		if (compressedIter >= compressedBytesEnd)
+		{
+			AMP_LOG_ERROR("Unexpectedly encountered the end of the compressed bytes during delta-decompression.");
+			return false;
+		}
+		const size_t sectionSize = *(compressedIter++);
+
+		if (sectionSize > static_cast<size_t>(numBytesBeforeCompression - outIndex))
+		{
+			AMP_LOG_ERROR("Encountered a section of invalid size [%zu] during delta-decompression.", sectionSize);
+			return false;
+		}
 
 		if (sectionTypeID == k_unchangedSectionTypeID)
 		{
-			if ((lastSeenIter + sectionSizeInBytes) > lastSeenEnd)
+			if (lastSeenIndex > lastSeenBytes.Size() || sectionSize > (lastSeenBytes.Size() - lastSeenIndex))
 			{
 				AMP_LOG_ERROR("Unexpectedly encountered the end of the last seen bytes during delta-decompression.");
 				return false;
 			}
 
-			memcpy(outIter, lastSeenIter, sectionSizeInBytes);
-			outIter += sectionSizeInBytes;
-			lastSeenIter += sectionSizeInBytes;
+			memcpy(out + outIndex, lastSeenBytes.begin() + lastSeenIndex, sectionSize);
+			outIndex += sectionSize;
+			lastSeenIndex += sectionSize;
 		}
-		else if (sectionTypeID == k_changedSectionTypeID)
+		else if (sectionTypeID == k_changedSectionTypeID || sectionTypeID == k_trailingSectionTypeID)
 		{
-			memcpy(outIter, compressedIter, sectionSizeInBytes);
-			outIter += sectionSizeInBytes;
-			lastSeenIter += sectionSizeInBytes;
-			compressedIter += sectionSizeInBytes;
-		}
-		else if (sectionTypeID == k_trailingSectionTypeID)
-		{
-			memcpy(outIter, compressedIter, sectionSizeInBytes);
-			outIter += sectionSizeInBytes;
-			compressedIter += sectionSizeInBytes;
+			if (sectionSize > static_cast<size_t>(compressedBytesEnd - compressedIter))
+			{
+				AMP_LOG_ERROR("Unexpectedly encountered the end of the compressed bytes during delta-decompression.");
+				return false;
+			}
+
+			memcpy(out + outIndex, compressedIter, sectionSize);
+			outIndex += sectionSize;
+			compressedIter += sectionSize;
+
+			// Changed sections replace bytes of the last seen bytes, while trailing sections follow them.
+			if (sectionTypeID == k_changedSectionTypeID)
+			{
+				lastSeenIndex += sectionSize;
+			}
 		}
 		else
 		{
@@ -212,18 +503,12 @@ bool DeltaCompression::TryDecompress(
 		}
 	}
 
-	// The loop above has a lookahead exit condition. If it ends due to that, ensure that it ended at a terminal marker.
-	// Otherwise, assert that it found a terminal marker.
-	if (compressedIter < compressedBytesEnd && sectionTypeID != k_terminalMarker)
+	if (outIndex != numBytesBeforeCompression)
 	{
-		AMP_LOG_ERROR("Delta-decompression failed to consume the correct number of bytes.");
+		AMP_LOG_ERROR("Delta-decompression produced [%zu] bytes, but expected [%u].",
+			outIndex, static_cast<uint32_t>(numBytesBeforeCompression));
 		return false;
 	}
-	else
-	{
-		AMP_ASSERT(*(compressedIter - 1) == k_terminalMarker,
-			"The above loop should have exited after finding a terminal marker!");
-	}
 
 	return true;
 }
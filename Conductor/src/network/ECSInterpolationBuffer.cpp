@@ -0,0 +1,198 @@
+#include <network/ECSInterpolationBuffer.h>
+
+#include <ecs/EntityManager.h>
+#include <ecs/SerializedEntitiesAndComponents.h>
+#include <math/Matrix4x4.h>
+#include <network/ECSReceiver.h>
+#include <scene/SceneTransformComponent.h>
+
+#include <cmath>
+
+namespace Internal_ECSInterpolationBuffer
+{
+// Interpolate the basis vectors of the transforms and restore their interpolated lengths so that rotation doesn't
+// shrink the transform. This closely approximates a spherical interpolation for the small rotations between frames.
+Math::Matrix4x4 InterpolateTransform(const Math::Matrix4x4& from, const Math::Matrix4x4& to, const float t)
+{
+	Math::Matrix4x4 result;
+	for (size_t i = 0; i < 3; ++i)
+	{
+		const Math::Vector4& fromColumn = from.GetColumn(i);
+		const Math::Vector4& toColumn = to.GetColumn(i);
+
+		Math::Vector4 column = fromColumn + ((toColumn - fromColumn) * t);
+		const float length = column.Length();
+		if (length > 0.0f)
+		{
+			const float fromLength = fromColumn.Length();
+			const float toLength = toColumn.Length();
+			column *= (fromLength + ((toLength - fromLength) * t)) / length;
+		}
+		result.GetColumn(i) = column;
+	}
+
+	const Math::Vector4& fromTranslation = from.GetColumn(3);
+	result.GetColumn(3) = fromTranslation + ((to.GetColumn(3) - fromTranslation) * t);
+
+	return result;
+}
+
+bool TryReadSceneTransformComponent(const ECS::SerializedBytesWithViews& components,
+	const ECS::SerializedByteView& view,
+	Scene::SceneTransformComponent& outComponent)
+{
+	const size_t componentBeginIndex = view.m_beginIndex + ECS::FullSerializedComponentHeader::k_unpaddedSize;
+	if (componentBeginIndex + sizeof(Scene::SceneTransformComponent) > view.m_endIndex)
+	{
+		return false;
+	}
+
+	// Scene transforms are memory imaged.
+	memcpy(&outComponent, &components.m_bytes[componentBeginIndex], sizeof(Scene::SceneTransformComponent));
+	return true;
+}
+}
+
+namespace Network
+{
+void ECSInterpolationBuffer::SetTiming(
+	const Unit::Time::Millisecond frameDuration, const Unit::Time::Millisecond renderDelay)
+{
+	m_frameDuration = (frameDuration.GetN() > 0) ? frameDuration : Unit::Time::Millisecond(1);
+	m_renderDelay = renderDelay;
+	m_hasClockOffset = false;
+}
+
+void ECSInterpolationBuffer::NotifyOfFrameReceived(const uint64_t frameIndex, const Unit::Time::Millisecond now)
+{
+	const double frameTime = static_cast<double>(frameIndex) * static_cast<double>(m_frameDuration.GetN());
+	const double clockOffset = static_cast<double>(now.GetN()) - frameTime;
+
+	if (!m_hasClockOffset || clockOffset < m_clockOffset)
+	{
+		m_clockOffset = clockOffset;
+		m_hasClockOffset = true;
+	}
+	else
+	{
+		m_clockOffset += (clockOffset - m_clockOffset) * k_clockOffsetRiseRate;
+	}
+}
+
+bool ECSInterpolationBuffer::TryFindInterpolationPoint(const ECSReceiver& receiver,
+	const Unit::Time::Millisecond now,
+	InterpolationPoint& outPoint) const
+{
+	const uint64_t newestFrameIndex = receiver.GetLastSeenFrameIndex();
+	if (newestFrameIndex == k_invalidFrameIndex || !m_hasClockOffset)
+	{
+		return false;
+	}
+	const uint64_t oldestFrameIndex = receiver.GetOldestStoredFrameIndex();
+
+	// Find the fractional frame index to present.
+	const double presentationTime =
+		static_cast<double>(now.GetN()) - m_clockOffset - static_cast<double>(m_renderDelay.GetN());
+	const double presentationFrame = presentationTime / static_cast<double>(m_frameDuration.GetN());
+
+	if (presentationFrame >= static_cast<double>(newestFrameIndex))
+	{
+		outPoint = { newestFrameIndex, newestFrameIndex, 0.0f };
+		return true;
+	}
+
+	// Find the newest frame at or before the presentation frame. If there isn't one, present the oldest frame.
+	const uint64_t flooredPresentationFrame =
+		(presentationFrame > 0.0) ? static_cast<uint64_t>(std::floor(presentationFrame)) : 0;
+	uint64_t fromFrameIndex =
+		(flooredPresentationFrame > oldestFrameIndex) ? flooredPresentationFrame : oldestFrameIndex;
+	while (fromFrameIndex > oldestFrameIndex && receiver.FindFrame(fromFrameIndex) == nullptr)
+	{
+		--fromFrameIndex;
+	}
+	if (receiver.FindFrame(fromFrameIndex) == nullptr || presentationFrame < static_cast<double>(fromFrameIndex))
+	{
+		while (receiver.FindFrame(fromFrameIndex) == nullptr)
+		{
+			++fromFrameIndex;
+		}
+		outPoint = { fromFrameIndex, fromFrameIndex, 0.0f };
+		return true;
+	}
+
+	// Find the oldest frame after it. The newest frame is always in the history, so there is one.
+	uint64_t toFrameIndex = fromFrameIndex + 1;
+	while (receiver.FindFrame(toFrameIndex) == nullptr)
+	{
+		++toFrameIndex;
+	}
+
+	const double t = (presentationFrame - static_cast<double>(fromFrameIndex))
+		/ static_cast<double>(toFrameIndex - fromFrameIndex);
+	outPoint = { fromFrameIndex, toFrameIndex, static_cast<float>((t < 1.0) ? t : 1.0) };
+	return true;
+}
+
+void InterpolateSceneTransforms(const ECS::SerializedEntitiesAndComponents& fromFrame,
+	const ECS::SerializedEntitiesAndComponents& toFrame,
+	const float t,
+	const ECS::ComponentID& excludedComponentID,
+	ECS::EntityManager& entityManager)
+{
+	using namespace Internal_ECSInterpolationBuffer;
+
+	const ECS::SerializedBytesWithViews* const fromComponents =
+		fromFrame.FindComponentsEntry(Scene::SceneTransformComponent::k_type);
+	const ECS::SerializedBytesWithViews* const toComponents =
+		toFrame.FindComponentsEntry(Scene::SceneTransformComponent::k_type);
+	if (fromComponents == nullptr || toComponents == nullptr)
+	{
+		return;
+	}
+
+	// The component views of both frames are sorted by ID, so components in both frames are found by walking them
+	// together.
+	Scene::SceneTransformComponent fromComponent{ ECS::ComponentID() };
+	Scene::SceneTransformComponent toComponent{ ECS::ComponentID() };
+
+	const ECS::SerializedByteView* fromIter = fromComponents->m_views.begin();
+	const ECS::SerializedByteView* toIter = toComponents->m_views.begin();
+	while (fromIter != fromComponents->m_views.end() && toIter != toComponents->m_views.end())
+	{
+		ECS::FullSerializedComponentHeader fromHeader;
+		memcpy(&fromHeader, &fromComponents->m_bytes[fromIter->m_beginIndex],
+			ECS::FullSerializedComponentHeader::k_unpaddedSize);
+		ECS::FullSerializedComponentHeader toHeader;
+		memcpy(&toHeader, &toComponents->m_bytes[toIter->m_beginIndex],
+			ECS::FullSerializedComponentHeader::k_unpaddedSize);
+
+		if (fromHeader.m_uniqueID < toHeader.m_uniqueID)
+		{
+			++fromIter;
+			continue;
+		}
+		if (toHeader.m_uniqueID < fromHeader.m_uniqueID)
+		{
+			++toIter;
+			continue;
+		}
+
+		const ECS::ComponentID componentID{ Scene::SceneTransformComponent::k_type, fromHeader.m_uniqueID };
+		auto* const component = (componentID != excludedComponentID)
+			? static_cast<Scene::SceneTransformComponent*>(entityManager.FindComponent(componentID))
+			: nullptr;
+		if (component != nullptr
+			&& TryReadSceneTransformComponent(*fromComponents, *fromIter, fromComponent)
+			&& TryReadSceneTransformComponent(*toComponents, *toIter, toComponent))
+		{
+			component->m_modelToWorldMatrix =
+				InterpolateTransform(fromComponent.m_modelToWorldMatrix, toComponent.m_modelToWorldMatrix, t);
+			component->m_childToParentMatrix =
+				InterpolateTransform(fromComponent.m_childToParentMatrix, toComponent.m_childToParentMatrix, t);
+		}
+
+		++fromIter;
+		++toIter;
+	}
+}
+}
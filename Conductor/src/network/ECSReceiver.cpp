@@ -1,6 +1,7 @@
 #include <network/ECSReceiver.h>
 
 #include <mem/DeserializeLittleEndian.h>
+#include <network/PacketCompression.h>
 
 namespace Network
 {
@@ -13,6 +14,32 @@ float ECSReceiver::GetLastSeenCompressionRatio() const
 	return m_frameHistory.Newest().m_compressionRatio;
 }
 
+uint64_t ECSReceiver::GetOldestStoredFrameIndex() const
+{
+	if (m_frameIndex == k_invalidFrameIndex)
+	{
+		return k_invalidFrameIndex;
+	}
+	return m_frameIndex - (m_frameHistory.Size() - 1);
+}
+
+const ECS::SerializedEntitiesAndComponents* ECSReceiver::FindFrame(const uint64_t frameIndex) const
+{
+	const uint64_t oldestStoredFrameIndex = GetOldestStoredFrameIndex();
+	if (oldestStoredFrameIndex == k_invalidFrameIndex || frameIndex < oldestStoredFrameIndex || frameIndex > m_frameIndex)
+	{
+		return nullptr;
+	}
+
+	const HistoryEntry& historyEntry = m_frameHistory[static_cast<size_t>(frameIndex - oldestStoredFrameIndex)];
+	return historyEntry.m_isValid ? &historyEntry.m_frame : nullptr;
+}
+
+void ECSReceiver::SetPacketCompressionDictionary(Collection::Vector<uint8_t>&& dictionary)
+{
+	m_packetCompressionDictionary = std::move(dictionary);
+}
+
 const ECS::SerializedEntitiesAndComponents* ECSReceiver::TryReceiveFrameTransmission(
 	const Collection::ArrayView<const uint8_t> transmissionBytes)
 {
@@ -27,14 +54,39 @@ const ECS::SerializedEntitiesAndComponents* ECSReceiver::TryReceiveFrameTransmis
 	}
 	const uint32_t frameTypeMarker = maybeFrameTypeMarker.first;
 
+	// The flags follow the frame type marker.
+	const auto maybeFrameFlags = Mem::LittleEndian::DeserializeUi8(transmissionIter, transmissionEnd);
+	if (!maybeFrameFlags.second || (maybeFrameFlags.first & ~k_allFrameFlags) != 0)
+	{
+		return nullptr;
+	}
+	const uint8_t frameFlags = maybeFrameFlags.first;
+	const size_t numTransmittedFrameBytes = static_cast<size_t>(transmissionEnd - transmissionIter);
+
+	// Packet compressed frames are decompressed before they are received.
+	const uint8_t* frameBegin = transmissionIter;
+	const uint8_t* frameEnd = transmissionEnd;
+	if ((frameFlags & k_packetCompressedFrameFlag) != 0)
+	{
+		m_decompressedFrameBytes.Clear();
+		if (!PacketCompression::TryDecompress(m_packetCompressionDictionary.GetConstView(),
+				transmissionIter, transmissionEnd, m_decompressedFrameBytes)
+			|| transmissionIter != transmissionEnd)
+		{
+			return nullptr;
+		}
+		frameBegin = m_decompressedFrameBytes.begin();
+		frameEnd = m_decompressedFrameBytes.end();
+	}
+
 	uint64_t receivedFrameIndex = k_invalidFrameIndex;
 	if (frameTypeMarker == k_fullFrameMarker)
 	{
-		receivedFrameIndex = TryReceiveFullFrameTransmission(transmissionIter, transmissionEnd);
+		receivedFrameIndex = TryReceiveFullFrameTransmission(frameBegin, frameEnd);
 	}
 	else if (frameTypeMarker == k_deltaFrameMarker)
 	{
-		receivedFrameIndex = TryReceiveDeltaFrameTransmission(transmissionIter, transmissionEnd);
+		receivedFrameIndex = TryReceiveDeltaFrameTransmission(frameBegin, frameEnd, numTransmittedFrameBytes);
 	}
 
 	if (receivedFrameIndex == k_invalidFrameIndex)
@@ -80,7 +132,10 @@ uint64_t ECSReceiver::TryReceiveFullFrameTransmission(const uint8_t* const frame
 	return newFrameIndex;
 }
 
-uint64_t ECSReceiver::TryReceiveDeltaFrameTransmission(const uint8_t* const frameBegin, const uint8_t* const frameEnd)
+uint64_t ECSReceiver::TryReceiveDeltaFrameTransmission(
+	const uint8_t* const frameBegin,
+	const uint8_t* const frameEnd,
+	const size_t numTransmittedFrameBytes)
 {
 	const uint8_t* frameIter = frameBegin;
 
@@ -107,7 +162,7 @@ uint64_t ECSReceiver::TryReceiveDeltaFrameTransmission(const uint8_t* const fram
 		return k_invalidFrameIndex;
 	}
 
-	const size_t previousFrameHistoryIndex = static_cast<size_t>(m_frameIndex - oldestStoredFrameIndex);
+	const size_t previousFrameHistoryIndex = static_cast<size_t>(previousFrameIndex - oldestStoredFrameIndex);
 	const HistoryEntry& previousFrameHistoryEntry = m_frameHistory[previousFrameHistoryIndex];
 	if (!previousFrameHistoryEntry.m_isValid)
 	{
@@ -142,7 +197,7 @@ uint64_t ECSReceiver::TryReceiveDeltaFrameTransmission(const uint8_t* const fram
 	numDecompressedFrameBytes += decompressedFrame.m_entities.m_views.Size() * sizeof(ECS::SerializedByteView);
 
 	const float compressionRatio =
-		static_cast<float>(numCompressedFrameBytes) / static_cast<float>(numDecompressedFrameBytes);
+		static_cast<float>(numTransmittedFrameBytes) / static_cast<float>(numDecompressedFrameBytes);
 
 	StoreFrame(newFrameIndex, compressionRatio, std::move(decompressedFrame));
 	return newFrameIndex;
@@ -176,9 +231,13 @@ void ECSReceiver::StoreFrame(
 	}
 
 	// If the frame is after the end of the current history buffer, advance the buffer to the new frame to add it.
+	// Frames which were skipped over are marked invalid. Advancing by more than the history size recycles every entry.
+	const uint64_t numFramesToAdvance = newFrameIndex - m_frameIndex;
+	const size_t numEntriesToAdd =
+		(numFramesToAdvance < k_historySize) ? static_cast<size_t>(numFramesToAdvance) : k_historySize;
 	m_frameIndex = newFrameIndex;
 
-	for (size_t i = 0, iEnd = (newFrameIndex - m_frameIndex); i < iEnd; ++i)
+	for (size_t i = 0; i < numEntriesToAdd; ++i)
 	{
 		HistoryEntry& historyEntry = m_frameHistory.AddRecycle();
 		historyEntry.m_isValid = false;
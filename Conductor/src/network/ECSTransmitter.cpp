@@ -2,86 +2,337 @@
 
 #include <mem/SerializeLittleEndian.h>
 #include <network/ECSTransmission.h>
+#include <network/PacketCompression.h>
+#include <thread/JobSystem.h>
 
 namespace Network
 {
+namespace Internal_ECSTransmitter
+{
+// Preparing a single transmission isn't worth the overhead of the job system.
+constexpr uint32_t k_minNumTransmissionsToPrepareInParallel = 2;
+
+// Returns the index of the relevant entity IDs of the given interest area, or sk_InvalidIndex if there are none.
+// Frames are transmitted with few distinct interest areas, so they are searched linearly.
+size_t IndexOfInterestArea(
+	const Collection::Vector<Collection::Pair<InterestArea, Collection::Vector<uint32_t>>>& relevantEntityIDs,
+	const InterestArea& interestArea)
+{
+	return relevantEntityIDs.IndexOf([&](const auto& entry) { return entry.first == interestArea; });
+}
+}
+
 void ECSTransmitter::NotifyOfClientConnected(const Client::ClientID clientID)
 {
-	m_lastSeenFramePerClient[clientID] = k_invalidFrameIndex;
+	m_clientStates[clientID] = ClientState();
 }
 
 void ECSTransmitter::NotifyOfClientDisconnected(const Client::ClientID clientID)
 {
-	[[maybe_unused]] const bool removed = m_lastSeenFramePerClient.TryRemove(clientID);
+	[[maybe_unused]] const bool removed = m_clientStates.TryRemove(clientID);
 	AMP_FATAL_ASSERT(removed,
 		"Client [%u] disconnected without connecting first, or disconnected twice in a row!",
 		static_cast<uint32_t>(clientID.GetN()));
 }
 
-void ECSTransmitter::AddSerializedFrame(ECS::SerializedEntitiesAndComponents&& newFrame)
+void ECSTransmitter::SetClientInterestArea(const Client::ClientID clientID, const InterestArea& interestArea)
+{
+	auto* const entry = m_clientStates.Find(clientID);
+	AMP_FATAL_ASSERT(entry != m_clientStates.end(),
+		"Client [%u] must connect before its interest area is set.", static_cast<uint32_t>(clientID.GetN()));
+	entry->second.m_interestArea = interestArea;
+}
+
+void ECSTransmitter::EnablePacketCompression(Collection::Vector<uint8_t>&& dictionary)
+{
+	m_isPacketCompressionEnabled = true;
+	m_packetCompressionDictionary = std::move(dictionary);
+}
+
+void ECSTransmitter::AddSerializedFrame(
+	ECS::SerializedEntitiesAndComponents&& newFrame,
+	ECS::SerializedChanges&& changes)
 {
 	++m_frameIndex;
-	m_frameHistory.Add(std::move(newFrame));
+	m_frameHistory.Add({ std::move(newFrame), std::move(changes), {} });
+}
+
+const ECS::SerializedEntitiesAndComponents* ECSTransmitter::FindNewestFrame() const
+{
+	if (m_frameHistory.Size() == 0)
+	{
+		return nullptr;
+	}
+	return &m_frameHistory.Newest().m_serialization;
 }
 
 void ECSTransmitter::NotifyOfFrameAcknowledgement(const Client::ClientID clientID, uint64_t frameIndex)
 {
-	auto* const entry = m_lastSeenFramePerClient.Find(clientID);
-	if (frameIndex > entry->second || entry->second == k_invalidFrameIndex)
+	auto* const entry = m_clientStates.Find(clientID);
+	if (frameIndex > entry->second.m_lastSeenFrameIndex || entry->second.m_lastSeenFrameIndex == k_invalidFrameIndex)
 	{
-		entry->second = frameIndex;
+		entry->second.m_lastSeenFrameIndex = frameIndex;
 	}
 }
 
-void ECSTransmitter::TransmitFrame(
-	const Client::ClientID clientID,
-	Collection::Vector<uint8_t>& outTransmission) const
+void ECSTransmitter::PrepareTransmissions(const RelevantEntityFinder& findRelevantEntityIDs)
+{
+	using namespace Internal_ECSTransmitter;
+
+	AMP_FATAL_ASSERT(m_frameHistory.Size() > 0, "Transmissions can't be prepared before a frame is added.");
+
+	// Find the entities of the newest frame relevant to each interest area it is transmitted with.
+	Frame& newestFrame = m_frameHistory.Newest();
+	for (const auto& entry : m_clientStates)
+	{
+		const InterestArea& interestArea = entry.second.m_interestArea;
+		if (interestArea.IsValid()
+			&& IndexOfInterestArea(newestFrame.m_relevantEntityIDs, interestArea)
+				== newestFrame.m_relevantEntityIDs.sk_InvalidIndex)
+		{
+			auto& relevantEntry = newestFrame.m_relevantEntityIDs.Emplace(interestArea, Collection::Vector<uint32_t>());
+			findRelevantEntityIDs(interestArea, relevantEntry.second);
+		}
+	}
+
+	// Group the clients by the frame their transmissions are compressed against and by their interest areas.
+	m_numPreparedTransmissions = 0;
+	for (auto& entry : m_clientStates)
+	{
+		ClientState& clientState = entry.second;
+		const uint64_t baselineFrameIndex = FindBaselineFrameIndex(clientState.m_lastSeenFrameIndex);
+		const InterestArea baselineInterestArea = (baselineFrameIndex == k_invalidFrameIndex)
+			? InterestArea()
+			: clientState.m_interestAreaHistory[baselineFrameIndex % k_historySize];
+
+		// Remember the interest area the newest frame is transmitted to the client with.
+		clientState.m_interestAreaHistory[m_frameIndex % k_historySize] = clientState.m_interestArea;
+
+		const auto isTransmissionShared = [&](const PreparedTransmission& transmission)
+		{
+			return transmission.m_baselineFrameIndex == baselineFrameIndex
+				&& transmission.m_baselineInterestArea == baselineInterestArea
+				&& transmission.m_interestArea == clientState.m_interestArea;
+		};
+
+		uint32_t transmissionIndex = 0;
+		while (transmissionIndex < m_numPreparedTransmissions
+			&& !isTransmissionShared(m_preparedTransmissions[transmissionIndex]))
+		{
+			++transmissionIndex;
+		}
+
+		if (transmissionIndex == m_numPreparedTransmissions)
+		{
+			if (m_numPreparedTransmissions == m_preparedTransmissions.Size())
+			{
+				m_preparedTransmissions.Emplace();
+			}
+			PreparedTransmission& transmission = m_preparedTransmissions[m_numPreparedTransmissions];
+			transmission.m_baselineFrameIndex = baselineFrameIndex;
+			transmission.m_baselineInterestArea = baselineInterestArea;
+			transmission.m_interestArea = clientState.m_interestArea;
+			transmission.m_bytes.Clear();
+			++m_numPreparedTransmissions;
+		}
+
+		clientState.m_preparedTransmissionIndex = transmissionIndex;
+	}
+
+	// Create each transmission once. The transmissions only read the frame history, so they can be created in
+	// parallel when there are several of them.
+	struct TransmissionContext
+	{
+		const ECSTransmitter& m_transmitter;
+		Collection::Vector<PreparedTransmission>& m_transmissions;
+
+		static void RunJob(void* rawContext, const uint32_t jobIndex)
+		{
+			TransmissionContext& context = *static_cast<TransmissionContext*>(rawContext);
+			context.m_transmitter.PrepareTransmission(context.m_transmissions[jobIndex]);
+		}
+	};
+
+	TransmissionContext context{ *this, m_preparedTransmissions };
+	if (m_numPreparedTransmissions < k_minNumTransmissionsToPrepareInParallel)
+	{
+		for (uint32_t i = 0; i < m_numPreparedTransmissions; ++i)
+		{
+			TransmissionContext::RunJob(&context, i);
+		}
+	}
+	else
+	{
+		Thread::JobSystem& jobSystem = Thread::JobSystem::GetEngineJobSystem();
+		Thread::JobCounter counter;
+		jobSystem.Submit(&TransmissionContext::RunJob, &context, m_numPreparedTransmissions, counter);
+		jobSystem.Wait(counter);
+	}
+}
+
+const Collection::Vector<uint8_t>& ECSTransmitter::GetPreparedTransmission(const Client::ClientID clientID) const
+{
+	const uint32_t transmissionIndex = m_clientStates.Find(clientID)->second.m_preparedTransmissionIndex;
+	AMP_FATAL_ASSERT(transmissionIndex < m_numPreparedTransmissions,
+		"No transmission was prepared for client [%u].", static_cast<uint32_t>(clientID.GetN()));
+
+	return m_preparedTransmissions[transmissionIndex].m_bytes;
+}
+
+uint64_t ECSTransmitter::FindBaselineFrameIndex(const uint64_t lastSeenFrameIndex) const
 {
 	// Fall back to a full transmission if there is no history or the client hasn't seen a frame yet.
-	const uint64_t lastSeenFrameIndex = m_lastSeenFramePerClient.Find(clientID)->second;
 	if (m_frameHistory.Size() == 0 || lastSeenFrameIndex == k_invalidFrameIndex)
 	{
-		TransmitFullFrame(outTransmission);
-		return;
+		return k_invalidFrameIndex;
 	}
 
 	// Fall back to a full transmission if there's not enough history to create a delta frame.
 	const uint64_t oldestStoredFrameIndex = m_frameIndex - (m_frameHistory.Size() - 1);
 	if (lastSeenFrameIndex < oldestStoredFrameIndex)
 	{
-		TransmitFullFrame(outTransmission);
+		return k_invalidFrameIndex;
+	}
+
+	return lastSeenFrameIndex;
+}
+
+void ECSTransmitter::PrepareTransmission(PreparedTransmission& transmission) const
+{
+	const Frame& newestFrame = m_frameHistory.Newest();
+	const ECS::SerializedEntitiesAndComponents& newestSerialization =
+		FilterFrame(newestFrame, transmission.m_interestArea, transmission.m_filteredFrame);
+
+	if (transmission.m_baselineFrameIndex == k_invalidFrameIndex)
+	{
+		TransmitFullFrame(newestSerialization, transmission.m_bytes);
 		return;
 	}
 
-	// If we have a last seen frame for this client, construct a delta transmission against the current frame.
-	const size_t historyIndex = static_cast<size_t>(lastSeenFrameIndex - oldestStoredFrameIndex);
-	const ECS::SerializedEntitiesAndComponents& lastSeenFrame = m_frameHistory[historyIndex];
-	const ECS::SerializedEntitiesAndComponents& newestFrame = m_frameHistory.Newest();
+	const uint64_t oldestStoredFrameIndex = m_frameIndex - (m_frameHistory.Size() - 1);
+	const size_t historyIndex = static_cast<size_t>(transmission.m_baselineFrameIndex - oldestStoredFrameIndex);
+	const Frame& lastSeenFrame = m_frameHistory[historyIndex];
+	const ECS::SerializedEntitiesAndComponents& lastSeenSerialization =
+		FilterFrame(lastSeenFrame, transmission.m_baselineInterestArea, transmission.m_filteredBaselineFrame);
 
+	// Entities enter and leave interest areas without changing, so filtered frames are compared in full. The cost of
+	// doing so is proportional to the number of entities in the interest area rather than in the whole frame.
+	if (transmission.m_baselineInterestArea.IsValid() || transmission.m_interestArea.IsValid())
+	{
+		TransmitDeltaFrame(transmission.m_baselineFrameIndex,
+			lastSeenSerialization, newestSerialization, nullptr, transmission.m_bytes);
+		return;
+	}
+
+	// Gather the changes of the frames since the last seen frame, which are the only elements that can differ.
+	ECS::SerializedChanges changes;
+	for (size_t i = historyIndex + 1, iEnd = m_frameHistory.Size(); i < iEnd; ++i)
+	{
+		changes.Merge(m_frameHistory[i].m_changes);
+	}
+
+	TransmitDeltaFrame(transmission.m_baselineFrameIndex,
+		lastSeenSerialization, newestSerialization, &changes, transmission.m_bytes);
+}
+
+const ECS::SerializedEntitiesAndComponents& ECSTransmitter::FilterFrame(
+	const Frame& frame,
+	const InterestArea& interestArea,
+	ECS::SerializedEntitiesAndComponents& outFilteredFrame) const
+{
+	if (!interestArea.IsValid())
+	{
+		return frame.m_serialization;
+	}
+
+	const size_t relevantIndex =
+		Internal_ECSTransmitter::IndexOfInterestArea(frame.m_relevantEntityIDs, interestArea);
+	AMP_FATAL_ASSERT(relevantIndex != frame.m_relevantEntityIDs.sk_InvalidIndex,
+		"Frames can only be filtered by the interest areas they were transmitted with.");
+
+	ECS::FilterSerializedEntitiesAndComponents(
+		frame.m_serialization, frame.m_relevantEntityIDs[relevantIndex].second.GetConstView(), outFilteredFrame);
+	return outFilteredFrame;
+}
+
+void ECSTransmitter::TransmitDeltaFrame(
+	const uint64_t baselineFrameIndex,
+	const ECS::SerializedEntitiesAndComponents& lastSeenFrame,
+	const ECS::SerializedEntitiesAndComponents& newestFrame,
+	const ECS::SerializedChanges* const changes,
+	Collection::Vector<uint8_t>& outTransmission) const
+{
 	// Transmit the delta frame marker so that the receiver knows to decompress the data.
 	Mem::LittleEndian::Serialize(k_deltaFrameMarker, outTransmission);
+	const size_t flagsIndex = outTransmission.Size();
+	Mem::LittleEndian::Serialize(k_noFrameFlags, outTransmission);
 	
 	// Transmit the current frame index and the index of the frame this is compressed against.
 	Mem::LittleEndian::Serialize(m_frameIndex, outTransmission);
-	Mem::LittleEndian::Serialize(lastSeenFrameIndex, outTransmission);
+	Mem::LittleEndian::Serialize(baselineFrameIndex, outTransmission);
 
 	// Create the delta transmission.
-	ECS::DeltaCompressSerializedEntitiesAndComponentsTo(lastSeenFrame, newestFrame, outTransmission);
+	if (changes != nullptr)
+	{
+		ECS::DeltaCompressSerializedEntitiesAndComponentsTo(lastSeenFrame, newestFrame, *changes, outTransmission);
+	}
+	else
+	{
+		ECS::DeltaCompressSerializedEntitiesAndComponentsTo(lastSeenFrame, newestFrame, outTransmission);
+	}
+
+	PacketCompressTransmission(flagsIndex, outTransmission);
+}
+
+void ECSTransmitter::PacketCompressTransmission(
+	const size_t flagsIndex,
+	Collection::Vector<uint8_t>& inOutTransmission) const
+{
+	if (!m_isPacketCompressionEnabled)
+	{
+		return;
+	}
+
+	const size_t bodyBeginIndex = flagsIndex + 1;
+	const size_t numBodyBytes = inOutTransmission.Size() - bodyBeginIndex;
+
+	Collection::Vector<uint8_t> compressedBody;
+	PacketCompression::Compress(m_packetCompressionDictionary.GetConstView(),
+		{ inOutTransmission.begin() + bodyBeginIndex, numBodyBytes },
+		compressedBody);
+
+	// Small delta frames may not compress, in which case they're transmitted as they are.
+	if (compressedBody.Size() < numBodyBytes)
+	{
+		inOutTransmission[flagsIndex] |= k_packetCompressedFrameFlag;
+		inOutTransmission.Remove(bodyBeginIndex, inOutTransmission.Size());
+		inOutTransmission.AddAll(compressedBody.GetConstView());
+	}
 }
 
 void ECSTransmitter::TransmitFullFrame(Collection::Vector<uint8_t>& outTransmission) const
+{
+	TransmitFullFrame(m_frameHistory.Newest().m_serialization, outTransmission);
+}
+
+void ECSTransmitter::TransmitFullFrame(
+	const ECS::SerializedEntitiesAndComponents& frame,
+	Collection::Vector<uint8_t>& outTransmission) const
 {
 	// Transmit the full frame marker so that the receiver knows to directly apply the data.
 	Mem::LittleEndian::Serialize(k_fullFrameMarker, outTransmission);
+	const size_t flagsIndex = outTransmission.Size();
+	Mem::LittleEndian::Serialize(k_noFrameFlags, outTransmission);
 
 	// Transmit the current frame index and create the full transmission.
 	Mem::LittleEndian::Serialize(m_frameIndex, outTransmission);
 
-	const ECS::SerializedEntitiesAndComponents& newestFrame = m_frameHistory.Newest();
-	ECS::WriteSerializedEntitiesAndComponentsTo(newestFrame,
+	ECS::WriteSerializedEntitiesAndComponentsTo(frame,
 		[&](const void* data, size_t length)
 		{
 			outTransmission.AddAll({ reinterpret_cast<const uint8_t*>(data), length });
 		});
+
+	PacketCompressTransmission(flagsIndex, outTransmission);
 }
 }
@@ -0,0 +1,114 @@
+#include <network/MessageFraming.h>
+
+#include <mem/DeserializeLittleEndian.h>
+#include <mem/SerializeLittleEndian.h>
+
+size_t Network::MessageFraming::BeginFrame(Collection::Vector<uint8_t>& outBytes)
+{
+	const size_t headerIndex = outBytes.Size();
+	Mem::LittleEndian::Serialize(static_cast<uint32_t>(0), outBytes);
+	return headerIndex;
+}
+
+void Network::MessageFraming::FinishFrame(
+	const size_t headerIndex,
+	Collection::Vector<uint8_t>& inOutBytes,
+	const size_t numExternalBytes)
+{
+	const size_t frameSize = (inOutBytes.Size() - headerIndex - k_frameHeaderSize) + numExternalBytes;
+	AMP_FATAL_ASSERT(frameSize <= k_maxFrameSize, "Frame size [%zu] exceeds the maximum frame size [%zu].",
+		frameSize, k_maxFrameSize);
+
+	const uint32_t frameSize32 = static_cast<uint32_t>(frameSize);
+	memcpy(inOutBytes.begin() + headerIndex, &frameSize32, sizeof(frameSize32));
+}
+
+Collection::ArrayView<uint8_t> Network::FrameReassembler::GetReceiveBuffer()
+{
+	using namespace MessageFraming;
+
+	// If the next frame's size has been received, make room for more of it so that it's received contiguously. The
+	// room made is at most double the bytes buffered, so the buffer only grows to fit a large frame as its bytes
+	// arrive. Frames larger than the maximum frame size are rejected by TryPopFrame() and aren't made room for.
+	const size_t numBufferedBytes = m_writeIndex - m_readIndex;
+	size_t numRequiredBytes = numBufferedBytes + k_minReceiveBufferSize;
+	if (numBufferedBytes >= k_frameHeaderSize)
+	{
+		uint32_t frameSize;
+		memcpy(&frameSize, m_bytes.begin() + m_readIndex, sizeof(frameSize));
+		if (frameSize <= m_maxFrameSize)
+		{
+			const size_t numFrameBytes = k_frameHeaderSize + frameSize;
+			const size_t maxGrowableBytes = numBufferedBytes * 2;
+			const size_t numGrowableBytes = (numFrameBytes < maxGrowableBytes) ? numFrameBytes : maxGrowableBytes;
+			if (numGrowableBytes > numRequiredBytes)
+			{
+				numRequiredBytes = numGrowableBytes;
+			}
+		}
+	}
+
+	if ((m_bytes.Size() - m_readIndex) < numRequiredBytes)
+	{
+		// Move the unpopped bytes to the front of the buffer. Every complete frame is popped before more bytes are
+		// received, so this only moves part of one frame.
+		if (m_readIndex > 0)
+		{
+			memmove(m_bytes.begin(), m_bytes.begin() + m_readIndex, numBufferedBytes);
+			m_readIndex = 0;
+			m_writeIndex = numBufferedBytes;
+		}
+
+		if (m_bytes.Size() < numRequiredBytes)
+		{
+			m_bytes.Resize(static_cast<uint32_t>(numRequiredBytes), 0);
+		}
+	}
+
+	return { m_bytes.begin() + m_writeIndex, m_bytes.Size() - m_writeIndex };
+}
+
+void Network::FrameReassembler::NotifyOfBytesReceived(const size_t numBytes)
+{
+	AMP_FATAL_ASSERT((m_writeIndex + numBytes) <= m_bytes.Size(),
+		"More bytes were received than fit in the buffer from GetReceiveBuffer().");
+	m_writeIndex += numBytes;
+}
+
+bool Network::FrameReassembler::TryPopFrame(Collection::ArrayView<const uint8_t>& outFrame)
+{
+	using namespace MessageFraming;
+
+	const uint8_t* bytesIter = m_bytes.begin() + m_readIndex;
+	const uint8_t* const bytesEnd = m_bytes.begin() + m_writeIndex;
+
+	const auto maybeFrameSize = Mem::LittleEndian::DeserializeUi32(bytesIter, bytesEnd);
+	if (m_hasInvalidFrame || !maybeFrameSize.second)
+	{
+		return false;
+	}
+
+	const size_t frameSize = maybeFrameSize.first;
+	if (frameSize > m_maxFrameSize)
+	{
+		AMP_LOG_ERROR("Received a frame of size [%zu], which exceeds the maximum frame size [%zu].",
+			frameSize, m_maxFrameSize);
+		m_hasInvalidFrame = true;
+		return false;
+	}
+	if (frameSize > static_cast<size_t>(bytesEnd - bytesIter))
+	{
+		return false;
+	}
+
+	outFrame = { bytesIter, frameSize };
+	m_readIndex += k_frameHeaderSize + frameSize;
+
+	// Start receiving at the front of the buffer again once everything received has been popped.
+	if (m_readIndex == m_writeIndex)
+	{
+		m_readIndex = 0;
+		m_writeIndex = 0;
+	}
+	return true;
+}
@@ -0,0 +1,262 @@
+#include <network/PacketCompression.h>
+
+#include <collection/ArrayView.h>
+#include <collection/Vector.h>
+#include <mem/DeserializeLittleEndian.h>
+#include <mem/SerializeLittleEndian.h>
+
+namespace Network
+{
+namespace Internal_PacketCompression
+{
+// Compressed bytes are a sequence of literal runs, each of which is followed by a match unless it ends the bytes.
+// A sequence begins with a token byte which holds the literal run length in its high nibble and the match length
+// minus k_minMatchLength in its low nibble. A nibble of k_maxTokenLength means the length continues in following
+// bytes, each of which is added to it; the length ends at the first byte that isn't UINT8_MAX.
+// The literals follow the token, and the match's offset back from the current position follows the literals.
+constexpr uint32_t k_tokenLengthNumBits = 4;
+constexpr uint32_t k_maxTokenLength = (1 << k_tokenLengthNumBits) - 1;
+
+constexpr size_t k_minMatchLength = 4;
+constexpr size_t k_maxMatchOffset = UINT16_MAX;
+
+// Small packets don't benefit from a large hash table, which would also be costly to clear for each packet.
+constexpr uint32_t k_hashTableNumBits = 12;
+constexpr uint32_t k_hashTableSize = 1 << k_hashTableNumBits;
+constexpr uint32_t k_invalidPosition = UINT32_MAX;
+
+// A byte of an extended length adds at most UINT8_MAX to it, which bounds how much bytes can be compressed.
+constexpr uint64_t k_maxCompressionRatio = UINT8_MAX;
+
+uint32_t Read32(const uint8_t* const bytes)
+{
+	uint32_t out;
+	memcpy(&out, bytes, sizeof(out));
+	return out;
+}
+
+uint32_t Hash(const uint32_t fourBytes)
+{
+	// Fibonacci hashing: the high bits of the product are well mixed.
+	return (fourBytes * 2654435761u) >> (32 - k_hashTableNumBits);
+}
+
+void SerializeExtendedLength(size_t length, Collection::Vector<uint8_t>& outBytes)
+{
+	while (length >= UINT8_MAX)
+	{
+		outBytes.Add(UINT8_MAX);
+		length -= UINT8_MAX;
+	}
+	outBytes.Add(static_cast<uint8_t>(length));
+}
+
+bool TryDeserializeExtendedLength(const uint8_t*& iter, const uint8_t* const end, size_t& inOutLength)
+{
+	uint8_t byte;
+	do
+	{
+		if (iter >= end)
+		{
+			return false;
+		}
+		byte = *(iter++);
+		inOutLength += byte;
+	} while (byte == UINT8_MAX);
+	return true;
+}
+
+void SerializeSequence(
+	const uint8_t* const literals,
+	const size_t numLiterals,
+	const size_t matchOffset,
+	const size_t matchLength,
+	Collection::Vector<uint8_t>& outBytes)
+{
+	const size_t literalToken = (numLiterals < k_maxTokenLength) ? numLiterals : k_maxTokenLength;
+	const size_t extraMatchLength = (matchLength > 0) ? (matchLength - k_minMatchLength) : 0;
+	const size_t matchToken = (extraMatchLength < k_maxTokenLength) ? extraMatchLength : k_maxTokenLength;
+	outBytes.Add(static_cast<uint8_t>((literalToken << k_tokenLengthNumBits) | matchToken));
+
+	if (literalToken == k_maxTokenLength)
+	{
+		SerializeExtendedLength(numLiterals - k_maxTokenLength, outBytes);
+	}
+	outBytes.AddAll({ literals, numLiterals });
+
+	if (matchLength == 0)
+	{
+		return;
+	}
+
+	Mem::LittleEndian::Serialize(static_cast<uint16_t>(matchOffset), outBytes);
+	if (matchToken == k_maxTokenLength)
+	{
+		SerializeExtendedLength(extraMatchLength - k_maxTokenLength, outBytes);
+	}
+}
+}
+
+void PacketCompression::Compress(
+	const Collection::ArrayView<const uint8_t>& dictionary,
+	const Collection::ArrayView<const uint8_t>& bytes,
+	Collection::Vector<uint8_t>& outCompressedBytes)
+{
+	using namespace Internal_PacketCompression;
+
+	Mem::LittleEndian::SerializeVarUint(bytes.Size(), outCompressedBytes);
+
+	// Search for matches in the dictionary followed by the bytes. Positions are indices into this window.
+	Collection::Vector<uint8_t> window;
+	window.EnsureCapacity(dictionary.Size() + bytes.Size());
+	window.AddAll(dictionary);
+	window.AddAll(bytes);
+
+	const uint8_t* const windowBytes = window.begin();
+	const size_t windowSize = window.Size();
+
+	// The hash table holds the most recent position of each hashed four byte sequence.
+	Collection::Vector<uint32_t> hashTable;
+	hashTable.Resize(k_hashTableSize, k_invalidPosition);
+	for (size_t i = 0; (i + k_minMatchLength) <= dictionary.Size(); ++i)
+	{
+		hashTable[Hash(Read32(windowBytes + i))] = static_cast<uint32_t>(i);
+	}
+
+	size_t literalsBegin = dictionary.Size();
+	size_t i = dictionary.Size();
+	while ((i + k_minMatchLength) <= windowSize)
+	{
+		const uint32_t fourBytes = Read32(windowBytes + i);
+		uint32_t& hashEntry = hashTable[Hash(fourBytes)];
+		const uint32_t candidate = hashEntry;
+		hashEntry = static_cast<uint32_t>(i);
+
+		if (candidate == k_invalidPosition || (i - candidate) > k_maxMatchOffset
+			|| Read32(windowBytes + candidate) != fourBytes)
+		{
+			++i;
+			continue;
+		}
+
+		// Extend the match as far as it goes. It may overlap the position it's found at.
+		size_t matchLength = k_minMatchLength;
+		while ((i + matchLength) < windowSize && windowBytes[candidate + matchLength] == windowBytes[i + matchLength])
+		{
+			++matchLength;
+		}
+
+		SerializeSequence(windowBytes + literalsBegin, i - literalsBegin, i - candidate, matchLength,
+			outCompressedBytes);
+
+		i += matchLength;
+		literalsBegin = i;
+	}
+
+	// The bytes always end with a run of literals, even if it's empty.
+	SerializeSequence(windowBytes + literalsBegin, windowSize - literalsBegin, 0, 0, outCompressedBytes);
+}
+
+bool PacketCompression::TryDecompress(
+	const Collection::ArrayView<const uint8_t>& dictionary,
+	const uint8_t*& compressedIter,
+	const uint8_t* const compressedBytesEnd,
+	Collection::Vector<uint8_t>& outDecompressedBytes)
+{
+	using namespace Internal_PacketCompression;
+
+	const auto maybeNumDecompressedBytes =
+		Mem::LittleEndian::DeserializeVarUint(compressedIter, compressedBytesEnd);
+	if (!maybeNumDecompressedBytes.second)
+	{
+		return false;
+	}
+
+	// Reject sizes that the compressed bytes can't possibly expand to before allocating anything.
+	const uint64_t numDecompressedBytes = maybeNumDecompressedBytes.first;
+	const uint64_t numCompressedBytes = static_cast<uint64_t>(compressedBytesEnd - compressedIter);
+	if (numDecompressedBytes > (numCompressedBytes + 1) * k_maxCompressionRatio)
+	{
+		AMP_LOG_ERROR("Packet decompression encountered an invalid size [%llu].",
+			static_cast<unsigned long long>(numDecompressedBytes));
+		return false;
+	}
+
+	const size_t outBegin = outDecompressedBytes.Size();
+	const size_t outEnd = outBegin + static_cast<size_t>(numDecompressedBytes);
+	outDecompressedBytes.Resize(outEnd, 0);
+	uint8_t* const out = outDecompressedBytes.begin();
+
+	size_t outIndex = outBegin;
+	while (true)
+	{
+		if (compressedIter >= compressedBytesEnd)
+		{
+			AMP_LOG_ERROR("Unexpectedly encountered the end of the compressed bytes during packet decompression.");
+			return false;
+		}
+		const uint8_t token = *(compressedIter++);
+
+		// Copy the literals.
+		size_t numLiterals = token >> k_tokenLengthNumBits;
+		if (numLiterals == k_maxTokenLength
+			&& !TryDeserializeExtendedLength(compressedIter, compressedBytesEnd, numLiterals))
+		{
+			return false;
+		}
+		if (numLiterals > (outEnd - outIndex)
+			|| numLiterals > static_cast<size_t>(compressedBytesEnd - compressedIter))
+		{
+			AMP_LOG_ERROR("Packet decompression encountered an invalid literal run.");
+			return false;
+		}
+		memcpy(out + outIndex, compressedIter, numLiterals);
+		compressedIter += numLiterals;
+		outIndex += numLiterals;
+
+		if (outIndex == outEnd)
+		{
+			return true;
+		}
+
+		// Copy the match, which may begin in the dictionary and may overlap the bytes it's copied to.
+		const auto maybeMatchOffset = Mem::LittleEndian::DeserializeUi16(compressedIter, compressedBytesEnd);
+		size_t matchLength = token & k_maxTokenLength;
+		if (!maybeMatchOffset.second
+			|| (matchLength == k_maxTokenLength
+				&& !TryDeserializeExtendedLength(compressedIter, compressedBytesEnd, matchLength)))
+		{
+			return false;
+		}
+		matchLength += k_minMatchLength;
+
+		const size_t matchOffset = maybeMatchOffset.first;
+		const size_t windowIndex = dictionary.Size() + (outIndex - outBegin);
+		if (matchOffset == 0 || matchOffset > windowIndex || matchLength > (outEnd - outIndex))
+		{
+			AMP_LOG_ERROR("Packet decompression encountered an invalid match.");
+			return false;
+		}
+
+		size_t sourceWindowIndex = windowIndex - matchOffset;
+		for (; sourceWindowIndex < dictionary.Size() && matchLength > 0; ++sourceWindowIndex, --matchLength)
+		{
+			out[outIndex++] = dictionary[sourceWindowIndex];
+		}
+
+		const uint8_t* source = out + outBegin + (sourceWindowIndex - dictionary.Size());
+		if (matchOffset >= matchLength)
+		{
+			memcpy(out + outIndex, source, matchLength);
+			outIndex += matchLength;
+		}
+		else
+		{
+			for (; matchLength > 0; --matchLength)
+			{
+				out[outIndex++] = *(source++);
+			}
+		}
+	}
+}
+}
@@ -1,9 +1,19 @@
+#if defined(_WIN32)
+
+#include <network/DatagramSocket.h>
 #include <network/Socket.h>
+#include <network/SocketPoller.h>
 
+#include <collection/Vector.h>
 #include <dev/Dev.h>
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 // Winsock includes and library.
 #include <winsock2.h>
+#include <mstcpip.h>
 #include <ws2tcpip.h>
 #pragma comment (lib, "Ws2_32.lib")
 
@@ -191,6 +201,17 @@ void Network::Socket::Close()
 	*m_impl = SocketImpl();
 }
 
+bool Network::Socket::TrySetNonBlocking()
+{
+	u_long isNonBlocking = 1;
+	if (ioctlsocket(m_impl->m_platformSocket, FIONBIO, &isNonBlocking) == SOCKET_ERROR)
+	{
+		Internal_Socket::LogWinsockError("ioctlsocket() failed: ", WSAGetLastError());
+		return false;
+	}
+	return true;
+}
+
 void Network::Socket::Send(const Collection::ArrayView<const uint8_t>& bytes)
 {
 	AMP_FATAL_ASSERT(IsValid(), "Can't send from an invalid socket!");
@@ -220,6 +241,63 @@ void Network::Socket::Send(const Collection::ArrayView<const uint8_t>& bytes)
 	}
 }
 
+size_t Network::Socket::SendBatch(const Collection::ArrayView<const Collection::ArrayView<const uint8_t>>& buffers)
+{
+	AMP_FATAL_ASSERT(IsValid(), "Can't send from an invalid socket!");
+
+	constexpr size_t k_maxNumBuffers = 64;
+	AMP_FATAL_ASSERT(buffers.Size() <= k_maxNumBuffers, "Can't send more than [%zu] buffers at once.", k_maxNumBuffers);
+
+	WSABUF platformBuffers[k_maxNumBuffers];
+	for (size_t i = 0, iEnd = buffers.Size(); i < iEnd; ++i)
+	{
+		platformBuffers[i].buf = const_cast<char*>(reinterpret_cast<const char*>(buffers[i].begin()));
+		platformBuffers[i].len = static_cast<ULONG>(buffers[i].Size());
+	}
+
+	// WSASend() can return early, and for a non-blocking socket it returns early whenever its send buffer fills up.
+	// The send is resumed from wherever it stopped until the socket would block.
+	WSABUF* unsentBuffers = platformBuffers;
+	DWORD numUnsentBuffers = static_cast<DWORD>(buffers.Size());
+	size_t numBytesSentTotal = 0;
+	while (numUnsentBuffers > 0)
+	{
+		DWORD numBytesSent = 0;
+		const int result = WSASend(m_impl->m_platformSocket,
+			unsentBuffers,
+			numUnsentBuffers,
+			&numBytesSent,
+			0,
+			nullptr,
+			nullptr);
+		if (result == SOCKET_ERROR)
+		{
+			const int errorCode = WSAGetLastError();
+			if (errorCode == WSAEWOULDBLOCK)
+			{
+				break;
+			}
+			Internal_Socket::LogWinsockError("WSASend() failed: ", errorCode);
+			Close();
+			break;
+		}
+		numBytesSentTotal += numBytesSent;
+
+		while (numUnsentBuffers > 0 && numBytesSent >= unsentBuffers->len)
+		{
+			numBytesSent -= unsentBuffers->len;
+			++unsentBuffers;
+			--numUnsentBuffers;
+		}
+		if (numUnsentBuffers > 0)
+		{
+			unsentBuffers->buf += numBytesSent;
+			unsentBuffers->len -= numBytesSent;
+		}
+	}
+	return numBytesSentTotal;
+}
+
 size_t Network::Socket::Receive(Collection::ArrayView<uint8_t>& outBytes)
 {
 	AMP_FATAL_ASSERT(IsValid(), "Can't receive on an invalid socket!");
@@ -251,7 +329,18 @@ size_t Network::Socket::Receive(Collection::ArrayView<uint8_t>& outBytes)
 		0);
 	if (numBytesReceived == SOCKET_ERROR)
 	{
-		Internal_Socket::LogWinsockError("recv() failed: ", WSAGetLastError());
+		const int errorCode = WSAGetLastError();
+		if (errorCode == WSAEWOULDBLOCK)
+		{
+			return 0;
+		}
+		Internal_Socket::LogWinsockError("recv() failed: ", errorCode);
+		Close();
+		return 0;
+	}
+	if (numBytesReceived == 0)
+	{
+		// The socket was readable but had no data, which means the endpoint closed the connection.
 		Close();
 		return 0;
 	}
@@ -349,3 +438,328 @@ Network::Socket Network::CreateConnectedSocket(const char* hostName, const char*
 	outSocket.GetImpl() = Socket::SocketImpl(connectSocket);
 	return outSocket;
 }
+
+struct Network::DatagramSocket::DatagramSocketImpl
+{
+	DatagramSocketImpl() = default;
+
+	explicit DatagramSocketImpl(SOCKET platformSocket)
+		: m_platformSocket(platformSocket)
+	{}
+
+	// Winsock socket.
+	SOCKET m_platformSocket{ INVALID_SOCKET };
+};
+
+Network::DatagramSocket::DatagramSocket()
+	: m_impl(Mem::MakeUnique<DatagramSocketImpl>())
+{
+}
+
+Network::DatagramSocket::~DatagramSocket()
+{
+	if (m_impl->m_platformSocket != INVALID_SOCKET)
+	{
+		Close();
+	}
+}
+
+Network::DatagramSocket::DatagramSocket(DatagramSocket&& other) noexcept
+	: m_impl(std::move(other.m_impl))
+{
+	other.m_impl = Mem::MakeUnique<DatagramSocketImpl>();
+}
+
+Network::DatagramSocket& Network::DatagramSocket::operator=(DatagramSocket&& rhs) noexcept
+{
+	m_impl = std::move(rhs.m_impl);
+	rhs.m_impl = Mem::MakeUnique<DatagramSocketImpl>();
+	return *this;
+}
+
+bool Network::DatagramSocket::IsValid() const
+{
+	return m_impl->m_platformSocket != INVALID_SOCKET;
+}
+
+void Network::DatagramSocket::Close()
+{
+	closesocket(m_impl->m_platformSocket);
+	*m_impl = DatagramSocketImpl();
+}
+
+void Network::DatagramSocket::SendTo(const DatagramAddress& address, const Collection::ArrayView<const uint8_t>& bytes)
+{
+	AMP_FATAL_ASSERT(IsValid(), "Can't send from an invalid socket!");
+
+	sockaddr_in platformAddress;
+	ZeroMemory(&platformAddress, sizeof(platformAddress));
+	platformAddress.sin_family = AF_INET;
+	platformAddress.sin_addr.s_addr = htonl(address.m_ipv4Address);
+	platformAddress.sin_port = htons(address.m_port);
+
+	// Datagrams may be dropped anywhere along their way, so a datagram the socket can't send is simply dropped too.
+	const int numBytesSent = sendto(
+		m_impl->m_platformSocket,
+		reinterpret_cast<const char*>(bytes.begin()),
+		static_cast<int>(bytes.Size()),
+		0,
+		reinterpret_cast<const sockaddr*>(&platformAddress),
+		sizeof(platformAddress));
+	if (numBytesSent == SOCKET_ERROR && WSAGetLastError() != WSAEWOULDBLOCK)
+	{
+		Internal_Socket::LogWinsockError("sendto() failed: ", WSAGetLastError());
+	}
+}
+
+size_t Network::DatagramSocket::ReceiveFrom(DatagramAddress& outAddress, Collection::ArrayView<uint8_t>& outBytes)
+{
+	AMP_FATAL_ASSERT(IsValid(), "Can't receive on an invalid socket!");
+
+	sockaddr_in platformAddress;
+	int platformAddressSize = sizeof(platformAddress);
+	const int numBytesReceived = recvfrom(
+		m_impl->m_platformSocket,
+		reinterpret_cast<char*>(outBytes.begin()),
+		static_cast<int>(outBytes.Size()),
+		0,
+		reinterpret_cast<sockaddr*>(&platformAddress),
+		&platformAddressSize);
+	if (numBytesReceived == SOCKET_ERROR)
+	{
+		const int errorCode = WSAGetLastError();
+		if (errorCode == WSAEMSGSIZE)
+		{
+			// The datagram was truncated to the size of outBytes.
+			outAddress.m_ipv4Address = ntohl(platformAddress.sin_addr.s_addr);
+			outAddress.m_port = ntohs(platformAddress.sin_port);
+			return outBytes.Size();
+		}
+		if (errorCode != WSAEWOULDBLOCK && errorCode != WSAECONNRESET)
+		{
+			Internal_Socket::LogWinsockError("recvfrom() failed: ", errorCode);
+		}
+		return 0;
+	}
+
+	outAddress.m_ipv4Address = ntohl(platformAddress.sin_addr.s_addr);
+	outAddress.m_port = ntohs(platformAddress.sin_port);
+	return static_cast<size_t>(numBytesReceived);
+}
+
+Network::DatagramSocket Network::CreateBoundDatagramSocket(const char* port)
+{
+	addrinfo* result = nullptr;
+	addrinfo hints;
+
+	ZeroMemory(&hints, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+	hints.ai_protocol = IPPROTO_UDP;
+	hints.ai_flags = AI_PASSIVE;
+
+	const int errorCode = getaddrinfo(NULL, port, &hints, &result);
+	if (errorCode != 0)
+	{
+		Internal_Socket::LogWinsockError("getaddrinfo() failed: ", errorCode);
+		return DatagramSocket();
+	}
+
+	SOCKET datagramSocket = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+	if (datagramSocket == INVALID_SOCKET)
+	{
+		Internal_Socket::LogWinsockError("socket() failed: ", WSAGetLastError());
+		freeaddrinfo(result);
+		return DatagramSocket();
+	}
+
+	if (bind(datagramSocket, result->ai_addr, static_cast<int>(result->ai_addrlen)) == SOCKET_ERROR)
+	{
+		Internal_Socket::LogWinsockError("bind() failed: ", WSAGetLastError());
+		freeaddrinfo(result);
+		closesocket(datagramSocket);
+		return DatagramSocket();
+	}
+
+	freeaddrinfo(result);
+
+	// Make the socket non-blocking.
+	u_long isNonBlocking = 1;
+	ioctlsocket(datagramSocket, FIONBIO, &isNonBlocking);
+
+	// Don't report ICMP port unreachable messages caused by earlier datagrams as errors on later receives.
+	BOOL isConnectionResetReported = FALSE;
+	DWORD numBytesReturned = 0;
+	WSAIoctl(datagramSocket, SIO_UDP_CONNRESET, &isConnectionResetReported, sizeof(isConnectionResetReported),
+		nullptr, 0, &numBytesReturned, nullptr, nullptr);
+
+	DatagramSocket outSocket;
+	outSocket.GetImpl() = DatagramSocket::DatagramSocketImpl(datagramSocket);
+	return outSocket;
+}
+
+bool Network::TryResolveDatagramAddress(const char* hostName, const char* port, DatagramAddress& outAddress)
+{
+	addrinfo* result = nullptr;
+	addrinfo hints;
+
+	ZeroMemory(&hints, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+	hints.ai_protocol = IPPROTO_UDP;
+
+	const int errorCode = getaddrinfo(hostName, port, &hints, &result);
+	if (errorCode != 0)
+	{
+		Internal_Socket::LogWinsockError("getaddrinfo() failed: ", errorCode);
+		return false;
+	}
+
+	const sockaddr_in* const platformAddress = reinterpret_cast<const sockaddr_in*>(result->ai_addr);
+	outAddress.m_ipv4Address = ntohl(platformAddress->sin_addr.s_addr);
+	outAddress.m_port = ntohs(platformAddress->sin_port);
+
+	freeaddrinfo(result);
+	return true;
+}
+
+namespace Internal_Socket
+{
+// WSAPoll() can't be interrupted by SocketPoller::Wake(), so waits are limited to this long.
+constexpr uint64_t k_maxPollerWaitMs = 1;
+}
+
+struct Network::SocketPoller::PollerImpl
+{
+	Collection::Vector<WSAPOLLFD> m_pollFDs;
+	Collection::Vector<uint64_t> m_keys;
+	std::atomic<bool> m_isWakeRequested{ false };
+};
+
+Network::SocketPoller::SocketPoller()
+	: m_impl(Mem::MakeUnique<PollerImpl>())
+{
+}
+
+Network::SocketPoller::~SocketPoller()
+{
+}
+
+namespace Internal_Socket
+{
+void AddToPoller(Network::SocketPoller::PollerImpl& poller, const SOCKET platformSocket, const uint64_t key)
+{
+	WSAPOLLFD& pollFD = poller.m_pollFDs.Emplace();
+	pollFD.fd = platformSocket;
+	pollFD.events = POLLRDNORM;
+	pollFD.revents = 0;
+	poller.m_keys.Add(key);
+}
+
+void RemoveFromPoller(Network::SocketPoller::PollerImpl& poller, const SOCKET platformSocket)
+{
+	const size_t index = poller.m_pollFDs.IndexOf([&](const WSAPOLLFD& pollFD) { return pollFD.fd == platformSocket; });
+	if (index != poller.m_pollFDs.sk_InvalidIndex)
+	{
+		poller.m_pollFDs.SwapWithAndRemoveLast(index);
+		poller.m_keys.SwapWithAndRemoveLast(index);
+	}
+}
+}
+
+bool Network::SocketPoller::TryAdd(Socket& socket, const uint64_t key)
+{
+	AMP_FATAL_ASSERT(key != k_invalidKey, "SocketPoller keys can't be k_invalidKey.");
+	if (!socket.IsValid())
+	{
+		return false;
+	}
+	Internal_Socket::AddToPoller(*m_impl, socket.GetImpl().m_platformSocket, key);
+	return true;
+}
+
+bool Network::SocketPoller::TryAdd(DatagramSocket& socket, const uint64_t key)
+{
+	AMP_FATAL_ASSERT(key != k_invalidKey, "SocketPoller keys can't be k_invalidKey.");
+	if (!socket.IsValid())
+	{
+		return false;
+	}
+	Internal_Socket::AddToPoller(*m_impl, socket.GetImpl().m_platformSocket, key);
+	return true;
+}
+
+void Network::SocketPoller::Remove(Socket& socket)
+{
+	Internal_Socket::RemoveFromPoller(*m_impl, socket.GetImpl().m_platformSocket);
+}
+
+void Network::SocketPoller::Remove(DatagramSocket& socket)
+{
+	Internal_Socket::RemoveFromPoller(*m_impl, socket.GetImpl().m_platformSocket);
+}
+
+void Network::SocketPoller::SetWaitForSend(Socket& socket, const uint64_t key, const bool isWaitingForSend)
+{
+	AMP_FATAL_ASSERT(key != k_invalidKey, "SocketPoller keys can't be k_invalidKey.");
+
+	const SOCKET platformSocket = socket.GetImpl().m_platformSocket;
+	const size_t index =
+		m_impl->m_pollFDs.IndexOf([&](const WSAPOLLFD& pollFD) { return pollFD.fd == platformSocket; });
+	if (index != m_impl->m_pollFDs.sk_InvalidIndex)
+	{
+		m_impl->m_pollFDs[index].events = isWaitingForSend ? (POLLRDNORM | POLLWRNORM) : POLLRDNORM;
+	}
+}
+
+size_t Network::SocketPoller::Wait(const Unit::Time::Millisecond timeout, uint64_t* outKeys, const size_t maxNumKeys)
+{
+	using namespace Internal_Socket;
+
+	if (m_impl->m_isWakeRequested.exchange(false, std::memory_order_acq_rel))
+	{
+		return 0;
+	}
+
+	const uint64_t timeoutMs = (timeout.GetN() < k_maxPollerWaitMs) ? timeout.GetN() : k_maxPollerWaitMs;
+	if (m_impl->m_pollFDs.IsEmpty())
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+		return 0;
+	}
+
+	const int result = WSAPoll(m_impl->m_pollFDs.begin(),
+		static_cast<ULONG>(m_impl->m_pollFDs.Size()),
+		static_cast<INT>(timeoutMs));
+	if (result == SOCKET_ERROR)
+	{
+		LogWinsockError("WSAPoll() failed: ", WSAGetLastError());
+		return 0;
+	}
+
+	// Closed sockets report POLLNVAL and are removed so that they aren't polled again.
+	size_t numKeys = 0;
+	for (size_t i = 0; i < m_impl->m_pollFDs.Size(); /* CONTROLLED IN LOOP */)
+	{
+		const SHORT revents = m_impl->m_pollFDs[i].revents;
+		if ((revents & POLLNVAL) != 0)
+		{
+			m_impl->m_pollFDs.SwapWithAndRemoveLast(i);
+			m_impl->m_keys.SwapWithAndRemoveLast(i);
+			continue;
+		}
+		if ((revents & (POLLRDNORM | POLLWRNORM | POLLHUP | POLLERR)) != 0 && numKeys < maxNumKeys)
+		{
+			outKeys[numKeys++] = m_impl->m_keys[i];
+		}
+		++i;
+	}
+	return numKeys;
+}
+
+void Network::SocketPoller::Wake()
+{
+	m_impl->m_isWakeRequested.store(true, std::memory_order_release);
+}
+
+#endif
@@ -0,0 +1,645 @@
+#if !defined(_WIN32)
+
+#include <network/DatagramSocket.h>
+#include <network/Socket.h>
+#include <network/SocketPoller.h>
+
+#include <dev/Dev.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+// POSIX includes.
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace Internal_Socket
+{
+constexpr int k_invalidSocket = -1;
+
+void LogSocketError(const char* message, int errorCode)
+{
+	AMP_LOG("%s%s", message, strerror(errorCode));
+}
+
+void LogAddressError(const char* message, int errorCode)
+{
+	AMP_LOG("%s%s", message, gai_strerror(errorCode));
+}
+}
+
+bool Network::TryInitializeSocketAPI()
+{
+	// POSIX sockets don't need to be initialized.
+	return true;
+}
+
+void Network::ShutdownSocketAPI()
+{
+}
+
+struct Network::Socket::SocketImpl
+{
+	SocketImpl() = default;
+
+	explicit SocketImpl(int platformSocket)
+		: m_platformSocket(platformSocket)
+	{}
+
+	// POSIX socket file descriptor.
+	int m_platformSocket{ Internal_Socket::k_invalidSocket };
+};
+
+Network::Socket::Socket()
+	: m_impl(Mem::MakeUnique<SocketImpl>())
+{
+}
+
+Network::Socket::~Socket()
+{
+	if (m_impl->m_platformSocket != Internal_Socket::k_invalidSocket)
+	{
+		Close();
+	}
+}
+
+Network::Socket::Socket(Socket&& other) noexcept
+	: m_impl(std::move(other.m_impl))
+{
+	other.m_impl = Mem::MakeUnique<SocketImpl>();
+}
+
+Network::Socket& Network::Socket::operator=(Socket&& rhs) noexcept
+{
+	m_impl = std::move(rhs.m_impl);
+	rhs.m_impl = Mem::MakeUnique<SocketImpl>();
+	return *this;
+}
+
+bool Network::Socket::IsValid() const
+{
+	return m_impl->m_platformSocket != Internal_Socket::k_invalidSocket;
+}
+
+bool Network::Socket::TryListen()
+{
+	if (listen(m_impl->m_platformSocket, SOMAXCONN) != 0)
+	{
+		Internal_Socket::LogSocketError("listen() failed: ", errno);
+		close(m_impl->m_platformSocket);
+		*m_impl = SocketImpl();
+		return false;
+	}
+	return true;
+}
+
+Network::Socket Network::Socket::Accept()
+{
+	const int clientSocket = accept4(m_impl->m_platformSocket, nullptr, nullptr, SOCK_CLOEXEC);
+	if (clientSocket == Internal_Socket::k_invalidSocket)
+	{
+		Internal_Socket::LogSocketError("accept() failed: ", errno);
+		return Socket();
+	}
+
+	// Return the platform specific socket wrapped in a platform agnostic way.
+	Socket outSocket;
+	(*outSocket.m_impl) = SocketImpl(clientSocket);
+	return outSocket;
+}
+
+size_t Network::Socket::AcceptPendingConnections(Socket* outSockets, const size_t maxAcceptCount)
+{
+	pollfd listenerPollFD;
+	listenerPollFD.fd = m_impl->m_platformSocket;
+	listenerPollFD.events = POLLIN;
+
+	size_t i = 0;
+	while (i < maxAcceptCount)
+	{
+		listenerPollFD.revents = 0;
+		const int result = poll(&listenerPollFD, 1, 0);
+		if (result < 0)
+		{
+			Internal_Socket::LogSocketError("poll() failed: ", errno);
+			return i;
+		}
+		if (result == 0)
+		{
+			return i;
+		}
+
+		outSockets[i++] = Accept();
+	}
+	return i;
+}
+
+void Network::Socket::Close()
+{
+	close(m_impl->m_platformSocket);
+	*m_impl = SocketImpl();
+}
+
+bool Network::Socket::TrySetNonBlocking()
+{
+	const int flags = fcntl(m_impl->m_platformSocket, F_GETFL);
+	if (flags < 0 || fcntl(m_impl->m_platformSocket, F_SETFL, flags | O_NONBLOCK) != 0)
+	{
+		Internal_Socket::LogSocketError("fcntl() failed: ", errno);
+		return false;
+	}
+	return true;
+}
+
+void Network::Socket::Send(const Collection::ArrayView<const uint8_t>& bytes)
+{
+	const Collection::ArrayView<const uint8_t> buffers[] = { bytes };
+	SendBatch({ buffers, 1 });
+}
+
+size_t Network::Socket::SendBatch(const Collection::ArrayView<const Collection::ArrayView<const uint8_t>>& buffers)
+{
+	AMP_FATAL_ASSERT(IsValid(), "Can't send from an invalid socket!");
+
+	constexpr size_t k_maxNumBuffers = 64;
+	AMP_FATAL_ASSERT(buffers.Size() <= k_maxNumBuffers, "Can't send more than [%zu] buffers at once.", k_maxNumBuffers);
+
+	iovec platformBuffers[k_maxNumBuffers];
+	for (size_t i = 0, iEnd = buffers.Size(); i < iEnd; ++i)
+	{
+		platformBuffers[i].iov_base = const_cast<uint8_t*>(buffers[i].begin());
+		platformBuffers[i].iov_len = buffers[i].Size();
+	}
+
+	// A send can be cut short by a signal or, for a non-blocking socket, by its send buffer filling up. The send is
+	// resumed from wherever it stopped until the socket would block.
+	msghdr message{};
+	message.msg_iov = platformBuffers;
+	message.msg_iovlen = buffers.Size();
+	size_t numBytesSentTotal = 0;
+	while (message.msg_iovlen > 0)
+	{
+		ssize_t numBytesSent = sendmsg(m_impl->m_platformSocket, &message, MSG_NOSIGNAL);
+		if (numBytesSent < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				break;
+			}
+			Internal_Socket::LogSocketError("sendmsg() failed: ", errno);
+			Close();
+			break;
+		}
+		numBytesSentTotal += static_cast<size_t>(numBytesSent);
+
+		while (message.msg_iovlen > 0 && static_cast<size_t>(numBytesSent) >= message.msg_iov->iov_len)
+		{
+			numBytesSent -= message.msg_iov->iov_len;
+			++message.msg_iov;
+			--message.msg_iovlen;
+		}
+		if (message.msg_iovlen > 0)
+		{
+			message.msg_iov->iov_base = static_cast<uint8_t*>(message.msg_iov->iov_base) + numBytesSent;
+			message.msg_iov->iov_len -= numBytesSent;
+		}
+	}
+	return numBytesSentTotal;
+}
+
+size_t Network::Socket::Receive(Collection::ArrayView<uint8_t>& outBytes)
+{
+	AMP_FATAL_ASSERT(IsValid(), "Can't receive on an invalid socket!");
+
+	const ssize_t numBytesReceived = recv(m_impl->m_platformSocket, outBytes.begin(), outBytes.Size(), MSG_DONTWAIT);
+	if (numBytesReceived < 0)
+	{
+		if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+		{
+			return 0;
+		}
+		Internal_Socket::LogSocketError("recv() failed: ", errno);
+		Close();
+		return 0;
+	}
+	if (numBytesReceived == 0 && outBytes.Size() > 0)
+	{
+		// The endpoint closed the connection.
+		Close();
+		return 0;
+	}
+	return static_cast<size_t>(numBytesReceived);
+}
+
+Network::Socket Network::CreateAndBindListenerSocket(const char* port)
+{
+	addrinfo* result = nullptr;
+	addrinfo hints;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+	hints.ai_flags = AI_PASSIVE;
+
+	const int errorCode = getaddrinfo(NULL, port, &hints, &result);
+	if (errorCode != 0)
+	{
+		Internal_Socket::LogAddressError("getaddrinfo() failed: ", errorCode);
+		return Socket();
+	}
+
+	// Create a listener socket.
+	const int listenerSocket = socket(result->ai_family, result->ai_socktype | SOCK_CLOEXEC, result->ai_protocol);
+	if (listenerSocket == Internal_Socket::k_invalidSocket)
+	{
+		Internal_Socket::LogSocketError("socket() failed: ", errno);
+		freeaddrinfo(result);
+		return Socket();
+	}
+
+	// Allow the port to be bound again immediately after a host restarts.
+	const int reuseAddress = 1;
+	setsockopt(listenerSocket, SOL_SOCKET, SO_REUSEADDR, &reuseAddress, sizeof(reuseAddress));
+
+	// Bind the socket.
+	if (bind(listenerSocket, result->ai_addr, result->ai_addrlen) != 0)
+	{
+		Internal_Socket::LogSocketError("bind() failed: ", errno);
+		freeaddrinfo(result);
+		close(listenerSocket);
+		return Socket();
+	}
+
+	// Free the addrinfo after it is no longer needed.
+	freeaddrinfo(result);
+
+	// Return the platform specific socket wrapped in a platform agnostic way.
+	Socket outSocket;
+	outSocket.GetImpl() = Socket::SocketImpl(listenerSocket);
+	return outSocket;
+}
+
+Network::Socket Network::CreateConnectedSocket(const char* hostName, const char* port)
+{
+	addrinfo* result = nullptr;
+	addrinfo hints;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+
+	const int errorCode = getaddrinfo(hostName, port, &hints, &result);
+	if (errorCode != 0)
+	{
+		Internal_Socket::LogAddressError("getaddrinfo() failed: ", errorCode);
+		return Socket();
+	}
+
+	// Create a socket to connect to the host.
+	addrinfo* ptr = result;
+	const int connectSocket = socket(ptr->ai_family, ptr->ai_socktype | SOCK_CLOEXEC, ptr->ai_protocol);
+	if (connectSocket == Internal_Socket::k_invalidSocket)
+	{
+		Internal_Socket::LogSocketError("socket() failed: ", errno);
+		freeaddrinfo(result);
+		return Socket();
+	}
+
+	// Connect the socket to the host.
+	if (connect(connectSocket, ptr->ai_addr, ptr->ai_addrlen) != 0)
+	{
+		Internal_Socket::LogSocketError("connect() failed: ", errno);
+		freeaddrinfo(result);
+		close(connectSocket);
+		return Socket();
+	}
+
+	// TODO(network) try to connect to all the results rather than just the first
+
+	// Free the addrinfo after it is no longer needed.
+	freeaddrinfo(result);
+
+	// Return the platform specific socket wrapped in a platform agnostic way.
+	Socket outSocket;
+	outSocket.GetImpl() = Socket::SocketImpl(connectSocket);
+	return outSocket;
+}
+
+struct Network::DatagramSocket::DatagramSocketImpl
+{
+	DatagramSocketImpl() = default;
+
+	explicit DatagramSocketImpl(int platformSocket)
+		: m_platformSocket(platformSocket)
+	{}
+
+	// POSIX socket file descriptor.
+	int m_platformSocket{ Internal_Socket::k_invalidSocket };
+};
+
+Network::DatagramSocket::DatagramSocket()
+	: m_impl(Mem::MakeUnique<DatagramSocketImpl>())
+{
+}
+
+Network::DatagramSocket::~DatagramSocket()
+{
+	if (m_impl->m_platformSocket != Internal_Socket::k_invalidSocket)
+	{
+		Close();
+	}
+}
+
+Network::DatagramSocket::DatagramSocket(DatagramSocket&& other) noexcept
+	: m_impl(std::move(other.m_impl))
+{
+	other.m_impl = Mem::MakeUnique<DatagramSocketImpl>();
+}
+
+Network::DatagramSocket& Network::DatagramSocket::operator=(DatagramSocket&& rhs) noexcept
+{
+	m_impl = std::move(rhs.m_impl);
+	rhs.m_impl = Mem::MakeUnique<DatagramSocketImpl>();
+	return *this;
+}
+
+bool Network::DatagramSocket::IsValid() const
+{
+	return m_impl->m_platformSocket != Internal_Socket::k_invalidSocket;
+}
+
+void Network::DatagramSocket::Close()
+{
+	close(m_impl->m_platformSocket);
+	*m_impl = DatagramSocketImpl();
+}
+
+void Network::DatagramSocket::SendTo(const DatagramAddress& address, const Collection::ArrayView<const uint8_t>& bytes)
+{
+	AMP_FATAL_ASSERT(IsValid(), "Can't send from an invalid socket!");
+
+	sockaddr_in platformAddress{};
+	platformAddress.sin_family = AF_INET;
+	platformAddress.sin_addr.s_addr = htonl(address.m_ipv4Address);
+	platformAddress.sin_port = htons(address.m_port);
+
+	// Datagrams may be dropped anywhere along their way, so a datagram the socket can't send is simply dropped too.
+	const ssize_t numBytesSent = sendto(m_impl->m_platformSocket, bytes.begin(), bytes.Size(), MSG_NOSIGNAL,
+		reinterpret_cast<const sockaddr*>(&platformAddress), sizeof(platformAddress));
+	if (numBytesSent < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+	{
+		Internal_Socket::LogSocketError("sendto() failed: ", errno);
+	}
+}
+
+size_t Network::DatagramSocket::ReceiveFrom(DatagramAddress& outAddress, Collection::ArrayView<uint8_t>& outBytes)
+{
+	AMP_FATAL_ASSERT(IsValid(), "Can't receive on an invalid socket!");
+
+	sockaddr_in platformAddress{};
+	socklen_t platformAddressSize = sizeof(platformAddress);
+	const ssize_t numBytesReceived = recvfrom(m_impl->m_platformSocket, outBytes.begin(), outBytes.Size(),
+		MSG_DONTWAIT, reinterpret_cast<sockaddr*>(&platformAddress), &platformAddressSize);
+	if (numBytesReceived < 0)
+	{
+		// Errors caused by earlier datagrams, such as a peer's port being unreachable, don't affect this socket.
+		if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNREFUSED)
+		{
+			Internal_Socket::LogSocketError("recvfrom() failed: ", errno);
+		}
+		return 0;
+	}
+
+	outAddress.m_ipv4Address = ntohl(platformAddress.sin_addr.s_addr);
+	outAddress.m_port = ntohs(platformAddress.sin_port);
+	return static_cast<size_t>(numBytesReceived);
+}
+
+Network::DatagramSocket Network::CreateBoundDatagramSocket(const char* port)
+{
+	addrinfo* result = nullptr;
+	addrinfo hints;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+	hints.ai_protocol = IPPROTO_UDP;
+	hints.ai_flags = AI_PASSIVE;
+
+	const int errorCode = getaddrinfo(NULL, port, &hints, &result);
+	if (errorCode != 0)
+	{
+		Internal_Socket::LogAddressError("getaddrinfo() failed: ", errorCode);
+		return DatagramSocket();
+	}
+
+	const int datagramSocket = socket(result->ai_family, result->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+		result->ai_protocol);
+	if (datagramSocket == Internal_Socket::k_invalidSocket)
+	{
+		Internal_Socket::LogSocketError("socket() failed: ", errno);
+		freeaddrinfo(result);
+		return DatagramSocket();
+	}
+
+	if (bind(datagramSocket, result->ai_addr, result->ai_addrlen) != 0)
+	{
+		Internal_Socket::LogSocketError("bind() failed: ", errno);
+		freeaddrinfo(result);
+		close(datagramSocket);
+		return DatagramSocket();
+	}
+
+	freeaddrinfo(result);
+
+	DatagramSocket outSocket;
+	outSocket.GetImpl() = DatagramSocket::DatagramSocketImpl(datagramSocket);
+	return outSocket;
+}
+
+bool Network::TryResolveDatagramAddress(const char* hostName, const char* port, DatagramAddress& outAddress)
+{
+	addrinfo* result = nullptr;
+	addrinfo hints;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+	hints.ai_protocol = IPPROTO_UDP;
+
+	const int errorCode = getaddrinfo(hostName, port, &hints, &result);
+	if (errorCode != 0)
+	{
+		Internal_Socket::LogAddressError("getaddrinfo() failed: ", errorCode);
+		return false;
+	}
+
+	const sockaddr_in* const platformAddress = reinterpret_cast<const sockaddr_in*>(result->ai_addr);
+	outAddress.m_ipv4Address = ntohl(platformAddress->sin_addr.s_addr);
+	outAddress.m_port = ntohs(platformAddress->sin_port);
+
+	freeaddrinfo(result);
+	return true;
+}
+
+namespace Internal_Socket
+{
+// The most events a single call to epoll_wait() reports.
+constexpr size_t k_maxNumPollerEvents = 64;
+// The events every socket is polled for. Sockets waiting to send are also polled for EPOLLOUT.
+constexpr uint32_t k_receiveEvents = EPOLLIN | EPOLLRDHUP;
+}
+
+struct Network::SocketPoller::PollerImpl
+{
+	int m_epoll{ Internal_Socket::k_invalidSocket };
+	// An eventfd which is written to by Wake() to interrupt epoll_wait().
+	int m_wakeEvent{ Internal_Socket::k_invalidSocket };
+};
+
+Network::SocketPoller::SocketPoller()
+	: m_impl(Mem::MakeUnique<PollerImpl>())
+{
+	m_impl->m_epoll = epoll_create1(EPOLL_CLOEXEC);
+	m_impl->m_wakeEvent = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	AMP_FATAL_ASSERT(m_impl->m_epoll != Internal_Socket::k_invalidSocket
+		&& m_impl->m_wakeEvent != Internal_Socket::k_invalidSocket,
+		"Failed to create a SocketPoller: %s", strerror(errno));
+
+	epoll_event wakeEvent{};
+	wakeEvent.events = EPOLLIN;
+	wakeEvent.data.u64 = k_invalidKey;
+	epoll_ctl(m_impl->m_epoll, EPOLL_CTL_ADD, m_impl->m_wakeEvent, &wakeEvent);
+}
+
+Network::SocketPoller::~SocketPoller()
+{
+	close(m_impl->m_wakeEvent);
+	close(m_impl->m_epoll);
+}
+
+namespace Internal_Socket
+{
+bool TryAddToPoller(const int epoll, const int platformSocket, const uint64_t key)
+{
+	// Sockets are level triggered so that a socket which isn't fully drained is reported again.
+	epoll_event socketEvent{};
+	socketEvent.events = k_receiveEvents;
+	socketEvent.data.u64 = key;
+	if (epoll_ctl(epoll, EPOLL_CTL_ADD, platformSocket, &socketEvent) != 0)
+	{
+		LogSocketError("epoll_ctl() failed: ", errno);
+		return false;
+	}
+	return true;
+}
+}
+
+bool Network::SocketPoller::TryAdd(Socket& socket, const uint64_t key)
+{
+	AMP_FATAL_ASSERT(key != k_invalidKey, "SocketPoller keys can't be k_invalidKey.");
+	return socket.IsValid()
+		&& Internal_Socket::TryAddToPoller(m_impl->m_epoll, socket.GetImpl().m_platformSocket, key);
+}
+
+bool Network::SocketPoller::TryAdd(DatagramSocket& socket, const uint64_t key)
+{
+	AMP_FATAL_ASSERT(key != k_invalidKey, "SocketPoller keys can't be k_invalidKey.");
+	return socket.IsValid()
+		&& Internal_Socket::TryAddToPoller(m_impl->m_epoll, socket.GetImpl().m_platformSocket, key);
+}
+
+void Network::SocketPoller::Remove(Socket& socket)
+{
+	if (socket.IsValid())
+	{
+		epoll_ctl(m_impl->m_epoll, EPOLL_CTL_DEL, socket.GetImpl().m_platformSocket, nullptr);
+	}
+}
+
+void Network::SocketPoller::Remove(DatagramSocket& socket)
+{
+	if (socket.IsValid())
+	{
+		epoll_ctl(m_impl->m_epoll, EPOLL_CTL_DEL, socket.GetImpl().m_platformSocket, nullptr);
+	}
+}
+
+void Network::SocketPoller::SetWaitForSend(Socket& socket, const uint64_t key, const bool isWaitingForSend)
+{
+	using namespace Internal_Socket;
+
+	AMP_FATAL_ASSERT(key != k_invalidKey, "SocketPoller keys can't be k_invalidKey.");
+	if (!socket.IsValid())
+	{
+		return;
+	}
+
+	epoll_event socketEvent{};
+	socketEvent.events = isWaitingForSend ? (k_receiveEvents | EPOLLOUT) : k_receiveEvents;
+	socketEvent.data.u64 = key;
+	if (epoll_ctl(m_impl->m_epoll, EPOLL_CTL_MOD, socket.GetImpl().m_platformSocket, &socketEvent) != 0)
+	{
+		LogSocketError("epoll_ctl() failed: ", errno);
+	}
+}
+
+size_t Network::SocketPoller::Wait(const Unit::Time::Millisecond timeout, uint64_t* outKeys, const size_t maxNumKeys)
+{
+	using namespace Internal_Socket;
+
+	// One extra event is reserved for the wake event.
+	epoll_event events[k_maxNumPollerEvents];
+	const size_t maxNumEvents = (maxNumKeys + 1 < k_maxNumPollerEvents) ? (maxNumKeys + 1) : k_maxNumPollerEvents;
+	const int timeoutMs = (timeout.GetN() < INT_MAX) ? static_cast<int>(timeout.GetN()) : INT_MAX;
+
+	const int numEvents = epoll_wait(m_impl->m_epoll, events, static_cast<int>(maxNumEvents), timeoutMs);
+	if (numEvents < 0)
+	{
+		if (errno != EINTR)
+		{
+			LogSocketError("epoll_wait() failed: ", errno);
+		}
+		return 0;
+	}
+
+	size_t numKeys = 0;
+	for (int i = 0; i < numEvents; ++i)
+	{
+		if (events[i].data.u64 == k_invalidKey)
+		{
+			// Reset the wake event so that it doesn't wake the next wait.
+			uint64_t numWakes;
+			while (read(m_impl->m_wakeEvent, &numWakes, sizeof(numWakes)) > 0);
+			continue;
+		}
+		if (numKeys < maxNumKeys)
+		{
+			outKeys[numKeys++] = events[i].data.u64;
+		}
+	}
+	return numKeys;
+}
+
+void Network::SocketPoller::Wake()
+{
+	const uint64_t one = 1;
+	[[maybe_unused]] const ssize_t result = write(m_impl->m_wakeEvent, &one, sizeof(one));
+}
+
+#endif
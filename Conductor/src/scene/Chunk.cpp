@@ -3,16 +3,18 @@
 #include <ecs/Entity.h>
 #include <ecs/EntityManager.h>
 #include <ecs/SerializedEntitiesAndComponents.h>
-#include <file/FullFileReader.h>
+#include <scene/ChunkStore.h>
+#include <scene/OutOfPlayChunkSimulation.h>
 
 void Scene::SaveInPlayChunk(const ChunkID chunkID,
 	const ECS::EntityManager& entityManager,
-	const Collection::Vector<const ECS::Entity*>& rootEntitiesInChunk,
-	std::ofstream& fileOutput)
+	const Collection::ArrayView<const ECS::Entity* const>& rootEntitiesInChunk,
+	ChunkStore& chunkStore,
+	OutOfPlayChunkSimulation* const outOfPlayChunks)
 {
 	// Gather all the entites in the hierarchy of root entities.
 	Collection::Vector<const ECS::Entity*> entitiesToSerialize;
-	entitiesToSerialize.AddAll(rootEntitiesInChunk.GetConstView());
+	entitiesToSerialize.AddAll(rootEntitiesInChunk);
 
 	for (size_t i = 0; i < entitiesToSerialize.Size(); ++i)
 	{
@@ -25,32 +27,21 @@ void Scene::SaveInPlayChunk(const ChunkID chunkID,
 	ECS::SerializedEntitiesAndComponents serialization;
 	entityManager.FullySerializeEntitiesAndComponents(entitiesToSerialize.GetView(), serialization);
 
-	// Write the serialization to the file.
-	ECS::WriteSerializedEntitiesAndComponentsTo(serialization, fileOutput);
-}
-
-ECS::SerializedEntitiesAndComponents Scene::LoadChunkForPlay(const File::Path& sourcePath,
-	const File::Path& userPath,
-	const std::string& chunkFileName)
-{
-	// If the chunk exists at the user path, load it. Otherwise load it from the source path.
-	std::string rawChunk = File::ReadFullTextFile(userPath / chunkFileName);
-	if (rawChunk.empty())
+	// Only the serialization happens here; the chunk store writes it to disk on its writer thread. A chunk which stays
+	// resident out of play, so that it can be simulated and quickly brought back into play, needs its own copy.
+	if (outOfPlayChunks == nullptr)
 	{
-		rawChunk = File::ReadFullTextFile(sourcePath / chunkFileName);
-		if (rawChunk.empty())
-		{
-			return ECS::SerializedEntitiesAndComponents();
-		}
+		chunkStore.QueueChunkSave(chunkID, std::move(serialization));
+		return;
 	}
+	chunkStore.QueueChunkSave(chunkID, ECS::SerializedEntitiesAndComponents(serialization));
+	outOfPlayChunks->AddChunk(chunkID, std::move(serialization));
+}
 
-	const uint8_t* const bytes = reinterpret_cast<const uint8_t*>(rawChunk.data());
-
+ECS::SerializedEntitiesAndComponents Scene::LoadChunkForPlay(ChunkStore& chunkStore, const ChunkID chunkID)
+{
 	ECS::SerializedEntitiesAndComponents serialization;
-	if (!ECS::TryReadSerializedEntitiesAndComponentsFrom({ bytes, rawChunk.size() }, serialization))
-	{
-		serialization = ECS::SerializedEntitiesAndComponents();
-	}
+	chunkStore.TryLoadChunk(chunkID, serialization);
 	return serialization;
 }
 
@@ -62,6 +53,14 @@ Math::Vector3 Scene::CalcChunkOrigin(const ChunkID chunkID)
 		static_cast<float>(chunkID.GetZ())) * k_chunkSideLengthMeters;
 }
 
+Scene::ChunkID Scene::CalcChunkID(const Math::Vector3& position)
+{
+	return ChunkID(
+		static_cast<int16_t>(static_cast<int32_t>(position.x) >> k_lgChunkSideLength),
+		static_cast<int16_t>(static_cast<int32_t>(position.y) >> k_lgChunkSideLength),
+		static_cast<int16_t>(static_cast<int32_t>(position.z) >> k_lgChunkSideLength));
+}
+
 void Scene::CalcChunkCoords(const ChunkID chunkID,
 	Math::Vector3& outOrigin, Math::Vector3& outCenter, Math::Vector3& outMax)
 {
@@ -0,0 +1,329 @@
+#include <scene/ChunkRegionFile.h>
+
+#include <collection/Vector.h>
+#include <ecs/SerializedEntitiesAndComponents.h>
+#include <file/FileSync.h>
+#include <mem/DeserializeLittleEndian.h>
+#include <mem/SerializeLittleEndian.h>
+
+#include <cstring>
+#include <fstream>
+#include <system_error>
+
+namespace Internal_ChunkRegionFile
+{
+using namespace Scene;
+
+struct CRCTable
+{
+	uint32_t m_entries[256];
+
+	CRCTable()
+	{
+		// The reflected polynomial of CRC-32, as used by zlib.
+		constexpr uint32_t k_polynomial = 0xEDB88320;
+		for (uint32_t i = 0; i < 256; ++i)
+		{
+			uint32_t entry = i;
+			for (size_t bit = 0; bit < 8; ++bit)
+			{
+				entry = (entry & 1) ? ((entry >> 1) ^ k_polynomial) : (entry >> 1);
+			}
+			m_entries[i] = entry;
+		}
+	}
+};
+
+const CRCTable& GetCRCTable()
+{
+	static const CRCTable crcTable;
+	return crcTable;
+}
+
+void SerializeEmptyRegion(Collection::Vector<uint8_t>& outBytes)
+{
+	Mem::LittleEndian::Serialize(ChunkRegionFile::k_magic, outBytes);
+	Mem::LittleEndian::Serialize(ChunkRegionFile::k_version, outBytes);
+	outBytes.Resize(static_cast<uint32_t>(ChunkRegionFile::k_dataOffset), 0);
+}
+
+void SerializeIndexEntry(const ChunkRegionIndexEntry& entry, Collection::Vector<uint8_t>& outBytes)
+{
+	Mem::LittleEndian::Serialize(entry.m_offset, outBytes);
+	Mem::LittleEndian::Serialize(entry.m_size, outBytes);
+	Mem::LittleEndian::Serialize(entry.m_checksum, outBytes);
+}
+
+bool IsValidHeader(const uint8_t* headerBytes)
+{
+	const uint8_t* iter = headerBytes;
+	const uint8_t* const iterEnd = headerBytes + ChunkRegionFile::k_headerSize;
+	const auto maybeMagic = Mem::LittleEndian::DeserializeUi32(iter, iterEnd);
+	const auto maybeVersion = Mem::LittleEndian::DeserializeUi32(iter, iterEnd);
+	return maybeMagic.first == ChunkRegionFile::k_magic && maybeVersion.first == ChunkRegionFile::k_version;
+}
+
+bool IsValidRegion(const Collection::ArrayView<const uint8_t>& regionBytes)
+{
+	return regionBytes.Size() >= ChunkRegionFile::k_dataOffset && IsValidHeader(regionBytes.begin());
+}
+
+// Read an entry from the index of a valid region. Entries which point outside of the region are read as empty.
+ChunkRegionIndexEntry ReadIndexEntry(const Collection::ArrayView<const uint8_t>& regionBytes, const uint32_t index)
+{
+	const uint8_t* iter = regionBytes.begin() + ChunkRegionFile::k_indexOffset
+		+ (index * ChunkRegionIndexEntry::k_unpaddedSize);
+	const uint8_t* const iterEnd = iter + ChunkRegionIndexEntry::k_unpaddedSize;
+
+	ChunkRegionIndexEntry entry;
+	entry.m_offset = Mem::LittleEndian::DeserializeUi64(iter, iterEnd).first;
+	entry.m_size = Mem::LittleEndian::DeserializeUi32(iter, iterEnd).first;
+	entry.m_checksum = Mem::LittleEndian::DeserializeUi32(iter, iterEnd).first;
+
+	if (entry.m_offset < ChunkRegionFile::k_dataOffset || entry.m_offset > regionBytes.Size()
+		|| entry.m_size > regionBytes.Size() - entry.m_offset)
+	{
+		entry = ChunkRegionIndexEntry();
+	}
+	return entry;
+}
+}
+
+Scene::ChunkID Scene::CalcChunkRegionID(const ChunkID chunkID)
+{
+	return ChunkID(
+		static_cast<int16_t>(chunkID.GetX() >> k_lgChunkRegionSideLength),
+		static_cast<int16_t>(chunkID.GetY() >> k_lgChunkRegionSideLength),
+		static_cast<int16_t>(chunkID.GetZ() >> k_lgChunkRegionSideLength));
+}
+
+uint32_t Scene::CalcChunkIndexInRegion(const ChunkID chunkID)
+{
+	constexpr uint32_t k_mask = k_chunkRegionSideLength - 1;
+	const uint32_t x = static_cast<uint32_t>(chunkID.GetX()) & k_mask;
+	const uint32_t y = static_cast<uint32_t>(chunkID.GetY()) & k_mask;
+	const uint32_t z = static_cast<uint32_t>(chunkID.GetZ()) & k_mask;
+	return (((z << k_lgChunkRegionSideLength) + y) << k_lgChunkRegionSideLength) + x;
+}
+
+std::string Scene::MakeChunkRegionFileName(const ChunkID regionID)
+{
+	return '(' + std::to_string(regionID.GetX()) + ")(" + std::to_string(regionID.GetY())
+		+ ")(" + std::to_string(regionID.GetZ()) + ").region";
+}
+
+uint32_t Scene::CalcChunkChecksum(const uint8_t* bytes, const size_t numBytes, const uint32_t checksum)
+{
+	const Internal_ChunkRegionFile::CRCTable& crcTable = Internal_ChunkRegionFile::GetCRCTable();
+
+	uint32_t crc = ~checksum;
+	for (size_t i = 0; i < numBytes; ++i)
+	{
+		crc = crcTable.m_entries[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+bool Scene::ChunkRegionFile::TryOpen(const File::Path& path)
+{
+	if (!m_mappedFile.TryOpen(path))
+	{
+		return false;
+	}
+	if (!Internal_ChunkRegionFile::IsValidRegion(m_mappedFile.GetBytes()))
+	{
+		AMP_LOG_WARNING("\"%s\" is not a valid chunk region file.", path.u8string().c_str());
+		m_mappedFile.Close();
+		return false;
+	}
+	return true;
+}
+
+bool Scene::ChunkRegionFile::TryFindChunkBytes(
+	const ChunkID chunkID,
+	Collection::ArrayView<const uint8_t>& outBytes) const
+{
+	if (!m_mappedFile.IsOpen())
+	{
+		return false;
+	}
+
+	const Collection::ArrayView<const uint8_t> regionBytes = m_mappedFile.GetBytes();
+	const ChunkRegionIndexEntry entry =
+		Internal_ChunkRegionFile::ReadIndexEntry(regionBytes, CalcChunkIndexInRegion(chunkID));
+	if (entry.m_offset == 0)
+	{
+		return false;
+	}
+
+	const uint8_t* const chunkBytes = regionBytes.begin() + entry.m_offset;
+	if (CalcChunkChecksum(chunkBytes, entry.m_size) != entry.m_checksum)
+	{
+		AMP_LOG_WARNING("Chunk (%d)(%d)(%d) doesn't match its checksum.",
+			chunkID.GetX(), chunkID.GetY(), chunkID.GetZ());
+		return false;
+	}
+
+	outBytes = { chunkBytes, entry.m_size };
+	return true;
+}
+
+bool Scene::TryWriteChunksToRegionFile(const File::Path& path, const Collection::ArrayView<const ChunkToWrite>& chunks)
+{
+	using namespace Internal_ChunkRegionFile;
+
+	// Open the region file, creating it if there isn't a valid region file at the path.
+	std::fstream file{ path, std::ios_base::in | std::ios_base::out | std::ios_base::binary };
+	if (file.is_open())
+	{
+		uint8_t headerBytes[ChunkRegionFile::k_headerSize];
+		file.read(reinterpret_cast<char*>(headerBytes), sizeof(headerBytes));
+		file.seekg(0, std::ios_base::end);
+
+		const bool isValid = file.good()
+			&& static_cast<uint64_t>(file.tellg()) >= ChunkRegionFile::k_dataOffset
+			&& IsValidHeader(headerBytes);
+		if (!isValid)
+		{
+			AMP_LOG_WARNING("Replacing invalid chunk region file \"%s\".", path.u8string().c_str());
+			file.close();
+		}
+	}
+	if (!file.is_open())
+	{
+		file.open(path, std::ios_base::in | std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+		if (!file.is_open())
+		{
+			return false;
+		}
+
+		Collection::Vector<uint8_t> emptyRegionBytes;
+		SerializeEmptyRegion(emptyRegionBytes);
+		file.write(reinterpret_cast<const char*>(emptyRegionBytes.begin()), emptyRegionBytes.Size());
+	}
+
+	// Append the chunks to the file.
+	file.seekp(0, std::ios_base::end);
+
+	Collection::Vector<ChunkRegionIndexEntry> entries{ static_cast<uint32_t>(chunks.Size()) };
+	for (const auto& chunk : chunks)
+	{
+		ChunkRegionIndexEntry& entry = entries.Emplace();
+		entry.m_offset = static_cast<uint64_t>(file.tellp());
+		entry.m_checksum = 0;
+
+		uint64_t size = 0;
+		ECS::WriteSerializedEntitiesAndComponentsTo(*chunk.m_serialization,
+			[&](const void* data, size_t length)
+			{
+				file.write(reinterpret_cast<const char*>(data), length);
+				entry.m_checksum = CalcChunkChecksum(static_cast<const uint8_t*>(data), length, entry.m_checksum);
+				size += length;
+			});
+
+		if (size > UINT32_MAX)
+		{
+			return false;
+		}
+		entry.m_size = static_cast<uint32_t>(size);
+	}
+	file.flush();
+
+	// Point the index entries at the chunks only once the chunks are on disk, so that a save which is interrupted
+	// leaves the previous versions of the chunks in place.
+	if (!file.good() || !File::TrySyncFile(path))
+	{
+		return false;
+	}
+
+	Collection::Vector<uint8_t> entryBytes;
+	for (size_t i = 0, iEnd = chunks.Size(); i < iEnd; ++i)
+	{
+		entryBytes.Clear();
+		SerializeIndexEntry(entries[i], entryBytes);
+
+		file.seekp(ChunkRegionFile::k_indexOffset
+			+ (CalcChunkIndexInRegion(chunks[i].m_chunkID) * ChunkRegionIndexEntry::k_unpaddedSize));
+		file.write(reinterpret_cast<const char*>(entryBytes.begin()), entryBytes.Size());
+	}
+	file.flush();
+
+	return file.good() && File::TrySyncFile(path);
+}
+
+bool Scene::TryCompactRegionFile(const File::Path& path)
+{
+	using namespace Internal_ChunkRegionFile;
+
+	Collection::Vector<uint8_t> compactedBytes;
+	{
+		File::MappedFile mappedFile;
+		if (!mappedFile.TryOpen(path) || !IsValidRegion(mappedFile.GetBytes()))
+		{
+			return true;
+		}
+		const Collection::ArrayView<const uint8_t> regionBytes = mappedFile.GetBytes();
+
+		ChunkRegionIndexEntry entries[k_numChunksPerRegion];
+		uint64_t numUsedBytes = 0;
+		for (uint32_t i = 0; i < k_numChunksPerRegion; ++i)
+		{
+			entries[i] = ReadIndexEntry(regionBytes, i);
+			numUsedBytes += entries[i].m_size;
+		}
+
+		const uint64_t numUnusedBytes = regionBytes.Size() - ChunkRegionFile::k_dataOffset - numUsedBytes;
+		if (numUnusedBytes <= numUsedBytes)
+		{
+			return true;
+		}
+
+		// Copy the current version of each chunk into a new region, packing the chunks in index order.
+		compactedBytes.EnsureCapacity(static_cast<uint32_t>(ChunkRegionFile::k_dataOffset + numUsedBytes));
+		SerializeEmptyRegion(compactedBytes);
+
+		Collection::Vector<uint8_t> entryBytes;
+		for (uint32_t i = 0; i < k_numChunksPerRegion; ++i)
+		{
+			ChunkRegionIndexEntry& entry = entries[i];
+			if (entry.m_offset == 0)
+			{
+				continue;
+			}
+
+			const uint64_t compactedOffset = compactedBytes.Size();
+			compactedBytes.AddAll({ regionBytes.begin() + entry.m_offset, entry.m_size });
+			entry.m_offset = compactedOffset;
+
+			entryBytes.Clear();
+			SerializeIndexEntry(entry, entryBytes);
+			memcpy(&compactedBytes[ChunkRegionFile::k_indexOffset + (i * ChunkRegionIndexEntry::k_unpaddedSize)],
+				entryBytes.begin(), ChunkRegionIndexEntry::k_unpaddedSize);
+		}
+	}
+
+	// Write the compacted region next to the region file and then replace the region file with it, so that the region
+	// file is never partially written.
+	File::Path compactedPath = path;
+	compactedPath += ".compact";
+	{
+		std::ofstream fileOutput{ compactedPath, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc };
+		fileOutput.write(reinterpret_cast<const char*>(compactedBytes.begin()), compactedBytes.Size());
+		fileOutput.flush();
+		if (!fileOutput.good() || !File::TrySyncFile(compactedPath))
+		{
+			AMP_LOG_WARNING("Failed to write \"%s\".", compactedPath.u8string().c_str());
+			return false;
+		}
+	}
+
+	std::error_code errorCode;
+	File::FileSystem::rename(compactedPath, path, errorCode);
+	if (errorCode)
+	{
+		AMP_LOG_WARNING("Failed to replace \"%s\": %s", path.u8string().c_str(), errorCode.message().c_str());
+		File::FileSystem::remove(compactedPath, errorCode);
+		return false;
+	}
+	return true;
+}
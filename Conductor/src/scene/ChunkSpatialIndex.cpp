@@ -0,0 +1,217 @@
+#include <scene/ChunkSpatialIndex.h>
+
+#include <scene/Chunk.h>
+
+#include <algorithm>
+
+namespace Internal_ChunkSpatialIndex
+{
+// Chunks are keyed by their coordinates so that the extra bits of their IDs don't affect which bucket they're in.
+uint64_t MakeChunkKey(const Scene::ChunkID chunkID)
+{
+	return static_cast<uint64_t>(static_cast<uint16_t>(chunkID.GetX()))
+		| (static_cast<uint64_t>(static_cast<uint16_t>(chunkID.GetY())) << 16)
+		| (static_cast<uint64_t>(static_cast<uint16_t>(chunkID.GetZ())) << 32);
+}
+
+int16_t ClampToChunkCoordinate(const int32_t coordinate)
+{
+	return static_cast<int16_t>(std::min<int32_t>(std::max<int32_t>(coordinate, INT16_MIN), INT16_MAX));
+}
+}
+
+namespace Scene
+{
+bool ChunkSpatialIndex::Place(const ECS::EntityID entityID, const ChunkID chunkID)
+{
+	const uint32_t placementIndex = m_placementIndicesByEntity.Find(entityID.GetUniqueID());
+	if (placementIndex != Collection::SparseIndexMap::k_invalidIndex)
+	{
+		Placement& placement = m_placements[placementIndex];
+		if (placement.m_chunkID == chunkID)
+		{
+			return false;
+		}
+
+		RemoveFromBucket(placement);
+		placement.m_chunkID = chunkID;
+		placement.m_indexInBucket = AddToBucket(entityID, chunkID);
+		return true;
+	}
+
+	m_placementIndicesByEntity.Set(entityID.GetUniqueID(), m_placements.Size());
+	m_placements.Add({ entityID, chunkID, AddToBucket(entityID, chunkID) });
+	return true;
+}
+
+void ChunkSpatialIndex::Remove(const ECS::EntityID entityID)
+{
+	const uint32_t placementIndex = m_placementIndicesByEntity.Find(entityID.GetUniqueID());
+	if (placementIndex == Collection::SparseIndexMap::k_invalidIndex)
+	{
+		return;
+	}
+
+	RemoveFromBucket(m_placements[placementIndex]);
+
+	// Move the last placement into the removed placement's place.
+	const uint32_t lastPlacementIndex = m_placements.Size() - 1;
+	if (placementIndex != lastPlacementIndex)
+	{
+		m_placementIndicesByEntity.Set(m_placements[lastPlacementIndex].m_entityID.GetUniqueID(), placementIndex);
+	}
+	m_placements.SwapWithAndRemoveLast(placementIndex);
+	m_placementIndicesByEntity.Remove(entityID.GetUniqueID());
+}
+
+void ChunkSpatialIndex::Clear()
+{
+	m_buckets.Clear();
+	m_bucketIndicesByChunk.Clear();
+	m_placements.Clear();
+	m_placementIndicesByEntity.Clear();
+}
+
+ChunkID ChunkSpatialIndex::FindChunkOf(const ECS::EntityID entityID) const
+{
+	const uint32_t placementIndex = m_placementIndicesByEntity.Find(entityID.GetUniqueID());
+	return (placementIndex != Collection::SparseIndexMap::k_invalidIndex)
+		? m_placements[placementIndex].m_chunkID
+		: ChunkID();
+}
+
+Collection::ArrayView<const ECS::EntityID> ChunkSpatialIndex::GetEntitiesInChunk(const ChunkID chunkID) const
+{
+	const uint32_t bucketIndex = m_bucketIndicesByChunk.Find(Internal_ChunkSpatialIndex::MakeChunkKey(chunkID));
+	if (bucketIndex == Collection::FlatIndexMap::k_invalidIndex)
+	{
+		return { nullptr, 0 };
+	}
+	return m_buckets[bucketIndex].m_entityIDs.GetConstView();
+}
+
+void ChunkSpatialIndex::FindEntitiesInChunkRadius(const ChunkID centerChunkID,
+	const int16_t radiusInChunks,
+	Collection::Vector<ECS::EntityID>& outEntityIDs) const
+{
+	using namespace Internal_ChunkSpatialIndex;
+
+	const float radiusInMeters = static_cast<float>(radiusInChunks) * k_chunkSideLengthMeters;
+	const float radiusSquared = radiusInMeters * radiusInMeters;
+	const Math::Vector3 centerChunkOrigin = CalcChunkOrigin(centerChunkID);
+
+	const ChunkID minChunkID{
+		ClampToChunkCoordinate(centerChunkID.GetX() - radiusInChunks),
+		ClampToChunkCoordinate(centerChunkID.GetY() - radiusInChunks),
+		ClampToChunkCoordinate(centerChunkID.GetZ() - radiusInChunks) };
+	const ChunkID maxChunkID{
+		ClampToChunkCoordinate(centerChunkID.GetX() + radiusInChunks),
+		ClampToChunkCoordinate(centerChunkID.GetY() + radiusInChunks),
+		ClampToChunkCoordinate(centerChunkID.GetZ() + radiusInChunks) };
+
+	FindEntitiesInMatchingBuckets(minChunkID, maxChunkID, [&](const ChunkID& chunkID)
+		{
+			return (CalcChunkOrigin(chunkID) - centerChunkOrigin).LengthSquared() <= radiusSquared;
+		}, outEntityIDs);
+}
+
+uint32_t ChunkSpatialIndex::AddToBucket(const ECS::EntityID entityID, const ChunkID chunkID)
+{
+	const uint64_t chunkKey = Internal_ChunkSpatialIndex::MakeChunkKey(chunkID);
+
+	uint32_t bucketIndex = m_bucketIndicesByChunk.Find(chunkKey);
+	if (bucketIndex == Collection::FlatIndexMap::k_invalidIndex)
+	{
+		bucketIndex = m_buckets.Size();
+		m_buckets.Emplace().m_chunkID = chunkID;
+		m_bucketIndicesByChunk.Set(chunkKey, bucketIndex);
+	}
+
+	Bucket& bucket = m_buckets[bucketIndex];
+	bucket.m_entityIDs.Add(entityID);
+	return bucket.m_entityIDs.Size() - 1;
+}
+
+void ChunkSpatialIndex::RemoveFromBucket(const Placement& placement)
+{
+	const uint64_t chunkKey = Internal_ChunkSpatialIndex::MakeChunkKey(placement.m_chunkID);
+	const uint32_t bucketIndex = m_bucketIndicesByChunk.Find(chunkKey);
+	AMP_FATAL_ASSERT(bucketIndex != Collection::FlatIndexMap::k_invalidIndex,
+		"Every placed entity must be in the bucket of its chunk.");
+
+	// Move the last entity of the bucket into the removed entity's place.
+	Bucket& bucket = m_buckets[bucketIndex];
+	const ECS::EntityID lastEntityID = bucket.m_entityIDs.Back();
+	bucket.m_entityIDs.SwapWithAndRemoveLast(placement.m_indexInBucket);
+	if (lastEntityID != placement.m_entityID)
+	{
+		const uint32_t lastPlacementIndex = m_placementIndicesByEntity.Find(lastEntityID.GetUniqueID());
+		m_placements[lastPlacementIndex].m_indexInBucket = placement.m_indexInBucket;
+	}
+
+	// Remove the bucket if it's empty, moving the last bucket into its place.
+	if (bucket.m_entityIDs.IsEmpty())
+	{
+		m_bucketIndicesByChunk.Remove(chunkKey);
+
+		const uint32_t lastBucketIndex = m_buckets.Size() - 1;
+		if (bucketIndex != lastBucketIndex)
+		{
+			m_bucketIndicesByChunk.Set(
+				Internal_ChunkSpatialIndex::MakeChunkKey(m_buckets[lastBucketIndex].m_chunkID), bucketIndex);
+		}
+		m_buckets.SwapWithAndRemoveLast(bucketIndex);
+	}
+}
+
+template <typename Predicate>
+void ChunkSpatialIndex::FindEntitiesInMatchingBuckets(const ChunkID minChunkID,
+	const ChunkID maxChunkID,
+	Predicate&& predicate,
+	Collection::Vector<ECS::EntityID>& outEntityIDs) const
+{
+	const int32_t xMin = minChunkID.GetX();
+	const int32_t yMin = minChunkID.GetY();
+	const int32_t zMin = minChunkID.GetZ();
+	const int32_t xMax = maxChunkID.GetX();
+	const int32_t yMax = maxChunkID.GetY();
+	const int32_t zMax = maxChunkID.GetZ();
+	if (xMax < xMin || yMax < yMin || zMax < zMin)
+	{
+		return;
+	}
+
+	// When the box has more chunks than there are buckets, it's faster to test each bucket than each chunk in the box.
+	const uint64_t numChunksInBox = static_cast<uint64_t>(xMax - xMin + 1)
+		* static_cast<uint64_t>(yMax - yMin + 1) * static_cast<uint64_t>(zMax - zMin + 1);
+	if (numChunksInBox > m_buckets.Size())
+	{
+		for (const auto& bucket : m_buckets)
+		{
+			const ChunkID chunkID = bucket.m_chunkID;
+			if (chunkID.GetX() >= xMin && chunkID.GetY() >= yMin && chunkID.GetZ() >= zMin
+				&& chunkID.GetX() <= xMax && chunkID.GetY() <= yMax && chunkID.GetZ() <= zMax
+				&& predicate(chunkID))
+			{
+				outEntityIDs.AddAll(bucket.m_entityIDs.GetConstView());
+			}
+		}
+		return;
+	}
+
+	for (int32_t z = zMin; z <= zMax; ++z)
+	{
+		for (int32_t y = yMin; y <= yMax; ++y)
+		{
+			for (int32_t x = xMin; x <= xMax; ++x)
+			{
+				const ChunkID chunkID{ static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z) };
+				if (predicate(chunkID))
+				{
+					outEntityIDs.AddAll(GetEntitiesInChunk(chunkID));
+				}
+			}
+		}
+	}
+}
+}
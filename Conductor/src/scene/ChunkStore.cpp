@@ -0,0 +1,264 @@
+#include <scene/ChunkStore.h>
+
+#include <ecs/SerializedEntitiesAndComponents.h>
+#include <file/MappedFile.h>
+#include <scene/ChunkRegionFile.h>
+
+#include <algorithm>
+
+namespace Internal_ChunkStore
+{
+std::string MakeChunkFileName(const Scene::ChunkID& chunkID)
+{
+	return '(' + std::to_string(chunkID.GetX()) + ")(" + std::to_string(chunkID.GetY())
+		+ ")(" + std::to_string(chunkID.GetZ()) + ").chunk";
+}
+}
+
+namespace Scene
+{
+ChunkStore::ChunkStore(const File::Path& sourcePath, const File::Path& userPath)
+	: m_sourcePath(sourcePath)
+	, m_userPath(userPath)
+	, m_queuedSaves()
+	, m_savesInProgress()
+	, m_savedRegionIDs()
+	, m_mappedRegions()
+{
+	m_writerThread = std::thread(&ChunkStore::WriterThreadFunction, this);
+}
+
+ChunkStore::~ChunkStore()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_saveMutex };
+		m_isShuttingDown = true;
+	}
+	m_saveCondition.notify_all();
+	m_writerThread.join();
+}
+
+bool ChunkStore::TryLoadChunk(const ChunkID chunkID, ECS::SerializedEntitiesAndComponents& outSerialization)
+{
+	// If the chunk is waiting to be saved, load its queued serialization. Otherwise, if the chunk has been saved to the
+	// user path, load it from there. Otherwise load it from the source path.
+	return TryLoadQueuedChunk(chunkID, outSerialization)
+		|| TryLoadChunkFromRegion(chunkID, true, outSerialization)
+		|| TryLoadChunkFromChunkFile(m_userPath, chunkID, outSerialization)
+		|| TryLoadChunkFromRegion(chunkID, false, outSerialization)
+		|| TryLoadChunkFromChunkFile(m_sourcePath, chunkID, outSerialization);
+}
+
+void ChunkStore::QueueChunkSave(const ChunkID chunkID, ECS::SerializedEntitiesAndComponents&& serialization)
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_saveMutex };
+		m_queuedSaves[chunkID] = std::move(serialization);
+	}
+	m_saveCondition.notify_all();
+}
+
+void ChunkStore::CompactSavedRegions()
+{
+	std::unique_lock<std::mutex> lock{ m_saveMutex };
+	m_saveCondition.wait(lock, [this]() { return m_queuedSaves.IsEmpty() && m_savesInProgress.IsEmpty(); });
+
+	// The writer thread can't begin writing while the lock is held, so the regions can be rewritten.
+	for (const auto& regionID : m_savedRegionIDs)
+	{
+		UnmapRegion(regionID, true);
+
+		const File::Path regionPath = m_userPath / MakeChunkRegionFileName(regionID);
+		if (!TryCompactRegionFile(regionPath))
+		{
+			AMP_LOG_WARNING("Failed to compact chunk region file \"%s\".", regionPath.u8string().c_str());
+		}
+	}
+	m_savedRegionIDs.Clear();
+}
+
+void ChunkStore::WriterThreadFunction()
+{
+	Collection::Vector<ChunkID> writtenRegionIDs;
+
+	std::unique_lock<std::mutex> lock{ m_saveMutex };
+	while (true)
+	{
+		m_saveCondition.wait(lock, [this]() { return !m_queuedSaves.IsEmpty() || m_isShuttingDown; });
+		if (m_queuedSaves.IsEmpty())
+		{
+			return;
+		}
+
+		// Take all the queued saves so that saves which are queued while they are written are written together next.
+		std::swap(m_queuedSaves, m_savesInProgress);
+
+		lock.unlock();
+		WriteSavesInProgress(writtenRegionIDs);
+		lock.lock();
+
+		for (const auto& regionID : writtenRegionIDs)
+		{
+			if (m_savedRegionIDs.IndexOf(regionID) == m_savedRegionIDs.sk_InvalidIndex)
+			{
+				m_savedRegionIDs.Add(regionID);
+			}
+		}
+		m_savesInProgress.Clear();
+		m_saveCondition.notify_all();
+	}
+}
+
+void ChunkStore::WriteSavesInProgress(Collection::Vector<ChunkID>& outWrittenRegionIDs)
+{
+	outWrittenRegionIDs.Clear();
+
+	// Group the chunks by region so that each region file is written and synchronized to disk once.
+	Collection::Vector<ChunkToWrite> chunksToWrite{ m_savesInProgress.Size() };
+	for (const auto& entry : m_savesInProgress)
+	{
+		chunksToWrite.Add({ entry.first, &entry.second });
+	}
+	std::sort(chunksToWrite.begin(), chunksToWrite.end(), [](const ChunkToWrite& lhs, const ChunkToWrite& rhs)
+		{
+			return CalcChunkRegionID(lhs.m_chunkID) < CalcChunkRegionID(rhs.m_chunkID);
+		});
+
+	for (size_t i = 0, iEnd = chunksToWrite.Size(); i < iEnd;)
+	{
+		const ChunkID regionID = CalcChunkRegionID(chunksToWrite[i].m_chunkID);
+		size_t regionEnd = i + 1;
+		while (regionEnd < iEnd && CalcChunkRegionID(chunksToWrite[regionEnd].m_chunkID) == regionID)
+		{
+			++regionEnd;
+		}
+
+		const Collection::ArrayView<const ChunkToWrite> regionChunks{ &chunksToWrite[i], regionEnd - i };
+		if (!TryWriteChunksToRegionFile(m_userPath / MakeChunkRegionFileName(regionID), regionChunks))
+		{
+			AMP_LOG_ERROR("Failed to save %zu chunks to region (%d)(%d)(%d).",
+				regionChunks.Size(), regionID.GetX(), regionID.GetY(), regionID.GetZ());
+		}
+
+		// The chunks may have been appended past the end of the region's current mapping, so the region is mapped
+		// again the next time a chunk is loaded from it. This must happen before the saves in progress are cleared.
+		UnmapRegion(regionID, true);
+		outWrittenRegionIDs.Add(regionID);
+
+		i = regionEnd;
+	}
+}
+
+bool ChunkStore::TryLoadQueuedChunk(const ChunkID chunkID, ECS::SerializedEntitiesAndComponents& outSerialization)
+{
+	std::lock_guard<std::mutex> lock{ m_saveMutex };
+
+	// Queued saves are newer than the saves in progress.
+	auto entry = m_queuedSaves.Find(chunkID);
+	if (entry == m_queuedSaves.end())
+	{
+		entry = m_savesInProgress.Find(chunkID);
+		if (entry == m_savesInProgress.end())
+		{
+			return false;
+		}
+	}
+
+	outSerialization = entry->second;
+	return true;
+}
+
+bool ChunkStore::TryLoadChunkFromRegion(const ChunkID chunkID,
+	const bool isUserRegion,
+	ECS::SerializedEntitiesAndComponents& outSerialization)
+{
+	// The region stays mapped while the chunk is read from it, even if it is unmapped by the store meanwhile.
+	const std::shared_ptr<const ChunkRegionFile> regionFile = FindOrMapRegion(CalcChunkRegionID(chunkID), isUserRegion);
+
+	Collection::ArrayView<const uint8_t> chunkBytes{ nullptr, 0 };
+	if (regionFile == nullptr || !regionFile->TryFindChunkBytes(chunkID, chunkBytes))
+	{
+		return false;
+	}
+
+	if (!ECS::TryReadSerializedEntitiesAndComponentsFrom(chunkBytes, outSerialization))
+	{
+		AMP_LOG_WARNING("Failed to read chunk (%d)(%d)(%d).", chunkID.GetX(), chunkID.GetY(), chunkID.GetZ());
+		outSerialization = ECS::SerializedEntitiesAndComponents();
+		return false;
+	}
+	return true;
+}
+
+bool ChunkStore::TryLoadChunkFromChunkFile(const File::Path& directory,
+	const ChunkID chunkID,
+	ECS::SerializedEntitiesAndComponents& outSerialization) const
+{
+	File::MappedFile chunkFile;
+	if (!chunkFile.TryOpen(directory / Internal_ChunkStore::MakeChunkFileName(chunkID)))
+	{
+		return false;
+	}
+
+	if (!ECS::TryReadSerializedEntitiesAndComponentsFrom(chunkFile.GetBytes(), outSerialization))
+	{
+		AMP_LOG_WARNING("Failed to read chunk (%d)(%d)(%d).", chunkID.GetX(), chunkID.GetY(), chunkID.GetZ());
+		outSerialization = ECS::SerializedEntitiesAndComponents();
+		return false;
+	}
+	return true;
+}
+
+std::shared_ptr<const ChunkRegionFile> ChunkStore::FindOrMapRegion(const ChunkID regionID, const bool isUserRegion)
+{
+	std::lock_guard<std::mutex> lock{ m_mappedRegionsMutex };
+
+	MappedRegion* const mappedRegion = m_mappedRegions.Find([&](const MappedRegion& entry)
+		{
+			return entry.m_regionID == regionID && entry.m_isUserRegion == isUserRegion;
+		});
+	if (mappedRegion != nullptr)
+	{
+		mappedRegion->m_lastUseIndex = m_nextUseIndex++;
+		return mappedRegion->m_regionFile;
+	}
+
+	// Make room for the region by unmapping the least recently used region.
+	if (m_mappedRegions.Size() >= k_maxMappedRegions)
+	{
+		size_t leastRecentlyUsedIndex = 0;
+		for (size_t i = 1, iEnd = m_mappedRegions.Size(); i < iEnd; ++i)
+		{
+			if (m_mappedRegions[i].m_lastUseIndex < m_mappedRegions[leastRecentlyUsedIndex].m_lastUseIndex)
+			{
+				leastRecentlyUsedIndex = i;
+			}
+		}
+		m_mappedRegions.SwapWithAndRemoveLast(leastRecentlyUsedIndex);
+	}
+
+	const File::Path& directory = isUserRegion ? m_userPath : m_sourcePath;
+	std::shared_ptr<ChunkRegionFile> regionFile = std::make_shared<ChunkRegionFile>();
+	if (!regionFile->TryOpen(directory / MakeChunkRegionFileName(regionID)))
+	{
+		regionFile.reset();
+	}
+
+	m_mappedRegions.Add({ regionID, isUserRegion, regionFile, m_nextUseIndex++ });
+	return regionFile;
+}
+
+void ChunkStore::UnmapRegion(const ChunkID regionID, const bool isUserRegion)
+{
+	std::lock_guard<std::mutex> lock{ m_mappedRegionsMutex };
+
+	const size_t index = m_mappedRegions.IndexOf([&](const MappedRegion& entry)
+		{
+			return entry.m_regionID == regionID && entry.m_isUserRegion == isUserRegion;
+		});
+	if (index != m_mappedRegions.sk_InvalidIndex)
+	{
+		m_mappedRegions.SwapWithAndRemoveLast(index);
+	}
+}
+}
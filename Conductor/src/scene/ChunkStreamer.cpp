@@ -0,0 +1,194 @@
+#include <scene/ChunkStreamer.h>
+
+#include <scene/Chunk.h>
+
+namespace Scene
+{
+ChunkStreamer::ChunkStreamer(ChunkStore& chunkStore, const uint32_t numWorkers)
+	: m_chunkStore(chunkStore)
+	, m_requests()
+	, m_workerThreads(numWorkers)
+{
+	AMP_FATAL_ASSERT(numWorkers > 0, "A ChunkStreamer needs at least one worker to load chunks.");
+	for (uint32_t i = 0; i < numWorkers; ++i)
+	{
+		m_workerThreads.Add(std::thread(&ChunkStreamer::WorkerThreadFunction, this));
+	}
+}
+
+ChunkStreamer::~ChunkStreamer()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_requestMutex };
+		m_requests.Clear();
+		m_isShuttingDown = true;
+	}
+	m_requestCondition.notify_all();
+
+	for (auto& workerThread : m_workerThreads)
+	{
+		workerThread.join();
+	}
+}
+
+void ChunkStreamer::RequestChunk(const ChunkID chunkID, const float priority, const bool isPrefetch)
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_requestMutex };
+
+		const size_t index = FindRequestIndex(chunkID);
+		if (index != m_requests.sk_InvalidIndex)
+		{
+			Request& request = m_requests[index];
+			request.m_priority = priority;
+			request.m_isPrefetch = request.m_isPrefetch && isPrefetch;
+			request.m_isRenewed = true;
+			return;
+		}
+
+		Request& request = m_requests.Emplace();
+		request.m_chunkID = chunkID;
+		request.m_priority = priority;
+		request.m_requestIndex = m_nextRequestIndex++;
+		request.m_state = RequestState::Queued;
+		request.m_isPrefetch = isPrefetch;
+		request.m_isRenewed = true;
+	}
+	m_requestCondition.notify_one();
+}
+
+void ChunkStreamer::CancelChunk(const ChunkID chunkID)
+{
+	std::lock_guard<std::mutex> lock{ m_requestMutex };
+
+	const size_t index = FindRequestIndex(chunkID);
+	if (index != m_requests.sk_InvalidIndex)
+	{
+		m_requests.SwapWithAndRemoveLast(index);
+	}
+}
+
+void ChunkStreamer::CancelStalePrefetches()
+{
+	std::lock_guard<std::mutex> lock{ m_requestMutex };
+
+	for (size_t i = 0; i < m_requests.Size();)
+	{
+		Request& request = m_requests[i];
+		if (request.m_isPrefetch && !request.m_isRenewed)
+		{
+			m_requests.SwapWithAndRemoveLast(i);
+		}
+		else
+		{
+			request.m_isRenewed = false;
+			++i;
+		}
+	}
+}
+
+void ChunkStreamer::CancelAllChunks()
+{
+	std::unique_lock<std::mutex> lock{ m_requestMutex };
+	m_requests.Clear();
+
+	m_requestCondition.wait(lock, [this]() { return m_numLoadingRequests == 0; });
+}
+
+bool ChunkStreamer::TryTakeLoadedChunk(const ChunkID chunkID, ECS::SerializedEntitiesAndComponents& outSerialization)
+{
+	std::lock_guard<std::mutex> lock{ m_requestMutex };
+
+	const size_t index = FindRequestIndex(chunkID);
+	if (index == m_requests.sk_InvalidIndex || m_requests[index].m_state != RequestState::Loaded)
+	{
+		return false;
+	}
+
+	outSerialization = std::move(m_requests[index].m_serialization);
+	m_requests.SwapWithAndRemoveLast(index);
+	return true;
+}
+
+void ChunkStreamer::WorkerThreadFunction()
+{
+	std::unique_lock<std::mutex> lock{ m_requestMutex };
+	while (true)
+	{
+		size_t requestIndex = m_requests.sk_InvalidIndex;
+		m_requestCondition.wait(lock, [&]()
+			{
+				requestIndex = FindNextRequestIndex();
+				return requestIndex != m_requests.sk_InvalidIndex || m_isShuttingDown;
+			});
+		if (m_isShuttingDown)
+		{
+			return;
+		}
+
+		Request& request = m_requests[requestIndex];
+		request.m_state = RequestState::Loading;
+		const ChunkID chunkID = request.m_chunkID;
+		const uint64_t loadingRequestIndex = request.m_requestIndex;
+		++m_numLoadingRequests;
+
+		lock.unlock();
+		ECS::SerializedEntitiesAndComponents serialization = LoadChunkForPlay(m_chunkStore, chunkID);
+		lock.lock();
+
+		// The request may have moved or been cancelled while the chunk was loading. If it was cancelled, the loaded
+		// chunk is discarded.
+		Request* const loadedRequest = m_requests.Find([&](const Request& entry)
+			{
+				return entry.m_requestIndex == loadingRequestIndex;
+			});
+		if (loadedRequest != nullptr)
+		{
+			loadedRequest->m_state = RequestState::Loaded;
+			loadedRequest->m_serialization = std::move(serialization);
+		}
+
+		--m_numLoadingRequests;
+		m_requestCondition.notify_all();
+	}
+}
+
+size_t ChunkStreamer::FindNextRequestIndex() const
+{
+	size_t nextIndex = m_requests.sk_InvalidIndex;
+	for (size_t i = 0, iEnd = m_requests.Size(); i < iEnd; ++i)
+	{
+		const Request& request = m_requests[i];
+		if (request.m_state != RequestState::Queued)
+		{
+			continue;
+		}
+
+		if (nextIndex == m_requests.sk_InvalidIndex)
+		{
+			nextIndex = i;
+			continue;
+		}
+
+		// Chunks requested for play are loaded before prefetched chunks regardless of priority.
+		const Request& nextRequest = m_requests[nextIndex];
+		if (request.m_isPrefetch != nextRequest.m_isPrefetch)
+		{
+			if (!request.m_isPrefetch)
+			{
+				nextIndex = i;
+			}
+		}
+		else if (request.m_priority < nextRequest.m_priority)
+		{
+			nextIndex = i;
+		}
+	}
+	return nextIndex;
+}
+
+size_t ChunkStreamer::FindRequestIndex(const ChunkID chunkID) const
+{
+	return m_requests.IndexOf([&](const Request& request) { return request.m_chunkID == chunkID; });
+}
+}
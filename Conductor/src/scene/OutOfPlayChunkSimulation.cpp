@@ -0,0 +1,191 @@
+#include <scene/OutOfPlayChunkSimulation.h>
+
+#include <scene/ChunkStore.h>
+
+namespace Internal_OutOfPlayChunkSimulation
+{
+uint64_t MakeChunkKey(const Scene::ChunkID chunkID)
+{
+	return static_cast<uint64_t>(static_cast<uint16_t>(chunkID.GetX()))
+		| (static_cast<uint64_t>(static_cast<uint16_t>(chunkID.GetY())) << 16)
+		| (static_cast<uint64_t>(static_cast<uint16_t>(chunkID.GetZ())) << 32);
+}
+}
+
+namespace Scene
+{
+OutOfPlayChunkSimulation::OutOfPlayChunkSimulation(ChunkStore& chunkStore, const uint32_t maxNumChunks)
+	: m_chunkStore(chunkStore)
+	, m_maxNumChunks(maxNumChunks)
+	, m_simulationFunctions()
+	, m_chunks()
+	, m_chunkIndicesByChunk()
+{
+	AMP_FATAL_ASSERT(maxNumChunks > 0, "OutOfPlayChunkSimulation must be able to keep at least one chunk resident.");
+}
+
+void OutOfPlayChunkSimulation::AddSimulationFunction(SimulationFunction&& function)
+{
+	m_simulationFunctions.Add(std::move(function));
+}
+
+void OutOfPlayChunkSimulation::AddChunk(const ChunkID chunkID, ECS::SerializedEntitiesAndComponents&& serialization)
+{
+	const uint64_t key = Internal_OutOfPlayChunkSimulation::MakeChunkKey(chunkID);
+
+	// The chunk was just saved, so its serialization isn't modified relative to the ChunkStore.
+	const uint32_t existingIndex = m_chunkIndicesByChunk.Find(key);
+	if (existingIndex != Collection::FlatIndexMap::k_invalidIndex)
+	{
+		ResidentChunk& residentChunk = m_chunks[existingIndex];
+		residentChunk.m_serialization = std::move(serialization);
+		residentChunk.m_lastSimulatedTime = m_time;
+		residentChunk.m_isModified = false;
+		return;
+	}
+
+	// Make room for the chunk by evicting the chunk which has been resident the longest. If every chunk is being
+	// promoted, there are temporarily more resident chunks than the maximum.
+	if (m_chunks.Size() >= m_maxNumChunks)
+	{
+		uint32_t oldestIndex = UINT32_MAX;
+		for (uint32_t i = 0, iEnd = m_chunks.Size(); i < iEnd; ++i)
+		{
+			const ResidentChunk& residentChunk = m_chunks[i];
+			if (!residentChunk.m_isPromoting
+				&& (oldestIndex == UINT32_MAX || residentChunk.m_residentIndex < m_chunks[oldestIndex].m_residentIndex))
+			{
+				oldestIndex = i;
+			}
+		}
+		if (oldestIndex != UINT32_MAX)
+		{
+			EvictChunk(oldestIndex);
+		}
+	}
+
+	m_chunkIndicesByChunk.Set(key, m_chunks.Size());
+	m_chunks.Add({ chunkID, std::move(serialization), m_time, m_nextResidentIndex++, false, false });
+}
+
+bool OutOfPlayChunkSimulation::HasChunk(const ChunkID chunkID) const
+{
+	return m_chunkIndicesByChunk.Find(Internal_OutOfPlayChunkSimulation::MakeChunkKey(chunkID))
+		!= Collection::FlatIndexMap::k_invalidIndex;
+}
+
+bool OutOfPlayChunkSimulation::TryBeginPromotingChunk(const ChunkID chunkID)
+{
+	const uint32_t index = m_chunkIndicesByChunk.Find(Internal_OutOfPlayChunkSimulation::MakeChunkKey(chunkID));
+	if (index == Collection::FlatIndexMap::k_invalidIndex)
+	{
+		return false;
+	}
+
+	m_chunks[index].m_isPromoting = true;
+	return true;
+}
+
+void OutOfPlayChunkSimulation::CancelPromotingChunk(const ChunkID chunkID)
+{
+	const uint32_t index = m_chunkIndicesByChunk.Find(Internal_OutOfPlayChunkSimulation::MakeChunkKey(chunkID));
+	if (index != Collection::FlatIndexMap::k_invalidIndex)
+	{
+		m_chunks[index].m_isPromoting = false;
+	}
+}
+
+bool OutOfPlayChunkSimulation::TryTakeChunk(const ChunkID chunkID,
+	ECS::SerializedEntitiesAndComponents& outSerialization)
+{
+	const uint32_t index = m_chunkIndicesByChunk.Find(Internal_OutOfPlayChunkSimulation::MakeChunkKey(chunkID));
+	if (index == Collection::FlatIndexMap::k_invalidIndex)
+	{
+		return false;
+	}
+
+	// A modified chunk doesn't need to be saved here: it is saved when it is next removed from play.
+	outSerialization = std::move(m_chunks[index].m_serialization);
+	RemoveChunk(index);
+	return true;
+}
+
+void OutOfPlayChunkSimulation::Update(const Unit::Time::Millisecond delta)
+{
+	m_time += delta;
+
+	if (m_chunks.IsEmpty() || m_simulationFunctions.IsEmpty())
+	{
+		return;
+	}
+
+	// Check each chunk at most once, stopping early if enough chunks have been simulated.
+	uint32_t numChunksSimulated = 0;
+	for (uint32_t i = 0, iEnd = m_chunks.Size(); i < iEnd; ++i)
+	{
+		if (numChunksSimulated >= k_maxChunksSimulatedPerUpdate)
+		{
+			break;
+		}
+
+		if (m_nextSimulatedIndex >= m_chunks.Size())
+		{
+			m_nextSimulatedIndex = 0;
+		}
+		ResidentChunk& residentChunk = m_chunks[m_nextSimulatedIndex++];
+
+		const Unit::Time::Millisecond elapsedTime = m_time - residentChunk.m_lastSimulatedTime;
+		if (elapsedTime < k_simulationPeriod)
+		{
+			continue;
+		}
+
+		for (const auto& simulationFunction : m_simulationFunctions)
+		{
+			if (simulationFunction(residentChunk.m_chunkID, elapsedTime, residentChunk.m_serialization))
+			{
+				residentChunk.m_isModified = true;
+			}
+		}
+		residentChunk.m_lastSimulatedTime = m_time;
+		++numChunksSimulated;
+	}
+}
+
+void OutOfPlayChunkSimulation::SaveAndEvictAllChunks()
+{
+	for (auto& residentChunk : m_chunks)
+	{
+		if (residentChunk.m_isModified)
+		{
+			m_chunkStore.QueueChunkSave(residentChunk.m_chunkID, std::move(residentChunk.m_serialization));
+		}
+	}
+	m_chunks.Clear();
+	m_chunkIndicesByChunk.Clear();
+	m_nextSimulatedIndex = 0;
+}
+
+void OutOfPlayChunkSimulation::EvictChunk(const uint32_t index)
+{
+	ResidentChunk& residentChunk = m_chunks[index];
+	if (residentChunk.m_isModified)
+	{
+		m_chunkStore.QueueChunkSave(residentChunk.m_chunkID, std::move(residentChunk.m_serialization));
+	}
+	RemoveChunk(index);
+}
+
+void OutOfPlayChunkSimulation::RemoveChunk(const uint32_t index)
+{
+	m_chunkIndicesByChunk.Remove(Internal_OutOfPlayChunkSimulation::MakeChunkKey(m_chunks[index].m_chunkID));
+
+	const uint32_t lastIndex = m_chunks.Size() - 1;
+	if (index != lastIndex)
+	{
+		const ChunkID lastChunkID = m_chunks[lastIndex].m_chunkID;
+		m_chunkIndicesByChunk.Set(Internal_OutOfPlayChunkSimulation::MakeChunkKey(lastChunkID), index);
+	}
+	m_chunks.SwapWithAndRemoveLast(index);
+}
+}
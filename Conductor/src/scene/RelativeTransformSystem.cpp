@@ -1,53 +1,220 @@
 #include <scene/RelativeTransformSystem.h>
 
 #include <ecs/Entity.h>
-#include <ecs/EntityManager.h>
 
-#include <algorithm>
+#include <cstring>
 
 namespace Scene
 {
+namespace Internal_RelativeTransformSystem
+{
+constexpr uint32_t k_unknownDepth = UINT32_MAX;
+
+bool AreBitwiseEqual(const Math::Matrix4x4& lhs, const Math::Matrix4x4& rhs)
+{
+	return memcmp(lhs.GetData(), rhs.GetData(), sizeof(Math::Matrix4x4)) == 0;
+}
+}
+
 void RelativeTransformSystem::Update(const Unit::Time::Millisecond delta,
 	const Collection::ArrayView<ECSGroupType>& ecsGroups,
-	Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions)
+	ECS::DeferredFunctionList& deferredFunctions)
 {
-	// Sort the ECS groups by parent/child dependency and discard entities without parents.
-	m_updateBuffer.Clear();
-	for (const auto& ecsGroup : ecsGroups)
+	const bool needsRebuild = m_isHierarchyDirty || !IsHierarchyValid(ecsGroups);
+	if (needsRebuild)
 	{
-		const ECS::Entity& entity = ecsGroup.Get<const ECS::Entity>();
-		if (entity.GetParent() != nullptr)
+		RebuildHierarchy(ecsGroups);
+		m_isHierarchyDirty = false;
+	}
+
+	// Every transform is recomputed after a rebuild because the matrices from the last propagation are stale.
+	PropagateTransforms(needsRebuild);
+}
+
+void RelativeTransformSystem::NotifyOfEntityAdded(const ECS::EntityID id, const ECSGroupType& group)
+{
+	m_isHierarchyDirty = true;
+}
+
+void RelativeTransformSystem::NotifyOfEntityRemoved(const ECS::EntityID id, const ECSGroupType& group)
+{
+	m_isHierarchyDirty = true;
+}
+
+bool RelativeTransformSystem::IsHierarchyValid(const Collection::ArrayView<ECSGroupType>& ecsGroups) const
+{
+	if (m_groupNodeIndices.Size() != ecsGroups.Size())
+	{
+		return false;
+	}
+
+	// The groups are checked against the nodes by identity before anything is read through the nodes, because
+	// entities can be replaced and components relocated between updates. Entities can also change parents without
+	// being removed from the system.
+	for (size_t i = 0, iEnd = ecsGroups.Size(); i < iEnd; ++i)
+	{
+		const uint32_t nodeIndex = m_groupNodeIndices[i];
+		const ECS::Entity& entity = ecsGroups[i].Get<const ECS::Entity>();
+		if (&entity != m_nodeEntities[nodeIndex]
+			|| entity.GetID() != m_nodeEntityIDs[nodeIndex]
+			|| &ecsGroups[i].Get<SceneTransformComponent>() != m_nodeComponents[nodeIndex]
+			|| entity.GetParent() != m_nodeParentEntities[nodeIndex])
 		{
-			SceneTransformComponent& component = ecsGroup.Get<SceneTransformComponent>();
-			m_updateBuffer.Add({ &entity, &component });
+			return false;
 		}
 	}
-	std::sort(m_updateBuffer.begin(), m_updateBuffer.end(), [](const UpdateEntry& lhs, const UpdateEntry& rhs)
+	return true;
+}
+
+void RelativeTransformSystem::RebuildHierarchy(const Collection::ArrayView<ECSGroupType>& ecsGroups)
+{
+	using namespace Internal_RelativeTransformSystem;
+
+	const uint32_t numGroups = static_cast<uint32_t>(ecsGroups.Size());
+
+	// Find the group of each entity's parent.
+	m_groupIndicesByEntityID.Clear();
+	for (uint32_t i = 0; i < numGroups; ++i)
 	{
-		return lhs.m_entity == rhs.m_entity->GetParent();
-	});
+		const ECS::Entity& entity = ecsGroups[i].Get<const ECS::Entity>();
+		m_groupIndicesByEntityID.Set(entity.GetID().GetUniqueID(), i);
+	}
 
-	// Defer a function to process the update buffer so it has access to the entity manager.
-	deferredFunctions.Add([this](ECS::EntityManager& entityManager)
+	m_groupParentIndices.Clear();
+	m_groupParentIndices.Resize(numGroups, k_noParentIndex);
+	for (uint32_t i = 0; i < numGroups; ++i)
 	{
-		ProcessUpdateBuffer(entityManager);
-	});
+		const ECS::Entity* const parent = ecsGroups[i].Get<const ECS::Entity>().GetParent();
+		if (parent != nullptr)
+		{
+			const uint32_t parentGroupIndex = m_groupIndicesByEntityID.Find(parent->GetID().GetUniqueID());
+			if (parentGroupIndex != Collection::FlatIndexMap::k_invalidIndex)
+			{
+				m_groupParentIndices[i] = parentGroupIndex;
+			}
+		}
+	}
+
+	// Determine the depth of each group by walking up to the nearest ancestor with a known depth.
+	m_groupDepths.Clear();
+	m_groupDepths.Resize(numGroups, k_unknownDepth);
+	uint32_t maxDepth = 0;
+	for (uint32_t i = 0; i < numGroups; ++i)
+	{
+		for (uint32_t j = i; m_groupDepths[j] == k_unknownDepth; j = m_groupParentIndices[j])
+		{
+			m_depthStack.Add(j);
+			if (m_groupParentIndices[j] == k_noParentIndex)
+			{
+				break;
+			}
+		}
+
+		while (!m_depthStack.IsEmpty())
+		{
+			const uint32_t groupIndex = m_depthStack.Back();
+			m_depthStack.RemoveLast();
+
+			const uint32_t parentGroupIndex = m_groupParentIndices[groupIndex];
+			const uint32_t depth = (parentGroupIndex == k_noParentIndex) ? 0 : (m_groupDepths[parentGroupIndex] + 1);
+			m_groupDepths[groupIndex] = depth;
+			maxDepth = (depth > maxDepth) ? depth : maxDepth;
+		}
+	}
+
+	// Order the groups by depth with a counting sort, which keeps groups at the same depth in their group order.
+	m_numNodesAtDepth.Clear();
+	m_numNodesAtDepth.Resize(maxDepth + 1, 0);
+	for (const auto& depth : m_groupDepths)
+	{
+		++m_numNodesAtDepth[depth];
+	}
+
+	uint32_t firstNodeIndexAtDepth = 0;
+	for (auto& numNodes : m_numNodesAtDepth)
+	{
+		const uint32_t numNodesAtDepth = numNodes;
+		numNodes = firstNodeIndexAtDepth;
+		firstNodeIndexAtDepth += numNodesAtDepth;
+	}
+
+	m_groupNodeIndices.Clear();
+	m_groupNodeIndices.Resize(numGroups, 0);
+	for (uint32_t i = 0; i < numGroups; ++i)
+	{
+		m_groupNodeIndices[i] = m_numNodesAtDepth[m_groupDepths[i]]++;
+	}
+
+	// Build the nodes in depth order.
+	m_nodeEntityIDs.Clear();
+	m_nodeEntityIDs.Resize(numGroups);
+	m_nodeEntities.Clear();
+	m_nodeEntities.Resize(numGroups, nullptr);
+	m_nodeComponents.Clear();
+	m_nodeComponents.Resize(numGroups, nullptr);
+	m_nodeParentIndices.Clear();
+	m_nodeParentIndices.Resize(numGroups, k_noParentIndex);
+	m_nodeParentEntities.Clear();
+	m_nodeParentEntities.Resize(numGroups, nullptr);
+
+	for (uint32_t i = 0; i < numGroups; ++i)
+	{
+		const uint32_t nodeIndex = m_groupNodeIndices[i];
+		const ECS::Entity& entity = ecsGroups[i].Get<const ECS::Entity>();
+
+		m_nodeEntityIDs[nodeIndex] = entity.GetID();
+		m_nodeEntities[nodeIndex] = &entity;
+		m_nodeComponents[nodeIndex] = &ecsGroups[i].Get<SceneTransformComponent>();
+		m_nodeParentEntities[nodeIndex] = entity.GetParent();
+
+		const uint32_t parentGroupIndex = m_groupParentIndices[i];
+		if (parentGroupIndex != k_noParentIndex)
+		{
+			m_nodeParentIndices[nodeIndex] = m_groupNodeIndices[parentGroupIndex];
+		}
+	}
+
+	m_lastChildToParentMatrices.Clear();
+	m_lastChildToParentMatrices.Resize(numGroups);
+	m_lastModelToWorldMatrices.Clear();
+	m_lastModelToWorldMatrices.Resize(numGroups);
+	m_nodeChangedFlags.Clear();
+	m_nodeChangedFlags.Resize(numGroups, 0);
 }
 
-void RelativeTransformSystem::ProcessUpdateBuffer(ECS::EntityManager& entityManager)
+void RelativeTransformSystem::PropagateTransforms(const bool forceFullPropagation)
 {
-	// Update the transform of each child to be relative to its parent's.
-	for (const auto& updateEntry : m_updateBuffer)
+	using namespace Internal_RelativeTransformSystem;
+
+	// Parents precede their children, so each node's parent is up to date by the time the node is reached.
+	for (size_t i = 0, iEnd = m_nodeComponents.Size(); i < iEnd; ++i)
 	{
-		SceneTransformComponent& component = *updateEntry.m_component;
+		SceneTransformComponent& component = *m_nodeComponents[i];
+		const uint32_t parentIndex = m_nodeParentIndices[i];
+
+		// The transform of a node is recomputed if its parent's transform changed, if its relative transform
+		// changed, or if something other than this system overwrote it.
+		bool changed = forceFullPropagation
+			|| !AreBitwiseEqual(component.m_modelToWorldMatrix, m_lastModelToWorldMatrices[i]);
+		if (parentIndex != k_noParentIndex)
+		{
+			changed = changed || (m_nodeChangedFlags[parentIndex] != 0)
+				|| !AreBitwiseEqual(component.m_childToParentMatrix, m_lastChildToParentMatrices[i]);
+			if (changed)
+			{
+				const Math::Matrix4x4& parentTransform = m_nodeComponents[parentIndex]->m_modelToWorldMatrix;
+				Math::Matrix4x4::Multiply(
+					parentTransform, component.m_childToParentMatrix, component.m_modelToWorldMatrix);
+				m_lastChildToParentMatrices[i] = component.m_childToParentMatrix;
+				MarkChanged(component);
+			}
+		}
 
-		const SceneTransformComponent* const parentComponent =
-			entityManager.FindComponent<SceneTransformComponent>(*updateEntry.m_entity->GetParent());
-		if (parentComponent != nullptr)
+		if (changed)
 		{
-			const Math::Matrix4x4& parentTransform = parentComponent->m_modelToWorldMatrix;
-			component.m_modelToWorldMatrix = parentTransform * component.m_childToParentMatrix;
+			m_lastModelToWorldMatrices[i] = component.m_modelToWorldMatrix;
 		}
+		m_nodeChangedFlags[i] = changed ? 1 : 0;
 	}
 }
 }
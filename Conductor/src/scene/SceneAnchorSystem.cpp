@@ -2,105 +2,201 @@
 
 #include <scene/UnboundedScene.h>
 
+#include <algorithm>
+#include <cfloat>
+#include <utility>
+
+namespace Internal_SceneAnchorSystem
+{
+// How far ahead in time of an anchor's movement its position is predicted.
+constexpr float k_predictionSeconds = 2.0f;
+
+// How much each update's measured velocity of an anchor contributes to its estimated velocity. Smoothing the estimate
+// keeps the predicted position from jumping around when an anchor's movement is uneven from frame to frame.
+constexpr float k_velocitySmoothing = 0.5f;
+
+// Call the given function with each chunk whose origin is within the given radius of the origin of the center chunk.
+template <typename Function>
+void ForEachChunkInRadius(const Scene::ChunkID centerChunkID, const int16_t radiusInChunks, Function&& function)
+{
+	const float radius = static_cast<float>(radiusInChunks) * Scene::k_chunkSideLengthMeters;
+	const float radiusSquared = radius * radius;
+
+	const Math::Vector3 centerChunkOrigin = Scene::CalcChunkOrigin(centerChunkID);
+
+	const int16_t xMin = centerChunkID.GetX() - radiusInChunks;
+	const int16_t yMin = centerChunkID.GetY() - radiusInChunks;
+	const int16_t zMin = centerChunkID.GetZ() - radiusInChunks;
+	const int16_t xMax = centerChunkID.GetX() + radiusInChunks;
+	const int16_t yMax = centerChunkID.GetY() + radiusInChunks;
+	const int16_t zMax = centerChunkID.GetZ() + radiusInChunks;
+
+	for (int16_t z = zMin; z <= zMax; ++z)
+	{
+		for (int16_t y = yMin; y <= yMax; ++y)
+		{
+			for (int16_t x = xMin; x <= xMax; ++x)
+			{
+				const Scene::ChunkID chunkID{ x, y, z };
+				const float distanceSquared = (Scene::CalcChunkOrigin(chunkID) - centerChunkOrigin).LengthSquared();
+				if (distanceSquared <= radiusSquared)
+				{
+					function(chunkID);
+				}
+			}
+		}
+	}
+}
+
+// Chunks are loaded in order of the distance of their centers from where the anchor is predicted to be, so chunks in
+// the direction the anchor is moving are loaded before the chunks behind it.
+float CalcLoadPriority(const Scene::ChunkID chunkID, const Math::Vector3& predictedPosition)
+{
+	constexpr float k_halfChunkSideLength = Scene::k_chunkSideLengthMeters * 0.5f;
+	const Math::Vector3 chunkCenter = Scene::CalcChunkOrigin(chunkID)
+		+ Math::Vector3(k_halfChunkSideLength, k_halfChunkSideLength, k_halfChunkSideLength);
+	return (chunkCenter - predictedPosition).LengthSquared();
+}
+}
+
 namespace Scene
 {
 SceneAnchorSystem::SceneAnchorSystem(UnboundedScene& scene)
 	: m_scene(scene)
+	, m_anchorChunks()
+	, m_prefetchChunks()
+	, m_anchorMotions()
+	, m_nextAnchorMotions()
 {}
 
 void SceneAnchorSystem::Update(const Unit::Time::Millisecond delta,
 	const Collection::ArrayView<ECSGroupType>& ecsGroups,
-	Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions)
+	ECS::DeferredFunctionList& deferredFunctions)
 {
-	// Clear the extra bits of the anchor chunk IDs.
-	for (auto& chunkID : m_anchorChunkIDs)
+	using namespace Internal_SceneAnchorSystem;
+
+	// Clear the extra bits of the anchor chunk IDs. Their priorities are found again as they are marked.
+	for (auto& anchorChunk : m_anchorChunks)
 	{
-		chunkID = chunkID.GetWithoutExtra();
+		anchorChunk.m_chunkID = anchorChunk.m_chunkID.GetWithoutExtra();
+		anchorChunk.m_loadPriority = FLT_MAX;
 	}
+	m_prefetchChunks.Clear();
+	m_nextAnchorMotions.Clear();
+
+	const float deltaSeconds = static_cast<float>(delta.GetN()) / 1000.0f;
 
-	// Mark the chunks that need to be anchors.
+	// Mark the chunks that need to be anchors and find the chunks that should be prefetched.
 	static constexpr uint8_t k_extraMarker = 1;
 	for (const auto& ecsGroup : ecsGroups)
 	{
 		const SceneTransformComponent& transformComponent = ecsGroup.Get<const SceneTransformComponent>();
 		const Math::Vector3& position = transformComponent.m_modelToWorldMatrix.GetTranslation();
-		
+
 		const AnchorComponent& anchorComponent = ecsGroup.Get<const AnchorComponent>();
 
 		const int16_t anchoringRadiusInChunks = anchorComponent.m_anchoringRadiusInChunks;
 
-		const float fAnchoringRadiusInChunks = static_cast<float>(anchoringRadiusInChunks) * k_chunkSideLengthMeters;
-		const float anchoringRadiusSquared = fAnchoringRadiusInChunks * fAnchoringRadiusInChunks;
+		// Estimate the velocity of the anchor from how far it moved since the last update.
+		Math::Vector3 velocity{ 0.0f, 0.0f, 0.0f };
+		const AnchorMotion* const previousMotion = m_anchorMotions.Find([&](const AnchorMotion& motion)
+			{
+				return motion.m_anchorComponentID == anchorComponent.m_id;
+			});
+		if (previousMotion != nullptr)
+		{
+			velocity = previousMotion->m_velocity;
+			if (deltaSeconds > 0.0f)
+			{
+				const Math::Vector3 measuredVelocity = (position - previousMotion->m_position) / deltaSeconds;
+				velocity += (measuredVelocity - velocity) * k_velocitySmoothing;
+			}
+		}
+		m_nextAnchorMotions.Add({ anchorComponent.m_id, position, velocity });
+
+		// Predict where the anchor will be. The prediction is limited to the anchoring radius so that an anchor which
+		// is teleported doesn't cause chunks far away from it to be prefetched.
+		const float anchoringRadius = static_cast<float>(anchoringRadiusInChunks) * k_chunkSideLengthMeters;
+		Math::Vector3 predictedOffset = velocity * k_predictionSeconds;
+		const float predictedDistance = predictedOffset.Length();
+		if (predictedDistance > anchoringRadius)
+		{
+			predictedOffset *= anchoringRadius / predictedDistance;
+		}
+		const Math::Vector3 predictedPosition = position + predictedOffset;
 
-		const int16_t entityChunkX = static_cast<int16_t>(static_cast<int32_t>(position.x) >> k_lgChunkSideLength);
-		const int16_t entityChunkY = static_cast<int16_t>(static_cast<int32_t>(position.y) >> k_lgChunkSideLength);
-		const int16_t entityChunkZ = static_cast<int16_t>(static_cast<int32_t>(position.z) >> k_lgChunkSideLength);
-		const ChunkID entityChunkID{ entityChunkX, entityChunkY, entityChunkZ };
+		const ChunkID entityChunkID = CalcChunkID(position);
+		ForEachChunkInRadius(entityChunkID, anchoringRadiusInChunks, [&](const ChunkID& chunkID)
+			{
+				RequestedChunk& anchorChunk =
+					AddRequestedChunk(m_anchorChunks, chunkID, CalcLoadPriority(chunkID, predictedPosition));
+				anchorChunk.m_chunkID = ChunkID(chunkID.GetX(), chunkID.GetY(), chunkID.GetZ(), k_extraMarker);
+			});
+
+		// Prefetch the chunks which will be anchored if the anchor reaches its predicted position.
+		const ChunkID predictedChunkID = CalcChunkID(predictedPosition);
+		if (predictedChunkID == entityChunkID)
+		{
+			continue;
+		}
 
 		const Math::Vector3 entityChunkOrigin = CalcChunkOrigin(entityChunkID);
-
-		const int16_t xMin = entityChunkX - anchoringRadiusInChunks;
-		const int16_t yMin = entityChunkY - anchoringRadiusInChunks;
-		const int16_t zMin = entityChunkZ - anchoringRadiusInChunks;
-		const int16_t xMax = entityChunkX + anchoringRadiusInChunks;
-		const int16_t yMax = entityChunkY + anchoringRadiusInChunks;
-		const int16_t zMax = entityChunkZ + anchoringRadiusInChunks;
-
-		for (int16_t z = zMin; z <= zMax; ++z)
-		{
-			for (int16_t y = yMin; y <= yMax; ++y)
+		const float anchoringRadiusSquared = anchoringRadius * anchoringRadius;
+		ForEachChunkInRadius(predictedChunkID, anchoringRadiusInChunks, [&](const ChunkID& chunkID)
 			{
-				for (int16_t x = xMin; x <= xMax; ++x)
+				if ((CalcChunkOrigin(chunkID) - entityChunkOrigin).LengthSquared() > anchoringRadiusSquared)
 				{
-					const ChunkID chunkID{ x, y, z };
-					const Math::Vector3 chunkOrigin = CalcChunkOrigin(chunkID);
-
-					const float distanceSquared = (chunkOrigin - entityChunkOrigin).LengthSquared();
-					if (distanceSquared > anchoringRadiusSquared)
-					{
-						continue;
-					}
-
-					bool found = false;
-					for (auto& anchorChunkID : m_anchorChunkIDs)
-					{
-						if (anchorChunkID.GetWithoutExtra() == chunkID)
-						{
-							anchorChunkID = ChunkID(x, y, z, k_extraMarker);
-							found = true;
-							break;
-						}
-					}
-
-					if (!found)
-					{
-						m_anchorChunkIDs.Emplace(x, y, z, k_extraMarker);
-					}
+					AddRequestedChunk(m_prefetchChunks, chunkID, CalcLoadPriority(chunkID, predictedPosition));
 				}
-			}
-		}
+			});
 	}
 
-	// Bring all marked chunks into play.
-	for (const auto& anchorChunkID : m_anchorChunkIDs)
+	// Anchors which no longer exist are forgotten.
+	std::swap(m_anchorMotions, m_nextAnchorMotions);
+
+	// Bring all marked chunks into play. Chunks which are still loading have their priority updated.
+	for (const auto& anchorChunk : m_anchorChunks)
 	{
-		if (anchorChunkID.GetExtra() == k_extraMarker)
+		if (anchorChunk.m_chunkID.GetExtra() == k_extraMarker)
 		{
-			m_scene.BringChunkIntoPlay(anchorChunkID.GetWithoutExtra());
+			m_scene.BringChunkIntoPlay(anchorChunk.m_chunkID.GetWithoutExtra(), anchorChunk.m_loadPriority);
 		}
 	}
 
-	// Remove all unmarked chunks from play and erase them from m_anchorChunkIDs.
-	for (const auto& anchorChunkID : m_anchorChunkIDs)
+	// Prefetch the chunks ahead of the anchors. Prefetches which aren't renewed here are cancelled by the scene.
+	for (const auto& prefetchChunk : m_prefetchChunks)
+	{
+		m_scene.PrefetchChunk(prefetchChunk.m_chunkID, prefetchChunk.m_loadPriority);
+	}
+
+	// Remove all unmarked chunks from play and erase them from m_anchorChunks.
+	for (const auto& anchorChunk : m_anchorChunks)
 	{
-		if (anchorChunkID.GetExtra() != k_extraMarker)
+		if (anchorChunk.m_chunkID.GetExtra() != k_extraMarker)
 		{
-			m_scene.RemoveChunkFromPlay(anchorChunkID.GetWithoutExtra());
+			m_scene.RemoveChunkFromPlay(anchorChunk.m_chunkID.GetWithoutExtra());
 		}
 	}
 
-	const size_t removeIndex = m_anchorChunkIDs.Partition(
-		[](const ChunkID& chunkID) { return chunkID.GetExtra() != k_extraMarker; });
-	m_anchorChunkIDs.Remove(removeIndex, m_anchorChunkIDs.Size());
+	const size_t removeIndex = m_anchorChunks.Partition(
+		[](const RequestedChunk& anchorChunk) { return anchorChunk.m_chunkID.GetExtra() == k_extraMarker; });
+	m_anchorChunks.Remove(removeIndex, m_anchorChunks.Size());
+}
+
+SceneAnchorSystem::RequestedChunk& SceneAnchorSystem::AddRequestedChunk(
+	Collection::Vector<RequestedChunk>& requestedChunks,
+	const ChunkID chunkID,
+	const float loadPriority)
+{
+	RequestedChunk* const requestedChunk = requestedChunks.Find([&](const RequestedChunk& entry)
+		{
+			return entry.m_chunkID.GetWithoutExtra() == chunkID;
+		});
+	if (requestedChunk != nullptr)
+	{
+		requestedChunk->m_loadPriority = std::min(requestedChunk->m_loadPriority, loadPriority);
+		return *requestedChunk;
+	}
+	return requestedChunks.Emplace(RequestedChunk{ chunkID, loadPriority });
 }
 }
@@ -0,0 +1,127 @@
+#include <scene/TrackedChunkSpatialIndex.h>
+
+#include <ecs/EntityManager.h>
+#include <scene/Chunk.h>
+#include <scene/SceneTransformComponent.h>
+
+namespace Internal_TrackedChunkSpatialIndex
+{
+constexpr uint64_t k_unplacedTransformID = UINT64_MAX;
+
+// The maps hold every root entity of a scene, so they have more buckets than the EntityManager's map of entities.
+constexpr uint32_t k_numBucketsShift = 10;
+}
+
+namespace Scene
+{
+TrackedChunkSpatialIndex::TrackedChunkSpatialIndex(std::function<bool(const ECS::Entity&)>&& filter)
+	: m_filter(std::move(filter))
+	, m_entityIDsByTransformID(Collection::I64HashFunctor(), Internal_TrackedChunkSpatialIndex::k_numBucketsShift)
+	, m_transformIDsByEntityID(Collection::I64HashFunctor(), Internal_TrackedChunkSpatialIndex::k_numBucketsShift)
+{}
+
+TrackedChunkSpatialIndex::~TrackedChunkSpatialIndex()
+{
+	if (m_observedEntityManager != nullptr)
+	{
+		m_observedEntityManager->RemoveChangeObserver(m_changes);
+	}
+}
+
+void TrackedChunkSpatialIndex::ObserveChangesOf(ECS::EntityManager& entityManager)
+{
+	AMP_FATAL_ASSERT(m_observedEntityManager == nullptr,
+		"A TrackedChunkSpatialIndex can only observe one EntityManager.");
+	m_observedEntityManager = &entityManager;
+	m_changes.SetEnabled(true);
+	entityManager.AddChangeObserver(m_changes);
+}
+
+void TrackedChunkSpatialIndex::Update(const ECS::EntityManager& entityManager)
+{
+	// Entities which were created, deleted, reparented, or had components added or removed are recorded themselves.
+	for (const auto& entityID : m_changes.GetChangedEntityIDs())
+	{
+		UpdateEntity(entityManager, entityID);
+	}
+
+	// Moved entities are recorded through their transforms. The transforms of entities which aren't indexed, such as
+	// child entities, are skipped.
+	for (const auto& componentID : m_changes.GetChangedComponentIDs())
+	{
+		if (componentID.GetType() != SceneTransformComponent::k_type)
+		{
+			continue;
+		}
+
+		const ECS::EntityID* const entityID = m_entityIDsByTransformID.Find(componentID.GetUniqueID());
+		if (entityID != nullptr)
+		{
+			// Updating the entity may remove it from the map, so the ID is copied out of it first.
+			const ECS::EntityID movedEntityID = *entityID;
+			UpdateEntity(entityManager, movedEntityID);
+		}
+	}
+
+	m_changes.Clear();
+}
+
+void TrackedChunkSpatialIndex::UpdateEntity(const ECS::EntityManager& entityManager, const ECS::EntityID entityID)
+{
+	using namespace Internal_TrackedChunkSpatialIndex;
+
+	const ECS::Entity* const entity = entityManager.FindEntity(entityID);
+	if (entity == nullptr || entity->GetParent() != nullptr || !m_filter(*entity))
+	{
+		RemoveEntity(entityID);
+		return;
+	}
+
+	const SceneTransformComponent* const transformComponent =
+		entityManager.FindComponent<SceneTransformComponent>(*entity);
+	const uint64_t transformID =
+		(transformComponent != nullptr) ? transformComponent->m_id.GetUniqueID() : k_unplacedTransformID;
+
+	// Map the entity to its transform if it is new to the index or its transform was added, removed, or replaced.
+	const uint64_t* const indexedTransformID = m_transformIDsByEntityID.Find(entityID.GetUniqueID());
+	if (indexedTransformID == nullptr || *indexedTransformID != transformID)
+	{
+		RemoveEntity(entityID);
+		m_transformIDsByEntityID[entityID.GetUniqueID()] = transformID;
+
+		if (transformComponent == nullptr)
+		{
+			m_unplacedEntityIDs.Add(entityID);
+			return;
+		}
+		m_entityIDsByTransformID[transformID] = entityID;
+	}
+	else if (transformComponent == nullptr)
+	{
+		return;
+	}
+
+	m_spatialIndex.Place(entityID, CalcChunkID(transformComponent->m_modelToWorldMatrix.GetTranslation()));
+}
+
+void TrackedChunkSpatialIndex::RemoveEntity(const ECS::EntityID entityID)
+{
+	using namespace Internal_TrackedChunkSpatialIndex;
+
+	uint64_t transformID = k_unplacedTransformID;
+	if (!m_transformIDsByEntityID.TryRemove(entityID.GetUniqueID(), &transformID))
+	{
+		return;
+	}
+
+	if (transformID == k_unplacedTransformID)
+	{
+		m_unplacedEntityIDs.SwapWithAndRemoveLast(m_unplacedEntityIDs.IndexOf(entityID));
+	}
+	else
+	{
+		m_entityIDsByTransformID.TryRemove(transformID);
+		m_spatialIndex.Remove(entityID);
+	}
+}
+}
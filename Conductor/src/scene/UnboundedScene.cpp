@@ -2,74 +2,106 @@
 
 #include <ecs/EntityManager.h>
 
-#include <fstream>
-#include <random>
-
-namespace Internal_UnboundedScene
-{
-std::string MakeChunkFileName(const Scene::ChunkID& chunkID)
-{
-	return '(' + std::to_string(chunkID.GetX()) + ")(" + std::to_string(chunkID.GetY())
-		+ ")(" + std::to_string(chunkID.GetZ()) + ").chunk";
-}
-}
+#include <chrono>
 
 namespace Scene
 {
 UnboundedScene::UnboundedScene(const File::Path& sourcePath, const File::Path& userPath)
-	: m_sourcePath(sourcePath)
-	, m_userPath(userPath)
-	, m_spatialHashMap(ChunkHashFunctor(), 12)
+	: m_chunkStore(sourcePath, userPath)
+	, m_chunkStreamer(m_chunkStore)
+	, m_outOfPlayChunks(m_chunkStore)
+	, m_spatialIndex([](const ECS::Entity& entity)
+		{
+			// The scene's entities are the ones it saves with their chunks.
+			return entity.FindComponentID<SceneTransformComponent>() != ECS::ComponentID()
+				&& entity.FindComponentID<SceneSaveComponent>() != ECS::ComponentID();
+		})
 	, m_chunksInPlay()
 	, m_transitionChunksToRefCounts()
 {}
 
+void UnboundedScene::NotifyOfRegistration(ECS::EntityManager& entityManager)
+{
+	m_spatialIndex.ObserveChangesOf(entityManager);
+}
+
 void UnboundedScene::NotifyOfShutdown(ECS::EntityManager& entityManager)
 {
-	// Synchronize any chunks that are loading, but don't add them to the EntityManager.
-	for (auto& future : m_chunkLoadingFutures)
+	// Bring the spatial index up to date so that every entity is saved with the chunk it is in.
+	m_spatialIndex.Update(entityManager);
+
+	// Synchronize any chunks that are loading, but don't add them to the EntityManager. Chunks which haven't loaded
+	// have no entities to save, and saving them would overwrite their stored chunks with empty ones, so they are taken
+	// out of play without being saved.
+	m_chunkStreamer.CancelAllChunks();
+	for (const auto& chunkID : m_chunksLoading)
 	{
-		future.wait();
+		m_chunksInPlay.SwapWithAndRemoveLast(m_chunksInPlay.IndexOf(chunkID));
 	}
-	m_chunkLoadingFutures.Clear();
+	m_chunksLoading.Clear();
 
-	// Save and unload all transition chunks.
+	// Save and unload all transition chunks. The resident out-of-play chunks are about to be evicted, so the chunks
+	// aren't kept resident.
 	for (const auto& entry : m_transitionChunksToRefCounts)
 	{
-		SaveChunkAndQueueEntitiesForUnload(entityManager, entry.first);
+		SaveChunkAndQueueEntitiesForUnload(entityManager, entry.first, false);
 	}
 	m_transitionChunksToRefCounts.Clear();
 
 	// Save and unload all chunks pending removal.
 	for (const auto& chunkID : m_chunksPendingRemoval)
 	{
-		SaveChunkAndQueueEntitiesForUnload(entityManager, chunkID);
+		SaveChunkAndQueueEntitiesForUnload(entityManager, chunkID, false);
 	}
 	m_chunksPendingRemoval.Clear();
 
 	// Save and unload all chunks in play.
 	for (const auto& chunkID : m_chunksInPlay)
 	{
-		SaveChunkAndQueueEntitiesForUnload(entityManager, chunkID);
+		SaveChunkAndQueueEntitiesForUnload(entityManager, chunkID, false);
 	}
 	m_chunksInPlay.Clear();
 
 	// Unload all entities from chunks that were unloaded.
-	entityManager.DeleteEntities(m_entitiesPendingUnload.GetConstView());
-	m_entitiesPendingUnload.Clear();
+	entityManager.ApplyCommandBuffer(m_unloadCommands);
+
+	// Save the resident out-of-play chunks which were modified by their simplified simulation.
+	m_outOfPlayChunks.SaveAndEvictAllChunks();
+
+	// No chunks are loading, so the region files that were saved to can be compacted once the saves are written.
+	m_chunkStore.CompactSavedRegions();
 }
 
-void UnboundedScene::BringChunkIntoPlay(const ChunkID chunkID)
+void UnboundedScene::BringChunkIntoPlay(const ChunkID chunkID, const float loadPriority)
 {
 	if (m_chunksInPlay.IndexOf(chunkID) != m_chunksInPlay.sk_InvalidIndex)
 	{
+		// Update the priority of the chunk if it is still loading from the chunk store.
+		if (m_chunksLoading.IndexOf(chunkID) != m_chunksLoading.sk_InvalidIndex
+			&& !m_outOfPlayChunks.HasChunk(chunkID))
+		{
+			m_chunkStreamer.RequestChunk(chunkID, loadPriority, false);
+		}
 		return;
 	}
 	m_chunksInPlay.Add(chunkID);
 
-	// Begin asynchronously loading the chunk.
-	m_chunkLoadingFutures.Add(std::async(std::launch::async, LoadChunkForPlay,
-		m_sourcePath, m_userPath, Internal_UnboundedScene::MakeChunkFileName(chunkID)));
+	// If the chunk was removed from play but hasn't been saved and unloaded yet, its entities are still loaded.
+	// If it is resident out of play, it is promoted back into play when pending chunks are flushed. Otherwise, request
+	// that the chunk be loaded. If it was prefetched, it may already be loaded.
+	const size_t pendingRemovalIndex = m_chunksPendingRemoval.IndexOf(chunkID);
+	if (pendingRemovalIndex != m_chunksPendingRemoval.sk_InvalidIndex)
+	{
+		m_chunksPendingRemoval.Remove(pendingRemovalIndex, pendingRemovalIndex + 1);
+	}
+	else
+	{
+		m_chunksLoading.Add(chunkID);
+		if (!m_outOfPlayChunks.TryBeginPromotingChunk(chunkID))
+		{
+			m_chunkStreamer.RequestChunk(chunkID, loadPriority, false);
+		}
+	}
 
 	// If the chunk is in the transition zone, remove it.
 	m_transitionChunksToRefCounts.TryRemove(chunkID);
@@ -100,7 +132,21 @@ void UnboundedScene::RemoveChunkFromPlay(const ChunkID chunkID)
 		return;
 	}
 	m_chunksInPlay.SwapWithAndRemoveLast(chunkIndex);
-	m_chunksPendingRemoval.Add(chunkID);
+
+	// A chunk which hasn't finished loading has no entities to save, so its load is cancelled instead. A chunk which
+	// was being promoted from out of play stays resident. Entities which moved into the chunk while it was loading stay
+	// loaded until it is next removed from play after loading.
+	const size_t loadingIndex = m_chunksLoading.IndexOf(chunkID);
+	if (loadingIndex != m_chunksLoading.sk_InvalidIndex)
+	{
+		m_chunksLoading.SwapWithAndRemoveLast(loadingIndex);
+		m_chunkStreamer.CancelChunk(chunkID);
+		m_outOfPlayChunks.CancelPromotingChunk(chunkID);
+	}
+	else
+	{
+		m_chunksPendingRemoval.Add(chunkID);
+	}
 
 	// Decrement the reference counts of all adjacent transition chunks.
 	for (int16_t z = -1; z <= 1; ++z)
@@ -120,22 +166,30 @@ void UnboundedScene::RemoveChunkFromPlay(const ChunkID chunkID)
 	}
 }
 
-void UnboundedScene::Update(const Unit::Time::Millisecond delta,
-	const Collection::ArrayView<ECSGroupType>& ecsGroups,
-	Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions)
+void UnboundedScene::PrefetchChunk(const ChunkID chunkID, const float loadPriority)
 {
-	// Update the hash map with the location of all root entities.
-	m_spatialHashMap.Clear();
-	for (const auto& ecsGroup : ecsGroups)
+	// Chunks in play and chunks pending removal already have their entities loaded, and resident out-of-play chunks
+	// don't need to be loaded.
+	if (m_chunksInPlay.IndexOf(chunkID) != m_chunksInPlay.sk_InvalidIndex
+		|| m_chunksPendingRemoval.IndexOf(chunkID) != m_chunksPendingRemoval.sk_InvalidIndex
+		|| m_outOfPlayChunks.HasChunk(chunkID))
 	{
-		const ECS::Entity& entity = ecsGroup.Get<ECS::Entity>();
-		if (entity.GetParent() == nullptr)
-		{
-			const auto& sceneTransformComponent = ecsGroup.Get<const SceneTransformComponent>();
-			const Math::Vector3& position = sceneTransformComponent.m_modelToWorldMatrix.GetTranslation();
-			m_spatialHashMap[position] = &entity;
-		}
+		return;
 	}
+	m_chunkStreamer.RequestChunk(chunkID, loadPriority, true);
+}
+
+void UnboundedScene::AddOutOfPlaySimulationFunction(OutOfPlayChunkSimulation::SimulationFunction&& function)
+{
+	m_outOfPlayChunks.AddSimulationFunction(std::move(function));
+}
+
+void UnboundedScene::Update(const Unit::Time::Millisecond delta,
+	const Collection::ArrayView<ECSGroupType>& ecsGroups,
+	ECS::DeferredFunctionList& deferredFunctions)
+{
+	// Run the simplified simulation of the resident out-of-play chunks.
+	m_outOfPlayChunks.Update(delta);
 
 	// Apply all pending chunk changes.
 	deferredFunctions.Add([this](ECS::EntityManager& entityManager) { FlushPendingChunks(entityManager); });
@@ -143,130 +197,106 @@ void UnboundedScene::Update(const Unit::Time::Millisecond delta,
 
 void UnboundedScene::FlushPendingChunks(ECS::EntityManager& entityManager)
 {
+	// Move the root entities which were moved, created, deleted, or reparented since the last flush to the chunks
+	// they are now in, so that each chunk is saved with the entities in it.
+	m_spatialIndex.Update(entityManager);
+
+	// Chunks are serialized on this thread and written to disk by the chunk store's writer thread. There is a fixed
+	// amount of time that the scene will spend serializing chunks before the rest are deferred to the next frame.
+	constexpr size_t k_saveBudgetMicroseconds = 2000;
+	const auto saveDeadline = std::chrono::steady_clock::now() + std::chrono::microseconds(k_saveBudgetMicroseconds);
+	bool hasSaveBudget = true;
+
 	// Save and unload any unreferenced transition chunks.
 	m_transitionChunksToRefCounts.RemoveAllMatching([&](const Collection::Pair<ChunkID, ChunkRefCount>& entry)
 	{
-		if (entry.second < ChunkRefCount(1))
+		if (hasSaveBudget && entry.second < ChunkRefCount(1))
 		{
-			SaveChunkAndQueueEntitiesForUnload(entityManager, entry.first);
+			SaveChunkAndQueueEntitiesForUnload(entityManager, entry.first, true);
+			hasSaveBudget = (std::chrono::steady_clock::now() < saveDeadline);
 			return true;
 		}
 		return false;
 	});
 
-	// Save and unload any chunks pending removal.
-	for (const auto& chunkID : m_chunksPendingRemoval)
+	// Save and unload chunks pending removal in the order they were removed from play.
+	size_t numChunksRemoved = 0;
+	while (hasSaveBudget && numChunksRemoved < m_chunksPendingRemoval.Size())
 	{
-		SaveChunkAndQueueEntitiesForUnload(entityManager, chunkID);
+		SaveChunkAndQueueEntitiesForUnload(entityManager, m_chunksPendingRemoval[numChunksRemoved], true);
+		++numChunksRemoved;
+		hasSaveBudget = (std::chrono::steady_clock::now() < saveDeadline);
 	}
-	m_chunksPendingRemoval.Clear();
+	m_chunksPendingRemoval.Remove(0, numChunksRemoved);
 
-	// Unload all entities from chunks that were saved. This will invalidate pointers in m_spatialHashMap,
-	// so it should not be used at any further point of FlushPendingChunks.
+	// Unload all entities from chunks that were saved. They are removed from m_spatialIndex when it is next updated.
 	// TODO(scene) partial unloading support for RoPEs
-	entityManager.DeleteEntities(m_entitiesPendingUnload.GetConstView());
-	m_entitiesPendingUnload.Clear();
+	entityManager.ApplyCommandBuffer(m_unloadCommands);
 
-	// Synchronize with any chunks that are loading. There is a fixed amount of time that the scene
-	// will spend waiting for a chunk before it is deferred to the next frame.
-	if (m_chunkLoadingFutures.IsEmpty())
-	{
-		return;
-	}
-
-	constexpr size_t k_syncBudgetMilliseconds = 8;
-	constexpr size_t k_syncBudgetMicroseconds = k_syncBudgetMilliseconds * 1000;
+	// Create the entities of the chunks in play which are resident out of play or have finished loading. Chunks are
+	// never waited on: chunks which haven't finished loading are checked again next frame. There is a fixed amount of
+	// time that the scene will spend creating entities before the rest of the loaded chunks are deferred to the next
+	// frame.
+	constexpr size_t k_loadBudgetMicroseconds = 2000;
+	const auto loadDeadline = std::chrono::steady_clock::now() + std::chrono::microseconds(k_loadBudgetMicroseconds);
 
-	const std::chrono::microseconds waitPerFuture{ k_syncBudgetMicroseconds / m_chunkLoadingFutures.Size() };
-	for (size_t i = 0; i < m_chunkLoadingFutures.Size();)
+	ECS::SerializedEntitiesAndComponents chunk;
+	for (size_t i = 0; i < m_chunksLoading.Size();)
 	{
-		auto& future = m_chunkLoadingFutures[i];
-
-		const std::future_status status = future.wait_for(waitPerFuture);
-		AMP_FATAL_ASSERT(status != std::future_status::deferred, "Chunk loading should always be asynchronous.");
-
-		if (status == std::future_status::ready)
+		if (m_outOfPlayChunks.TryTakeChunk(m_chunksLoading[i], chunk)
+			|| m_chunkStreamer.TryTakeLoadedChunk(m_chunksLoading[i], chunk))
 		{
-			ECS::SerializedEntitiesAndComponents chunk = future.get();
 			entityManager.CreateEntitiesFromFullSerialization(chunk);
+			m_chunksLoading.SwapWithAndRemoveLast(i);
 
-			m_chunkLoadingFutures.SwapWithAndRemoveLast(i);
+			if (std::chrono::steady_clock::now() >= loadDeadline)
+			{
+				break;
+			}
 		}
 		else
 		{
 			++i;
 		}
 	}
+
+	// Prefetches which weren't renewed since the last flush are no longer ahead of any anchor.
+	m_chunkStreamer.CancelStalePrefetches();
 }
 
-void UnboundedScene::SaveChunkAndQueueEntitiesForUnload(ECS::EntityManager& entityManager, const ChunkID chunkID)
+void UnboundedScene::SaveChunkAndQueueEntitiesForUnload(
+	ECS::EntityManager& entityManager,
+	const ChunkID chunkID,
+	const bool isKeptResident)
 {
-	// Determine the entities that are in the chunk.
-	Math::Vector3 chunkOrigin, chunkCenter, chunkBound;
-	CalcChunkCoords(chunkID, chunkOrigin, chunkCenter, chunkBound);
-
-	const auto chunkBucketView = m_spatialHashMap.GetBucketView(chunkCenter);
-
-	Collection::Vector<const ECS::Entity*> entitiesInChunk;
-	for (size_t i = 0, iEnd = chunkBucketView.m_keys.Size(); i < iEnd; ++i)
+	// Find the root entities that are in the chunk.
+	const Collection::ArrayView<const ECS::EntityID> entityIDsInChunk =
+		m_spatialIndex.GetSpatialIndex().GetEntitiesInChunk(chunkID);
+
+	// The list of entities is only needed while saving the chunk, so it is allocated for the frame.
+	const ECS::Entity** const entitiesInChunk =
+		entityManager.GetFrameAllocator().AllocArray<const ECS::Entity*>(entityIDsInChunk.Size());
+	size_t numEntitiesInChunk = 0;
+	for (const auto& entityID : entityIDsInChunk)
 	{
-		const Math::Vector3& position = chunkBucketView.m_keys[i];
-		const ECS::Entity* const entity = chunkBucketView.m_values[i];
-
-		if (position.x >= chunkOrigin.x && position.y >= chunkOrigin.y && position.z >= chunkOrigin.z
-			&& position.x < chunkBound.x && position.y < chunkBound.y && position.z < chunkBound.z)
-		{
-			entitiesInChunk.Add(entity);
-		}
+		const ECS::Entity* const entity = entityManager.FindEntity(entityID);
+		AMP_FATAL_ASSERT(entity != nullptr, "Entities must be removed from the spatial index when they are deleted.");
+		entitiesInChunk[numEntitiesInChunk++] = entity;
 	}
 
-	// Save the chunk to its file.
-	std::ofstream fileOutput;
-	fileOutput.open(m_userPath / Internal_UnboundedScene::MakeChunkFileName(chunkID),
-		std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+	// Queue the chunk to be saved to its region file.
+	const Collection::ArrayView<const ECS::Entity* const> entitiesInChunkView{ entitiesInChunk, numEntitiesInChunk };
+	SaveInPlayChunk(chunkID, entityManager, entitiesInChunkView, m_chunkStore,
+		isKeptResident ? &m_outOfPlayChunks : nullptr);
 
-	AMP_ASSERT(fileOutput.good(), "Failed to open a chunk file for writing!");
+	// If the chunk was prefetched, the prefetched chunk is out of date.
+	m_chunkStreamer.CancelChunk(chunkID);
 
-	SaveInPlayChunk(chunkID, entityManager, entitiesInChunk, fileOutput);
-
-	fileOutput.flush();
-	fileOutput.close();
-
-	// Add the entities in the chunk to the list of entities to unload. Only root entities are in this list.
+	// Queue the entities in the chunk to be unloaded. Only root entities are queued.
 	// Non-root entities will be unloaded by their parents.
-	for (const auto& entity : entitiesInChunk)
+	for (const auto& entity : entitiesInChunkView)
 	{
-		m_entitiesPendingUnload.Add(entity->GetID());
+		m_unloadCommands.DeleteEntity(entity->GetID());
 	}
 }
-
-UnboundedScene::ChunkHashFunctor::ChunkHashFunctor()
-	: m_a()
-	, m_b()
-	, m_c()
-	, m_d()
-{
-	Rehash();
-}
-
-uint64_t UnboundedScene::ChunkHashFunctor::Hash(const Math::Vector3& position) const
-{
-	constexpr int64_t k_bucketSideLengthMetersShift = k_lgChunkSideLength;
-	const int64_t bucketX = static_cast<int64_t>(position.x) >> k_bucketSideLengthMetersShift;
-	const int64_t bucketY = static_cast<int64_t>(position.y) >> k_bucketSideLengthMetersShift;
-	const int64_t bucketZ = static_cast<int64_t>(position.z) >> k_bucketSideLengthMetersShift;
-
-	return static_cast<uint64_t>((bucketX * m_a) + (bucketY * m_b) + (bucketZ * m_c) + m_d);
-}
-
-void UnboundedScene::ChunkHashFunctor::Rehash()
-{
-	std::random_device device;
-	std::mt19937_64 generator{ device() };
-	std::uniform_int_distribution<int64_t> random;
-	m_a = random(generator) | 1;
-	m_b = random(generator) | 1;
-	m_c = random(generator) | 1;
-	m_d = random(generator) | 1;
-}
 }
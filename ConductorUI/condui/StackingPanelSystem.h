@@ -21,7 +21,7 @@ public:
 	void Update(
 		const Unit::Time::Millisecond delta,
 		const Collection::ArrayView<ECSGroupType>& ecsGroups,
-		Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions) const;
+		ECS::DeferredFunctionList& deferredFunctions) const;
 
 private:
 	void DeferredUpdate(ECS::EntityManager& entityManager, const Collection::ArrayView<ECSGroupType>& ecsGroups) const;
@@ -17,6 +17,6 @@ public:
 	void Update(
 		const Unit::Time::Millisecond delta,
 		const Collection::ArrayView<ECSGroupType>& ecsGroups,
-		Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions) const;
+		ECS::DeferredFunctionList& deferredFunctions) const;
 };
 }
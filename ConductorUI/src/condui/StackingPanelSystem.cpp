@@ -7,7 +7,7 @@ namespace Condui
 void StackingPanelSystem::Update(
 	const Unit::Time::Millisecond delta,
 	const Collection::ArrayView<ECSGroupType>& ecsGroups,
-	Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions) const
+	ECS::DeferredFunctionList& deferredFunctions) const
 {
 	// Defer the update to get access to the entity manager.
 	deferredFunctions.Add([this, ecsGroups](ECS::EntityManager& entityManager)
@@ -5,7 +5,7 @@ namespace Condui
 void TextDisplayUpdateSystem::Update(
 	const Unit::Time::Millisecond delta,
 	const Collection::ArrayView<ECSGroupType>& ecsGroups,
-	Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions) const
+	ECS::DeferredFunctionList& deferredFunctions) const
 {
 	for (const auto& ecsGroup : ecsGroups)
 	{
@@ -63,7 +63,7 @@ TextInputSystem::TextInputSystem(const Math::Frustum& sceneViewFrustum,
 
 void TextInputSystem::Update(const Unit::Time::Millisecond delta,
 	const Collection::ArrayView<ECSGroupType>& ecsGroups,
-	Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions)
+	ECS::DeferredFunctionList& deferredFunctions)
 {
 	using namespace Internal_TextInputSystem;
 
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <input/InputStateBuffer.h>
+#include <math/Matrix4x4.h>
+#include <unit/Time.h>
+#include <util/StringHash.h>
+
+namespace IslandGame
+{
+// The inputs which move a client's avatar across the ground.
+constexpr const char* k_moveForwardInputName = "move_forward";
+constexpr const char* k_moveBackwardInputName = "move_backward";
+constexpr const char* k_moveLeftInputName = "move_left";
+constexpr const char* k_moveRightInputName = "move_right";
+
+constexpr float k_avatarSpeedMetersPerSecond = 4.0f;
+
+// Move an avatar by the movement inputs which are held for delta. findInput returns the InputStateBuffer of the input
+// with the given name hash, or nullptr if there is none. The host moves avatars with this and clients predict their
+// avatar with it, so that the prediction matches the host.
+template <typename FindInputFn>
+void MoveAvatar(FindInputFn&& findInput, const Unit::Time::Millisecond delta, Math::Matrix4x4& modelToWorldMatrix);
+}
+
+// Inline implementations.
+namespace IslandGame
+{
+template <typename FindInputFn>
+inline void MoveAvatar(FindInputFn&& findInput,
+	const Unit::Time::Millisecond delta,
+	Math::Matrix4x4& modelToWorldMatrix)
+{
+	// An input is held if its latest state is pressed.
+	const auto calcHeldValue = [&](const char* const inputName)
+	{
+		const Input::InputStateBuffer* const inputStateBuffer = findInput(Util::CalcHash(inputName));
+		return (inputStateBuffer != nullptr && inputStateBuffer->m_count > 0
+			&& inputStateBuffer->m_values[inputStateBuffer->m_count - 1] > 0.5f) ? 1.0f : 0.0f;
+	};
+
+	const float forward = calcHeldValue(k_moveForwardInputName) - calcHeldValue(k_moveBackwardInputName);
+	const float right = calcHeldValue(k_moveRightInputName) - calcHeldValue(k_moveLeftInputName);
+	if (forward == 0.0f && right == 0.0f)
+	{
+		return;
+	}
+
+	const float distance = k_avatarSpeedMetersPerSecond * (static_cast<float>(delta.GetN()) / 1000.0f);
+	const Math::Vector3& translation = modelToWorldMatrix.GetTranslation();
+	modelToWorldMatrix.SetTranslation(
+		translation.x + (right * distance), translation.y, translation.z + (forward * distance));
+}
+}
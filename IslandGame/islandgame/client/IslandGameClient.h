@@ -14,5 +14,10 @@ public:
 	IslandGameClient(const IslandGameData& gameData, ::Client::ConnectedHost& connectedHost);
 
 	void Update(const Unit::Time::Millisecond delta) override;
+
+protected:
+	void PredictControlledEntity(ECS::Entity& entity,
+		const Input::InputStateManager& inputStates,
+		const Unit::Time::Millisecond delta) override;
 };
 }
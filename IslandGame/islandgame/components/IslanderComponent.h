@@ -24,6 +24,7 @@ public:
 		: Component(id)
 	{}
 
+	// How long the islander has gone without eating and sleeping, in milliseconds.
 	int32_t m_hunger{ 0 };
 	int32_t m_tiredness{ 0 };
 };
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <ecs/System.h>
+#include <input/InputComponent.h>
+#include <scene/SceneTransformComponent.h>
+
+namespace IslandGame::Host
+{
+/**
+ * The AvatarMovementSystem moves the avatars of clients by their movement inputs.
+ */
+class AvatarMovementSystem final : public ECS::SystemTempl<
+	Util::TypeList<Input::InputComponent>,
+	Util::TypeList<Scene::SceneTransformComponent>>
+{
+public:
+	AvatarMovementSystem() = default;
+	virtual ~AvatarMovementSystem() {}
+
+	void Update(const Unit::Time::Millisecond delta,
+		const Collection::ArrayView<ECSGroupType>& ecsGroups,
+		ECS::DeferredFunctionList& deferredFunctions);
+};
+}
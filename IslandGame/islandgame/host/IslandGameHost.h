@@ -1,5 +1,6 @@
 #pragma once
 
+#include <collection/VectorMap.h>
 #include <host/IHost.h>
 
 namespace IslandGame { class IslandGameData; }
@@ -9,11 +10,17 @@ namespace IslandGame::Host
 class IslandGameHost : public ::Host::IHost
 {
 	const IslandGameData& m_gameData;
+	// The entity each connected client controls.
+	Collection::VectorMap<::Client::ClientID, ECS::EntityID> m_clientAvatarIDs;
 
 public:
 	IslandGameHost(const IslandGameData& gameData);
 	~IslandGameHost();
 
 	void Update(const Unit::Time::Millisecond delta) override;
+
+protected:
+	void HandleClientConnected(const ::Client::ClientID clientID) override;
+	void HandleClientDisconnected(const ::Client::ClientID clientID) override;
 };
 }
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <islandgame/components/IslanderComponent.h>
+
+#include <ecs/SerializedEntitiesAndComponents.h>
+#include <ecs/System.h>
+#include <scene/ChunkID.h>
+
+namespace IslandGame::Host
+{
+/**
+ * The IslanderNeedsSystem makes islanders hungrier and more tired as time passes. Islanders in chunks which are out of
+ * play are simulated by SimulateOutOfPlayChunk, which updates their serialized components in place, so that their
+ * needs keep growing while nobody is near them.
+ */
+class IslanderNeedsSystem final : public ECS::SystemTempl<
+	Util::TypeList<>,
+	Util::TypeList<Components::IslanderComponent>>
+{
+public:
+	IslanderNeedsSystem() = default;
+	virtual ~IslanderNeedsSystem() {}
+
+	void Update(const Unit::Time::Millisecond delta,
+		const Collection::ArrayView<ECSGroupType>& ecsGroups,
+		ECS::DeferredFunctionList& deferredFunctions);
+
+	// An out-of-play simulation of the islanders in a serialized chunk. Returns true if the chunk had islanders.
+	static bool SimulateOutOfPlayChunk(const Scene::ChunkID chunkID,
+		const Unit::Time::Millisecond elapsedTime,
+		ECS::SerializedEntitiesAndComponents& serialization);
+};
+}
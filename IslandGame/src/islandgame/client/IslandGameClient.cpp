@@ -1,5 +1,6 @@
 #include <islandgame/client/IslandGameClient.h>
 
+#include <islandgame/AvatarMovement.h>
 #include <islandgame/IslandGameData.h>
 
 #include <asset/AssetManager.h>
@@ -28,15 +29,21 @@ IslandGame::Client::IslandGameClient::IslandGameClient(
 		Util::CalcHash("mouse_x"));
 	m_inputStateManager.SetInputName({ Input::InputSource::k_mouseID, Input::InputSource::k_mouseAxisY },
 		Util::CalcHash("mouse_y"));
+	m_inputStateManager.SetInputName(Input::Sources::Key('w'), Util::CalcHash(k_moveForwardInputName));
+	m_inputStateManager.SetInputName(Input::Sources::Key('s'), Util::CalcHash(k_moveBackwardInputName));
+	m_inputStateManager.SetInputName(Input::Sources::Key('a'), Util::CalcHash(k_moveLeftInputName));
+	m_inputStateManager.SetInputName(Input::Sources::Key('d'), Util::CalcHash(k_moveRightInputName));
 
 	const Behave::BehaveContext context{
 		m_gameData.GetBehaveASTInterpreter(),
 		m_entityManager };
 	m_entityManager.RegisterSystem(Mem::MakeUnique<Behave::BehaviourTreeEvaluationSystem>(context));
 
-	m_entityManager.RegisterSystem(Mem::MakeUnique<Scene::RelativeTransformSystem>());
+	// These systems only touch their components, so they are scheduled automatically.
+	m_entityManager.RegisterSystem(Mem::MakeUnique<Scene::RelativeTransformSystem>(), ECS::SystemScheduling::Automatic);
 	// SkeletonMatrixCollectionSystem depends on the output of RelativeTransformSystem.
-	m_entityManager.RegisterSystem(Mem::MakeUnique<Mesh::SkeletonMatrixCollectionSystem>());
+	m_entityManager.RegisterSystem(
+		Mem::MakeUnique<Mesh::SkeletonMatrixCollectionSystem>(), ECS::SystemScheduling::Automatic);
 
 	const Mesh::TriangleMesh& cubes = *gameData.GetAssetManager().RequestAsset<Mesh::TriangleMesh>(
 		File::MakePath("meshes/cubes.fbx"), Asset::LoadingMode::Immediate).TryGetAsset();
@@ -140,3 +147,16 @@ void IslandGame::Client::IslandGameClient::Update(const Unit::Time::Millisecond
 	
 	m_entityManager.Update(delta);
 }
+
+void IslandGame::Client::IslandGameClient::PredictControlledEntity(ECS::Entity& entity,
+	const Input::InputStateManager& inputStates,
+	const Unit::Time::Millisecond delta)
+{
+	// The controlled entity is the client's avatar, which the host moves with the same function.
+	auto* const transformComponent = m_entityManager.FindComponent<Scene::SceneTransformComponent>(entity);
+	if (transformComponent != nullptr)
+	{
+		MoveAvatar([&](const Util::StringHash nameHash) { return inputStates.FindNamedInput(nameHash); },
+			delta, transformComponent->m_modelToWorldMatrix);
+	}
+}
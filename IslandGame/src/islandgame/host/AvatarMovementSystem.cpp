@@ -0,0 +1,29 @@
+#include <islandgame/host/AvatarMovementSystem.h>
+
+#include <islandgame/AvatarMovement.h>
+
+namespace IslandGame::Host
+{
+void AvatarMovementSystem::Update(const Unit::Time::Millisecond delta,
+	const Collection::ArrayView<ECSGroupType>& ecsGroups,
+	ECS::DeferredFunctionList& deferredFunctions)
+{
+	for (const auto& ecsGroup : ecsGroups)
+	{
+		const Input::InputComponent& inputComponent = ecsGroup.Get<const Input::InputComponent>();
+		Scene::SceneTransformComponent& transformComponent = ecsGroup.Get<Scene::SceneTransformComponent>();
+
+		const auto findInput = [&](const Util::StringHash nameHash) -> const Input::InputStateBuffer*
+		{
+			const auto iter = inputComponent.m_inputMap.Find(nameHash);
+			return (iter != inputComponent.m_inputMap.end()) ? &iter->second : nullptr;
+		};
+		const Math::Vector3 previousTranslation = transformComponent.m_modelToWorldMatrix.GetTranslation();
+		MoveAvatar(findInput, delta, transformComponent.m_modelToWorldMatrix);
+		if (transformComponent.m_modelToWorldMatrix.GetTranslation() != previousTranslation)
+		{
+			MarkChanged(transformComponent);
+		}
+	}
+}
+}
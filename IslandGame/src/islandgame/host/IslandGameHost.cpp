@@ -1,14 +1,20 @@
 #include <islandgame/host/IslandGameHost.h>
 
+#include <islandgame/AvatarMovement.h>
 #include <islandgame/IslandGameData.h>
+#include <islandgame/host/AvatarMovementSystem.h>
+#include <islandgame/host/IslanderNeedsSystem.h>
 
 #include <asset/AssetManager.h>
 #include <behave/BehaveContext.h>
 #include <behave/BehaviourTreeEvaluationSystem.h>
+#include <host/HostNetworkWorld.h>
+#include <input/InputComponent.h>
 #include <input/InputSystem.h>
 #include <mesh/MeshComponent.h>
 #include <mesh/SkeletonMatrixCollectionSystem.h>
 #include <mesh/SkeletonSystem.h>
+#include <scene/AnchorComponent.h>
 #include <scene/RelativeTransformSystem.h>
 #include <scene/SceneAnchorSystem.h>
 #include <scene/UnboundedScene.h>
@@ -33,13 +39,25 @@ IslandGame::Host::IslandGameHost::IslandGameHost(const IslandGameData& gameData)
 		gameData.GetDataDirectory() / k_chunkSourceDirectory,
 		gameData.GetUserDirectory() / k_chunkUserDirectory));
 
+	// SceneAnchorSystem shares the scene's state, so it keeps the default exclusive scheduling like the scene.
 	m_entityManager.RegisterSystem(Mem::MakeUnique<Scene::SceneAnchorSystem>(scene));
 
+	// The systems below only touch their components, so they are scheduled automatically. Islanders' needs don't
+	// conflict with avatar movement, so those two systems run concurrently.
+
+	// Islanders keep getting hungrier and more tired when they are out of play, just at a lower rate of updates.
+	m_entityManager.RegisterSystem(Mem::MakeUnique<IslanderNeedsSystem>(), ECS::SystemScheduling::Automatic);
+	scene.AddOutOfPlaySimulationFunction(&IslanderNeedsSystem::SimulateOutOfPlayChunk);
+
+	// Avatars are moved before RelativeTransformSystem runs so that their children follow them this update.
+	m_entityManager.RegisterSystem(Mem::MakeUnique<AvatarMovementSystem>(), ECS::SystemScheduling::Automatic);
+
 	// SkeletonSystem produces an entity hierarchy which should happen before RelativeTransformSystem runs.
-	m_entityManager.RegisterSystem(Mem::MakeUnique<Mesh::SkeletonSystem>());
-	m_entityManager.RegisterSystem(Mem::MakeUnique<Scene::RelativeTransformSystem>());
+	m_entityManager.RegisterSystem(Mem::MakeUnique<Mesh::SkeletonSystem>(), ECS::SystemScheduling::Automatic);
+	m_entityManager.RegisterSystem(Mem::MakeUnique<Scene::RelativeTransformSystem>(), ECS::SystemScheduling::Automatic);
 	// SkeletonMatrixCollectionSystem depends on the output of RelativeTransformSystem.
-	m_entityManager.RegisterSystem(Mem::MakeUnique<Mesh::SkeletonMatrixCollectionSystem>());
+	m_entityManager.RegisterSystem(
+		Mem::MakeUnique<Mesh::SkeletonMatrixCollectionSystem>(), ECS::SystemScheduling::Automatic);
 }
 
 IslandGame::Host::IslandGameHost::~IslandGameHost()
@@ -72,3 +90,62 @@ void IslandGame::Host::IslandGameHost::Update(const Unit::Time::Millisecond delt
 
 	m_entityManager.Update(delta);
 }
+
+void IslandGame::Host::IslandGameHost::HandleClientConnected(const ::Client::ClientID clientID)
+{
+	// The local admin client observes the whole scene rather than playing in it, so it isn't given an avatar.
+	if (clientID == ::Host::HostNetworkWorld::k_localClientID)
+	{
+		return;
+	}
+
+	Asset::AssetManager& assetManager = m_gameData.GetAssetManager();
+
+	// Give the client an avatar which receives its input and keeps the scene around it in play.
+	const auto avatarComponents = { Scene::SceneTransformComponent::k_type,
+		Mesh::MeshComponent::k_type,
+		Mesh::SkeletonRootComponent::k_type,
+		Input::InputComponent::k_type,
+		Scene::AnchorComponent::k_type };
+
+	ECS::Entity& avatar = m_entityManager.CreateEntityWithComponents(
+		{ avatarComponents.begin(), avatarComponents.size() }, ECS::EntityFlags::Networked, ECS::EntityLayer());
+
+	auto& meshComponent = *m_entityManager.FindComponent<Mesh::MeshComponent>(avatar);
+	meshComponent.m_meshHandle =
+		assetManager.RequestAsset<Mesh::TriangleMesh>(File::MakePath("meshes/offset-root-bone.fbx"));
+
+	auto& sceneTransformComponent = *m_entityManager.FindComponent<Scene::SceneTransformComponent>(avatar);
+	sceneTransformComponent.m_modelToWorldMatrix =
+		Math::Matrix4x4::MakeTranslation(clientID.GetN() * 2.0f, 0.0f, -4.0f);
+
+	auto& inputComponent = *m_entityManager.FindComponent<Input::InputComponent>(avatar);
+	inputComponent.m_clientID = clientID;
+	for (const char* const inputName : { k_moveForwardInputName,
+		k_moveBackwardInputName,
+		k_moveLeftInputName,
+		k_moveRightInputName })
+	{
+		inputComponent.m_inputMap[Util::CalcHash(inputName)];
+	}
+
+	// The client is only sent the entities near its avatar, which are the entities the avatar keeps in play.
+	const auto& anchorComponent = *m_entityManager.FindComponent<Scene::AnchorComponent>(avatar);
+	SetClientFocusEntity(clientID, avatar.GetID(), anchorComponent.m_anchoringRadiusInChunks);
+
+	m_clientAvatarIDs[clientID] = avatar.GetID();
+}
+
+void IslandGame::Host::IslandGameHost::HandleClientDisconnected(const ::Client::ClientID clientID)
+{
+	const auto iter = m_clientAvatarIDs.Find(clientID);
+	if (iter == m_clientAvatarIDs.end())
+	{
+		return;
+	}
+
+	ClearClientFocusEntity(clientID);
+	const ECS::EntityID avatarID = iter->second;
+	m_entityManager.DeleteEntities({ &avatarID, 1 });
+	m_clientAvatarIDs.TryRemove(clientID);
+}
@@ -0,0 +1,88 @@
+#include <islandgame/host/IslanderNeedsSystem.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace Internal_IslanderNeedsSystem
+{
+// Hunger and tiredness are how long an islander has gone without eating and sleeping, in milliseconds. They stop
+// growing after a day so that islanders left alone for a long time don't overflow them.
+constexpr int32_t k_maxNeedMilliseconds = 24 * 60 * 60 * 1000;
+
+int32_t AddToNeed(const int32_t need, const Unit::Time::Millisecond elapsedTime)
+{
+	const uint64_t grownNeed = static_cast<uint64_t>((std::max)(need, 0)) + elapsedTime.GetN();
+	return static_cast<int32_t>((std::min)(grownNeed, static_cast<uint64_t>(k_maxNeedMilliseconds)));
+}
+
+// Returns true if either of the islander's needs changed.
+bool AdvanceIslanderNeeds(IslandGame::Components::IslanderComponent& islander,
+	const Unit::Time::Millisecond elapsedTime)
+{
+	const int32_t hunger = AddToNeed(islander.m_hunger, elapsedTime);
+	const int32_t tiredness = AddToNeed(islander.m_tiredness, elapsedTime);
+	const bool isChanged = (hunger != islander.m_hunger) || (tiredness != islander.m_tiredness);
+	islander.m_hunger = hunger;
+	islander.m_tiredness = tiredness;
+	return isChanged;
+}
+}
+
+namespace IslandGame::Host
+{
+void IslanderNeedsSystem::Update(const Unit::Time::Millisecond delta,
+	const Collection::ArrayView<ECSGroupType>& ecsGroups,
+	ECS::DeferredFunctionList& deferredFunctions)
+{
+	using namespace Internal_IslanderNeedsSystem;
+
+	for (const auto& ecsGroup : ecsGroups)
+	{
+		Components::IslanderComponent& islander = ecsGroup.Get<Components::IslanderComponent>();
+		if (AdvanceIslanderNeeds(islander, delta))
+		{
+			MarkChanged(islander);
+		}
+	}
+}
+
+bool IslanderNeedsSystem::SimulateOutOfPlayChunk(const Scene::ChunkID chunkID,
+	const Unit::Time::Millisecond elapsedTime,
+	ECS::SerializedEntitiesAndComponents& serialization)
+{
+	using namespace Internal_IslanderNeedsSystem;
+
+	// The islanders are found directly rather than with FindOrCreateComponentsEntry, which would add an empty entry to
+	// chunks without islanders.
+	for (auto& entry : serialization.m_components)
+	{
+		if (entry.first != Components::IslanderComponent::k_type)
+		{
+			continue;
+		}
+
+		// Islanders are memory imaged, so each is read and advanced, then written back after its header if it changed.
+		ECS::SerializedBytesWithViews& islanders = entry.second;
+		bool isModified = false;
+		Components::IslanderComponent islander{ ECS::ComponentID() };
+		for (const auto& view : islanders.m_views)
+		{
+			const size_t componentBeginIndex = view.m_beginIndex + ECS::FullSerializedComponentHeader::k_unpaddedSize;
+			if (componentBeginIndex + sizeof(Components::IslanderComponent) > view.m_endIndex)
+			{
+				continue;
+			}
+
+			uint8_t* const componentBytes = &islanders.m_bytes[componentBeginIndex];
+			memcpy(&islander, componentBytes, sizeof(Components::IslanderComponent));
+			if (AdvanceIslanderNeeds(islander, elapsedTime))
+			{
+				memcpy(componentBytes, &islander, sizeof(Components::IslanderComponent));
+				isModified = true;
+			}
+		}
+		return isModified;
+	}
+	return false;
+}
+}
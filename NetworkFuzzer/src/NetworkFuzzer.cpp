@@ -0,0 +1,432 @@
+#include <collection/ArrayView.h>
+#include <collection/ProgramParameters.h>
+#include <collection/Vector.h>
+#include <dev/Dev.h>
+#include <mem/SerializeLittleEndian.h>
+#include <network/DeltaCompression.h>
+#include <network/MessageFraming.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <random>
+#include <string>
+
+namespace Internal_NetworkFuzzer
+{
+using namespace Network;
+
+// The largest buffer that malformed input is decompressed into.
+constexpr size_t k_maxFrameSize = 256 * 1024;
+
+void FillRandomBytes(std::mt19937_64& random, Collection::Vector<uint8_t>& outBytes, const size_t count)
+{
+	outBytes.Clear();
+	outBytes.Resize(static_cast<uint32_t>(count));
+	for (auto& byte : outBytes)
+	{
+		byte = static_cast<uint8_t>(random());
+	}
+}
+
+// Produce the next frame of a transmission by changing some runs of bytes of the last frame and changing its size,
+// which is what frames of serialized components look like from one transmission to the next.
+void MakeNextFrame(std::mt19937_64& random,
+	const Collection::Vector<uint8_t>& lastFrame,
+	Collection::Vector<uint8_t>& outFrame)
+{
+	outFrame.Clear();
+	outFrame.AddAll(lastFrame.GetConstView());
+
+	switch (random() % 4)
+	{
+	case 0:
+	{
+		// Shrink the frame.
+		outFrame.Resize(static_cast<uint32_t>(random() % (outFrame.Size() + 1)));
+		break;
+	}
+	case 1:
+	{
+		// Grow the frame.
+		const size_t growth = random() % 1024;
+		for (size_t i = 0; i < growth; ++i)
+		{
+			outFrame.Add(static_cast<uint8_t>(random()));
+		}
+		break;
+	}
+	default:
+	{
+		break;
+	}
+	}
+
+	const size_t numChangedRuns = outFrame.IsEmpty() ? 0 : (random() % 16);
+	for (size_t i = 0; i < numChangedRuns; ++i)
+	{
+		const size_t runBegin = random() % outFrame.Size();
+		const size_t runLength = 1 + (random() % 300);
+		for (size_t j = runBegin; j < outFrame.Size() && j < (runBegin + runLength); ++j)
+		{
+			outFrame[j] = static_cast<uint8_t>(random());
+		}
+	}
+}
+
+// Decompress the given bytes into a buffer of exactly the given capacity so that writing past the capacity is caught.
+// Returns true if decompression succeeded and consumed the compressed bytes up to the returned iterator.
+bool TryDecompressInto(const Collection::Vector<uint8_t>& lastSeenBytes,
+	const uint8_t* const compressedBytesBegin,
+	const uint8_t* const compressedBytesEnd,
+	const size_t capacity,
+	Collection::Vector<uint8_t>& outBytes,
+	const uint8_t*& outCompressedIter)
+{
+	outBytes.Clear();
+	outBytes.Resize(static_cast<uint32_t>(capacity));
+
+	Collection::ArrayView<uint8_t> decompressedBytes{ outBytes.begin(), outBytes.Size() };
+	outCompressedIter = compressedBytesBegin;
+	const bool succeeded = DeltaCompression::TryDecompress(
+		lastSeenBytes.GetConstView(), outCompressedIter, compressedBytesEnd, decompressedBytes);
+
+	if (outCompressedIter < compressedBytesBegin || outCompressedIter > compressedBytesEnd)
+	{
+		printf("TryDecompress moved the compressed bytes iterator out of bounds.\n");
+		return false;
+	}
+	if (decompressedBytes.begin() != outBytes.begin() || decompressedBytes.Size() > capacity)
+	{
+		printf("TryDecompress returned decompressed bytes outside of the buffer it was given.\n");
+		return false;
+	}
+
+	outBytes.Resize(static_cast<uint32_t>(decompressedBytes.Size()));
+	return succeeded;
+}
+
+// Compress a frame, check that it decompresses to itself, and check that every truncation of the compressed bytes
+// is rejected. Returns false if a check failed.
+bool CheckRoundTrip(const Collection::Vector<uint8_t>& lastSeenBytes,
+	const Collection::Vector<uint8_t>& currentBytes,
+	const DeltaCompression::Format format,
+	Collection::Vector<uint8_t>& compressedBytes,
+	Collection::Vector<uint8_t>& decompressedBytes)
+{
+	compressedBytes.Clear();
+	DeltaCompression::Compress(lastSeenBytes.GetConstView(), currentBytes.GetConstView(), compressedBytes, format);
+
+	const uint8_t* const compressedBegin = compressedBytes.begin();
+	const uint8_t* const compressedEnd = compressedBytes.end();
+	const uint8_t* compressedIter = nullptr;
+	if (!TryDecompressInto(lastSeenBytes, compressedBegin, compressedEnd, currentBytes.Size(), decompressedBytes,
+		compressedIter))
+	{
+		printf("Failed to decompress a frame of [%u] bytes.\n", currentBytes.Size());
+		return false;
+	}
+	if (compressedIter != compressedEnd)
+	{
+		printf("Decompression consumed [%zu] of [%u] compressed bytes.\n",
+			static_cast<size_t>(compressedIter - compressedBegin), compressedBytes.Size());
+		return false;
+	}
+	if (decompressedBytes.Size() != currentBytes.Size()
+		|| memcmp(decompressedBytes.begin(), currentBytes.begin(), currentBytes.Size()) != 0)
+	{
+		printf("A frame of [%u] bytes didn't decompress to itself.\n", currentBytes.Size());
+		return false;
+	}
+
+	// Compressed bytes which are cut off must never decompress. Only some truncations of large frames are checked.
+	const size_t truncationStep = 1 + (compressedBytes.Size() / 64);
+	for (size_t truncatedSize = 0; truncatedSize < compressedBytes.Size(); truncatedSize += truncationStep)
+	{
+		if (TryDecompressInto(lastSeenBytes, compressedBegin, compressedBegin + truncatedSize, currentBytes.Size(),
+			decompressedBytes, compressedIter))
+		{
+			printf("Compressed bytes truncated to [%zu] of [%u] bytes decompressed.\n",
+				truncatedSize, compressedBytes.Size());
+			return false;
+		}
+	}
+	return true;
+}
+
+// Decompress random bytes and randomly corrupted compressed bytes. The decoder may accept or reject them, but must
+// stay within the bounds it was given.
+bool CheckMalformedInput(std::mt19937_64& random,
+	const Collection::Vector<uint8_t>& lastSeenBytes,
+	Collection::Vector<uint8_t>& compressedBytes,
+	Collection::Vector<uint8_t>& decompressedBytes)
+{
+	if (compressedBytes.IsEmpty() || (random() % 4) == 0)
+	{
+		FillRandomBytes(random, compressedBytes, random() % 512);
+
+		// Random bytes rarely begin with one of the format markers, so make sure both formats are reached.
+		if (compressedBytes.Size() >= 2 && (random() % 2) == 0)
+		{
+			compressedBytes[0] = 0xFE;
+			compressedBytes[1] = 0xFF;
+		}
+	}
+	else
+	{
+		const size_t numCorruptedBytes = 1 + (random() % 8);
+		for (size_t i = 0; i < numCorruptedBytes; ++i)
+		{
+			compressedBytes[random() % compressedBytes.Size()] = static_cast<uint8_t>(random());
+		}
+	}
+
+	const uint8_t* compressedIter = nullptr;
+	const size_t capacity = random() % k_maxFrameSize;
+	TryDecompressInto(lastSeenBytes, compressedBytes.begin(), compressedBytes.end(), capacity, decompressedBytes,
+		compressedIter);
+	return compressedIter >= compressedBytes.begin() && compressedIter <= compressedBytes.end();
+}
+
+bool FuzzDeltaCompression(std::mt19937_64& random, const uint64_t numIterations)
+{
+	Collection::Vector<uint8_t> lastFrame;
+	Collection::Vector<uint8_t> frame;
+	Collection::Vector<uint8_t> compressedBytes;
+	Collection::Vector<uint8_t> decompressedBytes;
+
+	for (uint64_t i = 0; i < numIterations; ++i)
+	{
+		// Start a new transmission every so often so that frames don't only grow or shrink.
+		if ((i % 64) == 0)
+		{
+			FillRandomBytes(random, lastFrame, random() % (k_maxFrameSize / 8));
+		}
+		MakeNextFrame(random, lastFrame, frame);
+
+		if (!CheckRoundTrip(lastFrame, frame, DeltaCompression::Format::Wide, compressedBytes, decompressedBytes))
+		{
+			return false;
+		}
+		if (frame.Size() < (UINT16_MAX - 1)
+			&& !CheckRoundTrip(lastFrame, frame, DeltaCompression::Format::Bytewise, compressedBytes,
+				decompressedBytes))
+		{
+			return false;
+		}
+		if (!CheckMalformedInput(random, lastFrame, compressedBytes, decompressedBytes))
+		{
+			return false;
+		}
+
+		std::swap(lastFrame, frame);
+	}
+	return true;
+}
+
+void BenchmarkDeltaCompression(std::mt19937_64& random, const DeltaCompression::Format format, const char* name)
+{
+	constexpr size_t k_frameSize = 60 * 1024;
+	constexpr size_t k_numFrames = 2000;
+
+	Collection::Vector<uint8_t> lastFrame;
+	FillRandomBytes(random, lastFrame, k_frameSize);
+
+	// Most of each frame is unchanged, as is typical of ECS transmissions.
+	Collection::Vector<uint8_t> frame;
+	frame.AddAll(lastFrame.GetConstView());
+	for (size_t i = 0; i < (k_frameSize / 100); ++i)
+	{
+		frame[random() % frame.Size()] = static_cast<uint8_t>(random());
+	}
+
+	Collection::Vector<uint8_t> compressedBytes;
+	Collection::Vector<uint8_t> decompressedBytes;
+	decompressedBytes.Resize(k_frameSize);
+
+	const auto compressBegin = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < k_numFrames; ++i)
+	{
+		compressedBytes.Clear();
+		DeltaCompression::Compress(lastFrame.GetConstView(), frame.GetConstView(), compressedBytes, format);
+	}
+	const auto compressEnd = std::chrono::steady_clock::now();
+
+	for (size_t i = 0; i < k_numFrames; ++i)
+	{
+		const uint8_t* compressedIter = compressedBytes.begin();
+		Collection::ArrayView<uint8_t> outBytes{ decompressedBytes.begin(), decompressedBytes.Size() };
+		DeltaCompression::TryDecompress(lastFrame.GetConstView(), compressedIter, compressedBytes.end(), outBytes);
+	}
+	const auto decompressEnd = std::chrono::steady_clock::now();
+
+	const double numMegabytes = static_cast<double>(k_frameSize * k_numFrames) / (1024.0 * 1024.0);
+	const double compressSeconds = std::chrono::duration<double>(compressEnd - compressBegin).count();
+	const double decompressSeconds = std::chrono::duration<double>(decompressEnd - compressEnd).count();
+	printf("%s: compressed %u bytes to %u bytes, compress %.0f MiB/s, decompress %.0f MiB/s\n",
+		name, frame.Size(), compressedBytes.Size(), numMegabytes / compressSeconds, numMegabytes / decompressSeconds);
+}
+
+// Receive the given bytes into a reassembler in pieces of random sizes, popping the complete frames after each piece.
+// Returns false if a popped frame was outside of the reassembler's buffer.
+bool ReceiveInPieces(std::mt19937_64& random,
+	const Collection::Vector<uint8_t>& bytes,
+	FrameReassembler& reassembler,
+	Collection::Vector<Collection::Vector<uint8_t>>& outFrames)
+{
+	size_t numBytesReceived = 0;
+	while (numBytesReceived < bytes.Size() && !reassembler.HasInvalidFrame())
+	{
+		Collection::ArrayView<uint8_t> receiveBuffer = reassembler.GetReceiveBuffer();
+		size_t numBytes = 1 + (random() % (2 * FrameReassembler::k_minReceiveBufferSize));
+		numBytes = (numBytes < receiveBuffer.Size()) ? numBytes : receiveBuffer.Size();
+		numBytes = (numBytes < (bytes.Size() - numBytesReceived)) ? numBytes : (bytes.Size() - numBytesReceived);
+		memcpy(receiveBuffer.begin(), bytes.begin() + numBytesReceived, numBytes);
+		reassembler.NotifyOfBytesReceived(numBytes);
+		numBytesReceived += numBytes;
+
+		const uint8_t* const receiveBufferEnd = receiveBuffer.begin() + receiveBuffer.Size();
+		Collection::ArrayView<const uint8_t> frame{ nullptr, 0 };
+		while (reassembler.TryPopFrame(frame))
+		{
+			if (frame.Size() > 0 && (frame.begin() + frame.Size()) > receiveBufferEnd)
+			{
+				printf("A popped frame extends past the end of the reassembler's buffer.\n");
+				return false;
+			}
+			outFrames.Emplace().AddAll(frame);
+		}
+	}
+	return true;
+}
+
+bool FuzzMessageFraming(std::mt19937_64& random, const uint64_t numIterations)
+{
+	constexpr size_t k_maxTestFrameSize = 1024 * 1024;
+
+	Collection::Vector<Collection::Vector<uint8_t>> sentFrames;
+	Collection::Vector<Collection::Vector<uint8_t>> receivedFrames;
+	Collection::Vector<uint8_t> streamBytes;
+	Collection::Vector<uint8_t> frameBytes;
+
+	for (uint64_t i = 0; i < numIterations; ++i)
+	{
+		// Frames split across pieces of the stream must be reassembled exactly.
+		sentFrames.Clear();
+		streamBytes.Clear();
+		const size_t numFrames = 1 + (random() % 8);
+		for (size_t j = 0; j < numFrames; ++j)
+		{
+			const size_t frameSize = ((random() % 16) == 0) ? (random() % k_maxTestFrameSize) : (random() % 512);
+			FillRandomBytes(random, frameBytes, frameSize);
+			sentFrames.Emplace().AddAll(frameBytes.GetConstView());
+
+			const size_t headerIndex = MessageFraming::BeginFrame(streamBytes);
+			streamBytes.AddAll(frameBytes.GetConstView());
+			MessageFraming::FinishFrame(headerIndex, streamBytes);
+		}
+
+		FrameReassembler reassembler{ k_maxTestFrameSize };
+		receivedFrames.Clear();
+		if (!ReceiveInPieces(random, streamBytes, reassembler, receivedFrames))
+		{
+			return false;
+		}
+		if (reassembler.HasInvalidFrame() || receivedFrames.Size() != sentFrames.Size())
+		{
+			printf("Sent [%u] frames but reassembled [%u].\n", sentFrames.Size(), receivedFrames.Size());
+			return false;
+		}
+		for (size_t j = 0; j < sentFrames.Size(); ++j)
+		{
+			if (receivedFrames[j].Size() != sentFrames[j].Size()
+				|| memcmp(receivedFrames[j].begin(), sentFrames[j].begin(), sentFrames[j].Size()) != 0)
+			{
+				printf("Frame [%zu] of [%u] bytes wasn't reassembled exactly.\n", j, sentFrames[j].Size());
+				return false;
+			}
+		}
+
+		// A frame header alone must not make the reassembler allocate room for the whole frame.
+		FrameReassembler headerOnlyReassembler{ k_maxTestFrameSize };
+		streamBytes.Clear();
+		Mem::LittleEndian::Serialize(static_cast<uint32_t>(k_maxTestFrameSize), streamBytes);
+		Collection::ArrayView<uint8_t> headerBuffer = headerOnlyReassembler.GetReceiveBuffer();
+		memcpy(headerBuffer.begin(), streamBytes.begin(), streamBytes.Size());
+		headerOnlyReassembler.NotifyOfBytesReceived(streamBytes.Size());
+		if (headerOnlyReassembler.GetReceiveBuffer().Size() > (2 * FrameReassembler::k_minReceiveBufferSize))
+		{
+			printf("A frame header alone made the reassembler grow to fit the whole frame.\n");
+			return false;
+		}
+
+		// Random bytes must either be reassembled into frames within bounds or be rejected as an invalid frame.
+		FillRandomBytes(random, streamBytes, random() % (4 * FrameReassembler::k_minReceiveBufferSize));
+		FrameReassembler randomReassembler{ 1 + (random() % k_maxTestFrameSize) };
+		receivedFrames.Clear();
+		if (!ReceiveInPieces(random, streamBytes, randomReassembler, receivedFrames))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+}
+
+/**
+ * Checks the decoders of network data against round trips, truncated input, and random input. Decoders parse bytes
+ * received from untrusted peers, so they must reject malformed input without reading or writing out of bounds; run
+ * this under a sanitizer or with the debug heap to catch those.
+ *
+ * The number of iterations is specified with -iterations N.
+ * The random seed is specified with -seed N. The seed is printed so that failures can be reproduced.
+ * Compression throughput is measured with -benchmark.
+ */
+int main(const int argc, const char* argv[])
+{
+	using namespace Internal_NetworkFuzzer;
+
+	const Collection::ProgramParameters params{ argc, argv };
+
+	std::string value;
+	uint64_t numIterations = 2000;
+	if (params.TryGet("-iterations", value))
+	{
+		numIterations = std::stoull(value);
+	}
+
+	uint64_t seed = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+	if (params.TryGet("-seed", value))
+	{
+		seed = std::stoull(value);
+	}
+	printf("Seed: %llu\n", static_cast<unsigned long long>(seed));
+	std::mt19937_64 random{ seed };
+
+	// Malformed input makes the decoders log errors, which aren't interesting here.
+	std::ostream discardedErrors{ nullptr };
+	Dev::SetOutputFor(Dev::MessageType::Error, discardedErrors);
+
+	if (params.TryGet("-benchmark", value))
+	{
+		BenchmarkDeltaCompression(random, Network::DeltaCompression::Format::Bytewise, "Bytewise");
+		BenchmarkDeltaCompression(random, Network::DeltaCompression::Format::Wide, "Wide");
+		return 0;
+	}
+
+	if (!FuzzDeltaCompression(random, numIterations))
+	{
+		printf("Delta compression failed with seed [%llu].\n", static_cast<unsigned long long>(seed));
+		return 1;
+	}
+	printf("Delta compression passed [%llu] iterations.\n", static_cast<unsigned long long>(numIterations));
+
+	if (!FuzzMessageFraming(random, numIterations))
+	{
+		printf("Message framing failed with seed [%llu].\n", static_cast<unsigned long long>(seed));
+		return 1;
+	}
+	printf("Message framing passed [%llu] iterations.\n", static_cast<unsigned long long>(numIterations));
+	return 0;
+}
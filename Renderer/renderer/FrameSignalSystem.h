@@ -13,6 +13,6 @@ class FrameSignalSystem final : public ECS::SystemTempl<Util::TypeList<Scene::Sc
 public:
 	void Update(const Unit::Time::Millisecond delta,
 		const Collection::ArrayView<ECSGroupType>& ecsGroups,
-		Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions) const;
+		ECS::DeferredFunctionList& deferredFunctions) const;
 };
 }
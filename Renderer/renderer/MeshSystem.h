@@ -28,7 +28,7 @@ public:
 
 	void Update(const Unit::Time::Millisecond delta,
 		const Collection::ArrayView<ECSGroupType>& ecsGroups,
-		Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions);
+		ECS::DeferredFunctionList& deferredFunctions);
 
 	void NotifyOfEntityAdded(const ECS::EntityID id, const ECSGroupType& group);
 	void NotifyOfEntityRemoved(const ECS::EntityID id, const ECSGroupType& group);
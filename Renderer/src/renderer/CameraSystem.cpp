@@ -7,7 +7,7 @@ namespace Renderer
 {
 void CameraSystem::Update(const Unit::Time::Millisecond delta,
 	const Collection::ArrayView<ECSGroupType>& ecsGroups,
-	Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions)
+	ECS::DeferredFunctionList& deferredFunctions)
 {
 	// Construct and apply a default camera for the scene view.
 	{
@@ -6,7 +6,7 @@ namespace Renderer
 {
 void FrameSignalSystem::Update(const Unit::Time::Millisecond delta,
 	const Collection::ArrayView<ECSGroupType>& ecsGroups,
-	Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions) const
+	ECS::DeferredFunctionList& deferredFunctions) const
 {
 	bgfx::frame();
 }
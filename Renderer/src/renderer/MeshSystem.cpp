@@ -51,7 +51,7 @@ MeshSystem::~MeshSystem()
 
 void MeshSystem::Update(const Unit::Time::Millisecond delta,
 	const Collection::ArrayView<ECSGroupType>& ecsGroups,
-	Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions)
+	ECS::DeferredFunctionList& deferredFunctions)
 {
 	bgfx::Encoder* const encoder = bgfx::begin();
 	if (encoder == nullptr)
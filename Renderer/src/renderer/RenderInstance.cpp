@@ -318,6 +318,8 @@ void RenderInstance::RegisterComponentTypes(ECS::ComponentReflector& componentRe
 void RenderInstance::RegisterSystems(ECS::EntityManager& entityManager)
 {
 	using namespace Internal_RenderInstance;
+
+	// Rendering systems share the renderer's state, so they keep the default exclusive scheduling.
 	entityManager.RegisterSystem(Mem::MakeUnique<CameraSystem>(m_sceneViewFrustum, k_width, k_height));
 
 	entityManager.RegisterSystem(Mem::MakeUnique<MeshSystem>(m_assetManager));
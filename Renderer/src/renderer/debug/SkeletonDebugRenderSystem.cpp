@@ -11,7 +11,7 @@ namespace Renderer::Debug
 {
 void SkeletonDebugRenderSystem::Update(const Unit::Time::Millisecond delta,
 	const Collection::ArrayView<ECSGroupType>& ecsGroups,
-	Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions) const
+	ECS::DeferredFunctionList& deferredFunctions) const
 {
 	bgfx::Encoder* const encoder = bgfx::begin();
 	if (encoder == nullptr)
@@ -18,7 +18,7 @@ TextDisplayRenderSystem::~TextDisplayRenderSystem()
 
 void TextDisplayRenderSystem::Update(const Unit::Time::Millisecond delta,
 	const Collection::ArrayView<ECSGroupType>& ecsGroups,
-	Collection::Vector<std::function<void(ECS::EntityManager&)>>& deferredFunctions)
+	ECS::DeferredFunctionList& deferredFunctions)
 {
 	bgfx::Encoder* const encoder = bgfx::begin();
 	if (encoder == nullptr)